@@ -80,6 +80,7 @@ public:
 
 		uint32_t (*calculate_crc)(const uint8_t* data, uint32_t length);
 		void (*notify_client_messages_processed)(void* reserved);
+		void (*notify_connection_phase)(int phase, void* reserved);
 	};
 
 private:
@@ -122,6 +123,12 @@ private:
 
 	void reset_session();
 
+	void notify_connection_phase(ConnectionPhase::Enum phase) {
+		if (callbacks.notify_connection_phase) {
+			callbacks.notify_connection_phase(phase, nullptr);
+		}
+	}
+
  public:
 	DTLSMessageChannel() :
 			ssl_context(),
@@ -131,6 +131,11 @@ class Protocol
 	 */
 	system_tick_t last_ack_handlers_update;
 
+	/**
+	 * Set if a pipelined Hello message was not acknowledged.
+	 */
+	ProtocolError hello_error;
+
 	uint32_t protocol_flags;
 
 	uint8_t initialized;
@@ -156,7 +161,11 @@ protected:
 		/**
 		 * Support for compressed/combined OTA updates.
 		 */
-		COMPRESSED_OTA = 0x10
+		COMPRESSED_OTA = 0x10,
+		/**
+		 * Do not wait for the Hello message to be acknowledged when resuming a session.
+		 */
+		PIPELINE_RESUMED_HELLO = 0x20
 	};
 
 	/**
@@ -220,6 +229,32 @@ protected:
 	 */
 	ProtocolError hello_response();
 
+	/**
+	 * Send the hello message without waiting for an acknowledgement. The cached session parameters
+	 * are updated once the message is acknowledged.
+	 */
+	ProtocolError pipelined_hello(bool was_ota_upgrade_successful);
+
+	/**
+	 * Get the flags of the hello message.
+	 */
+	uint16_t hello_flags(bool was_ota_upgrade_successful) const;
+
+	/**
+	 * Update the session parameters cached by the channel.
+	 */
+	void update_cached_session_parameters();
+
+	/**
+	 * Notify the system that the connection has reached the given phase.
+	 */
+	void notify_connection_phase(ConnectionPhase::Enum phase)
+	{
+		if (callbacks.notify_connection_phase) {
+			callbacks.notify_connection_phase(phase, nullptr);
+		}
+	}
+
 	virtual size_t build_hello(Message& message, uint16_t flags) = 0;
 
 	/**
@@ -348,6 +383,7 @@ public:
 			publisher(this),
 			description(this),
 			last_ack_handlers_update(0),
+			hello_error(ProtocolError::NO_ERROR),
 			protocol_flags(0),
 			initialized(false),
 			max_binary_size(0), // Unlimited
@@ -387,6 +423,15 @@ public:
 		protocol_flags |= ProtocolFlag::DEVICE_INITIATED_DESCRIBE;
 	}
 
+	void set_pipeline_resumed_hello(bool enabled)
+	{
+		if (enabled) {
+			protocol_flags |= ProtocolFlag::PIPELINE_RESUMED_HELLO;
+		} else {
+			protocol_flags &= ~ProtocolFlag::PIPELINE_RESUMED_HELLO;
+		}
+	}
+
 	void set_compressed_ota_enabled(bool enabled)
 	{
 		if (enabled) {
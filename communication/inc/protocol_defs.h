@@ -98,6 +98,9 @@ const size_t MAX_VARIABLE_VALUE_LENGTH = 1024;
 // Timeout in milliseconds given to receive an acknowledgement for a published event
 const unsigned SEND_EVENT_ACK_TIMEOUT = 20000;
 
+// Timeout in milliseconds given to receive an acknowledgement for a pipelined Hello message
+const unsigned HELLO_ACK_TIMEOUT = 20000;
+
 /**
  * Maximum possible size of a CoAP message carrying a cloud event.
  */
@@ -153,7 +156,36 @@ enum Enum
     MAX_TRANSMIT_MESSAGE_SIZE = 7, ///< Maximum size of of outgoing CoAP message (set).
     MAX_EVENT_DATA_SIZE = 8, ///< Maximum size of event data (get).
     MAX_VARIABLE_VALUE_SIZE = 9, ///< Maximum size of a variable value (get).
-    MAX_FUNCTION_ARGUMENT_SIZE = 10 ///< Maximum size of a function call argument (get).
+    MAX_FUNCTION_ARGUMENT_SIZE = 10, ///< Maximum size of a function call argument (get).
+    PIPELINE_RESUMED_HELLO = 11 ///< Enable/disable pipelining of the Hello message on resumed sessions (set).
+};
+
+}
+
+namespace ConnectionPhase
+{
+
+/**
+ * Phases of a cloud connection attempt.
+ *
+ * @see `SparkCallbacks::notify_connection_phase`
+ */
+enum Enum
+{
+    CONNECT_START = 0, ///< Connection attempt started.
+    DNS_RESOLVED = 1, ///< Server address resolved.
+    SOCKET_CONNECTED = 2, ///< Socket connected.
+    HANDSHAKE_START = 3, ///< Secure session negotiation started.
+    HANDSHAKE_FLIGHT_SENT = 4, ///< A flight of handshake messages sent to the server.
+    HANDSHAKE_FLIGHT_RECEIVED = 5, ///< A flight of handshake messages received from the server.
+    HANDSHAKE_DONE = 6, ///< Full handshake completed.
+    SESSION_RESUMED = 7, ///< Session resumed without a handshake.
+    HELLO_SENT = 8, ///< Hello message sent.
+    HELLO_ACKED = 9, ///< Hello message acknowledged.
+    DESCRIBE_SENT = 10, ///< Describe message sent.
+    SUBSCRIPTIONS_SENT = 11, ///< Subscriptions sent.
+    CONNECTED = 12, ///< All handshake messages acknowledged.
+    PHASE_COUNT = 13 ///< Number of phases.
 };
 
 }
@@ -143,9 +143,16 @@ struct SparkCallbacks
             void* context);
 
     // size == 60
+
+    /**
+     * Notify the system that the connection has reached the given phase (see `ConnectionPhase`).
+     */
+    void (*notify_connection_phase)(int phase, void* reserved);
+
+    // size == 64
 };
 
-PARTICLE_STATIC_ASSERT(SparkCallbacks_size, sizeof(SparkCallbacks)==(sizeof(void*)*15));
+PARTICLE_STATIC_ASSERT(SparkCallbacks_size, sizeof(SparkCallbacks)==(sizeof(void*)*16));
 
 /**
  * Application-supplied callbacks. (Deliberately distinct from the system-supplied
@@ -42,6 +42,7 @@ typedef CoapTag CoapToken;
 
 class CoapPayload;
 class CoapOptionEntry;
+class CoapRouter;
 
 /**
  * Base abstract class for a CoAP message.
@@ -147,7 +148,6 @@ private:
     struct Message;
     struct RequestMessage;
     struct ResponseMessage;
-    struct RequestHandler;
     struct ConnectionHandler;
     struct EncodingContext;
 
@@ -155,7 +155,7 @@ private:
 
     MessageBuffer msgBuf_; // Reference to the shared message buffer
     ConnectionHandler* connHandlers_; // List of registered connection handlers
-    RequestHandler* reqHandlers_; // List of registered request handlers
+    std::unique_ptr<CoapRouter> reqRouter_; // Registered request handlers
     RequestMessage* sentReqs_; // List of requests awaiting a response from the server
     RequestMessage* recvReqs_; // List of requests awaiting a response from the device
     RequestMessage* recvBlockReqs_; // List of incoming blockwise requests in progress
@@ -89,10 +89,15 @@ CoapMessageDecoder::CoapMessageDecoder() :
         tokenSize_(0),
         optsSize_(0),
         payloadSize_(0),
-        code_(0) {
+        optIndexSize_(0),
+        code_(0),
+        optIndexComplete_(true) {
 }
 
 int CoapMessageDecoder::decode(const char* data, size_t size) {
+    // Invalidate the option index in case the message cannot be decoded
+    optIndexSize_ = 0;
+    optIndexComplete_ = false;
     size_t offs = 0;
     // Message header
     uint32_t h = 0;
@@ -118,9 +123,25 @@ int CoapMessageDecoder::decode(const char* data, size_t size) {
     offs += tokenSize;
     // Options
     size_t optsOffs = offs;
+    size_t optIndexSize = 0;
+    bool optIndexComplete = true;
+    unsigned opt = 0;
     while (size - offs > 0 && *(data + offs) != (char)0xff) {
-        offs += CHECK(readOption(nullptr /* opt */, nullptr /* optData */, nullptr /* optSize */, 0 /* prevOpt */,
-                data + offs, size - offs));
+        const char* optData = nullptr;
+        size_t optSize = 0;
+        offs += CHECK(readOption(&opt, &optData, &optSize, opt /* prevOpt */, data + offs, size - offs));
+        if (!optIndexComplete) {
+            continue;
+        }
+        const size_t optOffs = optData - (data + optsOffs);
+        if (optIndexSize == MAX_INDEXED_OPTION_COUNT || optOffs + optSize > 0xffff) {
+            optIndexComplete = false;
+            continue;
+        }
+        auto& e = optIndex_[optIndexSize++];
+        e.num = opt;
+        e.offs = optOffs;
+        e.size = optSize;
     }
     const size_t optsSize = offs - optsOffs;
     // Payload
@@ -131,6 +152,8 @@ int CoapMessageDecoder::decode(const char* data, size_t size) {
     payload_ = (payloadSize_ > 0) ? data + offs : nullptr;
     optsSize_ = optsSize;
     opts_ = (optsSize_ > 0) ? data + optsOffs : nullptr;
+    optIndexSize_ = optIndexSize;
+    optIndexComplete_ = optIndexComplete;
     tokenSize_ = tokenSize;
     memcpy(token_, data + tokenOffs, tokenSize_);
     code_ = code;
@@ -140,12 +163,43 @@ int CoapMessageDecoder::decode(const char* data, size_t size) {
 }
 
 CoapOptionIterator CoapMessageDecoder::findOption(unsigned opt) const {
-    auto it = options();
+    // Options are sorted by their numbers
+    for (size_t i = 0; i < optIndexSize_; ++i) {
+        const auto num = optIndex_[i].num;
+        if (num == opt) {
+            return indexedOption(i);
+        }
+        if (num > opt) {
+            return CoapOptionIterator();
+        }
+    }
+    if (optIndexComplete_) {
+        return CoapOptionIterator();
+    }
+    // Parse the options that didn't fit in the index
+    auto it = (optIndexSize_ > 0) ? indexedOption(optIndexSize_ - 1) : options();
     while (it.next()) {
         if (it.option() == opt) {
             break;
         }
+        if (it.option() > opt) {
+            return CoapOptionIterator();
+        }
+    }
+    return it;
+}
+
+CoapOptionIterator CoapMessageDecoder::indexedOption(size_t index) const {
+    const auto& e = optIndex_[index];
+    const size_t nextOffs = e.offs + e.size;
+    CoapOptionIterator it;
+    if (nextOffs < optsSize_) {
+        it.nextOpt_ = opts_ + nextOffs;
+        it.bufSize_ = optsSize_ - nextOffs;
     }
+    it.optData_ = opts_ + e.offs;
+    it.optSize_ = e.size;
+    it.opt_ = e.num;
     return it;
 }
 
@@ -20,6 +20,7 @@
 #include "coap_defs.h"
 
 #include <cstddef>
+#include <cstdint>
 
 namespace particle {
 
@@ -29,9 +30,15 @@ class CoapOptionIterator;
 
 /**
  * A class for decoding CoAP messages.
+ *
+ * The message options are parsed in a single pass by `decode()`, which records the location of the
+ * first `MAX_INDEXED_OPTION_COUNT` options in the message. `findOption()` and `hasOption()` look up
+ * the indexed options without parsing the message data again.
  */
 class CoapMessageDecoder {
 public:
+    static const size_t MAX_INDEXED_OPTION_COUNT = 12;
+
     CoapMessageDecoder();
 
     CoapType type() const;
@@ -58,9 +65,16 @@ public:
     static int decodeUintOptionValue(const char* data, size_t size, unsigned& val);
 
 private:
+    struct IndexedOption {
+        unsigned num; // Option number
+        uint16_t offs; // Offset of the option value from the start of the options data
+        uint16_t size; // Size of the option value
+    };
+
     // We want all fields that identify the message, such as the ID and token, to remain valid
     // even if the data in the source buffer is not valid anymore
     char token_[MAX_COAP_TOKEN_SIZE];
+    IndexedOption optIndex_[MAX_INDEXED_OPTION_COUNT];
     CoapType type_;
     CoapMessageId id_;
     const char* opts_;
@@ -68,7 +82,11 @@ private:
     size_t tokenSize_;
     size_t optsSize_;
     size_t payloadSize_;
+    size_t optIndexSize_;
     unsigned code_;
+    bool optIndexComplete_;
+
+    CoapOptionIterator indexedOption(size_t index) const;
 };
 
 /**
@@ -318,9 +318,9 @@ ProtocolError Description::receiveRequest(const Message& msg) {
             enc.option(CoapOption::CONTENT_FORMAT, contentFormat);
         }
         const size_t msgOffs = enc.payloadData() - (char*)respMsg.buf();
-        Vector<char> buf;
-        CHECK_PROTOCOL(getDescribeData(flags, &respMsg, msgOffs, &buf, &payloadSize));
-        if (!buf.isEmpty()) {
+        RefCountPtr<Data> data;
+        CHECK_PROTOCOL(getDescribeData(flags, &respMsg, msgOffs, &data, &payloadSize));
+        if (data) {
             // Prepare a blockwise response
             if (flags & DescriptionType::DESCRIBE_SYSTEM) {
                 // Re-encode response without Content-Type option
@@ -328,8 +328,8 @@ ProtocolError Description::receiveRequest(const Message& msg) {
                 enc = CoapMessageEncoder((char*)respMsg.buf(), respMsg.capacity());
                 initDescribeResponse(&enc, reqToken, flags);
             }
-            newResp.data = std::move(buf);
-            newResp.blockCount = (newResp.data.size() + blockSize - 1) / blockSize;
+            newResp.data = std::move(data);
+            newResp.blockCount = (newResp.data->buf.size() + blockSize - 1) / blockSize;
             newResp.reqCount = 1;
             newResp.etag = ++lastEtag_;
             newResp.flags = flags;
@@ -404,7 +404,7 @@ ProtocolError Description::receiveAckOrRst(const Message& msg, int* descFlags, b
             activeReq_.reset();
             return ProtocolError::MESSAGE_RESET;
         }
-        if (!activeReq_->data.isEmpty()) {
+        if (activeReq_->offset < (size_t)activeReq_->data->buf.size()) {
             // Send the next block of the current blockwise request
             Message msg;
             CHECK_PROTOCOL(proto_->get_channel().create(msg));
@@ -536,6 +536,16 @@ void Description::reset() {
     activeResps_.clear();
     reqQueue_.clear();
     acks_.clear();
+    // The checksum of the system state doesn't cover everything that is reported in the system
+    // Describe, such as the modem info and the device protection state, so the system Describe
+    // data is reused only within a session
+    for (int i = 0; i < cache_.size();) {
+        if (cache_[i].flags == DescriptionType::DESCRIBE_SYSTEM) {
+            cache_.removeAt(i);
+        } else {
+            ++i;
+        }
+    }
     blockSize_ = 0;
 }
 
@@ -548,16 +558,16 @@ ProtocolError Description::sendNextRequest(int flags) {
     const auto token = proto_->get_next_token();
     initDescribeRequest(&enc, token, flags);
     const size_t msgOffs = enc.payloadData() - (char*)msg.buf();
-    Vector<char> buf;
+    RefCountPtr<Data> data;
     size_t payloadSize = 0;
-    CHECK_PROTOCOL(getDescribeData(flags, &msg, msgOffs, &buf, &payloadSize));
-    if (!buf.isEmpty()) {
+    CHECK_PROTOCOL(getDescribeData(flags, &msg, msgOffs, &data, &payloadSize));
+    if (data) {
         // Send a blockwise request
         Request req = {};
-        req.data = std::move(buf);
+        req.data = std::move(data);
         req.flags = flags;
         CHECK_PROTOCOL(sendNextRequestBlock(&req, &msg, token));
-        SPARK_ASSERT(!req.data.isEmpty());
+        SPARK_ASSERT(req.offset < (size_t)req.data->buf.size());
         activeReq_ = std::move(req);
     } else {
         // Send a regular request
@@ -578,7 +588,8 @@ ProtocolError Description::sendNextRequestBlock(Request* req, Message* msg, toke
     initDescribeRequest(&enc, token, req->flags);
     size_t blockSize = 0;
     CHECK_PROTOCOL(getBlockSize(&blockSize));
-    size_t payloadSize = req->data.size();
+    const auto& buf = req->data->buf;
+    size_t payloadSize = buf.size() - req->offset;
     bool hasMore = false;
     if (payloadSize > blockSize) {
         payloadSize = blockSize;
@@ -586,13 +597,10 @@ ProtocolError Description::sendNextRequestBlock(Request* req, Message* msg, toke
     }
     const auto blockOpt = encodeBlockOption(req->nextBlockIndex, blockSize, hasMore);
     enc.option(CoapOption::BLOCK1, blockOpt);
-    enc.payload(req->data.data(), payloadSize);
+    enc.payload(buf.data() + req->offset, payloadSize);
     CHECK_PROTOCOL(encodeAndSend(&enc, msg));
     req->msgId = msg->get_id();
-    const size_t newSize = req->data.size() - payloadSize;
-    memmove(req->data.data(), req->data.data() + payloadSize, newSize);
-    req->data.resize(newSize);
-    req->data.trimToSize(); // Ignore error
+    req->offset += payloadSize;
     ++req->nextBlockIndex;
     return ProtocolError::NO_ERROR;
 }
@@ -603,8 +611,9 @@ ProtocolError Description::sendResponseBlock(const Response& resp, Message* msg,
     enc.option(CoapOption::ETAG, resp.etag);
     size_t blockSize = 0;
     CHECK_PROTOCOL(getBlockSize(&blockSize));
+    const auto& buf = resp.data->buf;
     size_t offs = blockIndex * blockSize;
-    size_t payloadSize = resp.data.size() - offs;
+    size_t payloadSize = buf.size() - offs;
     bool hasMore = false;
     if (payloadSize > blockSize) {
         payloadSize = blockSize;
@@ -616,7 +625,7 @@ ProtocolError Description::sendResponseBlock(const Response& resp, Message* msg,
     }
     const auto blockOpt = encodeBlockOption(blockIndex, blockSize, hasMore);
     enc.option(CoapOption::BLOCK2, blockOpt);
-    enc.payload(resp.data.data() + offs, payloadSize);
+    enc.payload(buf.data() + offs, payloadSize);
     CHECK_PROTOCOL(encodeAndSend(&enc, msg));
     return ProtocolError::NO_ERROR;
 }
@@ -664,18 +673,93 @@ ProtocolError Description::encodeAndSend(CoapMessageEncoder* enc, Message* msg)
     return ProtocolError::NO_ERROR;
 }
 
-ProtocolError Description::getDescribeData(int flags, Message* msg, size_t msgOffs, Vector<char>* buf, size_t* size) {
+ProtocolError Description::getDescribeData(int flags, Message* msg, size_t msgOffs, RefCountPtr<Data>* data, size_t* size) {
     const size_t maxMsgSize = proto_->get_max_transmit_message_size();
     SPARK_ASSERT(msgOffs <= maxMsgSize);
-    BufferAppender2 appender((char*)msg->buf() + msgOffs, maxMsgSize - msgOffs, buf);
-    CHECK_PROTOCOL(serialize(&appender, flags));
-    if (!appender.ok()) {
-        return ProtocolError::NO_MEMORY;
+    char* const msgBuf = (char*)msg->buf() + msgOffs;
+    const size_t msgBufSize = maxMsgSize - msgOffs;
+    uint32_t checksum = 0;
+    if (!getAppStateChecksum(flags, &checksum)) {
+        // The data cannot be cached. Serialize it directly to the message buffer
+        Vector<char> buf;
+        BufferAppender2 appender(msgBuf, msgBufSize, &buf);
+        CHECK_PROTOCOL(serialize(&appender, flags));
+        if (!appender.ok()) {
+            return ProtocolError::NO_MEMORY;
+        }
+        if (!buf.isEmpty()) {
+            auto d = makeRefCountPtr<Data>();
+            if (!d) {
+                return ProtocolError::NO_MEMORY;
+            }
+            d->buf = std::move(buf);
+            *data = std::move(d);
+        }
+        *size = appender.size();
+        return ProtocolError::NO_ERROR;
+    }
+    int index = 0;
+    for (; index < cache_.size(); ++index) {
+        if (cache_[index].flags == flags) {
+            break;
+        }
+    }
+    if (index == cache_.size() || cache_[index].checksum != checksum) {
+        // Serialize the data for the current application state
+        auto d = makeRefCountPtr<Data>();
+        if (!d) {
+            return ProtocolError::NO_MEMORY;
+        }
+        BufferAppender2 appender(nullptr /* buf */, 0 /* bufSize */, &d->buf);
+        CHECK_PROTOCOL(serialize(&appender, flags));
+        if (!appender.ok()) {
+            return ProtocolError::NO_MEMORY;
+        }
+        d->buf.trimToSize(); // Ignore error
+        CachedData c = {};
+        c.data = std::move(d);
+        c.checksum = checksum;
+        c.flags = flags;
+        if (index == cache_.size()) {
+            if (!cache_.append(std::move(c))) {
+                return ProtocolError::NO_MEMORY;
+            }
+        } else {
+            cache_[index] = std::move(c);
+        }
+    }
+    const auto& d = cache_[index].data;
+    const size_t n = d->buf.size();
+    if (n > msgBufSize) {
+        // The blockwise transfer will use the cached data
+        *data = d;
+    } else {
+        memcpy(msgBuf, d->buf.data(), n);
     }
-    *size = appender.size();
+    *size = n;
     return ProtocolError::NO_ERROR;
 }
 
+bool Description::getAppStateChecksum(int flags, uint32_t* checksum) const {
+    const auto& descriptor = proto_->get_descriptor();
+    if (!descriptor.app_state_selector_info) {
+        return false;
+    }
+    SparkAppStateSelector::Enum selector = SparkAppStateSelector::DESCRIBE_APP;
+    switch (flags) {
+    case DescriptionType::DESCRIBE_SYSTEM:
+        selector = SparkAppStateSelector::DESCRIBE_SYSTEM;
+        break;
+    case DescriptionType::DESCRIBE_APPLICATION:
+        selector = SparkAppStateSelector::DESCRIBE_APP;
+        break;
+    default:
+        return false; // Metrics are never cached
+    }
+    *checksum = descriptor.app_state_selector_info(selector, SparkAppStateUpdate::COMPUTE, 0, nullptr);
+    return true;
+}
+
 ProtocolError Description::getBlockSize(size_t* size) {
     static_assert(MIN_BLOCK_SIZE == 512 && MAX_BLOCK_SIZE == 1024, "This code needs to be updated accordingly");
     if (!blockSize_) {
@@ -21,6 +21,7 @@
 #include "coap_defs.h"
 
 #include "spark_wiring_vector.h"
+#include "ref_count.h"
 
 #include "hal_platform.h"
 
@@ -56,15 +57,26 @@ public:
     void reset();
 
 private:
+    struct Data: RefCount {
+        Vector<char> buf; // Serialized Describe data
+    };
+
+    struct CachedData {
+        RefCountPtr<Data> data; // Serialized Describe data
+        uint32_t checksum; // Checksum of the application state the data was serialized for
+        int flags; // Describe flags
+    };
+
     struct Request {
-        Vector<char> data; // Remaining Describe data
+        RefCountPtr<Data> data; // Describe data
+        size_t offset; // Offset of the next block in the Describe data
         message_id_t msgId; // Message ID of the last sent block request
         unsigned nextBlockIndex; // Index of the next block to send
         int flags; // Describe flags
     };
 
     struct Response {
-        Vector<char> data; // Describe data
+        RefCountPtr<Data> data; // Describe data
         system_tick_t lastAccessTime; // Last time this Describe data was requested
         unsigned blockCount; // Number of blocks required to transfer the Describe data
         unsigned reqCount; // Number of concurrent blockwise transfers requesting the Describe data
@@ -81,6 +93,7 @@ private:
     Vector<Response> activeResps_; // Blockwise Describe responses that are being sent to the server
     Vector<int> reqQueue_; // Queued Describe requests (flags)
     Vector<Ack> acks_; // Pending acknowledgements for device-originated messages
+    Vector<CachedData> cache_; // Describe data serialized for the current application state
     Protocol* proto_; // Protocol instance
     size_t blockSize_; // Block size used for blockwise transfers
     unsigned lastEtag_; // Last used ETag
@@ -91,7 +104,8 @@ private:
     ProtocolError sendErrorResponse(const CoapMessageDecoder& reqDec, CoapCode code);
     ProtocolError sendEmptyAck(message_id_t msgId);
     ProtocolError encodeAndSend(CoapMessageEncoder* enc, Message* msg);
-    ProtocolError getDescribeData(int flags, Message* msg, size_t msgOffs, Vector<char>* buf, size_t* size);
+    ProtocolError getDescribeData(int flags, Message* msg, size_t msgOffs, RefCountPtr<Data>* data, size_t* size);
+    bool getAppStateChecksum(int flags, uint32_t* checksum) const;
     ProtocolError getBlockSize(size_t* size);
     system_tick_t millis() const;
 };
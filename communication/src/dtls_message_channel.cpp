@@ -60,6 +60,38 @@ namespace {
 // A custom content type for session resumption packets
 const unsigned ALT_CID_CONTENT_TYPE = 253;
 
+// Returns true if the client sends handshake messages in the given state
+bool is_client_flight_state(int state) {
+	switch (state) {
+	case MBEDTLS_SSL_CLIENT_HELLO:
+	case MBEDTLS_SSL_CLIENT_CERTIFICATE:
+	case MBEDTLS_SSL_CLIENT_KEY_EXCHANGE:
+	case MBEDTLS_SSL_CERTIFICATE_VERIFY:
+	case MBEDTLS_SSL_CLIENT_CHANGE_CIPHER_SPEC:
+	case MBEDTLS_SSL_CLIENT_FINISHED:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Returns true if the client receives handshake messages in the given state
+bool is_server_flight_state(int state) {
+	switch (state) {
+	case MBEDTLS_SSL_SERVER_HELLO:
+	case MBEDTLS_SSL_SERVER_CERTIFICATE:
+	case MBEDTLS_SSL_SERVER_KEY_EXCHANGE:
+	case MBEDTLS_SSL_CERTIFICATE_REQUEST:
+	case MBEDTLS_SSL_SERVER_HELLO_DONE:
+	case MBEDTLS_SSL_SERVER_CHANGE_CIPHER_SPEC:
+	case MBEDTLS_SSL_SERVER_FINISHED:
+	case MBEDTLS_SSL_SERVER_NEW_SESSION_TICKET:
+		return true;
+	default:
+		return false;
+	}
+}
+
 } // namespace
 
 uint32_t compute_checksum(uint32_t(*calculate_crc)(const uint8_t* data, uint32_t len), const uint8_t* server, size_t server_len, const uint8_t* device, size_t device_len)
@@ -404,6 +436,7 @@ ProtocolError DTLSMessageChannel::setup_context()
 ProtocolError DTLSMessageChannel::establish()
 {
 	int ret = 0;
+	notify_connection_phase(ConnectionPhase::HANDSHAKE_START);
 	// LOG(INFO,"setup context");
 	ProtocolError error = setup_context();
 	if (error) {
@@ -422,6 +455,7 @@ ProtocolError DTLSMessageChannel::establish()
 				sessionPersist.out_ctr[7], sessionPersist.next_coap_id);
 		sessionPersist.make_persistent();
 		LOG(INFO,"restored session from persisted session data. next_msg_id=%d", *coap_state);
+		notify_connection_phase(ConnectionPhase::SESSION_RESUMED);
 		return SESSION_RESUMED;
 	}
 	else if (restoreStatus==SessionPersist::RENEGOTIATE)
@@ -441,11 +475,19 @@ ProtocolError DTLSMessageChannel::establish()
 	{
 		while (ssl_context.state != MBEDTLS_SSL_HANDSHAKE_OVER)
 		{
+			const int prev_state = ssl_context.state;
 			ret = mbedtls_ssl_handshake_step(&ssl_context);
 
 			if (ret != 0)
 				break;
 
+			// A flight ends when the state machine stops sending or receiving handshake messages
+			if (is_client_flight_state(prev_state) && !is_client_flight_state(ssl_context.state)) {
+				notify_connection_phase(ConnectionPhase::HANDSHAKE_FLIGHT_SENT);
+			} else if (is_server_flight_state(prev_state) && !is_server_flight_state(ssl_context.state)) {
+				notify_connection_phase(ConnectionPhase::HANDSHAKE_FLIGHT_RECEIVED);
+			}
+
 			// we've already received the ServerHello, thus
 			// we have the random values for client and server
 			if (ssl_context.state == MBEDTLS_SSL_SERVER_KEY_EXCHANGE)
@@ -468,6 +510,7 @@ ProtocolError DTLSMessageChannel::establish()
 		return IO_ERROR_GENERIC_ESTABLISH;
 	}
 
+	notify_connection_phase(ConnectionPhase::HANDSHAKE_DONE);
 	return NO_ERROR;
 }
 
@@ -29,6 +29,9 @@ void DTLSProtocol::init(const char *id,
 	if (offsetof(SparkCallbacks, notify_client_messages_processed) + sizeof(SparkCallbacks::notify_client_messages_processed) <= callbacks.size) {
 		channelCallbacks.notify_client_messages_processed = callbacks.notify_client_messages_processed;
 	}
+	if (offsetof(SparkCallbacks, notify_connection_phase) + sizeof(SparkCallbacks::notify_connection_phase) <= callbacks.size) {
+		channelCallbacks.notify_connection_phase = callbacks.notify_connection_phase;
+	}
 
 	// TODO: Ideally, the next token value should be stored in the session data
 	mbedtls_default_rng(nullptr, &next_token, sizeof(next_token));
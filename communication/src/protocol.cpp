@@ -519,12 +519,24 @@ int Protocol::begin()
 		}
 	}
 
+	// On a resumed session, the server already has all the state it needs to process other messages,
+	// so the Hello and Describe messages can be sent in a single flight
+	const bool pipeline_hello = session_resumed && (protocol_flags & ProtocolFlag::PIPELINE_RESUMED_HELLO);
 	LOG(INFO, "Sending HELLO message");
-	error = hello(descriptor.was_ota_upgrade_successful());
+	if (pipeline_hello) {
+		error = pipelined_hello(descriptor.was_ota_upgrade_successful());
+	} else {
+		error = hello(descriptor.was_ota_upgrade_successful());
+	}
 	if (error) {
 		LOG(ERROR,"Could not send HELLO message: %d", error);
 		return error;
 	}
+	if (!pipeline_hello) {
+		// The message was sent and acknowledged synchronously
+		notify_connection_phase(ConnectionPhase::HELLO_SENT);
+		notify_connection_phase(ConnectionPhase::HELLO_ACKED);
+	}
 
 	if (protocol_flags & ProtocolFlag::REQUIRE_HELLO_RESPONSE) {
 		LOG(INFO, "Receiving HELLO response");
@@ -539,16 +551,8 @@ int Protocol::begin()
 
 	// An ACK or a response for the Hello message has already been received at this point, so we can
 	// update the cached session parameters
-	if (descriptor.app_state_selector_info) {
-		LOG(TRACE, "Updating cached session parameters");
-		channel.command(Channel::SAVE_SESSION);
-		// TODO: Update the underlying SessionPersist structure directly
-		descriptor.app_state_selector_info(SparkAppStateSelector::PROTOCOL_FLAGS, SparkAppStateUpdate::PERSIST, protocol_flags, nullptr);
-		descriptor.app_state_selector_info(SparkAppStateSelector::SYSTEM_MODULE_VERSION, SparkAppStateUpdate::PERSIST, system_version, nullptr);
-		descriptor.app_state_selector_info(SparkAppStateSelector::MAX_MESSAGE_SIZE, SparkAppStateUpdate::PERSIST, PROTOCOL_BUFFER_SIZE, nullptr);
-		descriptor.app_state_selector_info(SparkAppStateSelector::MAX_BINARY_SIZE, SparkAppStateUpdate::PERSIST, max_binary_size, nullptr);
-		descriptor.app_state_selector_info(SparkAppStateSelector::OTA_CHUNK_SIZE, SparkAppStateUpdate::PERSIST, ota_chunk_size, nullptr);
-		channel.command(Channel::LOAD_SESSION);
+	if (!pipeline_hello) {
+		update_cached_session_parameters();
 	}
 
 	if (protocol_flags & ProtocolFlag::DEVICE_INITIATED_DESCRIBE) {
@@ -563,6 +567,22 @@ int Protocol::begin()
 	return 0;
 }
 
+void Protocol::update_cached_session_parameters()
+{
+	if (!descriptor.app_state_selector_info) {
+		return;
+	}
+	LOG(TRACE, "Updating cached session parameters");
+	channel.command(Channel::SAVE_SESSION);
+	// TODO: Update the underlying SessionPersist structure directly
+	descriptor.app_state_selector_info(SparkAppStateSelector::PROTOCOL_FLAGS, SparkAppStateUpdate::PERSIST, protocol_flags, nullptr);
+	descriptor.app_state_selector_info(SparkAppStateSelector::SYSTEM_MODULE_VERSION, SparkAppStateUpdate::PERSIST, system_version, nullptr);
+	descriptor.app_state_selector_info(SparkAppStateSelector::MAX_MESSAGE_SIZE, SparkAppStateUpdate::PERSIST, PROTOCOL_BUFFER_SIZE, nullptr);
+	descriptor.app_state_selector_info(SparkAppStateSelector::MAX_BINARY_SIZE, SparkAppStateUpdate::PERSIST, max_binary_size, nullptr);
+	descriptor.app_state_selector_info(SparkAppStateSelector::OTA_CHUNK_SIZE, SparkAppStateUpdate::PERSIST, ota_chunk_size, nullptr);
+	channel.command(Channel::LOAD_SESSION);
+}
+
 void Protocol::reset() {
 #if HAL_PLATFORM_OTA_PROTOCOL_V3
 	firmwareUpdate.reset();
@@ -573,6 +593,7 @@ void Protocol::reset() {
 	timesync_.reset();
 	description.reset();
 	ack_handlers.clear();
+	hello_error = ProtocolError::NO_ERROR;
 	channel.reset();
 	subscription_msg_ids.clear();
 	v2::CoapChannel::instance()->close();
@@ -586,7 +607,48 @@ ProtocolError Protocol::hello(bool was_ota_upgrade_successful)
 {
 	Message message;
 	channel.create(message);
+	size_t len = build_hello(message, hello_flags(was_ota_upgrade_successful));
+	message.set_length(len);
+	message.set_confirm_received(true); // Send synchronously
+	last_message_millis = callbacks.millis();
+	return channel.send(message);
+}
+
+ProtocolError Protocol::pipelined_hello(bool was_ota_upgrade_successful)
+{
+	struct Callback {
+		static void hello_acked(int error, const void* data, void* callback_data, void* reserved) {
+			const auto p = (Protocol*)callback_data;
+			if (error < 0) {
+				// The server can't process any other messages without a Hello. The cached parameters
+				// are left intact so that the Hello message is sent again next time the session is
+				// resumed
+				LOG(ERROR, "HELLO message was not acknowledged: %d", error);
+				p->hello_error = (error == SYSTEM_ERROR_TIMEOUT) ? ProtocolError::MESSAGE_TIMEOUT : ProtocolError::COAP_ERROR;
+				return;
+			}
+			p->notify_connection_phase(ConnectionPhase::HELLO_ACKED);
+			p->update_cached_session_parameters();
+		}
+	};
+	Message message;
+	channel.create(message);
+	size_t len = build_hello(message, hello_flags(was_ota_upgrade_successful));
+	message.set_length(len);
+	last_message_millis = callbacks.millis();
+	const ProtocolError error = channel.send(message);
+	if (error) {
+		return error;
+	}
+	notify_connection_phase(ConnectionPhase::HELLO_SENT);
+	if (message.has_id()) {
+		add_ack_handler(message.get_id(), CompletionHandler(Callback::hello_acked, this), HELLO_ACK_TIMEOUT);
+	}
+	return ProtocolError::NO_ERROR;
+}
 
+uint16_t Protocol::hello_flags(bool was_ota_upgrade_successful) const
+{
 	uint16_t flags = HELLO_FLAG_DIAGNOSTICS_SUPPORT | HELLO_FLAG_IMMEDIATE_UPDATES_SUPPORT |
 			HELLO_FLAG_GOODBYE_SUPPORT;
 	if (was_ota_upgrade_successful) {
@@ -601,11 +663,7 @@ ProtocolError Protocol::hello(bool was_ota_upgrade_successful)
 #if HAL_PLATFORM_OTA_PROTOCOL_V3
 	flags |= HELLO_FLAG_OTA_PROTOCOL_V3;
 #endif
-	size_t len = build_hello(message, flags);
-	message.set_length(len);
-	message.set_confirm_received(true); // Send synchronously
-	last_message_millis = callbacks.millis();
-	return channel.send(message);
+	return flags;
 }
 
 ProtocolError Protocol::hello_response()
@@ -673,6 +731,10 @@ ProtocolError Protocol::event_loop(CoAPMessageType::Enum& message_type)
 			error = event_loop_idle();
 		}
 	}
+	if (!error && hello_error)
+	{
+		error = hello_error;
+	}
 
 	if (error)
 	{
@@ -710,7 +772,11 @@ ProtocolError Protocol::post_description(int desc_flags, bool force)
 	if (!desc_flags) {
 		return ProtocolError::NO_ERROR;
 	}
-	return description.sendRequest(desc_flags);
+	const ProtocolError error = description.sendRequest(desc_flags);
+	if (error == ProtocolError::NO_ERROR) {
+		notify_connection_phase(ConnectionPhase::DESCRIBE_SENT);
+	}
+	return error;
 }
 
 ProtocolError Protocol::send_subscription(const char *event_name, int flags)
@@ -738,8 +804,11 @@ ProtocolError Protocol::send_subscriptions(bool force)
 	}
 	LOG(INFO, "Sending subscriptions");
 	const ProtocolError error = subscriptions.send_subscriptions(channel);
-	if (error == ProtocolError::NO_ERROR && descriptor.app_state_selector_info) {
-		subscription_msg_ids.append(subscriptions.subscription_message_ids());
+	if (error == ProtocolError::NO_ERROR) {
+		if (descriptor.app_state_selector_info) {
+			subscription_msg_ids.append(subscriptions.subscription_message_ids());
+		}
+		notify_connection_phase(ConnectionPhase::SUBSCRIPTIONS_SENT);
 	}
 	return error;
 }
@@ -226,6 +226,10 @@ int spark_protocol_set_connection_property(ProtocolFacade* protocol, unsigned pr
         protocol->set_max_transmit_message_size(value);
         return 0;
     }
+    case Connection::PIPELINE_RESUMED_HELLO: {
+        protocol->set_pipeline_resumed_hello(value);
+        return 0;
+    }
     default:
         return ProtocolError::NOT_IMPLEMENTED;
     }
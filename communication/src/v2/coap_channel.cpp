@@ -35,6 +35,7 @@ LOG_SOURCE_CATEGORY("comm.coap")
 #include "v2/coap_channel.h"
 #include "coap_payload.h"
 #include "coap_options.h"
+#include "coap_router.h"
 #include "coap_message_encoder.h"
 #include "coap_message_decoder.h"
 #include "coap_util.h"
@@ -42,7 +43,6 @@ LOG_SOURCE_CATEGORY("comm.coap")
 #include "spark_protocol_functions.h"
 #include "communication_diagnostic.h"
 
-#include "c_string.h"
 #include "endian_util.h"
 #include "scope_guard.h"
 #include "check.h"
@@ -312,31 +312,6 @@ struct CoapChannel::ResponseMessage: Message {
     }
 };
 
-struct CoapChannel::RequestHandler {
-    CString path; // Base URI path
-    size_t pathLen; // Path length
-    coap_method method; // Method code
-
-    coap_request_callback callback; // Callback to invoke when a request is received
-    void* callbackArg; // User argument to pass to the callback
-
-    int flags; // Message flags
-
-    RequestHandler* next; // Next handler in the list
-    RequestHandler* prev; // Previous handler in the list
-
-    RequestHandler(CString path, size_t pathLen, coap_method method, int flags, coap_request_callback callback, void* callbackArg) :
-            path(std::move(path)),
-            pathLen(pathLen),
-            method(method),
-            callback(callback),
-            callbackArg(callbackArg),
-            flags(flags),
-            next(nullptr),
-            prev(nullptr) {
-    }
-};
-
 struct CoapChannel::ConnectionHandler {
     coap_connection_callback callback; // Callback to invoke when the connection status changes
     void* callbackArg; // User argument to pass to the callback
@@ -369,7 +344,6 @@ struct CoapChannel::EncodingContext {
 
 CoapChannel::CoapChannel() :
         connHandlers_(nullptr),
-        reqHandlers_(nullptr),
         sentReqs_(nullptr),
         recvReqs_(nullptr),
         recvBlockReqs_(nullptr),
@@ -393,9 +367,6 @@ CoapChannel::~CoapChannel() {
     forEachInList(connHandlers_, [](auto h) {
         delete h;
     });
-    forEachInList(reqHandlers_, [](auto h) {
-        delete h;
-    });
 }
 
 int CoapChannel::beginRequest(RefCountPtr<CoapMessage>& coapMsg, const char* path, coap_method method, int timeout, int flags) {
@@ -775,42 +746,17 @@ int CoapChannel::addRequestHandler(const char* path, coap_method method, int fla
     if (pathLen > COAP_MAX_URI_PATH_LENGTH) {
         return SYSTEM_ERROR_INVALID_ARGUMENT;
     }
-    auto handler = findInList(reqHandlers_, [=](auto h) {
-        return h->method == method && h->pathLen == pathLen && (!pathLen || std::memcmp(h->path, path, pathLen) == 0);
-    });
-    if (handler) {
-        handler->callback = callback;
-        handler->callbackArg = callbackArg;
-    } else {
-        CString pathStr(path, pathLen);
-        if (!pathStr && path) {
+    if (!reqRouter_) {
+        reqRouter_.reset(new(std::nothrow) CoapRouter());
+        if (!reqRouter_) {
             return SYSTEM_ERROR_NO_MEMORY;
         }
-        std::unique_ptr<RequestHandler> handler(new(std::nothrow) RequestHandler(std::move(pathStr), pathLen, method,
-                flags, callback, callbackArg));
-        if (!handler) {
-            return SYSTEM_ERROR_NO_MEMORY;
-        }
-        // Keep the handlers sorted from longest to shortest path
-        RequestHandler* last = nullptr;
-        auto h = reqHandlers_;
-        while (h && h->pathLen > pathLen) {
-            last = h;
-            h = h->next;
-        }
-        if (h) {
-            handler->next = h;
-            handler->prev = h->prev;
-            h->prev = handler.get();
-        } else if (last) {
-            handler->prev = last;
-            last->next = handler.get();
-        }
-        if (!handler->prev) {
-            reqHandlers_ = handler.get();
-        }
-        handler.release();
     }
+    CoapRouter::Handler handler = {};
+    handler.callback = callback;
+    handler.callbackArg = callbackArg;
+    handler.flags = flags;
+    CHECK(reqRouter_->add(path, pathLen, method, handler));
     return 0;
 }
 
@@ -825,12 +771,8 @@ void CoapChannel::removeRequestHandler(const char* path, coap_method method) {
             --pathLen; // Skip the trailing '/'
         }
     }
-    auto h = findInList(reqHandlers_, [=](auto h) {
-        return h->method == method && h->pathLen == pathLen && (!pathLen || std::memcmp(h->path, path, pathLen) == 0);
-    });
-    if (h) {
-        removeFromList(reqHandlers_, h);
-        delete h;
+    if (reqRouter_) {
+        reqRouter_->remove(path, pathLen, method);
     }
 }
 
@@ -1197,26 +1139,14 @@ int CoapChannel::handleRequestImpl(CoapMessageDecoder& d, CoapCode& errStatus) {
         }
     }
 
-    RequestHandler* handler = nullptr;
+    const CoapRouter::Handler* handler = nullptr;
     auto method = d.code();
 
     if (!hasBlockOpt || (hasBlockOpt && !hasMore)) {
         // Find a request handler
-        handler = findInList(reqHandlers_, [=](auto h) {
-            if (h->method != method) {
-                return false;
-            }
-            if (!h->pathLen) {
-                return true; // Catch-all handler
-            }
-            if (h->pathLen > pathLen || std::memcmp(h->path, path + 1, h->pathLen) != 0) {
-                return false;
-            }
-            if (h->pathLen < pathLen && path[h->pathLen + 1] != '/') { // Match complete path segments
-                return false;
-            }
-            return true;
-        });
+        if (reqRouter_) {
+            handler = reqRouter_->find(path + 1, pathLen, method);
+        }
         if (!handler) {
             // The new CoAP API is implemented as an extension to the old protocol layer so, technically,
             // the request may still be handled elsewhere
@@ -1554,8 +1484,12 @@ int CoapChannel::prepareMessage(const RefCountPtr<Message>& msg, bool retransmit
 
 int CoapChannel::updateMessage(const RefCountPtr<Message>& msg) {
     assert(curMsgId_ == msg->id);
-    char prefix[MAX_MESSAGE_PREFIX_SIZE];
-    CoapMessageEncoder e(prefix, sizeof(prefix));
+    auto msgBuf = (char*)msgBuf_.buf();
+    size_t suffixSize = msg->pos - msgBuf - msg->prefixSize; // Size of the payload data with the payload marker
+    // If no payload data has been written yet, encode the prefix directly into the message buffer
+    char prefixBuf[MAX_MESSAGE_PREFIX_SIZE];
+    char* prefix = suffixSize ? prefixBuf : msgBuf;
+    CoapMessageEncoder e(prefix, std::min(MAX_MESSAGE_PREFIX_SIZE, msgBuf_.capacity()));
     e.type(CoapType::CON);
     e.id(0); // Will be set by the underlying message channel
     bool isRequest = msg->type == MessageType::REQUEST || msg->type == MessageType::BLOCK_REQUEST;
@@ -1597,7 +1531,6 @@ int CoapChannel::updateMessage(const RefCountPtr<Message>& msg) {
     // Encode remaining options
     encodeOptions(ctx);
 
-    auto msgBuf = (char*)msgBuf_.buf();
     size_t newPrefixSize = CHECK(e.encode());
     if (newPrefixSize > MAX_MESSAGE_PREFIX_SIZE) {
         LOG(ERROR, "Too many CoAP options");
@@ -1610,13 +1543,14 @@ int CoapChannel::updateMessage(const RefCountPtr<Message>& msg) {
             return SYSTEM_ERROR_TOO_LARGE;
         }
         // Make room for the updated prefix data
-        size_t suffixSize = msg->pos - msgBuf - msg->prefixSize; // Size of the payload data with the payload marker
         std::memmove(msgBuf + newPrefixSize, msgBuf + msg->prefixSize, suffixSize);
         msg->pos += (int)newPrefixSize - (int)msg->prefixSize;
         msg->end = msgBuf + maxMsgSize;
         msg->prefixSize = newPrefixSize;
     }
-    std::memcpy(msgBuf, prefix, msg->prefixSize);
+    if (prefix != msgBuf) {
+        std::memcpy(msgBuf, prefix, msg->prefixSize);
+    }
     return 0;
 }
 
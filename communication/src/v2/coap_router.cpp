@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <new>
+#include <cstring>
+#include <cstdint>
+
+#include "coap_router.h"
+
+#include "c_string.h"
+#include "scope_guard.h"
+#include "check.h"
+
+namespace particle::protocol::v2 {
+
+namespace {
+
+// Method codes are represented as bits in a 32-bit mask
+const unsigned MAX_METHOD_CODE = 31;
+
+inline uint32_t methodBit(unsigned method) {
+    return (uint32_t)1 << method;
+}
+
+inline size_t segmentLength(const char* path, size_t pathLen) {
+    auto p = (const char*)std::memchr(path, '/', pathLen);
+    return p ? p - path : pathLen;
+}
+
+inline bool isWildcardSegment(const char* seg, size_t segLen) {
+    return segLen == 1 && *seg == '*';
+}
+
+// Advances the path to the next segment
+inline void nextSegment(const char*& path, size_t& pathLen, size_t segLen) {
+    path += segLen;
+    pathLen -= segLen;
+    if (pathLen > 0) {
+        ++path; // Skip the '/'
+        --pathLen;
+    }
+}
+
+} // namespace
+
+struct CoapRouter::MethodHandler {
+    Handler handler; // Handler
+    unsigned method; // Method code
+    MethodHandler* next; // Next handler in the list
+};
+
+struct CoapRouter::Node {
+    CString segment; // Path segment matched by this node
+    size_t segmentLen; // Length of the path segment
+    MethodHandler* handlers; // Handlers registered for the path ending at this node
+    uint32_t methods; // Bitmask of the methods for which handlers are registered
+    Node* children; // Child nodes matching specific segments
+    Node* wildcard; // Child node matching any segment
+    Node* next; // Next sibling node
+
+    Node() :
+            segmentLen(0),
+            handlers(nullptr),
+            methods(0),
+            children(nullptr),
+            wildcard(nullptr),
+            next(nullptr) {
+    }
+
+    ~Node() {
+        while (handlers) {
+            auto h = handlers;
+            handlers = h->next;
+            delete h;
+        }
+        while (children) {
+            auto n = children;
+            children = n->next;
+            delete n;
+        }
+        delete wildcard;
+    }
+
+    Node* child(const char* seg, size_t segLen) const {
+        for (auto n = children; n; n = n->next) {
+            if (n->segmentLen == segLen && std::memcmp(n->segment, seg, segLen) == 0) {
+                return n;
+            }
+        }
+        return nullptr;
+    }
+
+    const Handler* handler(unsigned method) const {
+        if (method > MAX_METHOD_CODE || !(methods & methodBit(method))) {
+            return nullptr;
+        }
+        for (auto h = handlers; h; h = h->next) {
+            if (h->method == method) {
+                return &h->handler;
+            }
+        }
+        return nullptr;
+    }
+
+    // Returns the handler registered for the longest path matching the request path. The number
+    // of matched segments is stored in `depth`
+    const Handler* match(const char* path, size_t pathLen, unsigned method, size_t& depth) const {
+        const size_t nodeDepth = depth;
+        const Handler* found = nullptr;
+        if (pathLen > 0) {
+            const auto seg = path;
+            const auto segLen = segmentLength(path, pathLen);
+            nextSegment(path, pathLen, segLen);
+            // Prefer the longest matching path, and a specific segment over a wildcard if both
+            // paths are of the same length
+            auto n = child(seg, segLen);
+            if (n) {
+                size_t d = nodeDepth + 1;
+                auto h = n->match(path, pathLen, method, d);
+                if (h) {
+                    found = h;
+                    depth = d;
+                }
+            }
+            if (wildcard) {
+                size_t d = nodeDepth + 1;
+                auto h = wildcard->match(path, pathLen, method, d);
+                if (h && (!found || d > depth)) {
+                    found = h;
+                    depth = d;
+                }
+            }
+        }
+        if (!found) {
+            found = handler(method);
+            depth = nodeDepth;
+        }
+        return found;
+    }
+
+    void remove(const char* path, size_t pathLen, unsigned method) {
+        if (!pathLen) {
+            MethodHandler* prev = nullptr;
+            for (auto h = handlers; h; prev = h, h = h->next) {
+                if (h->method == method) {
+                    if (prev) {
+                        prev->next = h->next;
+                    } else {
+                        handlers = h->next;
+                    }
+                    delete h;
+                    methods &= ~methodBit(method);
+                    break;
+                }
+            }
+            return;
+        }
+        const auto seg = path;
+        const auto segLen = segmentLength(path, pathLen);
+        nextSegment(path, pathLen, segLen);
+        if (isWildcardSegment(seg, segLen)) {
+            if (wildcard) {
+                wildcard->remove(path, pathLen, method);
+                if (wildcard->isEmpty()) {
+                    delete wildcard;
+                    wildcard = nullptr;
+                }
+            }
+            return;
+        }
+        Node* prev = nullptr;
+        for (auto n = children; n; prev = n, n = n->next) {
+            if (n->segmentLen == segLen && std::memcmp(n->segment, seg, segLen) == 0) {
+                n->remove(path, pathLen, method);
+                if (n->isEmpty()) {
+                    if (prev) {
+                        prev->next = n->next;
+                    } else {
+                        children = n->next;
+                    }
+                    n->next = nullptr;
+                    delete n;
+                }
+                break;
+            }
+        }
+    }
+
+    bool isEmpty() const {
+        return !handlers && !children && !wildcard;
+    }
+};
+
+CoapRouter::CoapRouter() :
+        root_(nullptr) {
+}
+
+CoapRouter::~CoapRouter() {
+    clear();
+}
+
+int CoapRouter::add(const char* path, size_t pathLen, unsigned method, const Handler& handler) {
+    CHECK_TRUE(method <= MAX_METHOD_CODE, SYSTEM_ERROR_INVALID_ARGUMENT);
+    if (!root_) {
+        root_ = new(std::nothrow) Node();
+        if (!root_) {
+            return SYSTEM_ERROR_NO_MEMORY;
+        }
+    }
+    // Remove the nodes created for the path if the handler cannot be registered
+    NAMED_SCOPE_GUARD(removeGuard, {
+        remove(path, pathLen, method);
+    });
+    auto node = root_;
+    auto p = path;
+    auto len = pathLen;
+    while (len > 0) {
+        const auto seg = p;
+        const auto segLen = segmentLength(p, len);
+        nextSegment(p, len, segLen);
+        const bool wildcard = isWildcardSegment(seg, segLen);
+        auto n = wildcard ? node->wildcard : node->child(seg, segLen);
+        if (!n) {
+            std::unique_ptr<Node> newNode(new(std::nothrow) Node());
+            if (!newNode) {
+                return SYSTEM_ERROR_NO_MEMORY;
+            }
+            if (!wildcard) {
+                newNode->segment = CString(seg, segLen);
+                if (!newNode->segment) {
+                    return SYSTEM_ERROR_NO_MEMORY;
+                }
+                newNode->segmentLen = segLen;
+            }
+            n = newNode.release();
+            if (wildcard) {
+                node->wildcard = n;
+            } else {
+                n->next = node->children;
+                node->children = n;
+            }
+        }
+        node = n;
+    }
+    for (auto h = node->handlers; h; h = h->next) {
+        if (h->method == method) {
+            h->handler.callback = handler.callback;
+            h->handler.callbackArg = handler.callbackArg;
+            removeGuard.dismiss();
+            return 0;
+        }
+    }
+    auto h = new(std::nothrow) MethodHandler();
+    if (!h) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    h->handler = handler;
+    h->method = method;
+    h->next = node->handlers;
+    node->handlers = h;
+    node->methods |= methodBit(method);
+    removeGuard.dismiss();
+    return 0;
+}
+
+void CoapRouter::remove(const char* path, size_t pathLen, unsigned method) {
+    if (!root_) {
+        return;
+    }
+    root_->remove(path, pathLen, method);
+    if (root_->isEmpty()) {
+        delete root_;
+        root_ = nullptr;
+    }
+}
+
+const CoapRouter::Handler* CoapRouter::find(const char* path, size_t pathLen, unsigned method) const {
+    if (!root_) {
+        return nullptr;
+    }
+    size_t depth = 0;
+    return root_->match(path, pathLen, method, depth);
+}
+
+void CoapRouter::clear() {
+    delete root_;
+    root_ = nullptr;
+}
+
+} // namespace particle::protocol::v2
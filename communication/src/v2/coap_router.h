@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "coap_api.h"
+
+namespace particle::protocol::v2 {
+
+/**
+ * A tree of request handlers indexed by the segments of their URI paths.
+ *
+ * A handler registered for a path also handles requests to the paths nested under it, unless there's
+ * a handler registered for a longer path. A handler registered for an empty path handles all requests.
+ *
+ * A path segment consisting of a single `*` character matches any segment of a request path. A
+ * segment that is matched exactly takes precedence over a wildcard segment.
+ *
+ * All paths passed to the methods of this class are expected to have no leading or trailing '/'.
+ */
+class CoapRouter {
+public:
+    /**
+     * Request handler.
+     */
+    struct Handler {
+        coap_request_callback callback; // Callback to invoke when a request is received
+        void* callbackArg; // User argument to pass to the callback
+        int flags; // Message flags
+    };
+
+    CoapRouter();
+    ~CoapRouter();
+
+    /**
+     * Register a handler.
+     *
+     * If a handler is already registered for the given path and method, its callback and callback
+     * argument are replaced.
+     *
+     * @param path Path.
+     * @param pathLen Path length.
+     * @param method Method code.
+     * @param handler Handler.
+     * @return 0 on success, otherwise an error code defined by `system_error_t`.
+     */
+    int add(const char* path, size_t pathLen, unsigned method, const Handler& handler);
+
+    /**
+     * Unregister a handler.
+     *
+     * @param path Path.
+     * @param pathLen Path length.
+     * @param method Method code.
+     */
+    void remove(const char* path, size_t pathLen, unsigned method);
+
+    /**
+     * Find a handler for a request.
+     *
+     * @param path Request path.
+     * @param pathLen Path length.
+     * @param method Method code.
+     * @return Handler or `nullptr` if no handler is registered for the request.
+     */
+    const Handler* find(const char* path, size_t pathLen, unsigned method) const;
+
+    /**
+     * Unregister all handlers.
+     */
+    void clear();
+
+    /**
+     * Check if no handlers are registered.
+     */
+    bool isEmpty() const {
+        return !root_;
+    }
+
+    // This class is non-copyable
+    CoapRouter(const CoapRouter&) = delete;
+    CoapRouter& operator=(const CoapRouter&) = delete;
+
+private:
+    struct Node;
+    struct MethodHandler;
+
+    Node* root_; // Root node. Allocated when the first handler is registered
+};
+
+} // namespace particle::protocol::v2
@@ -32,26 +32,35 @@ using namespace particle::services;
 
 int wifiNcpUpdateInfoCache(uint16_t version, MacAddress mac) {
     int result = 0;
+    auto& cache = SystemCache::instance();
+    // Write both values to the file at once
+    const int updateRes = cache.beginUpdate();
     uint16_t cached = 0;
-    int versionRes = SystemCache::instance().get(SystemCacheKey::WIFI_NCP_FIRMWARE_VERSION, &cached, sizeof(cached));
+    int versionRes = cache.get(SystemCacheKey::WIFI_NCP_FIRMWARE_VERSION, &cached, sizeof(cached));
     if (versionRes != sizeof(cached) || cached != version) {
         LOG(INFO, "Updating ESP32 cached module version to %u", version);
-        versionRes = SystemCache::instance().set(SystemCacheKey::WIFI_NCP_FIRMWARE_VERSION, &version, sizeof(version));
+        versionRes = cache.set(SystemCacheKey::WIFI_NCP_FIRMWARE_VERSION, &version, sizeof(version));
     }
     if (versionRes < 0) {
         result = versionRes;
     }
     MacAddress cachedMac = {};
-    int macRes = SystemCache::instance().get(SystemCacheKey::WIFI_NCP_MAC_ADDRESS, cachedMac.data, sizeof(cachedMac.data));
+    int macRes = cache.get(SystemCacheKey::WIFI_NCP_MAC_ADDRESS, cachedMac.data, sizeof(cachedMac.data));
     if (macRes != sizeof(cachedMac.data) || cachedMac != mac) {
         char macStr[MAC_ADDRESS_STRING_SIZE + 1] = {};
         macAddressToString(mac, macStr, sizeof(macStr));
         LOG(INFO, "Updating ESP32 cached MAC to %s", macStr);
-        macRes = SystemCache::instance().set(SystemCacheKey::WIFI_NCP_MAC_ADDRESS, mac.data, sizeof(mac.data));
+        macRes = cache.set(SystemCacheKey::WIFI_NCP_MAC_ADDRESS, mac.data, sizeof(mac.data));
     }
     if (macRes < 0) {
         result = macRes;
     }
+    if (updateRes == 0) {
+        const int r = cache.endUpdate();
+        if (r < 0) {
+            result = r;
+        }
+    }
     return result;
 }
 
@@ -83,14 +92,22 @@ int wifiNcpGetCachedModuleVersion(uint16_t* ncpVersion) {
 int wifiNcpInvalidateInfoCache() {
     int result = 0;
     LOG(TRACE, "Invalidating cached ESP32 NCP info");
-    int versionError = SystemCache::instance().del(SystemCacheKey::WIFI_NCP_FIRMWARE_VERSION);
+    auto& cache = SystemCache::instance();
+    const int updateRes = cache.beginUpdate();
+    int versionError = cache.del(SystemCacheKey::WIFI_NCP_FIRMWARE_VERSION);
     if (versionError < 0) {
         result = versionError;
     }
-    int macError = SystemCache::instance().del(SystemCacheKey::WIFI_NCP_MAC_ADDRESS);
+    int macError = cache.del(SystemCacheKey::WIFI_NCP_MAC_ADDRESS);
     if (macError < 0) {
         result = macError;
     }
+    if (updateRes == 0) {
+        const int r = cache.endUpdate();
+        if (r < 0) {
+            result = r;
+        }
+    }
     return result;
 }
 
@@ -24,9 +24,246 @@
 /* netdb_hal_impl.h should get included from netdb_hal.h automagically */
 #include "netdb_hal.h"
 #include <lwip/sockets.h>
+#include <lwip/dns.h>
 #include <errno.h>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include "resolvapi.h"
+#include "lwiplock.h"
+#include "dns_cache.h"
+#include "system_cache.h"
+#include "static_recursive_mutex.h"
+#include "rtc_hal.h"
+
+namespace {
+
+using namespace particle;
+using namespace particle::net;
+using particle::services::SystemCache;
+using particle::services::SystemCacheKey;
+
+// System-wide cache of resolved addresses. lwIP has its own cache but it doesn't survive a reset
+// or sleep, so the addresses are also kept here and persisted in the system cache
+DnsCache g_dnsCache;
+StaticRecursiveMutex g_dnsCacheMutex;
+// Serializes writes of the cache to persistent storage
+StaticRecursiveMutex g_dnsCacheSaveMutex;
+bool g_dnsCacheLoaded = false;
+
+uint32_t currentTime() {
+    if (!hal_rtc_time_is_valid(nullptr)) {
+        return 0; // Unknown
+    }
+    struct timeval tv = {};
+    if (hal_rtc_get_time(&tv, nullptr) < 0) {
+        return 0;
+    }
+    return tv.tv_sec;
+}
+
+// Should be called with the cache mutex locked
+void loadDnsCache() {
+    if (g_dnsCacheLoaded) {
+        return;
+    }
+    g_dnsCacheLoaded = true;
+    std::unique_ptr<uint8_t[]> buf(new(std::nothrow) uint8_t[DnsCache::MAX_SAVED_SIZE]);
+    if (!buf) {
+        return;
+    }
+    const int r = SystemCache::instance().get(SystemCacheKey::DNS_CACHE, buf.get(), DnsCache::MAX_SAVED_SIZE);
+    if (r > 0 && g_dnsCache.load(buf.get(), r) < 0) {
+        g_dnsCache.clear();
+    }
+}
+
+// Should be called with the cache mutex unlocked
+void saveDnsCache() {
+    std::lock_guard<StaticRecursiveMutex> saveLock(g_dnsCacheSaveMutex);
+    std::unique_ptr<uint8_t[]> buf;
+    int size = 0;
+    {
+        std::lock_guard<StaticRecursiveMutex> lock(g_dnsCacheMutex);
+        if (!g_dnsCache.isModified()) {
+            return;
+        }
+        buf.reset(new(std::nothrow) uint8_t[DnsCache::MAX_SAVED_SIZE]);
+        if (!buf) {
+            return;
+        }
+        size = g_dnsCache.save(buf.get(), DnsCache::MAX_SAVED_SIZE);
+    }
+    // Don't keep the cache locked while writing to the filesystem
+    if (size > 0) {
+        SystemCache::instance().set(SystemCacheKey::DNS_CACHE, buf.get(), size);
+    }
+}
+
+bool isCacheable(const char* hostname, const struct addrinfo* hints) {
+    if (!hostname || !*hostname || std::strlen(hostname) > DnsCache::MAX_HOST_NAME_LENGTH) {
+        return false;
+    }
+    if (hints) {
+        if (hints->ai_flags & AI_NUMERICHOST) {
+            return false;
+        }
+        if (hints->ai_family != AF_UNSPEC && hints->ai_family != AF_INET && hints->ai_family != AF_INET6) {
+            return false;
+        }
+    }
+    // Numeric addresses don't need to be resolved
+    ip_addr_t addr = {};
+    return !ipaddr_aton(hostname, &addr);
+}
+
+DnsCache::Family cacheFamily(int family) {
+    switch (family) {
+    case AF_INET:
+        return DnsCache::IPV4;
+    case AF_INET6:
+        return DnsCache::IPV6;
+    default:
+        return DnsCache::ANY;
+    }
+}
+
+bool toCacheAddress(const struct sockaddr* saddr, DnsCache::Address* addr) {
+    *addr = {};
+    if (saddr->sa_family == AF_INET) {
+        addr->family = DnsCache::IPV4;
+        std::memcpy(addr->data, &((const struct sockaddr_in*)saddr)->sin_addr, 4);
+        return true;
+    }
+    if (saddr->sa_family == AF_INET6) {
+        addr->family = DnsCache::IPV6;
+        std::memcpy(addr->data, &((const struct sockaddr_in6*)saddr)->sin6_addr, 16);
+        return true;
+    }
+    return false;
+}
+
+int getaddrinfoFromCache(const DnsCache::Address& addr, const char* servname, const struct addrinfo* hints,
+        struct addrinfo** res, uint8_t ifaceIndex) {
+    // Let lwIP allocate the result as usual so that it can be freed with netdb_freeaddrinfo()
+    const int family = (addr.family == DnsCache::IPV6) ? AF_INET6 : AF_INET;
+    char host[INET6_ADDRSTRLEN] = {};
+    if (!lwip_inet_ntop(family, addr.data, host, sizeof(host))) {
+        return EAI_FAIL;
+    }
+    struct addrinfo h = {};
+    if (hints) {
+        h = *hints;
+    }
+    h.ai_family = family;
+    h.ai_flags = (h.ai_flags & ~AI_FLUSHCACHE) | AI_NUMERICHOST;
+    return lwip_getaddrinfo_ex(host, servname, &h, res, ifaceIndex);
+}
+
+void toCacheAddress(const ip_addr_t* ipaddr, DnsCache::Address* addr) {
+    *addr = {};
+    if (IP_IS_V6(ipaddr)) {
+        addr->family = DnsCache::IPV6;
+        std::memcpy(addr->data, ip_2_ip6(ipaddr)->addr, 16);
+    } else {
+        addr->family = DnsCache::IPV4;
+        std::memcpy(addr->data, &ip_2_ip4(ipaddr)->addr, 4);
+    }
+}
+
+void dnsRefreshCallback(const char* name, const ip_addr_t* ipaddr, void* arg) {
+    // Called in the context of the TCP/IP thread
+    const auto family = (DnsCache::Family)(uintptr_t)arg;
+    std::lock_guard<StaticRecursiveMutex> lock(g_dnsCacheMutex);
+    if (ipaddr) {
+        DnsCache::Address addr = {};
+        toCacheAddress(ipaddr, &addr);
+        if (addr.family == family && g_dnsCache.put(name, addr, currentTime()) == 0) {
+            return;
+        }
+    }
+    g_dnsCache.refreshFailed(name, family);
+}
+
+// Asks lwIP for the current address of a cached host. lwIP answers immediately if it has a valid
+// address in its own cache, which honors the TTL of the DNS record. Otherwise, the host is resolved
+// in the background and the cached entry is updated once the query completes. The cached address
+// is updated with lwIP's answer if one is available right away.
+//
+// Should be called with the cache mutex unlocked
+void refreshDnsCacheEntry(const char* hostname, DnsCache::Address* cachedAddr) {
+    const auto family = cachedAddr->family;
+    ip_addr_t addr = {};
+    void* arg = (void*)(uintptr_t)family;
+    err_t err = ERR_OK;
+    {
+        LwipTcpIpCoreLock lk;
+        err = dns_gethostbyname_addrtype(hostname, &addr, dnsRefreshCallback, arg,
+                (family == DnsCache::IPV6) ? LWIP_DNS_ADDRTYPE_IPV6 : LWIP_DNS_ADDRTYPE_IPV4);
+    }
+    if (err == ERR_OK) {
+        dnsRefreshCallback(hostname, &addr, arg);
+        DnsCache::Address a = {};
+        toCacheAddress(&addr, &a);
+        if (a.family == family) {
+            *cachedAddr = a;
+        }
+    } else if (err != ERR_INPROGRESS) {
+        dnsRefreshCallback(hostname, nullptr, arg);
+    }
+}
+
+int cachedGetaddrinfo(const char* hostname, const char* servname, const struct addrinfo* hints,
+        struct addrinfo** res, uint8_t ifaceIndex) {
+    if (!isCacheable(hostname, hints)) {
+        return lwip_getaddrinfo_ex(hostname, servname, hints, res, ifaceIndex);
+    }
+    const auto family = cacheFamily(hints ? hints->ai_family : AF_UNSPEC);
+    // The cached entries are used optimistically even if the current time is unknown
+    const uint32_t now = currentTime();
+    // When flushing, the cached entry is bypassed but kept as a fallback until it's replaced with
+    // a fresh address. This also avoids rewriting the saved cache if the address hasn't changed
+    const bool flush = hints && (hints->ai_flags & AI_FLUSHCACHE);
+    DnsCache::Address addr = {};
+    unsigned flags = 0;
+    bool cached = false;
+    {
+        std::lock_guard<StaticRecursiveMutex> lock(g_dnsCacheMutex);
+        loadDnsCache();
+        cached = (g_dnsCache.get(hostname, family, now, &addr, &flags) == 0);
+        if (cached && flush && (flags & DnsCache::REFRESH)) {
+            g_dnsCache.refreshFailed(hostname, addr.family);
+        }
+    }
+    if (cached && !flush && !(flags & DnsCache::EXPIRED)) {
+        if (flags & DnsCache::REFRESH) {
+            refreshDnsCacheEntry(hostname, &addr);
+        }
+        if (getaddrinfoFromCache(addr, servname, hints, res, ifaceIndex) == 0) {
+            saveDnsCache();
+            return 0;
+        }
+    }
+    int r = lwip_getaddrinfo_ex(hostname, servname, hints, res, ifaceIndex);
+    if (r == 0) {
+        std::lock_guard<StaticRecursiveMutex> lock(g_dnsCacheMutex);
+        for (auto ai = *res; ai; ai = ai->ai_next) {
+            DnsCache::Address a = {};
+            if (ai->ai_addr && toCacheAddress(ai->ai_addr, &a)) {
+                g_dnsCache.put(hostname, a, now);
+                break; // lwIP returns one address per lookup
+            }
+        }
+    } else if (cached && getaddrinfoFromCache(addr, servname, hints, res, ifaceIndex) == 0) {
+        // Use the cached address rather than failing altogether
+        r = 0;
+    }
+    saveDnsCache();
+    return r;
+}
+
+} // namespace
 
 struct hostent* netdb_gethostbyname(const char *name) {
     return lwip_gethostbyname(name);
@@ -61,12 +298,12 @@ int netdb_getaddrinfo_ex(const char* hostname, const char* servname,
 
             /* First perform a lookup with AF_INET6 */
             h.ai_family = AF_INET6;
-            int rinet6 = lwip_getaddrinfo_ex(hostname, servname, &h, res, ifaceIndex);
+            int rinet6 = cachedGetaddrinfo(hostname, servname, &h, res, ifaceIndex);
 
             /* Next perform a lookup with AF_INET */
             h.ai_family = AF_INET;
             /* FIXME: expects that there is either 1 or 0 results from the previous call */
-            int rinet = lwip_getaddrinfo_ex(hostname, servname, &h, rinet6 == 0 && *res ? &((*res)->ai_next) : res, ifaceIndex);
+            int rinet = cachedGetaddrinfo(hostname, servname, &h, rinet6 == 0 && *res ? &((*res)->ai_next) : res, ifaceIndex);
 
             if (rinet6 == 0 || rinet == 0) {
                 return 0;
@@ -75,7 +312,7 @@ int netdb_getaddrinfo_ex(const char* hostname, const char* servname,
             return std::max(rinet, rinet6);
         }
     }
-    return lwip_getaddrinfo_ex(hostname, servname, hints, res, ifaceIndex);
+    return cachedGetaddrinfo(hostname, servname, hints, res, ifaceIndex);
 }
 
 int netdb_getnameinfo(const struct sockaddr* sa, socklen_t salen, char* host,
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "at_command_batch.h"
+
+#include "at_parser.h"
+#include "at_command.h"
+#include "at_response.h"
+
+#include "system_error.h"
+#include "str_util.h"
+
+#include <cstring>
+#include <cstdio>
+
+namespace particle {
+
+namespace {
+
+// Prefix of the command line
+const char CMD_LINE_PREFIX[] = "AT";
+const size_t CMD_LINE_PREFIX_SIZE = sizeof(CMD_LINE_PREFIX) - 1;
+
+// Separator of the extended syntax commands
+const char CMD_SEPARATOR = ';';
+
+// Prefix of the extended syntax commands
+const char EXT_CMD_PREFIX = '+';
+
+// Separator of the command name and the information text in an information response
+const char RESP_NAME_SEPARATOR = ':';
+
+} // unnamed
+
+AtCommandBatch::AtCommandBatch(AtParser* parser) :
+        entries_(),
+        cmdLineSize_(0),
+        count_(0),
+        cursor_(0),
+        timeout_(0),
+        parser_(parser),
+        error_(0),
+        continueOnError_(false),
+        responded_(false) {
+    memcpy(cmdLine_, CMD_LINE_PREFIX, CMD_LINE_PREFIX_SIZE);
+    cmdLineSize_ = CMD_LINE_PREFIX_SIZE;
+}
+
+AtCommandBatch::AtCommandBatch(AtCommandBatch&& batch) :
+        cmdLineSize_(batch.cmdLineSize_),
+        count_(batch.count_),
+        cursor_(batch.cursor_),
+        timeout_(batch.timeout_),
+        parser_(batch.parser_),
+        error_(batch.error_),
+        continueOnError_(batch.continueOnError_),
+        responded_(batch.responded_) {
+    memcpy(entries_, batch.entries_, sizeof(entries_));
+    memcpy(cmdLine_, batch.cmdLine_, cmdLineSize_);
+    batch.parser_ = nullptr;
+    batch.error_ = SYSTEM_ERROR_INVALID_STATE;
+}
+
+AtCommandBatch& AtCommandBatch::add(const char* cmd, const char* prefix, LineHandler handler, void* data) {
+    if (error_ < 0) {
+        return *this;
+    }
+    if (!cmd || (handler && !prefix)) {
+        error(SYSTEM_ERROR_INVALID_ARGUMENT);
+        return *this;
+    }
+    if (count_ == MAX_COMMAND_COUNT) {
+        error(SYSTEM_ERROR_TOO_LARGE);
+        return *this;
+    }
+    size_t size = strlen(cmd);
+    if (startsWithIgnoreCase(cmd, size, CMD_LINE_PREFIX, CMD_LINE_PREFIX_SIZE)) {
+        cmd += CMD_LINE_PREFIX_SIZE;
+        size -= CMD_LINE_PREFIX_SIZE;
+    }
+    if (size == 0) {
+        error(SYSTEM_ERROR_INVALID_ARGUMENT);
+        return *this;
+    }
+    if (append(cmd, size) < 0) {
+        return *this;
+    }
+    auto& e = entries_[count_++];
+    e.cmdOffset = cmdLineSize_ - size;
+    e.cmdSize = size;
+    e.prefix = prefix;
+    e.prefixSize = prefix ? strlen(prefix) : 0;
+    e.nameSize = 0;
+    if (cmd[0] == EXT_CMD_PREFIX) {
+        // Information responses to an extended syntax command are prefixed with the command name
+        e.nameSize = strcspn(cmd, "=?");
+        if (e.nameSize > size) {
+            e.nameSize = size;
+        }
+    }
+    e.handler = handler;
+    e.data = data;
+    return *this;
+}
+
+AtCommandBatch& AtCommandBatch::addf(const char* fmt, ...) {
+    char buf[MAX_COMMAND_LINE_SIZE];
+    va_list args;
+    va_start(args, fmt);
+    const int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) {
+        error(SYSTEM_ERROR_UNKNOWN);
+        return *this;
+    }
+    if ((size_t)n >= sizeof(buf)) {
+        error(SYSTEM_ERROR_TOO_LARGE);
+        return *this;
+    }
+    return add(buf);
+}
+
+AtCommandBatch& AtCommandBatch::timeout(unsigned timeout) {
+    timeout_ = timeout;
+    return *this;
+}
+
+AtCommandBatch& AtCommandBatch::continueOnError(bool enabled) {
+    continueOnError_ = enabled;
+    return *this;
+}
+
+AtResponse AtCommandBatch::send() {
+    if (error_ < 0) {
+        return AtResponse(error_);
+    }
+    if (!parser_) {
+        return AtResponse(error(SYSTEM_ERROR_INVALID_STATE));
+    }
+    if (count_ == 0) {
+        return AtResponse(error(SYSTEM_ERROR_NOT_ENOUGH_DATA));
+    }
+    auto cmd = parser_->command();
+    if (timeout_ > 0) {
+        cmd.timeout(timeout_);
+    }
+    cmd.write(cmdLine_, cmdLineSize_);
+    cursor_ = 0;
+    responded_ = false;
+    parser_ = nullptr; // A batch can only be sent once
+    return cmd.send();
+}
+
+int AtCommandBatch::exec() {
+    const auto parser = parser_;
+    auto resp = send();
+    const int result = readResponse(resp, count_);
+    if (result < 0 || result == AtResponse::OK || !continueOnError_) {
+        return result;
+    }
+    // The DCE doesn't report which command has failed. The commands up to the last one that has
+    // reported a response have been executed, the rest are sent one at a time
+    size_t i = responded_ ? cursor_ + 1 : cursor_;
+    if (i == count_) {
+        return result; // The last command has failed
+    }
+    int finalResult = AtResponse::OK;
+    for (; i < count_; ++i) {
+        const auto& e = entries_[i];
+        cursor_ = i;
+        responded_ = false;
+        auto cmd = parser->command();
+        if (timeout_ > 0) {
+            cmd.timeout(timeout_);
+        }
+        cmd.write(CMD_LINE_PREFIX, CMD_LINE_PREFIX_SIZE);
+        cmd.write(cmdLine_ + e.cmdOffset, e.cmdSize);
+        auto resp = cmd.send();
+        const int r = readResponse(resp, i + 1);
+        if (r < 0) {
+            return r;
+        }
+        if (r != AtResponse::OK && finalResult == AtResponse::OK) {
+            finalResult = r;
+        }
+    }
+    return finalResult;
+}
+
+int AtCommandBatch::append(const char* cmd, size_t size) {
+    const size_t sepSize = (count_ > 0) ? 1 : 0;
+    if (cmdLineSize_ + sepSize + size > MAX_COMMAND_LINE_SIZE) {
+        return error(SYSTEM_ERROR_TOO_LARGE);
+    }
+    if (sepSize) {
+        cmdLine_[cmdLineSize_++] = CMD_SEPARATOR;
+    }
+    memcpy(cmdLine_ + cmdLineSize_, cmd, size);
+    cmdLineSize_ += size;
+    return 0;
+}
+
+int AtCommandBatch::readResponse(AtResponse& resp, size_t end) {
+    int handlerError = 0;
+    char line[MAX_RESPONSE_LINE_SIZE];
+    while (resp.hasNextLine()) {
+        const int n = resp.readLine(line, sizeof(line));
+        if (n < 0) {
+            return error(n);
+        }
+        const int r = dispatch(line, end);
+        if (r < 0 && handlerError == 0) {
+            // Keep reading the response so that the parser stays in a consistent state
+            handlerError = r;
+        }
+    }
+    const int r = resp.readResult();
+    if (r < 0) {
+        return error(r);
+    }
+    if (handlerError < 0) {
+        return error(handlerError);
+    }
+    return r;
+}
+
+int AtCommandBatch::dispatch(const char* line, size_t end) {
+    // Intermediate responses are reported in the order of the commands, so there's no need to look
+    // back at the commands whose responses have already been processed
+    for (size_t i = cursor_; i < end; ++i) {
+        const auto& e = entries_[i];
+        if (e.prefix && strncmp(line, e.prefix, e.prefixSize) == 0) {
+            cursor_ = i;
+            responded_ = true;
+            return e.handler ? e.handler(line, e.data) : 0;
+        }
+    }
+    // Commands without a registered prefix are matched by name only if the line is not claimed by
+    // another command, e.g. "+COPS:" is reported by "+COPS?" but not by "+COPS=3,2"
+    for (size_t i = cursor_; i < end; ++i) {
+        const auto& e = entries_[i];
+        if (!e.prefix && e.nameSize > 0 && strncmp(line, cmdLine_ + e.cmdOffset, e.nameSize) == 0 &&
+                line[e.nameSize] == RESP_NAME_SEPARATOR) {
+            cursor_ = i;
+            responded_ = true;
+            return 0;
+        }
+    }
+    return 0; // Ignore unknown lines
+}
+
+int AtCommandBatch::error(int ret) {
+    parser_ = nullptr;
+    if (error_ == 0) {
+        error_ = ret;
+    }
+    return error_;
+}
+
+} // particle
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdarg>
+
+namespace particle {
+
+class AtParser;
+class AtResponse;
+
+/**
+ * AT command batch.
+ *
+ * This class allows sending several extended syntax commands in a single command line, as described
+ * in V.250, section 5.4.1. The DCE executes the commands in the order in which they appear in the
+ * command line and reports the intermediate responses in the same order, followed by a single final
+ * result code. This saves a full round-trip over the serial interface for every command in the batch:
+ *
+ * ```cpp
+ * // Sends "AT+CREG?;+CGREG?"
+ * int r = parser.batch().add("+CREG?").add("+CGREG?").exec();
+ * ```
+ *
+ * Responses can be correlated with the commands by registering a line handler for a given response
+ * prefix. The lines are dispatched to the handlers in the order of the commands in the batch:
+ *
+ * ```cpp
+ * int r = parser.batch()
+ *         .add("+CSQ", "+CSQ:", parseCsq, &qual)
+ *         .add("+COPS?", "+COPS:", parseCops, &qual)
+ *         .exec();
+ * ```
+ *
+ * The DCE stops processing the command line on the first failed command, so only commands whose
+ * results do not depend on each other should be batched together. If the remaining commands need to
+ * be executed regardless of the failure, `continueOnError()` can be used to send them one at a time
+ * after the batch fails:
+ *
+ * ```cpp
+ * // Sends "AT+QCSQ;+QNWINFO", and then "AT+QNWINFO" if "+QCSQ" responds but the batch fails
+ * int r = parser.batch().add("+QCSQ").add("+QNWINFO").continueOnError().exec();
+ * ```
+ *
+ * @see `AtParser::batch()`
+ */
+class AtCommandBatch {
+public:
+    /**
+     * The signature of a function invoked to process a response line.
+     *
+     * @param line Response line (null-terminated).
+     * @param data User data.
+     * @return `0` on success, or a negative result code in case of an error.
+     */
+    typedef int(*LineHandler)(const char* line, void* data);
+
+    /**
+     * Maximum number of commands in a batch.
+     */
+    static const size_t MAX_COMMAND_COUNT = 8;
+    /**
+     * Maximum length of the command line.
+     */
+    static const size_t MAX_COMMAND_LINE_SIZE = 128;
+    /**
+     * Maximum length of a response line passed to a line handler.
+     */
+    static const size_t MAX_RESPONSE_LINE_SIZE = 128;
+
+    /**
+     * Move-constructs a batch object.
+     */
+    AtCommandBatch(AtCommandBatch&& batch);
+    /**
+     * Adds a command to the batch.
+     *
+     * The leading "AT" characters of the command are optional and get stripped if present.
+     *
+     * @param cmd Command string, e.g. "+CREG?".
+     * @return This batch object.
+     */
+    AtCommandBatch& add(const char* cmd);
+    /**
+     * Adds a command to the batch and registers a handler for its response lines.
+     *
+     * @param cmd Command string.
+     * @param prefix Response line prefix, e.g. "+CREG:".
+     * @param handler Line handler.
+     * @param data User data.
+     * @return This batch object.
+     */
+    AtCommandBatch& add(const char* cmd, const char* prefix, LineHandler handler, void* data);
+    /**
+     * Formats a command and adds it to the batch.
+     *
+     * @param fmt printf-style format string.
+     * @param ... Formatting arguments.
+     * @return This batch object.
+     */
+    AtCommandBatch& addf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    /**
+     * Sets the timeout for the entire batch.
+     *
+     * @param timeout Timeout in milliseconds.
+     * @return This batch object.
+     *
+     * @see `AtParserConfig::commandTimeout()`
+     */
+    AtCommandBatch& timeout(unsigned timeout);
+    /**
+     * Enables or disables the execution of the remaining commands after a failed command.
+     *
+     * If enabled and the batch fails, `exec()` sends the commands one at a time, starting with the
+     * failed command. The DCE doesn't report which command has failed, so the failed command is
+     * assumed to be the one following the last command that has reported an information response
+     * (a line starting with the command name followed by a colon, e.g. "+CREG:" for "+CREG?", or
+     * with the prefix registered for the command). Commands that don't report any information
+     * response may therefore be executed twice, so this option is only suitable for commands that
+     * can safely be repeated.
+     *
+     * @param enabled Whether the remaining commands need to be executed after a failed command.
+     * @return This batch object.
+     */
+    AtCommandBatch& continueOnError(bool enabled = true);
+    /**
+     * Sends the batch as a single command line.
+     *
+     * Registered line handlers are not invoked when the response is read via the returned object.
+     *
+     * @return Response object.
+     */
+    AtResponse send();
+    /**
+     * Sends the batch, dispatches the response lines to the registered handlers and waits for the
+     * final result code.
+     *
+     * @return One of the values defined by `AtResponse::Result`, or a negative result code in
+     *         case of an error. If `continueOnError()` is enabled and the batch fails, the final
+     *         result code of the first command that fails when sent on its own is returned, or
+     *         `AtResponse::OK` if all of the resent commands succeed.
+     */
+    int exec();
+    /**
+     * Returns the number of commands in the batch.
+     */
+    size_t size() const;
+    /**
+     * Returns the result code of the first failed operation.
+     */
+    int error() const;
+
+    // Instances of this class are non-copyable
+    AtCommandBatch(const AtCommandBatch&) = delete;
+    AtCommandBatch& operator=(const AtCommandBatch&) = delete;
+
+private:
+    struct Entry {
+        size_t cmdOffset; // Offset of the command in the command line
+        size_t cmdSize; // Size of the command
+        const char* prefix; // Response line prefix
+        size_t prefixSize; // Size of the prefix string
+        size_t nameSize; // Size of the command name if it's an extended syntax command (0 otherwise)
+        LineHandler handler; // Line handler
+        void* data; // User data
+    };
+
+    Entry entries_[MAX_COMMAND_COUNT]; // Queued commands
+    char cmdLine_[MAX_COMMAND_LINE_SIZE]; // Command line data
+    size_t cmdLineSize_; // Size of the command line data
+    size_t count_; // Number of queued commands
+    size_t cursor_; // Index of the command whose response is being processed
+    unsigned timeout_; // Command timeout (0 if not set)
+    AtParser* parser_;
+    int error_;
+    bool continueOnError_; // Whether the remaining commands need to be executed after a failed command
+    bool responded_; // Whether the command at the cursor has reported an information response
+
+    explicit AtCommandBatch(AtParser* parser);
+
+    int append(const char* cmd, size_t size);
+    int readResponse(AtResponse& resp, size_t end);
+    int dispatch(const char* line, size_t end);
+    int error(int ret);
+
+    friend class AtParser;
+};
+
+inline AtCommandBatch& AtCommandBatch::add(const char* cmd) {
+    return add(cmd, nullptr /* prefix */, nullptr /* handler */, nullptr /* data */);
+}
+
+inline size_t AtCommandBatch::size() const {
+    return count_;
+}
+
+inline int AtCommandBatch::error() const {
+    return error_;
+}
+
+} // particle
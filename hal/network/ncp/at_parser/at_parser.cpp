@@ -18,6 +18,7 @@
 #include "at_parser.h"
 
 #include "at_command.h"
+#include "at_command_batch.h"
 #include "at_parser_impl.h"
 
 #include "check.h"
@@ -61,6 +62,10 @@ AtCommand AtParser::command() {
     return AtCommand(p_.get());
 }
 
+AtCommandBatch AtParser::batch() {
+    return AtCommandBatch(this);
+}
+
 AtResponse AtParser::sendCommand(const char* fmt, ...) {
     AtCommand cmd = command();
     va_list args;
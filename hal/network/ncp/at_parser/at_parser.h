@@ -29,6 +29,7 @@ class AtParserImpl;
 } // particle::detail
 
 class AtCommand;
+class AtCommandBatch;
 class AtResponse;
 class AtResponseReader;
 class Stream;
@@ -260,6 +261,16 @@ public:
      * @see `execCommand()`
      */
     AtCommand command();
+    /**
+     * Initiates a batch of AT commands.
+     *
+     * The commands added to the batch are sent to the DCE in a single command line.
+     *
+     * @return Batch object.
+     *
+     * @see `AtCommandBatch`
+     */
+    AtCommandBatch batch();
     /**
      * Formats and sends an AT command.
      *
@@ -230,6 +230,7 @@ private:
     explicit AtResponse(int error);
 
     friend class AtCommand;
+    friend class AtCommandBatch;
 };
 
 inline int AtResponseReader::error() const {
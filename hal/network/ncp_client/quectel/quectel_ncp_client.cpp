@@ -22,6 +22,7 @@ LOG_SOURCE_CATEGORY("ncp.client");
 #include "quectel_ncp_client.h"
 
 #include "at_command.h"
+#include "at_command_batch.h"
 #include "at_response.h"
 #include "network/ncp/cellular/network_config_db.h"
 
@@ -595,12 +596,9 @@ int QuectelNcpClient::queryAndParseAtCops(CellularSignalQuality* qual) {
     char mobileNetworkCode[4] = {0};
 
     // Reformat the operator string to be numeric
-    // (allows the capture of `mcc` and `mnc`)
-    int r = CHECK_PARSER(parser_.execCommand("AT+COPS=3,2"));
-    CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
-
-    auto resp = parser_.sendCommand("AT+COPS?");
-    r = CHECK_PARSER(resp.scanf("+COPS: %*d,%*d,\"%3[0-9]%3[0-9]\",%d", mobileCountryCode,
+    // (allows the capture of `mcc` and `mnc`) and query the operator in the same command line
+    auto resp = parser_.batch().add("+COPS=3,2").add("+COPS?").send();
+    int r = CHECK_PARSER(resp.scanf("+COPS: %*d,%*d,\"%3[0-9]%3[0-9]\",%d", mobileCountryCode,
                                     mobileNetworkCode, &act));
     CHECK_TRUE(r == 3, SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED);
     r = CHECK_PARSER(resp.readResult());
@@ -665,11 +663,7 @@ int QuectelNcpClient::getCellularGlobalIdentity(CellularGlobalIdentity* cgi) {
     cgi_.cell_id = std::numeric_limits<CidType>::max();
     // Fill in LAC and Cell ID based on current RAT, prefer PSD and EPS
     // fallback to CSD
-    CHECK_PARSER_OK(parser_.execCommand("AT+CEREG?"));
-    if (isQuecCat1Device() || ncpId() == PLATFORM_NCP_QUECTEL_BG95_M5) {
-        CHECK_PARSER_OK(parser_.execCommand("AT+CGREG?"));
-        CHECK_PARSER_OK(parser_.execCommand("AT+CREG?"));
-    }
+    CHECK_PARSER_OK(queryRegistrationStatus());
 
     switch (cgi->version)
     {
@@ -1175,17 +1169,23 @@ int QuectelNcpClient::initReady(ModemState state) {
         // int r = CHECK_PARSER(parser_.execCommand("AT+COPS=2"));
         // CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
 
+        // The results of the following commands are not checked, but a failed command shouldn't
+        // prevent the other ones from being executed
+        auto batch = parser_.batch();
         if (isQuecCatM1Device()) {
             // Force eDRX mode to be disabled.
-            CHECK_PARSER(parser_.execCommand("AT+CEDRXS=0"));
+            batch.add("+CEDRXS=0");
 
             // Disable Power Saving Mode
-            CHECK_PARSER(parser_.execCommand("AT+CPSMS=0"));
+            batch.add("+CPSMS=0");
         }
 
         // Select (U)SIM card in slot 1, EG91 has two SIM card slots
         if (isQuecCat1Device()) {
-            CHECK_PARSER(parser_.execCommand("AT+QDSIM=0"));
+            batch.add("+QDSIM=0");
+        }
+        if (batch.size() > 0) {
+            CHECK_PARSER(batch.continueOnError().exec());
         }
 
         // Send AT+CMUX and initialize multiplexer
@@ -1437,6 +1437,17 @@ int QuectelNcpClient::configureApn(const CellularNetworkConfig& conf) {
     return SYSTEM_ERROR_AT_NOT_OK;
 }
 
+int QuectelNcpClient::queryRegistrationStatus() {
+    // The registration status is reported via the URC handlers, so all the queries can be sent
+    // in a single command line
+    auto batch = parser_.batch();
+    batch.add("+CEREG?");
+    if (isQuecCat1Device() || ncpId() == PLATFORM_NCP_QUECTEL_BG95_M5) {
+        batch.add("+CREG?").add("+CGREG?");
+    }
+    return batch.exec();
+}
+
 int QuectelNcpClient::registerNet() {
     int r = 0;
     // Set modem full functionality
@@ -1445,14 +1456,12 @@ int QuectelNcpClient::registerNet() {
 
     resetRegistrationState();
 
+    auto batch = parser_.batch();
     if (isQuecCat1Device() || ncpId() == PLATFORM_NCP_QUECTEL_BG95_M5) {
         // Register GPRS, LTE, NB-IOT network
-        r = CHECK_PARSER(parser_.execCommand("AT+CREG=2"));
-        CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
-        r = CHECK_PARSER(parser_.execCommand("AT+CGREG=2"));
-        CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
+        batch.add("+CREG=2").add("+CGREG=2");
     }
-    r = CHECK_PARSER(parser_.execCommand("AT+CEREG=2"));
+    r = CHECK_PARSER(batch.add("+CEREG=2").exec());
     CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
 
     connectionState(NcpConnectionState::CONNECTING);
@@ -1541,11 +1550,7 @@ int QuectelNcpClient::registerNet() {
         }
     }
     // Check GSM, GPRS, and LTE network registration status
-    CHECK_PARSER_OK(parser_.execCommand("AT+CEREG?"));
-    if (isQuecCat1Device() || ncpId() == PLATFORM_NCP_QUECTEL_BG95_M5) {
-        CHECK_PARSER_OK(parser_.execCommand("AT+CREG?"));
-        CHECK_PARSER_OK(parser_.execCommand("AT+CGREG?"));
-    }
+    CHECK_PARSER_OK(queryRegistrationStatus());
 
     regStartTime_ = millis();
     regCheckTime_ = regStartTime_;
@@ -1984,17 +1989,12 @@ int QuectelNcpClient::processEventsImpl() {
     // CHECK_PARSER(parser_.execCommand("AT+CMEE?"));
 
     // Check GSM, GPRS, and LTE network registration status
-    CHECK_PARSER_OK(parser_.execCommand("AT+CEREG?"));
-    if (isQuecCat1Device() || ncpId() == PLATFORM_NCP_QUECTEL_BG95_M5) {
-        CHECK_PARSER_OK(parser_.execCommand("AT+CREG?"));
-        CHECK_PARSER_OK(parser_.execCommand("AT+CGREG?"));
-    }
+    CHECK_PARSER_OK(queryRegistrationStatus());
 
     // Check the signal seen by the module while trying to register
-    // Do not need to check for an OK, as this is just for debugging purpose
-    CHECK_PARSER(parser_.execCommand("AT+QCSQ"));
-    CHECK_PARSER(parser_.execCommand("AT+QNWINFO"));
-    CHECK_PARSER(parser_.execCommand("AT+QENG=\"servingcell\""));
+    // Do not need to check for an OK, as this is just for debugging purpose, but a failed query
+    // shouldn't prevent the other ones from being executed
+    CHECK_PARSER(parser_.batch().add("+QCSQ").add("+QNWINFO").add("+QENG=\"servingcell\"").continueOnError().exec());
 
     if (connState_ == NcpConnectionState::CONNECTING && millis() - regStartTime_ >= registrationTimeout_) {
         LOG(WARN, "Resetting the modem due to the network registration timeout");
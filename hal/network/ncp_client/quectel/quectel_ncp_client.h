@@ -134,6 +134,7 @@ private:
     int setModuleFunctionality(CellularFunctionality cfun, bool check);
     int configureApn(const CellularNetworkConfig& conf);
     int registerNet();
+    int queryRegistrationStatus();
     int changeBaudRate(unsigned int baud);
     static int muxChannelStateCb(uint8_t channel, decltype(muxer_)::ChannelState oldState,
             decltype(muxer_)::ChannelState newState, void* ctx);
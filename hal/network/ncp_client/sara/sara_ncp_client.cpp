@@ -23,6 +23,7 @@ LOG_SOURCE_CATEGORY("ncp.client");
 #include "sara_ncp_client.h"
 
 #include "at_command.h"
+#include "at_command_batch.h"
 #include "at_response.h"
 #include "network/ncp/cellular/network_config_db.h"
 
@@ -670,12 +671,9 @@ int SaraNcpClient::queryAndParseAtCops(CellularSignalQuality* qual) {
     char mobileNetworkCode[4] = {0};
 
     // Reformat the operator string to be numeric
-    // (allows the capture of `mcc` and `mnc`)
-    int r = CHECK_PARSER(parser_.execCommand("AT+COPS=3,2"));
-    CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
-
-    auto resp = parser_.sendCommand("AT+COPS?");
-    r = CHECK_PARSER(resp.scanf("+COPS: %*d,%*d,\"%3[0-9]%3[0-9]\",%d", mobileCountryCode,
+    // (allows the capture of `mcc` and `mnc`) and query the operator in the same command line
+    auto resp = parser_.batch().add("+COPS=3,2").add("+COPS?").send();
+    int r = CHECK_PARSER(resp.scanf("+COPS: %*d,%*d,\"%3[0-9]%3[0-9]\",%d", mobileCountryCode,
                                     mobileNetworkCode, &act));
     CHECK_TRUE(r == 3, SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED);
     r = CHECK_PARSER(resp.readResult());
@@ -748,8 +746,7 @@ int SaraNcpClient::getCellularGlobalIdentity(CellularGlobalIdentity* cgi) {
     // Fill in LAC and Cell ID based on current RAT, prefer PSD and EPS
     // fallback to CSD
     if (ncpId() != PLATFORM_NCP_SARA_R410 && ncpId() != PLATFORM_NCP_SARA_R510) {
-        CHECK_PARSER_OK(parser_.execCommand("AT+CGREG?"));
-        CHECK_PARSER_OK(parser_.execCommand("AT+CREG?"));
+        CHECK_PARSER_OK(parser_.batch().add("+CGREG?").add("+CREG?").exec());
     } else {
         CHECK_PARSER_OK(parser_.execCommand("AT+CEREG?"));
     }
@@ -794,8 +791,7 @@ int SaraNcpClient::getSignalQuality(CellularSignalQuality* qual) {
         qual->quality(255);
 
         // Set UCGED to mode 5 for RSRP/RSRQ values on R410M
-        CHECK_PARSER_OK(parser_.execCommand("AT+UCGED=5"));
-        auto resp = parser_.sendCommand("AT+UCGED?");
+        auto resp = parser_.batch().add("+UCGED=5").add("+UCGED?").send();
 
         int val;
         unsigned long val2;
@@ -1414,16 +1410,16 @@ int SaraNcpClient::disablePsmEdrx() {
         }
     }
     CHECK_PARSER_OK(resp.readResult());
-    int lastError = AtResponse::OK;
+    if (acts.isEmpty()) {
+        return SYSTEM_ERROR_NONE;
+    }
+    auto batch = parser_.batch();
     for (unsigned act: acts) {
-        // This command may fail for unknown reason. eDRX mode is a persistent setting and, eventually,
-        // it will get applied for each RAT during subsequent re-initialization attempts
-        auto r = CHECK_PARSER(parser_.execCommand("AT+CEDRXS=3,%u", act)); // 3: Disable the use of eDRX
-        if (r != AtResponse::OK) {
-            lastError = r;
-        }
+        batch.addf("+CEDRXS=3,%u", act); // 3: Disable the use of eDRX
     }
-    CHECK_PARSER_OK(lastError);
+    // This command may fail for unknown reason. eDRX mode is a persistent setting and, eventually,
+    // it will get applied for each RAT during subsequent re-initialization attempts
+    CHECK_PARSER_OK(batch.continueOnError().exec());
 
     return SYSTEM_ERROR_NONE;
 }
@@ -2073,9 +2069,7 @@ int SaraNcpClient::registerNet() {
     resetRegistrationState();
 
     if (ncpId() != PLATFORM_NCP_SARA_R410 && ncpId() != PLATFORM_NCP_SARA_R510) {
-        r = CHECK_PARSER(parser_.execCommand("AT+CREG=2"));
-        CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
-        r = CHECK_PARSER(parser_.execCommand("AT+CGREG=2"));
+        r = CHECK_PARSER(parser_.batch().add("+CREG=2").add("+CGREG=2").exec());
         CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
     } else {
         r = CHECK_PARSER(parser_.execCommand("AT+CEREG=2"));
@@ -2102,9 +2096,7 @@ int SaraNcpClient::registerNet() {
     }
 
     if (ncpId() != PLATFORM_NCP_SARA_R410 && ncpId() != PLATFORM_NCP_SARA_R510) {
-        r = CHECK_PARSER(parser_.execCommand("AT+CREG?"));
-        CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
-        r = CHECK_PARSER(parser_.execCommand("AT+CGREG?"));
+        r = CHECK_PARSER(parser_.batch().add("+CREG?").add("+CGREG?").exec());
         CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
     } else {
         r = CHECK_PARSER(parser_.execCommand("AT+CEREG?"));
@@ -2553,8 +2545,7 @@ int SaraNcpClient::processEventsImpl() {
 
     if (ncpId() != PLATFORM_NCP_SARA_R410 && ncpId() != PLATFORM_NCP_SARA_R510) {
         CHECK_PARSER(parser_.execCommand("AT+CEER"));
-        CHECK_PARSER_OK(parser_.execCommand("AT+CREG?"));
-        CHECK_PARSER_OK(parser_.execCommand("AT+CGREG?"));
+        CHECK_PARSER_OK(parser_.batch().add("+CREG?").add("+CGREG?").exec());
         // Check the signal seen by the module while trying to register
         // Do not need to check for an OK, as this is just for debugging purpose
         CHECK_PARSER(parser_.execCommand("AT+CSQ"));
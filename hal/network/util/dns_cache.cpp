@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "dns_cache.h"
+#include "endian_util.h"
+#include "system_error.h"
+#include "check.h"
+
+namespace particle {
+
+namespace {
+
+const uint8_t SAVED_DATA_VERSION = 1;
+
+size_t addressSize(DnsCache::Family family) {
+    return (family == DnsCache::IPV6) ? 16 : 4;
+}
+
+bool isValidFamily(unsigned family) {
+    return family == DnsCache::IPV4 || family == DnsCache::IPV6;
+}
+
+} // namespace
+
+DnsCache::DnsCache(uint32_t ttl) :
+        entries_(),
+        count_(0),
+        ttl_(ttl),
+        modified_(false) {
+}
+
+int DnsCache::get(const char* host, Family family, uint32_t now, Address* addr, unsigned* flags) {
+    CHECK_TRUE(host && addr, SYSTEM_ERROR_INVALID_ARGUMENT);
+    Entry* found = nullptr;
+    bool foundExpired = false;
+    for (size_t i = 0; i < count_; ++i) {
+        auto& e = entries_[i];
+        if ((family != ANY && e.addr.family != family) || std::strcmp(e.host, host) != 0) {
+            continue;
+        }
+        bool expired = false;
+        if (!now) {
+            // The age of the entry is unknown. An address that was resolved before the reset is most
+            // likely still valid, so it's returned optimistically, but only once until it's confirmed
+            expired = !e.confirmed && e.usedUnconfirmed;
+        } else {
+            expired = now >= e.expires;
+            if (expired && e.expires && now - e.expires >= MAX_STALE_TIME) {
+                continue; // Too old to be of any use
+            }
+        }
+        // Prefer entries that haven't expired, and IPv4 addresses over IPv6 ones
+        if (!found || (foundExpired && !expired) || (foundExpired == expired && e.addr.family == IPV4)) {
+            found = &e;
+            foundExpired = expired;
+        }
+    }
+    if (!found) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    unsigned f = 0;
+    if (foundExpired) {
+        f |= LookupFlag::EXPIRED;
+    } else {
+        if (!found->refreshing) {
+            f |= LookupFlag::REFRESH;
+            found->refreshing = true;
+        }
+        if (!now && !found->confirmed) {
+            found->usedUnconfirmed = true;
+        }
+    }
+    if (now) {
+        found->lastUsed = now;
+    }
+    *addr = found->addr;
+    if (flags) {
+        *flags = f;
+    }
+    return 0;
+}
+
+int DnsCache::put(const char* host, const Address& addr, uint32_t now) {
+    CHECK_TRUE(host && *host && isValidFamily(addr.family), SYSTEM_ERROR_INVALID_ARGUMENT);
+    const size_t hostLen = std::strlen(host);
+    CHECK_TRUE(hostLen <= MAX_HOST_NAME_LENGTH, SYSTEM_ERROR_TOO_LARGE);
+    Address a = {};
+    a.family = addr.family;
+    std::memcpy(a.data, addr.data, addressSize(addr.family));
+    uint32_t expires = now ? now + ttl_ : 0;
+    auto e = find(host, addr.family);
+    if (e) {
+        const bool changed = std::memcmp(e->addr.data, a.data, sizeof(a.data)) != 0;
+        if (!now && !changed) {
+            expires = e->expires;
+        }
+        if (changed || (now && (!e->savedExpires || (int32_t)(expires - e->savedExpires) >= (int32_t)(ttl_ / 2)))) {
+            modified_ = true;
+        }
+    } else {
+        e = alloc(now);
+        std::memcpy(e->host, host, hostLen + 1);
+        e->savedExpires = 0;
+        e->lastUsed = 0;
+        modified_ = true;
+    }
+    e->addr = a;
+    e->expires = expires;
+    if (now) {
+        e->lastUsed = now;
+    }
+    e->refreshing = false;
+    e->confirmed = true;
+    e->usedUnconfirmed = false;
+    return 0;
+}
+
+void DnsCache::refreshFailed(const char* host, Family family) {
+    if (!host) {
+        return;
+    }
+    auto e = find(host, family);
+    if (e) {
+        e->refreshing = false;
+    }
+}
+
+void DnsCache::remove(const char* host, Family family) {
+    if (!host) {
+        return;
+    }
+    for (size_t i = count_; i > 0; --i) {
+        const auto& e = entries_[i - 1];
+        if ((family == ANY || e.addr.family == family) && std::strcmp(e.host, host) == 0) {
+            removeAt(i - 1);
+            modified_ = true;
+        }
+    }
+}
+
+void DnsCache::clear() {
+    if (count_ > 0) {
+        count_ = 0;
+        modified_ = true;
+    }
+}
+
+int DnsCache::save(uint8_t* data, size_t size) {
+    size_t needed = 2;
+    for (size_t i = 0; i < count_; ++i) {
+        needed += 4 + 1 + addressSize(entries_[i].addr.family) + 1 + std::strlen(entries_[i].host);
+    }
+    CHECK_TRUE(data && size >= needed, SYSTEM_ERROR_TOO_LARGE);
+    uint8_t* p = data;
+    *p++ = SAVED_DATA_VERSION;
+    *p++ = count_;
+    for (size_t i = 0; i < count_; ++i) {
+        auto& e = entries_[i];
+        const uint32_t expires = nativeToLittleEndian(e.expires);
+        std::memcpy(p, &expires, 4);
+        p += 4;
+        *p++ = e.addr.family;
+        const size_t addrSize = addressSize(e.addr.family);
+        std::memcpy(p, e.addr.data, addrSize);
+        p += addrSize;
+        const size_t hostLen = std::strlen(e.host);
+        *p++ = hostLen;
+        std::memcpy(p, e.host, hostLen);
+        p += hostLen;
+        e.savedExpires = e.expires;
+    }
+    modified_ = false;
+    return p - data;
+}
+
+int DnsCache::load(const uint8_t* data, size_t size) {
+    CHECK_TRUE(data || !size, SYSTEM_ERROR_INVALID_ARGUMENT);
+    count_ = 0;
+    modified_ = false;
+    const uint8_t* p = data;
+    const uint8_t* const end = data + size;
+    if (end - p < 2 || p[0] != SAVED_DATA_VERSION || p[1] > MAX_ENTRY_COUNT) {
+        return SYSTEM_ERROR_BAD_DATA;
+    }
+    const size_t count = p[1];
+    p += 2;
+    for (size_t i = 0; i < count; ++i) {
+        auto& e = entries_[i];
+        if (end - p < 5 || !isValidFamily(p[4])) {
+            return SYSTEM_ERROR_BAD_DATA;
+        }
+        uint32_t expires = 0;
+        std::memcpy(&expires, p, 4);
+        e.expires = littleEndianToNative(expires);
+        e.addr = {};
+        e.addr.family = (Family)p[4];
+        p += 5;
+        const size_t addrSize = addressSize(e.addr.family);
+        if ((size_t)(end - p) < addrSize + 1) {
+            return SYSTEM_ERROR_BAD_DATA;
+        }
+        std::memcpy(e.addr.data, p, addrSize);
+        p += addrSize;
+        const size_t hostLen = *p++;
+        if (!hostLen || hostLen > MAX_HOST_NAME_LENGTH || (size_t)(end - p) < hostLen) {
+            return SYSTEM_ERROR_BAD_DATA;
+        }
+        std::memcpy(e.host, p, hostLen);
+        e.host[hostLen] = '\0';
+        p += hostLen;
+        e.savedExpires = e.expires;
+        e.lastUsed = 0;
+        e.refreshing = false;
+        e.confirmed = false;
+        e.usedUnconfirmed = false;
+        ++count_;
+    }
+    return 0;
+}
+
+DnsCache::Entry* DnsCache::find(const char* host, Family family) {
+    for (size_t i = 0; i < count_; ++i) {
+        auto& e = entries_[i];
+        if (e.addr.family == family && std::strcmp(e.host, host) == 0) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+DnsCache::Entry* DnsCache::alloc(uint32_t now) {
+    if (count_ < MAX_ENTRY_COUNT) {
+        return &entries_[count_++];
+    }
+    // Replace an expired entry or the least recently used one
+    Entry* victim = nullptr;
+    bool victimExpired = false;
+    for (size_t i = 0; i < count_; ++i) {
+        auto& e = entries_[i];
+        const bool expired = now && now >= e.expires;
+        if (!victim || (expired && !victimExpired) || (expired == victimExpired && e.lastUsed < victim->lastUsed)) {
+            victim = &e;
+            victimExpired = expired;
+        }
+    }
+    return victim;
+}
+
+void DnsCache::removeAt(size_t index) {
+    if (index != count_ - 1) {
+        entries_[index] = entries_[count_ - 1];
+    }
+    --count_;
+}
+
+} // namespace particle
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace particle {
+
+/**
+ * A cache of resolved host addresses.
+ *
+ * The cache stores one address per host name and address family, which matches what the lwIP
+ * resolver returns for a single query. All times are in seconds and are expected to be based on
+ * a clock that keeps running across resets and sleep, such as the RTC, so that the contents of
+ * the cache remain meaningful after they have been saved and restored.
+ *
+ * A time of 0 means that the current time is unknown. Addresses resolved while the time is unknown
+ * are still cached but their expiration time is unknown too, and such entries are only used as a
+ * fallback once the time becomes known. While the time is unknown, an entry that hasn't been
+ * confirmed by the resolver since the cache was loaded is returned optimistically once. Subsequent
+ * lookups report it as expired until it's updated, so that the caller resolves the host again if
+ * the address that was returned didn't work.
+ *
+ * The cache doesn't do any resolving on its own. Entries are refreshed only when they're looked up
+ * (see `LookupFlag::REFRESH`).
+ *
+ * The cache is not thread-safe.
+ */
+class DnsCache {
+public:
+    /**
+     * Address family.
+     */
+    enum Family: uint8_t {
+        ANY = 0, ///< Any address family (only valid for lookups).
+        IPV4 = 4, ///< IPv4.
+        IPV6 = 6 ///< IPv6.
+    };
+
+    /**
+     * Lookup flags.
+     */
+    enum LookupFlag {
+        EXPIRED = 0x01, ///< The entry has expired and should only be used if the host can't be resolved.
+        REFRESH = 0x02 ///< The host should be resolved in the background to keep the entry up to date.
+    };
+
+    /**
+     * Host address.
+     */
+    struct Address {
+        Family family; ///< Address family.
+        uint8_t data[16]; ///< Address data in network byte order.
+    };
+
+    static constexpr size_t MAX_ENTRY_COUNT = 8; ///< Maximum number of entries.
+    static constexpr size_t MAX_HOST_NAME_LENGTH = 63; ///< Maximum length of a cached host name.
+    static constexpr uint32_t DEFAULT_TTL = 30 * 60; ///< Default time for which an entry is used without waiting for the resolver.
+    static constexpr uint32_t MAX_STALE_TIME = 24 * 60 * 60; ///< Time after expiration when an entry is discarded.
+    static constexpr size_t MAX_SAVED_SIZE = 2 /* Header */ + MAX_ENTRY_COUNT * (4 /* Expiration time */ +
+            1 /* Family */ + 16 /* Address */ + 1 /* Name length */ + MAX_HOST_NAME_LENGTH); ///< Maximum size of the saved cache data.
+
+    explicit DnsCache(uint32_t ttl = DEFAULT_TTL);
+
+    /**
+     * Find a cached address.
+     *
+     * The `REFRESH` flag is reported for an entry that hasn't expired unless a refresh of that entry
+     * is already in progress, i.e. until the entry is updated via `put()` or `refreshFailed()` is
+     * called. The caller is expected to ask the resolver for the address, which can answer from its
+     * own cache if the DNS record hasn't expired yet. This way the cached address doesn't outlive
+     * the record's TTL by more than one lookup.
+     *
+     * @param host Host name.
+     * @param family Address family. If `ANY`, an IPv4 address is preferred over an IPv6 one.
+     * @param now Current time.
+     * @param[out] addr Cached address.
+     * @param[out] flags Lookup flags (see `LookupFlag`).
+     * @return 0 on success, or `SYSTEM_ERROR_NOT_FOUND` if there's no usable entry for the host.
+     */
+    int get(const char* host, Family family, uint32_t now, Address* addr, unsigned* flags = nullptr);
+
+    /**
+     * Add or update an entry.
+     *
+     * If the current time is unknown and the address hasn't changed, the expiration time of an
+     * existing entry is left as is.
+     *
+     * @param host Host name.
+     * @param addr Resolved address.
+     * @param now Current time.
+     * @return 0 on success, otherwise an error code defined by `system_error_t`.
+     */
+    int put(const char* host, const Address& addr, uint32_t now);
+
+    /**
+     * Notify the cache that a background refresh of an entry has failed.
+     *
+     * The entry will be reported as needing a refresh again by the next lookup.
+     */
+    void refreshFailed(const char* host, Family family);
+
+    /**
+     * Remove the entries for a host.
+     *
+     * @param host Host name.
+     * @param family Address family. If `ANY`, the entries for all address families are removed.
+     */
+    void remove(const char* host, Family family = ANY);
+
+    /**
+     * Remove all entries.
+     */
+    void clear();
+
+    /**
+     * Serialize the cache.
+     *
+     * @param data Output buffer.
+     * @param size Buffer size. `MAX_SAVED_SIZE` bytes is always enough.
+     * @return Number of bytes written, or an error code defined by `system_error_t`.
+     */
+    int save(uint8_t* data, size_t size);
+
+    /**
+     * Replace the contents of the cache with previously serialized data.
+     *
+     * @param data Input data.
+     * @param size Data size.
+     * @return 0 on success, otherwise an error code defined by `system_error_t`.
+     */
+    int load(const uint8_t* data, size_t size);
+
+    /**
+     * Check if the cache has changed enough since it was last saved or loaded to be worth saving.
+     *
+     * Extending the lifetime of an entry doesn't mark the cache as modified until the saved
+     * expiration time is at least half of the TTL behind, which limits how often the cache is
+     * written to persistent storage.
+     */
+    bool isModified() const {
+        return modified_;
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+    uint32_t ttl() const {
+        return ttl_;
+    }
+
+private:
+    struct Entry {
+        char host[MAX_HOST_NAME_LENGTH + 1]; // Host name
+        Address addr; // Address
+        uint32_t expires; // Expiration time (0 if unknown)
+        uint32_t savedExpires; // Expiration time that was last saved
+        uint32_t lastUsed; // Time of the last lookup or update
+        bool refreshing; // Whether the entry is being refreshed
+        bool confirmed; // Whether the address has been resolved since the cache was loaded
+        bool usedUnconfirmed; // Whether the entry has been returned while unconfirmed and the time was unknown
+    };
+
+    Entry entries_[MAX_ENTRY_COUNT]; // Entries
+    size_t count_; // Number of entries
+    uint32_t ttl_; // Lifetime of an entry
+    bool modified_; // Whether the cache needs to be saved
+
+    Entry* find(const char* host, Family family);
+    Entry* alloc(uint32_t now);
+    void removeAt(size_t index);
+};
+
+} // namespace particle
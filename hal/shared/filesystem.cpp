@@ -24,86 +24,213 @@
 #include "system_error.h"
 #include "file_util.h"
 #include "scope_guard.h"
+#include "filesystem_block_cache.h"
 
 using namespace particle::fs;
 
-#if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
-
-#include "static_recursive_mutex.h"
+#ifndef FILESYSTEM_CACHE_LINE_COUNT
+#define FILESYSTEM_CACHE_LINE_COUNT (0)
+#endif
 
-namespace {
+#ifndef FILESYSTEM_WRITE_BUFFER_SIZE
+#define FILESYSTEM_WRITE_BUFFER_SIZE (0)
+#endif
 
-static StaticRecursiveMutex s_lfs_mutex;
+#define FILESYSTEM_BLOCK_CACHE_ENABLED (FILESYSTEM_CACHE_LINE_COUNT > 0 || FILESYSTEM_WRITE_BUFFER_SIZE > 0)
 
-} /* anonymous */
+#if MODULE_FUNCTION == MOD_FUNC_BOOTLOADER
 
-int filesystem_lock(filesystem_t* fs) {
+// See filesystem_lock.cpp
+__attribute__((weak)) int filesystem_lock(filesystem_t* fs) {
     (void)fs;
-    return !s_lfs_mutex.lock();
+    return 0;
 }
 
-int filesystem_unlock(filesystem_t* fs) {
+__attribute__((weak)) int filesystem_unlock(filesystem_t* fs) {
     (void)fs;
-    return !s_lfs_mutex.unlock();
+    return 0;
+}
+
+#endif /* MODULE_FUNCTION == MOD_FUNC_BOOTLOADER */
+
+
+namespace {
+
+int exflash_read(filesystem_t* fs, lfs_block_t block, lfs_off_t off, void* buffer, lfs_size_t size) {
+    int r = hal_exflash_read((block + fs->first_block) * fs->config.block_size + off, (uint8_t*)buffer, size);
+    if (r) {
+        LOG_DEBUG(ERROR, "fs_read error %d", r);
+    }
+    return r;
+}
+
+int exflash_prog(filesystem_t* fs, lfs_block_t block, lfs_off_t off, const void* buffer, lfs_size_t size) {
+    int r = hal_exflash_write((block + fs->first_block) * fs->config.block_size + off, (const uint8_t*)buffer, size);
+    if (r) {
+        LOG_DEBUG(ERROR, "fs_prog error %d", r);
+    }
+    return r;
+}
+
+int exflash_erase(filesystem_t* fs, lfs_block_t block) {
+    int r = hal_exflash_erase_sector((block + fs->first_block) * fs->config.block_size, 1);
+    if (r) {
+        LOG_DEBUG(ERROR, "fs_erase error %d", r);
+    }
+    return r;
+}
+
+#if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER && FILESYSTEM_BLOCK_CACHE_ENABLED
+
+class ExflashBlockDevice: public BlockDevice {
+public:
+    explicit ExflashBlockDevice(filesystem_t* fs) :
+            fs_(fs) {
+    }
+
+    int read(uint32_t block, size_t offs, void* data, size_t size) override {
+        return exflash_read(fs_, block, offs, data, size);
+    }
+
+    int prog(uint32_t block, size_t offs, const void* data, size_t size) override {
+        return exflash_prog(fs_, block, offs, data, size);
+    }
+
+    int erase(uint32_t block) override {
+        return exflash_erase(fs_, block);
+    }
+
+private:
+    filesystem_t* fs_;
+};
+
+class FsBlockCache: private ExflashBlockDevice, public BlockCache {
+public:
+    explicit FsBlockCache(filesystem_t* fs) :
+            ExflashBlockDevice(fs),
+            BlockCache(this) {
+    }
+};
+
+inline BlockCache* blockCache(filesystem_t* fs) {
+    return static_cast<BlockCache*>(fs->cache);
+}
+
+int createBlockCache(filesystem_t* fs) {
+    std::unique_ptr<FsBlockCache> c(new(std::nothrow) FsBlockCache(fs));
+    if (!c) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    BlockCache::Config conf = {};
+    conf.lineSize = fs->config.read_size;
+    conf.lineCount = FILESYSTEM_CACHE_LINE_COUNT;
+    conf.writeBufferSize = FILESYSTEM_WRITE_BUFFER_SIZE;
+    int r = c->init(conf);
+    if (r < 0) {
+        return r;
+    }
+    fs->cache = static_cast<BlockCache*>(c.release());
+    return 0;
+}
+
+int destroyBlockCache(filesystem_t* fs) {
+    auto c = blockCache(fs);
+    if (!c) {
+        return 0;
+    }
+    int r = c->sync();
+    if (r < 0) {
+        LOG(ERROR, "Failed to flush block cache: %d", r);
+    }
+    fs->cache = nullptr;
+    delete static_cast<FsBlockCache*>(c);
+    return r;
+}
+
+// Keeps the superblock and root directory pairs in the cache as every path lookup starts there
+void pinMetadataBlocks(filesystem_t* fs) {
+    auto c = blockCache(fs);
+    if (!c) {
+        return;
+    }
+    c->unpinAll();
+    c->pin(0);
+    c->pin(1);
+    c->pin(fs->instance.root[0]);
+    c->pin(fs->instance.root[1]);
 }
 
 #else
 
-__attribute__((weak)) int filesystem_lock(filesystem_t* fs) {
+inline BlockCache* blockCache(filesystem_t* fs) {
     (void)fs;
-    return 0;
+    return nullptr;
 }
 
-__attribute__((weak)) int filesystem_unlock(filesystem_t* fs) {
+inline int createBlockCache(filesystem_t* fs) {
     (void)fs;
     return 0;
 }
 
-#endif /* MODULE_FUNCTION != MOD_FUNC_BOOTLOADER */
+inline int destroyBlockCache(filesystem_t* fs) {
+    (void)fs;
+    return 0;
+}
 
+inline void pinMetadataBlocks(filesystem_t* fs) {
+    (void)fs;
+}
 
-namespace {
+#endif // MODULE_FUNCTION != MOD_FUNC_BOOTLOADER && FILESYSTEM_BLOCK_CACHE_ENABLED
 
 int fs_read(const struct lfs_config* c, lfs_block_t block,
             lfs_off_t off, void* buffer, lfs_size_t size)
 {
-    if (!((filesystem_t*)c->context)->state) {
+    auto fs = (filesystem_t*)c->context;
+    if (!fs->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
-    int r = hal_exflash_read((block + ((filesystem_t*)c->context)->first_block) * c->block_size + off, (uint8_t*)buffer, size);
-    if (r) {
-        LOG_DEBUG(ERROR, "fs_read error %d", r);
+    auto cache = blockCache(fs);
+    if (cache) {
+        return cache->read(block, off, buffer, size);
     }
-    return r;
+    return exflash_read(fs, block, off, buffer, size);
 }
 
 int fs_prog(const struct lfs_config* c, lfs_block_t block,
             lfs_off_t off, const void* buffer, lfs_size_t size)
 {
-    if (!((filesystem_t*)c->context)->state) {
+    auto fs = (filesystem_t*)c->context;
+    if (!fs->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
-    int r = hal_exflash_write((block + ((filesystem_t*)c->context)->first_block) * c->block_size + off, (const uint8_t*)buffer, size);
-    if (r) {
-        LOG_DEBUG(ERROR, "fs_prog error %d", r);
+    auto cache = blockCache(fs);
+    if (cache) {
+        return cache->prog(block, off, buffer, size);
     }
-    return r;
+    return exflash_prog(fs, block, off, buffer, size);
 }
 
 int fs_erase(const struct lfs_config* c, lfs_block_t block)
 {
-    if (!((filesystem_t*)c->context)->state) {
+    auto fs = (filesystem_t*)c->context;
+    if (!fs->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
-    int r = hal_exflash_erase_sector((block + ((filesystem_t*)c->context)->first_block) * c->block_size, 1);
-    if (r) {
-        LOG_DEBUG(ERROR, "fs_erase error %d", r);
+    auto cache = blockCache(fs);
+    if (cache) {
+        return cache->erase(block);
     }
-    return r;
+    return exflash_erase(fs, block);
 }
 
 int fs_sync(const struct lfs_config *c)
 {
+    auto fs = (filesystem_t*)c->context;
+    auto cache = blockCache(fs);
+    if (cache) {
+        return cache->sync();
+    }
     return 0;
 }
 
@@ -264,11 +391,18 @@ int filesystem_mount(filesystem_t* fs) {
     fs->state = true;
     SCOPE_GUARD({
         if (ret) {
+            destroyBlockCache(fs);
             fs->state = false;
         }
         SPARK_ASSERT(fs->state);
     });
 
+    // The filesystem is still usable without the cache
+    int r = createBlockCache(fs);
+    if (r < 0) {
+        LOG(WARN, "Failed to create block cache: %d", r);
+    }
+
     ret = lfs_mount(&fs->instance, &fs->config);
     if (!ret) {
         /* IMPORTANT: manually calling deorphan here to validate the filesystem.
@@ -310,6 +444,7 @@ int filesystem_mount(filesystem_t* fs) {
     }
 
     if (!ret) {
+        pinMetadataBlocks(fs);
 #if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
         if (fs->index == FILESYSTEM_INSTANCE_DEFAULT) {
             // Make sure /usr and /tmp folders exist
@@ -332,6 +467,10 @@ int filesystem_unmount(filesystem_t* fs) {
 
     if (fs->state) {
         ret = lfs_unmount(&fs->instance);
+        int r = destroyBlockCache(fs);
+        if (!ret) {
+            ret = r;
+        }
         fs->state = false;
         // This should not be required as storage read/write/erase are gated
         // by fs->state, but just in case invalidate at least files.
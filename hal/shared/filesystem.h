@@ -53,6 +53,8 @@ typedef struct filesystem_t {
 
     filesystem_instance_t index;
     uintptr_t first_block;
+
+    void* cache; /* Block cache (particle::fs::BlockCache), allocated when the filesystem is mounted */
 } filesystem_t;
 
 int filesystem_mount(filesystem_t* fs);
@@ -61,6 +63,11 @@ int filesystem_invalidate(filesystem_t* fs);
 filesystem_t* filesystem_get_instance(filesystem_instance_t index, void* reserved);
 int filesystem_dump_info(filesystem_t* fs);
 
+/*
+ * Each filesystem instance has its own recursive lock, so a long operation on the asset storage
+ * doesn't block the users of the default filesystem. The asset storage lock may be held while
+ * acquiring the lock of the default filesystem, but not the other way around.
+ */
 int filesystem_lock(filesystem_t* fs);
 int filesystem_unlock(filesystem_t* fs);
 
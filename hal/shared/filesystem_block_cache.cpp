@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <new>
+#include <cstring>
+
+#include "filesystem_block_cache.h"
+
+#include "check.h"
+
+namespace particle::fs {
+
+namespace {
+
+const uint32_t NO_BLOCK = 0xffffffff;
+
+// Minimum average size of a buffered write used to calculate the number of write entries
+const size_t MIN_AVG_WRITE_SIZE = 64;
+
+} // namespace
+
+BlockCache::BlockCache(BlockDevice* dev) :
+        pinned_(),
+        dev_(dev),
+        lineSize_(0),
+        lineCount_(0),
+        writeBufSize_(0),
+        writeBufUsed_(0),
+        writeCount_(0),
+        maxWriteCount_(0),
+        pinnedCount_(0),
+        useCount_(0) {
+}
+
+int BlockCache::init(const Config& conf) {
+    CHECK_TRUE(conf.lineSize > 0, SYSTEM_ERROR_INVALID_ARGUMENT);
+    if (conf.lineCount > 0) {
+        lines_.reset(new(std::nothrow) Line[conf.lineCount]());
+        lineData_.reset(new(std::nothrow) char[conf.lineCount * conf.lineSize]);
+        CHECK_TRUE(lines_ && lineData_, SYSTEM_ERROR_NO_MEMORY);
+    }
+    if (conf.writeBufferSize > 0) {
+        const size_t maxWriteCount = std::max<size_t>(conf.writeBufferSize / MIN_AVG_WRITE_SIZE, 1);
+        writes_.reset(new(std::nothrow) Write[maxWriteCount]);
+        writeBuf_.reset(new(std::nothrow) char[conf.writeBufferSize]);
+        CHECK_TRUE(writes_ && writeBuf_, SYSTEM_ERROR_NO_MEMORY);
+        maxWriteCount_ = maxWriteCount;
+    }
+    lineSize_ = conf.lineSize;
+    lineCount_ = conf.lineCount;
+    writeBufSize_ = conf.writeBufferSize;
+    return 0;
+}
+
+int BlockCache::read(uint32_t block, size_t offs, void* data, size_t size) {
+    // Reads that span multiple full lines are usually file data and don't go through the cache
+    if (!lineCount_ || (size > lineSize_ && offs % lineSize_ == 0 && size % lineSize_ == 0)) {
+        return readDevice(block, offs, data, size);
+    }
+    auto d = (char*)data;
+    while (size > 0) {
+        const size_t lineOffs = offs / lineSize_ * lineSize_;
+        const size_t n = std::min(size, lineOffs + lineSize_ - offs);
+        char* lineData = nullptr;
+        CHECK(readLine(block, lineOffs, &lineData));
+        std::memcpy(d, lineData + (offs - lineOffs), n);
+        d += n;
+        offs += n;
+        size -= n;
+    }
+    return 0;
+}
+
+int BlockCache::prog(uint32_t block, size_t offs, const void* data, size_t size) {
+    invalidateLines(block, offs, size);
+    if (!writeBufSize_ || size > writeBufSize_) {
+        CHECK(flush(NO_BLOCK));
+        return dev_->prog(block, offs, data, size);
+    }
+    if (writeCount_ > 0) {
+        auto& w = writes_[writeCount_ - 1];
+        if (w.block == block && w.offs + w.size == offs && writeBufUsed_ + size <= writeBufSize_) {
+            std::memcpy(writeBuf_.get() + writeBufUsed_, data, size);
+            writeBufUsed_ += size;
+            w.size += size;
+            return 0;
+        }
+    }
+    if (writeCount_ == maxWriteCount_ || writeBufUsed_ + size > writeBufSize_) {
+        CHECK(flush(NO_BLOCK));
+    }
+    auto& w = writes_[writeCount_++];
+    w.block = block;
+    w.offs = offs;
+    w.bufOffs = writeBufUsed_;
+    w.size = size;
+    std::memcpy(writeBuf_.get() + writeBufUsed_, data, size);
+    writeBufUsed_ += size;
+    return 0;
+}
+
+int BlockCache::erase(uint32_t block) {
+    // Any buffered data for this block is about to be erased anyway
+    CHECK(flush(block));
+    invalidateLines(block, 0, (size_t)-1);
+    return dev_->erase(block);
+}
+
+int BlockCache::sync() {
+    return flush(NO_BLOCK);
+}
+
+int BlockCache::pin(uint32_t block) {
+    if (isPinned(block)) {
+        return 0;
+    }
+    CHECK_TRUE(pinnedCount_ < MAX_PINNED_BLOCKS, SYSTEM_ERROR_LIMIT_EXCEEDED);
+    pinned_[pinnedCount_++] = block;
+    return 0;
+}
+
+void BlockCache::unpin(uint32_t block) {
+    for (size_t i = 0; i < pinnedCount_; ++i) {
+        if (pinned_[i] == block) {
+            pinned_[i] = pinned_[--pinnedCount_];
+            break;
+        }
+    }
+}
+
+void BlockCache::unpinAll() {
+    pinnedCount_ = 0;
+}
+
+void BlockCache::invalidate() {
+    for (size_t i = 0; i < lineCount_; ++i) {
+        lines_[i].valid = false;
+    }
+}
+
+int BlockCache::readLine(uint32_t block, size_t lineOffs, char** data) {
+    auto line = findLine(block, lineOffs);
+    if (!line) {
+        line = evictLine();
+        line->valid = false;
+        CHECK(readDevice(block, lineOffs, lineData(line), lineSize_));
+        line->block = block;
+        line->offs = lineOffs;
+        line->valid = true;
+    }
+    line->lastUsed = ++useCount_;
+    *data = lineData(line);
+    return 0;
+}
+
+int BlockCache::readDevice(uint32_t block, size_t offs, void* data, size_t size) {
+    CHECK(dev_->read(block, offs, data, size));
+    // Apply the buffered writes in the order in which they were made
+    const size_t end = offs + size;
+    for (size_t i = 0; i < writeCount_; ++i) {
+        const auto& w = writes_[i];
+        if (w.block != block) {
+            continue;
+        }
+        const size_t wEnd = w.offs + w.size;
+        if (w.offs >= end || wEnd <= offs) {
+            continue;
+        }
+        const size_t from = std::max<size_t>(w.offs, offs);
+        const size_t to = std::min(wEnd, end);
+        std::memcpy((char*)data + (from - offs), writeBuf_.get() + w.bufOffs + (from - w.offs), to - from);
+    }
+    return 0;
+}
+
+void BlockCache::invalidateLines(uint32_t block, size_t offs, size_t size) {
+    const size_t end = (size > (size_t)-1 - offs) ? (size_t)-1 : offs + size;
+    for (size_t i = 0; i < lineCount_; ++i) {
+        auto& line = lines_[i];
+        if (line.valid && line.block == block && line.offs < end && line.offs + lineSize_ > offs) {
+            line.valid = false;
+        }
+    }
+}
+
+int BlockCache::flush(uint32_t dropBlock) {
+    int result = 0;
+    size_t failed = 0; // Index of the failed write
+    for (; failed < writeCount_; ++failed) {
+        const auto& w = writes_[failed];
+        if (w.block == dropBlock) {
+            continue;
+        }
+        result = dev_->prog(w.block, w.offs, writeBuf_.get() + w.bufOffs, w.size);
+        if (result < 0) {
+            break;
+        }
+    }
+    if (result < 0) {
+        // Keep the writes that haven't made it to the device so that they're retried by the next
+        // flush and the error is reported again if it persists. The writes to the block that was
+        // going to be erased are kept as well as the erase won't happen
+        size_t count = 0;
+        size_t bufUsed = 0;
+        for (size_t i = 0; i < writeCount_; ++i) {
+            auto w = writes_[i];
+            if (i < failed && w.block != dropBlock) {
+                continue;
+            }
+            std::memmove(writeBuf_.get() + bufUsed, writeBuf_.get() + w.bufOffs, w.size);
+            w.bufOffs = bufUsed;
+            writes_[count++] = w;
+            bufUsed += w.size;
+        }
+        writeCount_ = count;
+        writeBufUsed_ = bufUsed;
+        return result;
+    }
+    writeCount_ = 0;
+    writeBufUsed_ = 0;
+    return 0;
+}
+
+BlockCache::Line* BlockCache::findLine(uint32_t block, size_t lineOffs) {
+    for (size_t i = 0; i < lineCount_; ++i) {
+        auto& line = lines_[i];
+        if (line.valid && line.block == block && line.offs == lineOffs) {
+            return &line;
+        }
+    }
+    return nullptr;
+}
+
+BlockCache::Line* BlockCache::evictLine() {
+    Line* oldest = nullptr;
+    Line* oldestUnpinned = nullptr;
+    for (size_t i = 0; i < lineCount_; ++i) {
+        auto& line = lines_[i];
+        if (!line.valid) {
+            return &line;
+        }
+        // The use counter may wrap around so compare the ages of the lines
+        if (!oldest || useCount_ - line.lastUsed > useCount_ - oldest->lastUsed) {
+            oldest = &line;
+        }
+        if (!isPinned(line.block) && (!oldestUnpinned || useCount_ - line.lastUsed > useCount_ - oldestUnpinned->lastUsed)) {
+            oldestUnpinned = &line;
+        }
+    }
+    return oldestUnpinned ? oldestUnpinned : oldest;
+}
+
+bool BlockCache::isPinned(uint32_t block) const {
+    for (size_t i = 0; i < pinnedCount_; ++i) {
+        if (pinned_[i] == block) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace particle::fs
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace particle::fs {
+
+/**
+ * Block device interface.
+ */
+class BlockDevice {
+public:
+    virtual ~BlockDevice() = default;
+
+    virtual int read(uint32_t block, size_t offs, void* data, size_t size) = 0;
+    virtual int prog(uint32_t block, size_t offs, const void* data, size_t size) = 0;
+    virtual int erase(uint32_t block) = 0;
+};
+
+/**
+ * Read cache and write-behind buffer for a block device.
+ *
+ * Reads are cached in lines of a fixed size aligned to the line size within a block. Lines are
+ * evicted in LRU order, except for the lines of pinned blocks, which are only evicted if there's no
+ * other line to evict. A read that covers more than one full line bypasses the cache so that
+ * streaming file data doesn't push the metadata out of it. Programming a region of a block
+ * invalidates the cached lines that overlap with it so that the data read back after programming
+ * comes from the device.
+ *
+ * If write-behind is enabled, programmed data is kept in a buffer and written to the device when
+ * the buffer is full, before a block is erased, or when `sync()` is called. Adjacent writes to the
+ * same block are merged into one device operation. Reads of a region with buffered data return that
+ * data. Note that the device contents are only guaranteed to be consistent after a call to `sync()`
+ * and the cache doesn't flush the buffer when it's destroyed.
+ *
+ * If writing the buffered data to the device fails, the failed write and the ones that follow it
+ * remain in the buffer and the error is returned by the operation that caused the flush. The
+ * writes are retried by the next flush, so the error is reported again by subsequent calls to
+ * `sync()`, `prog()` or `erase()` until the device accepts the data.
+ */
+class BlockCache {
+public:
+    /**
+     * Cache settings.
+     */
+    struct Config {
+        size_t lineSize; // Size of a cache line
+        size_t lineCount; // Number of cache lines
+        size_t writeBufferSize; // Size of the write-behind buffer. 0 disables write-behind
+    };
+
+    /**
+     * Maximum number of pinned blocks.
+     */
+    static const size_t MAX_PINNED_BLOCKS = 4;
+
+    explicit BlockCache(BlockDevice* dev);
+    ~BlockCache() = default;
+
+    /**
+     * Initialize the cache.
+     *
+     * @param conf Settings.
+     * @return 0 on success, otherwise an error code defined by `system_error_t`.
+     */
+    int init(const Config& conf);
+
+    int read(uint32_t block, size_t offs, void* data, size_t size);
+    int prog(uint32_t block, size_t offs, const void* data, size_t size);
+    int erase(uint32_t block);
+
+    /**
+     * Write the buffered data to the device.
+     *
+     * @return 0 on success, otherwise an error code defined by `system_error_t`.
+     */
+    int sync();
+
+    /**
+     * Keep the cached lines of a block in the cache for as long as possible.
+     *
+     * @return 0 on success, otherwise an error code defined by `system_error_t`.
+     */
+    int pin(uint32_t block);
+    /**
+     * Unpin a block.
+     */
+    void unpin(uint32_t block);
+    /**
+     * Unpin all blocks.
+     */
+    void unpinAll();
+
+    /**
+     * Discard all cached lines.
+     *
+     * The write-behind buffer is not affected.
+     */
+    void invalidate();
+
+    // This class is non-copyable
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+private:
+    struct Line {
+        uint32_t block; // Block number
+        uint32_t offs; // Offset of the line in the block
+        uint32_t lastUsed; // Value of the use counter when the line was last accessed
+        bool valid; // Whether the line contains any data
+    };
+
+    struct Write {
+        uint32_t block; // Block number
+        uint32_t offs; // Offset in the block
+        uint32_t bufOffs; // Offset of the data in the write buffer
+        uint32_t size; // Data size
+    };
+
+    std::unique_ptr<Line[]> lines_; // Cache lines
+    std::unique_ptr<char[]> lineData_; // Data of the cache lines
+    std::unique_ptr<Write[]> writes_; // Buffered writes
+    std::unique_ptr<char[]> writeBuf_; // Data of the buffered writes
+    uint32_t pinned_[MAX_PINNED_BLOCKS]; // Pinned blocks
+    BlockDevice* dev_; // Block device
+    size_t lineSize_; // Size of a cache line
+    size_t lineCount_; // Number of cache lines
+    size_t writeBufSize_; // Size of the write buffer
+    size_t writeBufUsed_; // Number of bytes used in the write buffer
+    size_t writeCount_; // Number of buffered writes
+    size_t maxWriteCount_; // Maximum number of buffered writes
+    size_t pinnedCount_; // Number of pinned blocks
+    uint32_t useCount_; // Use counter
+
+    int readLine(uint32_t block, size_t lineOffs, char** data);
+    int readDevice(uint32_t block, size_t offs, void* data, size_t size);
+    void invalidateLines(uint32_t block, size_t offs, size_t size);
+    int flush(uint32_t dropBlock);
+    Line* findLine(uint32_t block, size_t lineOffs);
+    Line* evictLine();
+    bool isPinned(uint32_t block) const;
+
+    char* lineData(const Line* line) {
+        return lineData_.get() + (line - lines_.get()) * lineSize_;
+    }
+};
+
+} // namespace particle::fs
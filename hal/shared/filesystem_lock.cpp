@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filesystem.h"
+#include "filesystem_block_cache.h"
+#include "static_recursive_mutex.h"
+#include "logging.h"
+
+using namespace particle::fs;
+
+namespace {
+
+// littlefs is not reentrant, so the operations on a given instance are serialized. Reads can't
+// share the lock either as they update the caches and the file and directory state of the instance
+struct InstanceLock {
+    StaticRecursiveMutex mutex;
+    unsigned count; // Recursion depth
+};
+
+InstanceLock s_locks[2] = {};
+
+InstanceLock* instanceLock(filesystem_t* fs) {
+    if (fs && fs->index == FILESYSTEM_INSTANCE_ASSET_STORAGE) {
+        return &s_locks[1];
+    }
+    return &s_locks[0];
+}
+
+} // namespace
+
+int filesystem_lock(filesystem_t* fs) {
+    auto lock = instanceLock(fs);
+    if (!lock->mutex.lock()) {
+        return 1;
+    }
+    ++lock->count;
+    return 0;
+}
+
+int filesystem_unlock(filesystem_t* fs) {
+    auto lock = instanceLock(fs);
+    if (lock->count == 1 && fs && fs->cache) {
+        // littlefs doesn't reliably call the sync callback so make sure the buffered writes reach
+        // the flash by the time a filesystem operation completes
+        int r = static_cast<BlockCache*>(fs->cache)->sync();
+        if (r < 0) {
+            LOG(ERROR, "Failed to flush block cache: %d", r);
+        }
+    }
+    --lock->count;
+    return !lock->mutex.unlock();
+}
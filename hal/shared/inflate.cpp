@@ -20,6 +20,7 @@
 #if HAL_PLATFORM_COMPRESSED_OTA
 
 #include "inflate_impl.h"
+#include "module_info.h"
 
 #include "check.h"
 #include <algorithm>
@@ -38,6 +39,24 @@ const auto INFLATE_USE_FILESYSTEM_READ_CACHE_SIZE = 1024;
 
 #endif // HAL_PLATFORM_INFLATE_USE_FILESYSTEM
 
+#if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
+
+const uint32_t INFLATE_STATE_MAGIC = 0x54534e49; // "INST"
+
+struct __attribute__((packed)) InflateStateHeader {
+    uint32_t magic; // INFLATE_STATE_MAGIC
+    uint32_t decomp_size; // Size of the tinfl_decompressor structure
+    uint32_t buf_size; // Size of the dictionary window
+    uint32_t buf_offs; // Current offset in the dictionary window
+};
+
+bool canSaveState(const inflate_ctx* ctx) {
+    // Saving the state is not supported if the dictionary window is kept in the filesystem
+    return ctx->buf && ctx->buf_avail == 0 && ctx->result == INFLATE_NEEDS_MORE_INPUT && !ctx->done;
+}
+
+#endif // MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
+
 } // anonymous
 
 int inflate_create(inflate_ctx** ctx, const inflate_opts* opts, inflate_output output, void* user_data) {
@@ -223,4 +242,71 @@ int inflate_input(inflate_ctx* ctx, const char* data, size_t* size, unsigned fla
     return ctx->result;
 }
 
+#if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
+
+int inflate_state_size(const inflate_ctx* ctx) {
+    CHECK_TRUE(ctx->buf, SYSTEM_ERROR_NOT_SUPPORTED);
+    return sizeof(InflateStateHeader) + sizeof(ctx->decomp) + ctx->buf_size;
+}
+
+int inflate_save_state(inflate_ctx* ctx, inflate_output write, void* user_data) {
+    CHECK_TRUE(write, SYSTEM_ERROR_INVALID_ARGUMENT);
+    CHECK_TRUE(canSaveState(ctx), SYSTEM_ERROR_INVALID_STATE);
+    InflateStateHeader h = {};
+    h.magic = INFLATE_STATE_MAGIC;
+    h.decomp_size = sizeof(ctx->decomp);
+    h.buf_size = ctx->buf_size;
+    h.buf_offs = ctx->buf_offs;
+    const struct {
+        const char* data;
+        size_t size;
+    } parts[] = {
+        { (const char*)&h, sizeof(h) },
+        { (const char*)&ctx->decomp, sizeof(ctx->decomp) },
+        { ctx->buf, ctx->buf_size }
+    };
+    for (const auto& p: parts) {
+        const int n = CHECK(write(p.data, p.size, user_data));
+        CHECK_TRUE((size_t)n == p.size, SYSTEM_ERROR_IO);
+    }
+    return 0;
+}
+
+int inflate_restore_state(inflate_ctx* ctx, inflate_state_input read, void* user_data) {
+    CHECK_TRUE(read, SYSTEM_ERROR_INVALID_ARGUMENT);
+    CHECK_TRUE(ctx->buf, SYSTEM_ERROR_NOT_SUPPORTED);
+    InflateStateHeader h = {};
+    int n = CHECK(read((char*)&h, sizeof(h), user_data));
+    CHECK_TRUE((size_t)n == sizeof(h), SYSTEM_ERROR_IO);
+    CHECK_TRUE(h.magic == INFLATE_STATE_MAGIC && h.decomp_size == sizeof(ctx->decomp) && h.buf_size == ctx->buf_size &&
+            h.buf_offs < ctx->buf_size, SYSTEM_ERROR_BAD_DATA);
+    // The decompressor is left in the initial state if the data can't be read
+    NAMED_SCOPE_GUARD(sg, {
+        inflate_reset(ctx);
+    });
+#if HAL_PLATFORM_INFLATE_USE_FILESYSTEM
+    // Keep the callbacks of the current instance
+    const auto readWriteCtx = ctx->decomp.read_write_ctx;
+    const auto readBuf = ctx->decomp.read_buf;
+    const auto writeBuf = ctx->decomp.write_buf;
+#endif // HAL_PLATFORM_INFLATE_USE_FILESYSTEM
+    n = CHECK(read((char*)&ctx->decomp, sizeof(ctx->decomp), user_data));
+    CHECK_TRUE((size_t)n == sizeof(ctx->decomp), SYSTEM_ERROR_IO);
+#if HAL_PLATFORM_INFLATE_USE_FILESYSTEM
+    ctx->decomp.read_write_ctx = readWriteCtx;
+    ctx->decomp.read_buf = readBuf;
+    ctx->decomp.write_buf = writeBuf;
+#endif // HAL_PLATFORM_INFLATE_USE_FILESYSTEM
+    n = CHECK(read(ctx->buf, ctx->buf_size, user_data));
+    CHECK_TRUE((size_t)n == ctx->buf_size, SYSTEM_ERROR_IO);
+    ctx->buf_offs = h.buf_offs;
+    ctx->buf_avail = 0;
+    ctx->result = INFLATE_NEEDS_MORE_INPUT;
+    ctx->done = false;
+    sg.dismiss();
+    return 0;
+}
+
+#endif // MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
+
 #endif // HAL_PLATFORM_COMPRESSED_OTA
@@ -26,6 +26,7 @@
 typedef struct inflate_ctx inflate_ctx;
 
 typedef int (*inflate_output)(const char* data, size_t size, void* user_data);
+typedef int (*inflate_state_input)(char* data, size_t size, void* user_data);
 
 typedef enum inflate_result {
     INFLATE_DONE = 0,
@@ -52,6 +53,14 @@ int inflate_reset(inflate_ctx* ctx);
 
 int inflate_input(inflate_ctx* ctx, const char* data, size_t* size, unsigned flags);
 
+// The decompressor state can only be saved when all the output data produced so far has been consumed
+// and inflate_input() has returned INFLATE_NEEDS_MORE_INPUT. The saved state includes the contents
+// of the dictionary window and can be used to resume the decompression at the same position in the
+// compressed stream. These functions are not available in the bootloader
+int inflate_state_size(const inflate_ctx* ctx);
+int inflate_save_state(inflate_ctx* ctx, inflate_output write, void* user_data);
+int inflate_restore_state(inflate_ctx* ctx, inflate_state_input read, void* user_data);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffered_serial.h"
+
+#include <cstring>
+
+namespace particle {
+
+BufferedSerialIo::BufferedSerialIo(SendFn send, ReceiveFn receive) :
+        rx_(),
+        tx_(),
+        send_(std::move(send)),
+        receive_(std::move(receive)),
+        flushInterval_(std::chrono::milliseconds(DEFAULT_FLUSH_INTERVAL)),
+        flushThreshold_(DEFAULT_FLUSH_THRESHOLD),
+        flushRequested_(false),
+        stopRequested_(false) {
+}
+
+BufferedSerialIo::~BufferedSerialIo() {
+    stop();
+}
+
+void BufferedSerialIo::init(char* rxBuf, size_t rxSize, char* txBuf, size_t txSize) {
+    stop();
+    rx_ = { rxBuf, rxSize, 0, 0, 0 };
+    tx_ = { txBuf, txSize, 0, 0, 0 };
+}
+
+void BufferedSerialIo::start() {
+    if (isRunning() || !rx_.size || !tx_.size) {
+        return;
+    }
+    stopRequested_ = false;
+    flushRequested_ = false;
+    thread_ = std::thread([this]() {
+        run();
+    });
+}
+
+void BufferedSerialIo::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+        txReady_.notify_all();
+        txSpace_.notify_all();
+    }
+    thread_.join();
+    tx_.consume(tx_.count);
+}
+
+int BufferedSerialIo::available() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rx_.count;
+}
+
+int BufferedSerialIo::availableForWrite() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tx_.space();
+}
+
+int BufferedSerialIo::read() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!rx_.count) {
+        return -1;
+    }
+    const int c = (unsigned char)rx_.data[rx_.tail];
+    rx_.consume(1);
+    return c;
+}
+
+int BufferedSerialIo::peek() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!rx_.count) {
+        return -1;
+    }
+    return (unsigned char)rx_.data[rx_.tail];
+}
+
+size_t BufferedSerialIo::write(const char* data, size_t size) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t written = 0;
+    while (written < size && isRunning() && !stopRequested_) {
+        if (!tx_.space()) {
+            // Don't wait for the flush interval to elapse if the buffer is full
+            flushRequested_ = true;
+            txReady_.notify_one();
+            txSpace_.wait(lock, [this]() { return tx_.space() || stopRequested_; });
+            continue;
+        }
+        if (!tx_.count) {
+            txPendingSince_ = Clock::now();
+        }
+        const size_t n = std::min(size - written, tx_.writableBlock());
+        memcpy(tx_.data + tx_.head, data + written, n);
+        tx_.produce(n);
+        written += n;
+        if (tx_.count >= std::min(flushThreshold_, tx_.size)) {
+            txReady_.notify_one();
+        }
+    }
+    return written;
+}
+
+void BufferedSerialIo::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!isRunning() || !tx_.count) {
+        return;
+    }
+    flushRequested_ = true;
+    txReady_.notify_one();
+    txSpace_.wait(lock, [this]() { return !tx_.count || stopRequested_; });
+}
+
+void BufferedSerialIo::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool txBlocked = false; // Set if the transport didn't accept all of the data
+    while (!stopRequested_) {
+        bool idle = true;
+        // The I/O thread is the only one that takes data out of the TX buffer and puts data into the
+        // RX buffer, so the blocks being sent or received don't change while the lock is released
+        if (tx_.count && !txBlocked && shouldSend(Clock::now())) {
+            const char* const data = tx_.data + tx_.tail;
+            const size_t size = tx_.readableBlock();
+            lock.unlock();
+            int r = send_(data, size);
+            lock.lock();
+            if (r < 0) {
+                r = tx_.count; // Discard all pending data, as a serial line would do if nothing was connected
+            }
+            if (r > 0) {
+                tx_.consume(r);
+                if (!tx_.count) {
+                    flushRequested_ = false;
+                }
+                txSpace_.notify_all();
+            }
+            if ((size_t)r < size) {
+                // The transport can't take more data at the moment. Retrying right away would keep
+                // this thread spinning until there's space in the socket buffer
+                txBlocked = true;
+            } else {
+                idle = false;
+            }
+        }
+        if (rx_.space()) {
+            char* const data = rx_.data + rx_.head;
+            const size_t size = rx_.writableBlock();
+            lock.unlock();
+            const int r = receive_(data, size);
+            lock.lock();
+            if (r > 0) {
+                rx_.produce(r);
+                idle = false;
+            }
+        }
+        if (idle) {
+            txReady_.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL), [this, txBlocked]() {
+                return stopRequested_ || (!txBlocked && tx_.count && shouldSend(Clock::now()));
+            });
+            txBlocked = false;
+        }
+    }
+}
+
+bool BufferedSerialIo::shouldSend(Clock::time_point now) const {
+    return flushRequested_ || tx_.count >= std::min(flushThreshold_, tx_.size) ||
+            now - txPendingSince_ >= flushInterval_;
+}
+
+} // namespace particle
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstddef>
+
+namespace particle {
+
+/**
+ * Buffered serial I/O on top of a stream transport.
+ *
+ * Data written by the application is stored in a TX ring buffer and sent by a background thread
+ * in blocks, either when enough data has been accumulated, when the oldest pending byte has been
+ * waiting for too long, or when a flush is requested. The same thread keeps the RX ring buffer
+ * filled with the data available in the transport.
+ */
+class BufferedSerialIo {
+public:
+    // Sends data. Returns the number of bytes sent or a negative value in case of an error
+    typedef std::function<int(const char* data, size_t size)> SendFn;
+    // Receives data without blocking. Returns the number of bytes received or a negative value in case of an error
+    typedef std::function<int(char* data, size_t size)> ReceiveFn;
+
+    static const size_t DEFAULT_FLUSH_THRESHOLD = 256; // Bytes
+    static const unsigned DEFAULT_FLUSH_INTERVAL = 5; // Milliseconds
+    static const unsigned POLL_INTERVAL = 1; // Milliseconds
+
+    BufferedSerialIo(SendFn send, ReceiveFn receive);
+    ~BufferedSerialIo();
+
+    // Stops the I/O thread if it's running. The buffers must remain valid until the thread is stopped
+    void init(char* rxBuf, size_t rxSize, char* txBuf, size_t txSize);
+
+    void start();
+    // Stops the I/O thread. Pending TX data is discarded
+    void stop();
+
+    int available();
+    int availableForWrite();
+    int read();
+    int peek();
+    // Blocks while the TX buffer is full. Returns the number of bytes written
+    size_t write(const char* data, size_t size);
+    // Blocks until all pending TX data is sent
+    void flush();
+
+    BufferedSerialIo& flushThreshold(size_t size) {
+        flushThreshold_ = size;
+        return *this;
+    }
+
+    BufferedSerialIo& flushInterval(unsigned ms) {
+        flushInterval_ = std::chrono::milliseconds(ms);
+        return *this;
+    }
+
+    bool isRunning() const {
+        return thread_.joinable();
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct RingBuffer {
+        char* data;
+        size_t size;
+        size_t head; // Write position
+        size_t tail; // Read position
+        size_t count;
+
+        size_t space() const {
+            return size - count;
+        }
+
+        // Size of the contiguous block of data that can be read at the tail
+        size_t readableBlock() const {
+            return std::min(count, size - tail);
+        }
+
+        // Size of the contiguous block of space that can be written at the head
+        size_t writableBlock() const {
+            return std::min(space(), size - head);
+        }
+
+        void produce(size_t n) {
+            head = (head + n) % size;
+            count += n;
+        }
+
+        void consume(size_t n) {
+            tail = (tail + n) % size;
+            count -= n;
+        }
+    };
+
+    RingBuffer rx_;
+    RingBuffer tx_;
+    SendFn send_;
+    ReceiveFn receive_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable txReady_; // Signaled when there's enough data to send
+    std::condition_variable txSpace_; // Signaled when data has been taken out of the TX buffer
+    Clock::time_point txPendingSince_;
+    Clock::duration flushInterval_;
+    size_t flushThreshold_;
+    bool flushRequested_;
+    bool stopRequested_;
+
+    void run();
+    bool shouldSend(Clock::time_point now) const;
+};
+
+} // namespace particle
@@ -43,6 +43,11 @@
 #define HAL_PLATFORM_CLOUD_TCP 0
 #endif
 
+// Maximum number of TCP sockets, and separately of UDP sockets, that can be open at the same time
+#ifndef HAL_PLATFORM_SOCKET_COUNT
+#define HAL_PLATFORM_SOCKET_COUNT (64)
+#endif
+
 #define HAL_PLATFORM_NCP 	(0)
 #define HAL_PLATFORM_NCP_AT (0)
 
@@ -5,12 +5,15 @@
 #include <cstring>
 
 #include <boost/endian.hpp>
+#include <boost/crc.hpp>
 
 #include "ota_flash_hal.h"
 #include "device_config.h"
 #include "service_debug.h"
 #include "core_hal.h"
 #include "filesystem_util.h"
+#include "update_pipeline.h"
+#include "sha256.h"
 #include "bytes2hexbuf.h"
 #include "module_info.h"
 #include "../../../system/inc/system_info.h" // FIXME
@@ -52,6 +55,119 @@ struct ParsedModuleInfo {
     uint8_t hash[32];
 };
 
+class UpdateError: public std::runtime_error {
+public:
+    UpdateError(int error, const char* msg) :
+            std::runtime_error(msg),
+            error_(error) {
+    }
+
+    int error() const {
+        return error_;
+    }
+
+private:
+    int error_;
+};
+
+// Calculates the CRC-32 and SHA-256 of a module binary as its data is being written to the update file
+class ModuleChecksum {
+public:
+    explicit ModuleChecksum(size_t moduleSize) :
+            trailer_(),
+            moduleSize_(moduleSize),
+            offset_(0),
+            sequential_(true) {
+        if (sha_.init() < 0 || sha_.start() < 0) {
+            throw std::runtime_error("Failed to initialize SHA-256 context");
+        }
+    }
+
+    // Returns false if the data doesn't immediately follow the data processed so far
+    bool update(size_t offset, const char* data, size_t size) {
+        if (!sequential_ || offset != offset_ || size > moduleSize_ - offset_) {
+            sequential_ = false;
+            return false;
+        }
+        if (isValidSize()) {
+            // SHA-256 is calculated over the module data excluding the hash, the suffix size field and the CRC-32
+            const size_t crcDataSize = moduleSize_ - 4 /* CRC-32 */;
+            const size_t shaDataSize = crcDataSize - 2 /* size */ - Sha256::HASH_SIZE;
+            if (offset_ < crcDataSize) {
+                crc_.process_bytes(data, std::min(size, crcDataSize - offset_));
+            }
+            if (offset_ < shaDataSize && sha_.update(data, std::min(size, shaDataSize - offset_)) < 0) {
+                throw std::runtime_error("Failed to calculate SHA-256");
+            }
+            // Keep the expected hash and CRC-32
+            const size_t trailerOffs = moduleSize_ - sizeof(trailer_);
+            if (offset_ + size > trailerOffs) {
+                const size_t begin = std::max(offset_, trailerOffs);
+                memcpy(trailer_ + begin - trailerOffs, data + begin - offset_, offset_ + size - begin);
+            }
+        }
+        offset_ += size;
+        return true;
+    }
+
+    void verify() {
+        if (!isValidSize()) {
+            throw UpdateError(SYSTEM_ERROR_BAD_DATA, "Invalid module size");
+        }
+        if (!sequential_ || offset_ != moduleSize_) {
+            throw std::runtime_error("Incomplete module data");
+        }
+        uint32_t expectedCrc = 0;
+        memcpy(&expectedCrc, trailer_ + sizeof(trailer_) - sizeof(expectedCrc), sizeof(expectedCrc));
+        if (crc_.checksum() != endian::big_to_native(expectedCrc)) {
+            throw UpdateError(SYSTEM_ERROR_BAD_DATA, "Invalid module CRC-32");
+        }
+        char actualSha[Sha256::HASH_SIZE] = {};
+        if (sha_.finish(actualSha) < 0) {
+            throw std::runtime_error("Failed to calculate SHA-256");
+        }
+        if (memcmp(actualSha, trailer_, sizeof(actualSha)) != 0) {
+            throw UpdateError(SYSTEM_ERROR_BAD_DATA, "Invalid module SHA-256");
+        }
+    }
+
+    bool isSequential() const {
+        return sequential_;
+    }
+
+private:
+    boost::crc_32_type crc_;
+    Sha256 sha_;
+    char trailer_[Sha256::HASH_SIZE + 2 /* size */ + 4 /* CRC-32 */];
+    size_t moduleSize_;
+    size_t offset_;
+    bool sequential_;
+
+    bool isValidSize() const {
+        return moduleSize_ > MODULE_PREFIX_SIZE + MODULE_SUFFIX_SIZE + 4 /* CRC-32 */;
+    }
+};
+
+// Verifies the CRC-32 and SHA-256 of a module binary stored in a file
+void verifyModule(const std::string& file) {
+    std::ifstream in;
+    in.exceptions(std::ios::badbit | std::ios::failbit);
+    in.open(file, std::ios::binary);
+    in.seekg(0, std::ios::end);
+    const size_t fileSize = in.tellg();
+    in.seekg(0);
+    ModuleChecksum checksum(fileSize);
+    std::string buf(64 * 1024, '\0');
+    size_t offs = 0;
+    while (offs < fileSize) {
+        const size_t n = std::min(buf.size(), fileSize - offs);
+        in.read(buf.data(), n);
+        checksum.update(offs, buf.data(), n);
+        offs += n;
+    }
+    checksum.verify();
+}
+
 ParsedModuleInfo parseModule(const std::string& file) {
     std::ifstream in;
     in.exceptions(std::ios::badbit | std::ios::failbit);
@@ -142,7 +258,10 @@ module_bounds_location_t moduleLocation(const config::ModuleInfo& module) {
     return MODULE_BOUNDS_LOC_INTERNAL_FLASH;
 }
 
-std::ofstream g_updateStream;
+// Chunks of the update file are written and checksummed in a separate thread so that receiving
+// the next chunk doesn't have to wait for the disk
+AsyncFileWriter g_updateWriter;
+std::unique_ptr<ModuleChecksum> g_updateChecksum; // Accessed by the writer thread while the file is open
 std::string g_updateFile;
 size_t g_updateSize = 0;
 
@@ -244,19 +363,20 @@ uint16_t HAL_OTA_ChunkSize()
 bool HAL_FLASH_Begin(uint32_t sFLASH_Address, uint32_t fileSize, void* reserved)
 {
     try {
-        if (g_updateStream.is_open()) {
-            g_updateStream.close();
+        if (g_updateWriter.isOpen()) {
+            g_updateWriter.cancel();
             fs::remove(g_updateFile);
         }
         g_updateFile = temp_file_name("device_update_", ".bin");
-        g_updateStream.exceptions(std::ios::badbit | std::ios::failbit);
-        g_updateStream.open(g_updateFile, std::ios::binary | std::ios::trunc);
+        g_updateChecksum = std::make_unique<ModuleChecksum>(fileSize);
+        g_updateWriter.open(g_updateFile, [](size_t offset, const char* data, size_t size) {
+            g_updateChecksum->update(offset, data, size);
+        });
         g_updateSize = fileSize;
         return true;
     } catch (const std::exception& e) {
         LOG(ERROR, "%s", e.what());
-        g_updateStream.exceptions(std::ios::goodbit);
-        g_updateStream.close();
+        g_updateWriter.cancel();
         fs::remove(g_updateFile);
         return false;
     }
@@ -265,7 +385,7 @@ bool HAL_FLASH_Begin(uint32_t sFLASH_Address, uint32_t fileSize, void* reserved)
 int HAL_FLASH_Update(const uint8_t *pBuffer, uint32_t address, uint32_t length, void* reserved)
 {
     try {
-        if (!g_updateStream.is_open()) {
+        if (!g_updateWriter.isOpen()) {
             throw std::runtime_error("File is not open");
         }
         if (address > g_updateSize) {
@@ -274,13 +394,11 @@ int HAL_FLASH_Update(const uint8_t *pBuffer, uint32_t address, uint32_t length,
         if (address + length > g_updateSize) {
             length = g_updateSize - address;
         }
-        g_updateStream.seekp(address);
-        g_updateStream.write((const char*)pBuffer, length);
+        g_updateWriter.write(address, (const char*)pBuffer, length);
         return 0;
     } catch (const std::exception& e) {
         LOG(ERROR, "%s", e.what());
-        g_updateStream.exceptions(std::ios::goodbit);
-        g_updateStream.close();
+        g_updateWriter.cancel();
         fs::remove(g_updateFile);
         return SYSTEM_ERROR_IO;
     }
@@ -294,10 +412,16 @@ int HAL_FLASH_OTA_Validate(bool userDepsOptional, module_validation_flags_t flag
 int HAL_FLASH_End(void* reserved)
 {
     try {
-        if (!g_updateStream.is_open()) {
+        if (!g_updateWriter.isOpen()) {
             throw std::runtime_error("File is not open");
         }
-        g_updateStream.close();
+        g_updateWriter.close();
+        if (g_updateChecksum->isSequential()) {
+            g_updateChecksum->verify();
+        } else {
+            // Some chunks were written out of order or more than once
+            verifyModule(g_updateFile);
+        }
         auto updatedModule = parseModule(g_updateFile);
         auto desc = deviceConfig.describe;
         auto modules = desc.modules();
@@ -359,10 +483,13 @@ int HAL_FLASH_End(void* reserved)
         }
         fs::remove(g_updateFile);
         return HAL_UPDATE_APPLIED_PENDING_RESTART;
+    } catch (const UpdateError& e) {
+        LOG(ERROR, "%s", e.what());
+        fs::remove(g_updateFile);
+        return e.error();
     } catch (const std::exception& e) {
         LOG(ERROR, "%s", e.what());
-        g_updateStream.exceptions(std::ios::goodbit);
-        g_updateStream.close();
+        g_updateWriter.cancel();
         fs::remove(g_updateFile);
         return SYSTEM_ERROR_IO;
     }
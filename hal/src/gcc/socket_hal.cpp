@@ -29,7 +29,15 @@
 #include "socket_hal.h"
 #include "inet_hal.h"
 #include "core_msg.h"
+#include "scope_guard.h"
 #include <vector>
+#include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
 
 #pragma GCC diagnostic ignored "-Wunused-variable"
 #pragma GCC diagnostic ignored "-Wmissing-braces"
@@ -44,39 +52,198 @@
 
 namespace ip = boost::asio::ip;
 
-const sock_handle_t SOCKET_COUNT = sock_handle_t(8);
+const sock_handle_t SOCKET_COUNT = sock_handle_t(HAL_PLATFORM_SOCKET_COUNT);
 const sock_handle_t SOCKET_MAX =  SOCKET_COUNT*2;
 const sock_handle_t SOCKET_INVALID = (sock_handle_t)-1;
 
+// Size of the buffer for the TCP data read ahead of the socket_receive() calls
+const size_t READ_AHEAD_BUFFER_SIZE = 1024;
+
 boost::asio::io_service device_io_service;
-boost::system::error_code ec;
-
-boost::array<ip::tcp::socket, SOCKET_COUNT> tcp_handles = {
-    ip::tcp::socket(device_io_service),
-    ip::tcp::socket(device_io_service),
-    ip::tcp::socket(device_io_service),
-    ip::tcp::socket(device_io_service),
-    ip::tcp::socket(device_io_service),
-    ip::tcp::socket(device_io_service),
-    ip::tcp::socket(device_io_service),
-    ip::tcp::socket(device_io_service)
+
+/**
+ * Runs the I/O service in a background thread so that the readiness of the sockets can be tracked
+ * asynchronously.
+ *
+ * The completion handlers run by the reactor thread only update the atomic readiness flags of the
+ * socket entries. All other access to a socket object is serialized with the mutex of its entry.
+ */
+class SocketReactor
+{
+public:
+    ~SocketReactor()
+    {
+        if (thread_.joinable()) {
+            work_.reset();
+            device_io_service.stop();
+            thread_.join();
+        }
+    }
+
+    void start()
+    {
+        std::call_once(started_, [this]() {
+            work_.reset(new boost::asio::io_service::work(device_io_service));
+            thread_ = std::thread([]() {
+                device_io_service.run();
+            });
+        });
+    }
+
+private:
+    std::unique_ptr<boost::asio::io_service::work> work_;
+    std::thread thread_;
+    std::once_flag started_;
+};
+
+// Defined after the socket pools so that the reactor thread is joined before the sockets are destroyed
+extern SocketReactor reactor;
+
+template<typename SocketT>
+struct SocketEntry
+{
+    SocketT socket;
+    std::unique_ptr<char[]> readAhead;
+    size_t readAheadOffs;
+    size_t readAheadSize;
+    std::atomic<bool> readable; // Cached readiness for reading
+    std::atomic<unsigned> generation; // Incremented every time the entry is reset
+    std::atomic<unsigned> waitGeneration; // Generation of the pending wait operation, or 0
+    std::mutex mutex; // Serializes the access to the socket object
+    bool allocated;
+
+    explicit SocketEntry(boost::asio::io_service& service) :
+            socket(service),
+            readAheadOffs(0),
+            readAheadSize(0),
+            readable(true),
+            generation(1),
+            waitGeneration(0),
+            allocated(false)
+    {
+    }
+
+    void reset()
+    {
+        readAheadOffs = 0;
+        readAheadSize = 0;
+        // Let the first receive call check the socket
+        readable = true;
+        // A wait operation started for the previous user of the entry may still be pending
+        // if the socket was closed. Its handler will ignore the result
+        if (++generation == 0) {
+            ++generation;
+        }
+        waitGeneration = 0;
+    }
+
+    // Called when a read operation has returned no data. The entry must be locked
+    void notReadable()
+    {
+        readable = false;
+        waitReadable();
+        // Data may have arrived before the wait operation was started, in which case the reactor
+        // won't report the socket as readable until more data arrives
+        boost::system::error_code error;
+        if (socket.available(error) > 0) {
+            readable = true;
+        }
+    }
+
+    void waitReadable()
+    {
+        const unsigned gen = generation;
+        unsigned noWait = 0;
+        if (!waitGeneration.compare_exchange_strong(noWait, gen)) {
+            return;
+        }
+        reactor.start();
+        socket.async_wait(SocketT::wait_read, [this, gen](const boost::system::error_code& error) {
+            unsigned waitGen = gen;
+            if (!waitGeneration.compare_exchange_strong(waitGen, 0)) {
+                return; // The entry has been reset since the wait was started
+            }
+            if (!error) {
+                readable = true;
+            }
+        });
+    }
 };
 
-boost::array<ip::udp::socket, SOCKET_COUNT> udp_handles = {
-    ip::udp::socket(device_io_service),
-    ip::udp::socket(device_io_service),
-    ip::udp::socket(device_io_service),
-    ip::udp::socket(device_io_service),
-    ip::udp::socket(device_io_service),
-    ip::udp::socket(device_io_service),
-    ip::udp::socket(device_io_service),
-    ip::udp::socket(device_io_service)
+/**
+ * Preallocated sockets of the same type with a list of unused handles.
+ */
+template<typename SocketT>
+class SocketPool
+{
+public:
+    typedef SocketEntry<SocketT> Entry;
+
+    SocketPool(sock_handle_t first, sock_handle_t count) :
+            first_(first)
+    {
+        for (sock_handle_t i = 0; i < count; ++i) {
+            entries_.emplace_back(new Entry(device_io_service));
+        }
+        // Hand out the lower handles first
+        for (sock_handle_t i = count; i > 0; --i) {
+            free_.push_back(first + i - 1);
+        }
+    }
+
+    bool contains(sock_handle_t sd) const
+    {
+        return sd>=first_ && sd<first_+(sock_handle_t)entries_.size();
+    }
+
+    Entry* entry(sock_handle_t sd)
+    {
+        if (!contains(sd))
+            return nullptr;
+        return entries_[sd-first_].get();
+    }
+
+    sock_handle_t allocate()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty())
+            return SOCKET_INVALID;
+        sock_handle_t sd = free_.back();
+        free_.pop_back();
+        auto e = entries_[sd-first_].get();
+        e->allocated = true;
+        e->reset();
+        return sd;
+    }
+
+    // The entry must be locked
+    void release(sock_handle_t sd)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto e = entry(sd);
+        if (!e || !e->allocated)
+            return;
+        e->allocated = false;
+        e->reset();
+        free_.push_back(sd);
+    }
+
+private:
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::vector<sock_handle_t> free_;
+    std::mutex mutex_;
+    sock_handle_t first_;
 };
 
+SocketPool<ip::tcp::socket> tcp_sockets(0, SOCKET_COUNT);
+SocketPool<ip::udp::socket> udp_sockets(SOCKET_COUNT, SOCKET_COUNT);
 
 ip::tcp::socket invalid_tcp_(device_io_service);
 ip::udp::socket invalid_udp_(device_io_service);
 
+// Static objects are destroyed in the reverse order of their construction
+SocketReactor reactor;
+
 ip::tcp::socket& invalid_tcp() {
     return invalid_tcp_;
 }
@@ -87,46 +254,40 @@ ip::udp::socket& invalid_udp() {
 
 bool is_tcp_socket(sock_handle_t sd)
 {
-	return sd<SOCKET_COUNT;
+	return tcp_sockets.contains(sd);
 }
 
 bool is_udp_socket(sock_handle_t sd)
 {
-	return sd>=SOCKET_COUNT && sd<SOCKET_MAX;
+	return udp_sockets.contains(sd);
 }
 
 
 ip::tcp::socket& tcp_from(sock_handle_t sd)
 {
-    if (sd>=SOCKET_COUNT)
+    auto e = tcp_sockets.entry(sd);
+    if (!e)
         return invalid_tcp();
-    return tcp_handles[sd];
+    return e->socket;
 }
 
 ip::udp::socket& udp_from(sock_handle_t sd)
 {
-    if (sd<SOCKET_COUNT || sd>=SOCKET_MAX)
+    auto e = udp_sockets.entry(sd);
+    if (!e)
         return invalid_udp();
-    return udp_handles[sd-SOCKET_COUNT];
+    return e->socket;
 }
 
 
 sock_handle_t next_unused_tcp()
 {
-    for (sock_handle_t i=0; i<SOCKET_COUNT; i++) {
-        if (!tcp_from(i).is_open())
-            return i;
-    }
-    return -1;
+    return tcp_sockets.allocate();
 }
 
 sock_handle_t next_unused_udp()
 {
-    for (sock_handle_t i=SOCKET_COUNT; i<SOCKET_MAX; i++) {
-        if (!udp_from(i).is_open())
-            return i;
-    }
-    return -1;
+    return udp_sockets.allocate();
 }
 
 
@@ -144,6 +305,7 @@ bool is_valid(ip::udp::socket& handle) {
 class TCPServer
 {
 	ip::tcp::acceptor acceptor;
+	std::mutex mutex;
 
 	void accept_handler(const boost::system::error_code& error)
 	{
@@ -155,13 +317,7 @@ class TCPServer
 
 	sock_handle_t start_accept()
 	{
-		sock_handle_t handle = next_unused_tcp();
-		if (!socket_handle_valid(handle))
-			return handle;
-
-		ip::tcp::socket& sock = tcp_from(handle);
-		acceptor.accept(sock);
-		return handle;
+		return accept();
 	}
 
 
@@ -174,7 +330,9 @@ public:
 
 	~TCPServer()
 	{
-		acceptor.cancel();
+		std::lock_guard<std::mutex> lock(mutex);
+		boost::system::error_code ec;
+		acceptor.cancel(ec);
 	}
 
 	sock_handle_t accept()
@@ -183,10 +341,20 @@ public:
 		if (!socket_handle_valid(handle))
 			return handle;
 
-		ip::tcp::socket& sock = tcp_from(handle);
-
-		acceptor.accept(sock, ec);
-		return !ec ? handle : socket_handle_invalid();
+		auto e = tcp_sockets.entry(handle);
+		std::lock_guard<std::mutex> entryLock(e->mutex);
+		boost::system::error_code ec;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			acceptor.accept(e->socket, ec);
+		}
+		if (ec) {
+			tcp_sockets.release(handle);
+			return socket_handle_invalid();
+		}
+		// Accepted sockets are non-blocking like the ones created with socket_create()
+		e->socket.non_blocking(true, ec);
+		return handle;
 	}
 
 
@@ -251,9 +419,11 @@ sock_result_t socket_accept(sock_handle_t handle)
 
 int32_t socket_connect(sock_handle_t sd, const sockaddr_t *addr, long addrlen)
 {
-    auto& handle = tcp_from(sd);
-    if (!is_valid(handle))
+    auto e = tcp_sockets.entry(sd);
+    if (!e)
         return -1;
+    std::lock_guard<std::mutex> lock(e->mutex);
+    auto& handle = e->socket;
 
     unsigned port = addr->sa_data[0] << 8 | addr->sa_data[1];
     // 2-5 are IP address in network byte order
@@ -262,8 +432,8 @@ int32_t socket_connect(sock_handle_t sd, const sockaddr_t *addr, long addrlen)
     ip::address_v4::bytes_type address = {{ dest[0], dest[1], dest[2], dest[3] }};
     ip::tcp::endpoint endpoint(boost::asio::ip::address_v4(address),port);
 
+    boost::system::error_code ec;
     handle.connect(endpoint, ec);
-    bool open = handle.is_open();
     return ec.value();
 }
 
@@ -274,36 +444,62 @@ sock_result_t socket_reset_blocking_call()
 
 sock_result_t socket_receive(sock_handle_t sd, void* buffer, socklen_t len, system_tick_t _timeout)
 {
-    auto& handle = tcp_from(sd);
-    if (!is_valid(handle))
+    auto e = tcp_sockets.entry(sd);
+    if (!e)
         return -1;
-    boost::asio::socket_base::bytes_readable command(true);
-    handle.io_control(command);
-    std::size_t available = command.get();
+    std::lock_guard<std::mutex> lock(e->mutex);
+    // Return the data read ahead by a previous call
+    if (e->readAheadSize) {
+        size_t n = std::min<size_t>(len, e->readAheadSize);
+        memcpy(buffer, e->readAhead.get() + e->readAheadOffs, n);
+        e->readAheadOffs += n;
+        e->readAheadSize -= n;
+        return n;
+    }
+    // Don't make a syscall if the reactor hasn't reported the socket as readable. Note that this adds
+    // the wakeup latency of the reactor thread to a socket that is polled in a tight loop
+    if (!_timeout && !e->readable) {
+        return 0;
+    }
+    if (!e->readAhead) {
+        e->readAhead.reset(new(std::nothrow) char[READ_AHEAD_BUFFER_SIZE]);
+    }
+    // Read the data into the caller's buffer and whatever doesn't fit there into the read-ahead buffer
+    std::array<boost::asio::mutable_buffer, 2> buffers = {
+        boost::asio::buffer(buffer, len),
+        boost::asio::buffer(e->readAhead.get(), e->readAhead ? READ_AHEAD_BUFFER_SIZE : 0)
+    };
+    boost::system::error_code ec;
+    std::size_t count = e->socket.read_some(buffers, ec);
     sock_result_t result = 0;
-    if (_timeout || available) {
-        available = handle.read_some(boost::asio::buffer(buffer, len), ec);
-        result = ec.value() ? -abs(ec.value()) : available;
-        if (ec.value()) {
-            if (ec.value() == boost::system::errc::resource_deadlock_would_occur || // EDEADLK (35)
-                ec.value() == boost::system::errc::resource_unavailable_try_again) { // EAGAIN (11)
-                result = 0; // No data available
-            } else {
-                DEBUG("socket receive error: %d %s, read=%d", ec.value(), ec.message().c_str(), available);
-            }
+    if (ec.value()) {
+        if (ec.value() == boost::system::errc::resource_deadlock_would_occur || // EDEADLK (35)
+            ec.value() == boost::system::errc::resource_unavailable_try_again) { // EAGAIN (11)
+            e->notReadable();
+            result = 0; // No data available
+        } else {
+            result = -abs(ec.value());
+            DEBUG("socket receive error: %d %s", ec.value(), ec.message().c_str());
         }
+    } else if (count > len) {
+        e->readAheadOffs = 0;
+        e->readAheadSize = count - len;
+        result = len;
+    } else {
+        result = count;
     }
     return result;
 }
 
 sock_result_t socket_send(sock_handle_t sd, const void* buffer, socklen_t len)
 {
-    auto& socket = tcp_from(sd);
-    if (!is_valid(socket))
+    auto e = tcp_sockets.entry(sd);
+    if (!e)
         return -1;
+    std::lock_guard<std::mutex> lock(e->mutex);
     try
     {
-        sock_result_t result = write(socket, boost::asio::buffer(buffer, len));
+        sock_result_t result = write(e->socket, boost::asio::buffer(buffer, len));
         return result;
     }
     catch (const boost::system::system_error& e)
@@ -332,10 +528,18 @@ sock_result_t socket_receivefrom(sock_handle_t sock, void* buffer, socklen_t buf
 sock_result_t socket_receivefrom_ex(sock_handle_t sock, void* buffer, socklen_t bufLen, uint32_t flags, sockaddr_t* addr, socklen_t* addrsize, system_tick_t timeout, void* reserved)
 {
 	ip::udp::endpoint endpoint;
-	auto& socket = udp_from(sock);
+	auto e = udp_sockets.entry(sock);
+	if (!e)
+		return -1;
+	std::lock_guard<std::mutex> lock(e->mutex);
+	auto& socket = e->socket;
 
 	// FIXME: handle timeouts
 
+	if (!e->readable)
+		return 0;
+
+	boost::system::error_code ec;
 	int count = socket.receive_from(boost::asio::buffer(buffer, bufLen), endpoint, 0, ec);
 	if (addr && addrsize && *addrsize>=6u) {
 		addr->sa_family = AF_INET;
@@ -351,10 +555,10 @@ sock_result_t socket_receivefrom_ex(sock_handle_t sock, void* buffer, socklen_t
 
 	sock_handle_t result = ec.value();
 
-    if (result == boost::asio::error::would_block)
+    if (result == boost::asio::error::would_block || result==boost::asio::error::try_again) {
+        e->notReadable();
         return 0;
-    if (result==boost::asio::error::try_again)
-	   return 0;
+    }
 	if (!result) {
 		DEBUG("count: %d", count);
     } else {
@@ -373,8 +577,12 @@ sock_result_t socket_sendto(sock_handle_t sd, const void* buffer, socklen_t len,
     ip::address_v4::bytes_type address = {{ dest[0], dest[1], dest[2], dest[3] }};
     ip::udp::endpoint endpoint(boost::asio::ip::address_v4(address),port);
 
-	auto& socket = udp_from(sd);
-	int count = socket.send_to(boost::asio::buffer(buffer, len), endpoint, 0, ec);
+	auto e = udp_sockets.entry(sd);
+	if (!e)
+		return -1;
+	std::lock_guard<std::mutex> lock(e->mutex);
+	boost::system::error_code ec;
+	int count = e->socket.send_to(boost::asio::buffer(buffer, len), endpoint, 0, ec);
 
 	sock_handle_t result = ec.value();
     if (result == boost::asio::error::would_block)
@@ -390,13 +598,36 @@ sock_result_t socket_bind(sock_handle_t sock, uint16_t port)
     return 0;
 }
 
+template<typename SocketT>
+bool is_open(SocketPool<SocketT>& pool, sock_handle_t sd)
+{
+    auto e = pool.entry(sd);
+    if (!e)
+        return false;
+    std::lock_guard<std::mutex> lock(e->mutex);
+    return e->socket.is_open();
+}
+
+template<typename SocketT>
+void close_socket(SocketPool<SocketT>& pool, sock_handle_t sd)
+{
+    auto e = pool.entry(sd);
+    if (!e)
+        return;
+    std::lock_guard<std::mutex> lock(e->mutex);
+    boost::system::error_code ec;
+    e->socket.shutdown(SocketT::shutdown_both, ec);
+    e->socket.close(ec);
+    pool.release(sd);
+}
+
 uint8_t socket_active_status(sock_handle_t socket)
 {
     bool open;
     if (socket>=SOCKET_COUNT)
-    		open = udp_from(socket).is_open();
+    		open = is_open(udp_sockets, socket);
     else
-    		open = tcp_from(socket).is_open();
+    		open = is_open(tcp_sockets, socket);
     return open ? SOCKET_STATUS_ACTIVE : SOCKET_STATUS_INACTIVE;
 }
 
@@ -408,15 +639,11 @@ sock_result_t socket_close(sock_handle_t socket)
 	}
 	else if (socket>=SOCKET_COUNT)
     {
-    		auto& s = udp_from(socket);
-    		s.shutdown(boost::asio::ip::udp::socket::shutdown_both, ec);
-    		udp_from(socket).close();
+    		close_socket(udp_sockets, socket);
     }
     else
     {
-    		auto& s = tcp_from(socket);
-		s.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
-    		s.close();
+    		close_socket(tcp_sockets, socket);
     }
     return 0;
 }
@@ -428,13 +655,18 @@ sock_result_t socket_shutdown(sock_handle_t socket, int how)
     }
     else
     {
-        auto& s = tcp_from(socket);
+        auto e = tcp_sockets.entry(socket);
+        if (!e)
+            return -1;
+        std::lock_guard<std::mutex> lock(e->mutex);
+        auto& s = e->socket;
         auto shflags = boost::asio::ip::tcp::socket::shutdown_both;
         if (how == SHUT_WR) {
             shflags = boost::asio::ip::tcp::socket::shutdown_send;
         } else if (how == SHUT_RD) {
             shflags = boost::asio::ip::tcp::socket::shutdown_receive;
         }
+        boost::system::error_code ec;
         s.shutdown(shflags, ec);
         return (sock_result_t)ec.value();
     }
@@ -451,6 +683,17 @@ sock_handle_t socket_create(uint8_t family, uint8_t type, uint8_t protocol, uint
     if (handle==SOCKET_INVALID)
         return -1;
 
+    // The handle is not known to other threads until this function returns, so the entry is not
+    // locked here
+    boost::system::error_code ec;
+    NAMED_SCOPE_GUARD(releaseGuard, {
+        if (udp) {
+            close_socket(udp_sockets, handle);
+        } else {
+            close_socket(tcp_sockets, handle);
+        }
+    });
+
     if (udp) {
         auto& socket = udp_from(handle);
         socket.open(ip::udp::v4(), ec);
@@ -483,7 +726,10 @@ sock_handle_t socket_create(uint8_t family, uint8_t type, uint8_t protocol, uint
     }
 
     sock_handle_t result = ec.value();
-    return result ? result : handle;
+    if (result)
+        return result;
+    releaseGuard.dismiss();
+    return handle;
 }
 
 uint8_t socket_handle_valid(sock_handle_t handle) {
@@ -504,9 +750,11 @@ sock_result_t socket_join_multicast(const HAL_IPAddress* addr, network_interface
 {
 	if (info) {
 		sock_handle_t socket = info->sock_handle;
-		if (socket>=SOCKET_COUNT)
+		auto e = udp_sockets.entry(socket);
+		if (e)
 		{
-			auto& s = udp_from(socket);
+			std::lock_guard<std::mutex> lock(e->mutex);
+			auto& s = e->socket;
 			ip::address_v4 address(addr->ipv4);
 			DEBUG("join multicast %s", address.to_string().c_str());
 			s.set_option(ip::multicast::enable_loopback(true));
@@ -37,6 +37,8 @@ CPPSRC += $(call target_files,$(overridedir)/,*.cpp)
 
 CPPSRC += $(call target_files,$(HAL_MODULE_PATH)/network/util/,*.cpp)
 CPPSRC += $(HAL_MODULE_PATH)/shared/filesystem.cpp
+CPPSRC += $(HAL_MODULE_PATH)/shared/filesystem_block_cache.cpp
+CPPSRC += $(HAL_MODULE_PATH)/shared/filesystem_lock.cpp
 
 # ASM source files included in this build.
 ASRC +=
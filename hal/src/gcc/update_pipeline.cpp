@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "update_pipeline.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace particle {
+
+AsyncFileWriter::AsyncFileWriter(size_t queueSize) :
+        cancelled_(false),
+        queueSize_(queueSize) {
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    stop(false /* wait */);
+}
+
+void AsyncFileWriter::open(const std::string& file, BlockHandler handler) {
+    cancel();
+    // Open the file synchronously so that the caller gets notified if it can't be created
+    stream_ = std::ofstream();
+    stream_.exceptions(std::ios::badbit | std::ios::failbit);
+    stream_.open(file, std::ios::binary | std::ios::trunc);
+    handler_ = std::move(handler);
+    queue_ = std::make_unique<BoundedQueue<Block>>(queueSize_);
+    error_ = nullptr;
+    cancelled_ = false;
+    thread_ = std::thread([this]() {
+        run();
+    });
+}
+
+void AsyncFileWriter::write(size_t offset, const char* data, size_t size) {
+    if (!isOpen()) {
+        throw std::runtime_error("File is not open");
+    }
+    rethrowIfFailed();
+    if (!pending_.data.empty() && (offset != pending_.offset + pending_.data.size() ||
+            pending_.data.size() + size > MAX_BLOCK_SIZE)) {
+        flush();
+    }
+    if (pending_.data.empty()) {
+        pending_.offset = offset;
+        pending_.data.reserve(std::max(size, MAX_BLOCK_SIZE));
+    }
+    pending_.data.append(data, size);
+}
+
+void AsyncFileWriter::close() {
+    if (!isOpen()) {
+        throw std::runtime_error("File is not open");
+    }
+    if (!pending_.data.empty()) {
+        try {
+            flush();
+        } catch (...) {
+            cancel();
+            throw;
+        }
+    }
+    stop(true /* wait */);
+    rethrowIfFailed();
+}
+
+void AsyncFileWriter::cancel() {
+    stop(false /* wait */);
+}
+
+void AsyncFileWriter::run() {
+    try {
+        Block block;
+        while (!cancelled_ && queue_->pop(&block)) {
+            stream_.seekp(block.offset);
+            stream_.write(block.data.data(), block.data.size());
+            if (handler_) {
+                handler_(block.offset, block.data.data(), block.data.size());
+            }
+        }
+        stream_.close();
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+        }
+        queue_->close();
+    }
+    stream_.exceptions(std::ios::goodbit);
+    stream_.close();
+}
+
+void AsyncFileWriter::flush() {
+    Block block = std::move(pending_);
+    pending_ = Block();
+    if (!queue_->push(std::move(block))) {
+        rethrowIfFailed();
+        throw std::runtime_error("File is closed");
+    }
+}
+
+void AsyncFileWriter::stop(bool wait) {
+    pending_ = Block();
+    if (!thread_.joinable()) {
+        return;
+    }
+    if (!wait) {
+        cancelled_ = true;
+    }
+    queue_->close();
+    thread_.join();
+}
+
+void AsyncFileWriter::rethrowIfFailed() {
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error = error_;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace particle
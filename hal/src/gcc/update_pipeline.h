@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <atomic>
+#include <fstream>
+#include <cstddef>
+
+namespace particle {
+
+/**
+ * A FIFO queue with a limited capacity that can be shared between threads.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) :
+            capacity_(capacity),
+            closed_(false) {
+    }
+
+    // Blocks while the queue is full. Returns false if the queue is closed
+    bool push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this]() { return closed_ || queue_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        queue_.push_back(std::move(value));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // Blocks while the queue is empty. Returns false if the queue is closed and empty
+    bool pop(T* value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this]() { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return false;
+        }
+        *value = std::move(queue_.front());
+        queue_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    // Pending elements can still be taken out of a closed queue
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    std::deque<T> queue_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    size_t capacity_;
+    bool closed_;
+};
+
+/**
+ * Writes data to a file in a separate thread.
+ *
+ * Consecutive writes are combined into larger blocks before they're passed to the writer thread.
+ * An optional handler is invoked in the writer thread for every block of data after it has been
+ * written, so that the data can be processed, e.g. checksummed, while the caller is receiving more
+ * data.
+ */
+class AsyncFileWriter {
+public:
+    typedef std::function<void(size_t offset, const char* data, size_t size)> BlockHandler;
+
+    static const size_t DEFAULT_QUEUE_SIZE = 8;
+    static const size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+    explicit AsyncFileWriter(size_t queueSize = DEFAULT_QUEUE_SIZE);
+    ~AsyncFileWriter();
+
+    // An exception thrown by the handler is reported as a write error
+    void open(const std::string& file, BlockHandler handler = BlockHandler());
+    // Queues the data for writing. Rethrows the exception if a previous write has failed
+    void write(size_t offset, const char* data, size_t size);
+    // Waits until all queued data has been written and closes the file
+    void close();
+    // Closes the file without waiting for the pending writes to complete
+    void cancel();
+
+    bool isOpen() const {
+        return thread_.joinable();
+    }
+
+private:
+    struct Block {
+        size_t offset;
+        std::string data;
+    };
+
+    Block pending_; // Data that hasn't been passed to the writer thread yet
+    std::unique_ptr<BoundedQueue<Block>> queue_;
+    std::ofstream stream_; // Accessed only by the writer thread while it's running
+    BlockHandler handler_; // ditto
+    std::thread thread_;
+    std::mutex mutex_;
+    std::exception_ptr error_;
+    std::atomic<bool> cancelled_;
+    size_t queueSize_;
+
+    void run();
+    void flush();
+    void stop(bool wait);
+    void rethrowIfFailed();
+};
+
+} // namespace particle
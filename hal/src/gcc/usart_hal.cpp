@@ -1,13 +1,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usart_hal.h"
 #include "socket_hal.h"
-
-struct UsartRingBuffer {
-    uint8_t* buffer;
-    uint16_t size;
-    volatile uint16_t head;
-    volatile uint16_t tail;
-};
+#include "buffered_serial.h"
 
 struct Usart {
     virtual void init(const hal_usart_buffer_config_t* conf)=0;
@@ -25,97 +19,87 @@ struct Usart {
 
 const sock_handle_t SOCKET_INVALID = sock_handle_t(-1);
 
+/**
+ * Base class for the socket-backed USARTs.
+ *
+ * Written data is coalesced and sent in blocks, and received data is read ahead into the RX buffer
+ * by a background thread, so that reading and writing a byte doesn't involve a socket call.
+ */
 class SocketUsartBase : public Usart
 {
     private:
-        UsartRingBuffer rx;
-        UsartRingBuffer tx;
+        particle::BufferedSerialIo io;
 
     protected:
+        // Accessed only by the I/O thread while it's running
         sock_handle_t socket;
 
 
-        SocketUsartBase() : socket(SOCKET_INVALID) {}
+        SocketUsartBase() :
+                io([this](const char* data, size_t size) { return sendToSocket(data, size); },
+                        [this](char* data, size_t size) { return receiveFromSocket(data, size); }),
+                socket(SOCKET_INVALID) {}
 
         virtual bool initSocket()=0;
 
-        inline int32_t read_char(bool peek=false)
-        {
-            // Bảo vệ buffer overflow khi đọc
-            if (rx.size == 0) return -1;
-            if (rx.tail == rx.head)
+        int sendToSocket(const char* data, size_t size) {
+            if (!initSocket())
                 return -1;
-
-            int32_t c = rx.buffer[rx.tail];
-            if (!peek)
-                rx.tail = (rx.tail + 1) % rx.size;
-            return c;
+            return socket_send(socket, data, size);
         }
 
-        inline void write_char(unsigned char c)
-        {
-            // Bảo vệ buffer overflow khi ghi
-            if (tx.size == 0) return;
-            unsigned i = (unsigned int)(tx.head + 1) % tx.size;
-            if (i != tx.tail)
-            {
-                tx.buffer[tx.head] = c;
-                tx.head = i;
+        int receiveFromSocket(char* data, size_t size) {
+            if (socket==SOCKET_INVALID)
+                return 0;
+            int result = socket_receive(socket, data, size, 0);
+            if (result<0) {
+                // Reconnect on the next write
+                closeSocket();
+                return 0;
             }
-            // Nếu buffer đầy, có thể bỏ qua hoặc ghi đè, ở đây sẽ bỏ qua byte mới
+            return result;
         }
 
-        void fillFromSocketIfNeeded() {
-            int space;
-            if (rx.head>rx.tail) {    // head after tail, so can fill up to end of buffer
-                space = rx.size-rx.tail;
-            }
-            else {
-                space = rx.tail-rx.head;  // may be 0
-            }
-            if (socket!=SOCKET_INVALID && space>0) {
-                socket_receive(socket, rx.buffer+rx.head, space, 0);
+        void closeSocket() {
+            if (socket!=SOCKET_INVALID) {
+                socket_close(socket);
+                socket = SOCKET_INVALID;
             }
         }
 
-
     public:
+        virtual ~SocketUsartBase() {
+            io.stop();
+        }
+
         virtual void init(const hal_usart_buffer_config_t* conf) override
         {
-            this->rx.buffer = (uint8_t*)conf->rx_buffer;
-            this->rx.size = conf->rx_buffer_size;
-            this->rx.head = this->rx.tail = 0;
-            this->tx.buffer = (uint8_t*)conf->tx_buffer;
-            this->tx.size = conf->tx_buffer_size;
-            this->tx.head = this->tx.tail = 0;
+            io.init((char*)conf->rx_buffer, conf->rx_buffer_size, (char*)conf->tx_buffer, conf->tx_buffer_size);
+            io.start();
         }
 
         virtual void end() override {
-            socket_close(socket);
+            io.stop();
+            closeSocket();
         }
         virtual void flush() override {
-            // todo
+            io.flush();
         }
 
         virtual int32_t available() override {
-            fillFromSocketIfNeeded();
-            return (rx.head-rx.tail) % rx.size;
+            return io.available();
         }
         virtual int32_t availableForWrite() override {
-            return (rx.size + tx.head - tx.tail) % rx.size;
+            return io.availableForWrite();
         }
         virtual int32_t read() override {
-            fillFromSocketIfNeeded();
-            return read_char();
+            return io.read();
         }
         virtual int32_t peek() override {
-            fillFromSocketIfNeeded();
-            return read_char(true);
+            return io.peek();
         }
         virtual uint32_t write(uint8_t byte) override {
-            if (!initSocket())
-                return 0;
-            return socket_send(socket, &byte, 1);
+            return io.write((const char*)&byte, 1);
         }
 };
 
@@ -156,6 +140,10 @@ class SocketUsartClient : public SocketUsartBase {
 
     public:
 
+        virtual ~SocketUsartClient() {
+            end(); // Stop the I/O thread before initSocket() becomes unavailable
+        }
+
         virtual void begin(uint32_t baud) {}
 
 };
@@ -173,6 +161,10 @@ class SocketUsartServer : public SocketUsartBase {
 
     public:
 
+        virtual ~SocketUsartServer() {
+            end();
+        }
+
         virtual void begin(uint32_t baud) {}
 };
 
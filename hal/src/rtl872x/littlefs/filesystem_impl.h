@@ -26,3 +26,7 @@
 #define FILESYSTEM_BLOCK_COUNT  (sFLASH_FILESYSTEM_PAGE_COUNT)
 #define FILESYSTEM_FIRST_BLOCK  (sFLASH_FILESYSTEM_FIRST_PAGE)
 #define FILESYSTEM_LOOKAHEAD    (128)
+
+/* Block cache, see filesystem_block_cache.h */
+#define FILESYSTEM_CACHE_LINE_COUNT     (8)
+#define FILESYSTEM_WRITE_BUFFER_SIZE    (0)
@@ -19,19 +19,11 @@
 #pragma once
 
 static inline char ascii_nibble(uint8_t nibble) {
-    char hex_digit = nibble + 48;
-    if (57 < hex_digit) {
-        hex_digit += 7;
-    }
-    return hex_digit;
+    return "0123456789ABCDEF"[nibble & 0x0f];
 }
 
 static inline char ascii_nibble_lower_case(uint8_t nibble) {
-    char hex_digit = nibble + 48;
-    if (57 < hex_digit) {
-        hex_digit += 39;
-    }
-    return hex_digit;
+    return "0123456789abcdef"[nibble & 0x0f];
 }
 
 static inline char* concat_nibble(char* p, uint8_t nibble)
@@ -59,6 +59,10 @@
 #define DIAG_NAME_CLOUD_CONNECTION_ATTEMPTS "cloud:connatt"
 #define DIAG_NAME_CLOUD_DISCONNECTION_REASON "cloud:dconnrsn"
 #define DIAG_NAME_CLOUD_CONNECTION_INTERFACE "cloud:connif"
+#define DIAG_NAME_CLOUD_DNS_TIME "cloud:dnstime"
+#define DIAG_NAME_CLOUD_HANDSHAKE_TIME "cloud:hstime"
+#define DIAG_NAME_CLOUD_HELLO_TIME "cloud:hellotime"
+#define DIAG_NAME_CLOUD_CONNECTION_TIME "cloud:conntime"
 #define DIAG_NAME_CLOUD_RETRANSMITTED_MESSAGES "coap:retransmit"
 #define DIAG_NAME_CLOUD_UNACKNOWLEDGED_MESSAGES "coap:unack"
 #define DIAG_NAME_CLOUD_TRANSMITTED_MESSAGES "coap:transmit"
@@ -116,6 +120,10 @@ typedef enum diag_id {
     DIAG_ID_CLOUD_CONNECTION_ATTEMPTS = 29, // cloud:connatt
     DIAG_ID_CLOUD_DISCONNECTION_REASON = 30, // cloud:dconnrsn
     DIAG_ID_CLOUD_CONNECTION_INTERFACE = 44, // cloud:connif
+    DIAG_ID_CLOUD_DNS_TIME = 68, // cloud:dnstime
+    DIAG_ID_CLOUD_HANDSHAKE_TIME = 69, // cloud:hstime
+    DIAG_ID_CLOUD_HELLO_TIME = 70, // cloud:hellotime
+    DIAG_ID_CLOUD_CONNECTION_TIME = 71, // cloud:conntime
     DIAG_ID_CLOUD_RETRANSMITTED_MESSAGES = 21, // coap:retransmit
     DIAG_ID_CLOUD_UNACKNOWLEDGED_MESSAGES = 22, // coap:unack
     DIAG_ID_CLOUD_TRANSMITTED_MESSAGES = 23, // coap:transmit
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <cstdarg>
+#include <cstdint>
+#include <cstddef>
+
+#include "appender.h"
+
+namespace particle {
+
+namespace detail {
+
+/**
+ * Formatting argument.
+ */
+struct FormatArg {
+    enum Type {
+        NONE,
+        INT,
+        UINT,
+        DOUBLE,
+        CHAR,
+        STRING,
+        POINTER
+    };
+
+    union {
+        long long i;
+        unsigned long long u;
+        double d;
+        const char* s;
+        const void* p;
+    };
+    Type type; // Argument type
+    uint8_t size; // Size of the original integer type
+
+    FormatArg() :
+            u(0),
+            type(NONE),
+            size(0) {
+    }
+
+    template<typename T>
+    FormatArg(const T& val) :
+            FormatArg() {
+        using U = std::decay_t<T>;
+        size = sizeof(U);
+        if constexpr (std::is_same_v<U, char>) {
+            type = CHAR;
+            i = val;
+        } else if constexpr (std::is_same_v<U, bool>) {
+            type = UINT;
+            u = val;
+        } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            type = INT;
+            i = val;
+        } else if constexpr (std::is_integral_v<U>) {
+            type = UINT;
+            u = val;
+        } else if constexpr (std::is_enum_v<U>) {
+            size = sizeof(std::underlying_type_t<U>);
+            if constexpr (std::is_signed_v<std::underlying_type_t<U>>) {
+                type = INT;
+                i = (long long)val;
+            } else {
+                type = UINT;
+                u = (unsigned long long)val;
+            }
+        } else if constexpr (std::is_floating_point_v<U>) {
+            type = DOUBLE;
+            d = val;
+        } else if constexpr (std::is_same_v<U, char*> || std::is_same_v<U, const char*>) {
+            type = STRING;
+            s = val;
+        } else if constexpr (std::is_pointer_v<U> || std::is_null_pointer_v<U>) {
+            type = POINTER;
+            p = (const void*)val;
+        } else {
+            static_assert(!std::is_same_v<U, U>, "Unsupported argument type");
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * Format a string and write it to an appender.
+ *
+ * This function supports the conversion specifiers of `printf()` and writes the output as it is
+ * being formatted, without using the heap or an intermediate buffer for the entire output. The
+ * output is passed to the appender in blocks of up to 128 bytes, so a shorter string is written
+ * with a single call. Formatting stops if the appender fails.
+ *
+ * Floating point conversions are delegated to `snprintf()`. On the device, that is the newlib
+ * engine in `printf_export.c`, which remains in use by the rest of the system and is exported to
+ * the application, so this function only adds the integer, string and pointer conversions on top
+ * of it.
+ *
+ * @param append Appender function.
+ * @param appender Appender instance.
+ * @param fmt Format string.
+ * @param args Arguments.
+ * @return Number of characters written on success, otherwise an error code defined by
+ *         `system_error_t`.
+ */
+int vformat(appender_fn append, void* appender, const char* fmt, va_list args) __attribute__((format(printf, 3, 0)));
+
+/**
+ * Format a string and write it to an appender.
+ *
+ * @see `format()`
+ */
+int formatArgs(appender_fn append, void* appender, const char* fmt, const detail::FormatArg* args, size_t argCount);
+
+/**
+ * Format a string and write it to an appender.
+ *
+ * This is a type-safe variant of `vformat()`. The format string uses the same syntax, but the
+ * arguments are passed along with their types so the length modifiers are not needed and a
+ * conversion specifier that doesn't match the type of its argument doesn't result in undefined
+ * behavior: the argument is formatted using the default conversion for its type instead. Passing
+ * an argument of a type that cannot be formatted results in a compilation error.
+ *
+ * Note that the format string itself is not checked at compile time. Use `vformat()` with a
+ * function declared with the `format(printf)` attribute if that is needed.
+ *
+ * ```cpp
+ * format(appender, "%s: %d (0x%04x)", name, (uint64_t)value, (uint16_t)flags);
+ * ```
+ *
+ * @param append Appender function.
+ * @param appender Appender instance.
+ * @param fmt Format string.
+ * @param args Arguments.
+ * @return Number of characters written on success, otherwise an error code defined by
+ *         `system_error_t`.
+ */
+template<typename... ArgsT>
+inline int format(appender_fn append, void* appender, const char* fmt, const ArgsT&... args) {
+    const detail::FormatArg a[] = { detail::FormatArg(args)..., detail::FormatArg() };
+    return formatArgs(append, appender, fmt, a, sizeof...(ArgsT));
+}
+
+template<typename... ArgsT>
+inline int format(Appender& appender, const char* fmt, const ArgsT&... args) {
+    return format(Appender::callback, &appender, fmt, args...);
+}
+
+} // namespace particle
@@ -17,19 +17,14 @@
 
 #pragma once
 
+#include "str_util.h"
+
 #include <cstdint>
 
 namespace particle {
 
 inline int hexToNibble(char c) {
-    if (c >= '0' && c <= '9') {
-        return (c - '0');
-    } else if (c >= 'a' && c <= 'f') {
-        return (c - 'a' + 0x0a);
-    } else if (c >= 'A' && c <= 'F') {
-        return (c - 'A' + 0x0a);
-    }
-    return -1;
+    return hexDigitValue(c);
 }
 
 inline size_t hexToBytes(const char* src, char* dest, size_t size) {
@@ -23,6 +23,7 @@
 #include "check.h"
 #include "scope_guard.h"
 #include "storage_hal.h"
+#include "ota_flash_hal.h"
 #if HAL_PLATFORM_FILESYSTEM
 #include "filesystem.h"
 #include "lfs.h"
@@ -227,6 +228,47 @@ private:
 #endif // HAL_PLATFORM_FILESYSTEM
 
 #if HAL_PLATFORM_COMPRESSED_OTA
+/**
+ * Index of the restart points in a compressed stream.
+ *
+ * Each checkpoint stores the state of the decompressor, including its dictionary window, at a given
+ * position in the decompressed data. `InflatorStream` uses the checkpoints to seek to an arbitrary
+ * position without having to decompress the data from the beginning of the stream.
+ */
+class InflatorSeekIndex {
+public:
+    /**
+     * Checkpoint.
+     */
+    struct Checkpoint {
+        size_t offset; // Offset in the decompressed data
+        size_t compressedOffset; // Offset in the compressed data
+    };
+
+    virtual ~InflatorSeekIndex() = default;
+
+    /**
+     * Find the closest checkpoint at or before the given offset in the decompressed data.
+     *
+     * @return Index of the checkpoint or `SYSTEM_ERROR_NOT_FOUND`.
+     */
+    virtual int find(size_t offset, Checkpoint* checkpoint) = 0;
+    /**
+     * Restore the decompressor state saved at a checkpoint.
+     */
+    virtual int restore(int index, inflate_ctx* ctx) = 0;
+    /**
+     * Save the decompressor state at a new checkpoint.
+     *
+     * Checkpoints are added in the order of their offsets.
+     */
+    virtual int add(const Checkpoint& checkpoint, inflate_ctx* ctx) = 0;
+    /**
+     * Minimum distance between two checkpoints in the decompressed data.
+     */
+    virtual size_t span() const = 0;
+};
+
 class InflatorStream: public InputStream {
 public:
     InflatorStream(InputStream* compressedStream, size_t inflatedSize)
@@ -236,7 +278,11 @@ public:
               inflatedChunk_(nullptr),
               inflatedChunkSize_(0),
               posInChunk_(0),
-              offset_(0) {
+              offset_(0),
+              compressedOffset_(0),
+              index_(nullptr),
+              nextCheckpoint_(0),
+              buildingIndex_(false) {
     }
 
     int init() {
@@ -253,6 +299,48 @@ public:
         }
     }
 
+    /**
+     * Size of the decompressor state stored at each checkpoint of a seek index.
+     */
+    int stateSize() const {
+        CHECK_TRUE(inflate_, SYSTEM_ERROR_INVALID_STATE);
+        return inflate_state_size(inflate_);
+    }
+
+    /**
+     * Use a seek index.
+     *
+     * The index is not owned by the stream.
+     */
+    void seekIndex(InflatorSeekIndex* index) {
+        index_ = index;
+    }
+
+    /**
+     * Decompress the entire stream and populate an empty seek index.
+     *
+     * The stream is rewound and starts using the index on success.
+     */
+    int buildSeekIndex(InflatorSeekIndex* index) {
+        CHECK_TRUE(index && index->span() > 0, SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(rewind());
+        index_ = nullptr;
+        buildingIndex_ = true;
+        NAMED_SCOPE_GUARD(sg, {
+            index_ = nullptr;
+            buildingIndex_ = false;
+            rewind();
+        });
+        nextCheckpoint_ = index->span();
+        index_ = index;
+        while (toInflate() > 0) {
+            CHECK(skip(toInflate()));
+        }
+        sg.dismiss();
+        buildingIndex_ = false;
+        return rewind();
+    }
+
     int read(char* data, size_t size) override {
         size = CHECK(peek(data, size));
         return skip(size);
@@ -281,6 +369,18 @@ public:
     }
 
     int seek(size_t offset) override {
+        if (index_ && !buildingIndex_ && offset <= inflatedSize_ && !(offset <= offset_ && (offset_ - offset) <= posInChunk_)) {
+            InflatorSeekIndex::Checkpoint cp = {};
+            const int index = index_->find(offset, &cp);
+            // Resume from the checkpoint if it's closer to the requested position than the current one
+            if (index >= 0 && (offset < offset_ || cp.offset > offset_)) {
+                CHECK(restore(index, cp));
+            } else if (offset < offset_) {
+                CHECK(rewind());
+            }
+            CHECK(skip(offset - offset_));
+            return offset_;
+        }
         CHECK_TRUE(offset == 0 || (offset >= offset_ && offset <= inflatedSize_) || (offset < offset_ && (offset_ - offset) <= posInChunk_), SYSTEM_ERROR_NOT_ALLOWED);
         if (offset == 0) {
             return rewind();
@@ -324,6 +424,23 @@ private:
         CHECK(inflate_reset(inflate_));
         CHECK(compressedStream_->seek(0));
         offset_ = 0;
+        compressedOffset_ = 0;
+        posInChunk_ = 0;
+        inflatedChunkSize_ = 0;
+        inflatedChunk_ = nullptr;
+        return 0;
+    }
+
+    int restore(int index, const InflatorSeekIndex::Checkpoint& cp) {
+        CHECK_TRUE(inflate_ && compressedStream_, SYSTEM_ERROR_INVALID_STATE);
+        NAMED_SCOPE_GUARD(sg, {
+            rewind();
+        });
+        CHECK(index_->restore(index, inflate_));
+        CHECK(compressedStream_->seek(cp.compressedOffset));
+        sg.dismiss();
+        offset_ = cp.offset;
+        compressedOffset_ = cp.compressedOffset;
         posInChunk_ = 0;
         inflatedChunkSize_ = 0;
         inflatedChunk_ = nullptr;
@@ -333,6 +450,13 @@ private:
     int inflateUntilNextChunk() {
         CHECK_TRUE(inflate_ && compressedStream_, SYSTEM_ERROR_INVALID_STATE);
 
+        if (buildingIndex_ && offset_ >= nextCheckpoint_) {
+            CHECK(addCheckpoint());
+            if (availForRead() > 0) {
+                return availForRead();
+            }
+        }
+
         char tmp[256];
 
         while (true) {
@@ -347,6 +471,7 @@ private:
                 r = inflate_input(inflate_, tmp + compressedPos, &n, INFLATE_HAS_MORE_INPUT);
                 CHECK(r);
                 compressedPos += n;
+                compressedOffset_ += n;
                 compressedStream_->skip(n);
                 if (n == 0 && availForRead() <= 0) {
                     break;
@@ -359,6 +484,18 @@ private:
         return availForRead();
     }
 
+    int addCheckpoint() {
+        // Acknowledge the consumed data without providing more input. If the decompressor has no more
+        // output data pending, its current state is a valid restart point
+        size_t n = 0;
+        const int r = CHECK(inflate_input(inflate_, nullptr, &n, INFLATE_HAS_MORE_INPUT));
+        if (r == INFLATE_NEEDS_MORE_INPUT) {
+            CHECK(index_->add({ offset_, compressedOffset_ }, inflate_));
+            nextCheckpoint_ = offset_ + index_->span();
+        }
+        return 0;
+    }
+
     int inflatedChunk(const char* data, size_t size) {
         if (availForRead() == 0 && inflatedChunk_ && posInChunk_ > 0 && posInChunk_ == size) {
             // Acknowledge inflated chunk as consumed
@@ -381,6 +518,10 @@ private:
     size_t inflatedChunkSize_;
     size_t posInChunk_;
     size_t offset_;
+    size_t compressedOffset_;
+    InflatorSeekIndex* index_;
+    size_t nextCheckpoint_;
+    bool buildingIndex_;
 };
 
 #endif // HAL_PLATFORM_COMPRESSED_OTA
@@ -25,6 +25,77 @@
 
 namespace particle {
 
+namespace detail {
+
+// Lookup tables used by the string and hex conversion functions below. The tables are generated
+// at compile time and take 1KB of flash
+struct StrUtilTables {
+    char hexChars[256][2]; // Hex representation of every byte value (lower case)
+    int8_t hexDigits[256]; // Value of every hex digit character, or -1 for other characters
+    uint8_t lowerCase[256]; // ASCII lower case mapping
+
+    constexpr StrUtilTables() :
+            hexChars(),
+            hexDigits(),
+            lowerCase() {
+        const char alpha[] = "0123456789abcdef";
+        for (unsigned i = 0; i < 256; ++i) {
+            hexChars[i][0] = alpha[i >> 4];
+            hexChars[i][1] = alpha[i & 0x0f];
+            hexDigits[i] = -1;
+            lowerCase[i] = (i >= 'A' && i <= 'Z') ? i + ('a' - 'A') : i;
+        }
+        for (unsigned i = 0; i < 10; ++i) {
+            hexDigits['0' + i] = i;
+        }
+        for (unsigned i = 0; i < 6; ++i) {
+            hexDigits['a' + i] = i + 10;
+            hexDigits['A' + i] = i + 10;
+        }
+    }
+};
+
+inline constexpr StrUtilTables STR_UTIL_TABLES;
+
+// Converts the ASCII letters in a word to lower case, all bytes at once
+inline uint32_t toLowerCaseWord(uint32_t w) {
+    const uint32_t b = w & 0x7f7f7f7f;
+    const uint32_t aboveZ = b + 0x25252525; // The high bit is set for bytes above 'Z'
+    const uint32_t atLeastA = b + 0x3f3f3f3f; // The high bit is set for bytes starting from 'A'
+    const uint32_t upper = (atLeastA ^ aboveZ) & ~w & 0x80808080;
+    return w | (upper >> 2); // Set the 0x20 bit of the upper case letters
+}
+
+inline bool equalsIgnoreCase(const char* str1, const char* str2, size_t n) {
+    size_t i = 0;
+    for (; i + sizeof(uint32_t) <= n; i += sizeof(uint32_t)) {
+        uint32_t w1, w2;
+        memcpy(&w1, str1 + i, sizeof(w1));
+        memcpy(&w2, str2 + i, sizeof(w2));
+        if (w1 != w2 && toLowerCaseWord(w1) != toLowerCaseWord(w2)) {
+            return false;
+        }
+    }
+    for (; i < n; ++i) {
+        if (STR_UTIL_TABLES.lowerCase[(uint8_t)str1[i]] != STR_UTIL_TABLES.lowerCase[(uint8_t)str2[i]]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * Get the value of a hex digit.
+ *
+ * @param c Character.
+ * @return Value of the digit, or -1 if the character is not a hex digit.
+ */
+inline int hexDigitValue(char c) {
+    return detail::STR_UTIL_TABLES.hexDigits[(uint8_t)c];
+}
+
 inline char* toUpperCase(char* str, size_t n) {
     for (size_t i = 0; i < n; ++i) {
         str[i] = std::toupper((unsigned char)str[i]);
@@ -38,7 +109,7 @@ inline char* toUpperCase(char* str) {
 
 inline char* toLowerCase(char* str, size_t n) {
     for (size_t i = 0; i < n; ++i) {
-        str[i] = std::tolower((unsigned char)str[i]);
+        str[i] = detail::STR_UTIL_TABLES.lowerCase[(uint8_t)str[i]];
     }
     return str;
 }
@@ -90,6 +161,66 @@ inline bool endsWith(const char* str, const char* suffix) {
     return endsWith(str, strlen(str), suffix, strlen(suffix));
 }
 
+/**
+ * Compare two strings ignoring the case of the ASCII letters.
+ *
+ * @param str1 First string.
+ * @param size1 Size of the first string.
+ * @param str2 Second string.
+ * @param size2 Size of the second string.
+ * @return A negative value, zero or a positive value if the first string is less than, equal to
+ *         or greater than the second string respectively.
+ */
+inline int compareIgnoreCase(const char* str1, size_t size1, const char* str2, size_t size2) {
+    const size_t n = std::min(size1, size2);
+    size_t i = 0;
+    // Skip the words that match ignoring the case
+    for (; i + sizeof(uint32_t) <= n; i += sizeof(uint32_t)) {
+        uint32_t w1, w2;
+        memcpy(&w1, str1 + i, sizeof(w1));
+        memcpy(&w2, str2 + i, sizeof(w2));
+        if (w1 != w2 && detail::toLowerCaseWord(w1) != detail::toLowerCaseWord(w2)) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        const int c1 = detail::STR_UTIL_TABLES.lowerCase[(uint8_t)str1[i]];
+        const int c2 = detail::STR_UTIL_TABLES.lowerCase[(uint8_t)str2[i]];
+        if (c1 != c2) {
+            return c1 - c2;
+        }
+    }
+    return (size1 < size2) ? -1 : (size1 > size2) ? 1 : 0;
+}
+
+inline int compareIgnoreCase(const char* str1, const char* str2) {
+    return compareIgnoreCase(str1, strlen(str1), str2, strlen(str2));
+}
+
+inline bool equalsIgnoreCase(const char* str1, size_t size1, const char* str2, size_t size2) {
+    return size1 == size2 && detail::equalsIgnoreCase(str1, str2, size1);
+}
+
+inline bool equalsIgnoreCase(const char* str1, const char* str2) {
+    return equalsIgnoreCase(str1, strlen(str1), str2, strlen(str2));
+}
+
+inline bool startsWithIgnoreCase(const char* str, size_t strSize, const char* prefix, size_t prefixSize) {
+    return strSize >= prefixSize && detail::equalsIgnoreCase(str, prefix, prefixSize);
+}
+
+inline bool startsWithIgnoreCase(const char* str, const char* prefix) {
+    return startsWithIgnoreCase(str, strlen(str), prefix, strlen(prefix));
+}
+
+inline bool endsWithIgnoreCase(const char* str, size_t strSize, const char* suffix, size_t suffixSize) {
+    return strSize >= suffixSize && detail::equalsIgnoreCase(str + strSize - suffixSize, suffix, suffixSize);
+}
+
+inline bool endsWithIgnoreCase(const char* str, const char* suffix) {
+    return endsWithIgnoreCase(str, strlen(str), suffix, strlen(suffix));
+}
+
 /**
  * Escapes a set of characters in a string by prepending them with an escape character. The output
  * is always null-terminated, unless the size of the destination buffer is `0`.
@@ -117,20 +248,21 @@ size_t escape(const char* src, const char* spec, char esc, char* dest, size_t de
  * @return Number of characters written to the destination buffer, not including the trailing `\0`.
  */
 inline size_t toHex(const void* src, size_t srcSize, char* dest, size_t destSize) {
-    static const char alpha[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
-    size_t n = 0;
+    if (destSize == 0) {
+        return 0;
+    }
     auto srcBytes = (const uint8_t*)src;
-    for (size_t i = 0; i < srcSize && n + 1 < destSize; ++i) {
-        const auto b = srcBytes[i];
-        dest[n++] = alpha[b >> 4];
-        if (n + 1 < destSize) {
-            dest[n++] = alpha[b & 0x0f];
-        }
+    const size_t n = std::min(srcSize, (destSize - 1) / 2); // Number of bytes that fit entirely
+    for (size_t i = 0; i < n; ++i) {
+        memcpy(dest + i * 2, detail::STR_UTIL_TABLES.hexChars[srcBytes[i]], 2);
     }
-    if (n < destSize) {
-        dest[n] = '\0';
+    size_t pos = n * 2;
+    if (n < srcSize && pos + 1 < destSize) {
+        // Only the high nibble of the next byte fits in the buffer
+        dest[pos++] = detail::STR_UTIL_TABLES.hexChars[srcBytes[n]][0];
     }
-    return n;
+    dest[pos] = '\0';
+    return pos;
 }
 
 /**
@@ -143,30 +275,17 @@ inline size_t toHex(const void* src, size_t srcSize, char* dest, size_t destSize
  * @return Number of bytes written to the destination buffer.
  */
 inline size_t fromHex(const char* src, size_t srcSize, char* dest, size_t destSize) {
-    size_t n = 0;
-    uint8_t b = 0;
-    for (size_t i = 0; i < srcSize; ++i) {
-        if (n >= destSize) {
+    const size_t n = std::min(srcSize / 2, destSize);
+    size_t i = 0;
+    for (; i < n; ++i) {
+        const int h = hexDigitValue(src[i * 2]);
+        const int l = hexDigitValue(src[i * 2 + 1]);
+        if ((h | l) < 0) {
             break;
         }
-        char c = src[i];
-        if (c >= '0' && c <= '9') {
-            b |= c - '0';
-        } else if (c >= 'A' && c <= 'F') {
-            b |= c - 'A' + 10;
-        } else if (c >= 'a' && c <= 'f') {
-            b |= c - 'a' + 10;
-        } else {
-            break;
-        }
-        if (i % 2) {
-            dest[n++] = b;
-            b = 0;
-        } else {
-            b <<= 4;
-        }
+        dest[i] = (h << 4) | l;
     }
-    return n;
+    return i;
 }
 
 /**
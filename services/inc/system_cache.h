@@ -28,6 +28,7 @@ enum class SystemCacheKey : uint16_t {
     WIZNET_CONFIG_DATA = 0x0003,
     CELLULAR_NCP_OPERATION_MODE = 0x0004,
     CELLULAR_DEVICE_INFO = 0x0005,
+    DNS_CACHE = 0x0006,
     ASSET_MANAGER_CONSUMER_STATE = 0x0010,
 };
 
@@ -41,6 +42,11 @@ public:
     int set(SystemCacheKey key, const void* value, size_t length);
     int del(SystemCacheKey key);
 
+    // Defer writing the changes to the file until the matching call to endUpdate(). Use this when
+    // several keys are updated together
+    int beginUpdate();
+    int endUpdate();
+
     SystemCache(SystemCache const&) = delete;
     SystemCache(SystemCache&&) = delete;
     SystemCache& operator=(SystemCache const&) = delete;
@@ -19,13 +19,29 @@
 #define SERVICES_TLV_FILE_H
 
 #include "filesystem.h"
+#include "spark_wiring_vector.h"
 #include <stdio.h>
 
 namespace particle { namespace services { namespace settings {
 
+// Files in this format are rewritten on every update and don't contain deletion records
 static constexpr uint32_t TLV_FILE_MAGICK = 0x714f11e5;
+// Files in this format are updated by appending records to the file. A different magick number
+// prevents older versions of the firmware from reading superseded records. The legacy magick is
+// used while the file contains only the current records, e.g. after it has been compacted
+static constexpr uint32_t TLV_FILE_LOG_MAGICK = 0x714f11e6;
 static constexpr uint32_t TLV_HEADER_MAGICK = 0x4ead;
+// Flag set in the header of a record that marks an earlier record as deleted. The record data
+// contains the offset of the deleted record in the file
+static constexpr uint16_t TLV_HEADER_FLAG_DELETED = 0x0001;
 
+/**
+ * A file containing key/value records.
+ *
+ * Updates are appended to the file, and the space taken by deleted and superseded records is
+ * reclaimed when the file gets compacted. The offsets of the records are kept in memory so that
+ * looking up a record doesn't require reading the file.
+ */
 class TlvFile {
 public:
     TlvFile(const char* path);
@@ -37,6 +53,15 @@ public:
     int purge();
     int sync();
 
+    /**
+     * Defer syncing the file until the matching call to `endUpdate()`.
+     *
+     * This allows performing multiple updates with one write of the file metadata. The calls can
+     * be nested. Updates made by other threads in the meantime are deferred as well.
+     */
+    int beginUpdate();
+    int endUpdate();
+
     uint16_t currentVersion() const;
     int fileVersion();
 
@@ -72,9 +97,23 @@ private:
     int validate();
     int close();
 
+    struct Record {
+        uint32_t offset; // Offset of the record header in the file
+        uint16_t key; // Key
+        uint16_t length; // Data size
+    };
+
     int mkdir(char* dir);
 
-    ssize_t find(uint16_t key, int index, uint16_t* dataSize);
+    int load(size_t dataSize);
+    int find(uint16_t key, int index);
+    int appendRecord(uint16_t key, const uint8_t* value, uint16_t length, uint16_t flags = 0);
+    int deleteRecords(uint16_t key, int index);
+    int writeFooter();
+    uint32_t footerMagick() const;
+    int commit();
+    int compact();
+    int syncFile();
     int readFooter(FileFooter& footer);
 
     ssize_t seek(ssize_t offset, int whence = SEEK_SET);
@@ -87,6 +126,12 @@ private:
     bool open_ = false;
     filesystem_t* fs_ = nullptr;
     lfs_file_t file_ = {};
+
+    Vector<Record> records_; // Current records in the order they appear in the file
+    size_t dataSize_ = 0; // Size of the file excluding the footer
+    size_t recordsSize_ = 0; // Total size of the current records
+    unsigned updateDepth_ = 0; // Nesting level of beginUpdate()
+    bool syncPending_ = false; // Whether the file needs to be synced when the update ends
 };
 
 } } } /* namespace particle::services::settings */
@@ -25,7 +25,19 @@ namespace particle {
 class Stream;
 class InputStream;
 
-// Class implementing the XMODEM-1K protocol
+/**
+ * Class implementing the XMODEM-1K protocol.
+ *
+ * The receiver selects the transfer mode by sending one of the following bytes to initiate the
+ * transfer:
+ *
+ * - 'C': Regular XMODEM-1K with CRC-16. Each packet is acknowledged before the next one is sent.
+ * - 'G': XMODEM-1K-G. The packets are sent back to back without waiting for acknowledgements, only
+ *   the EOT is acknowledged. The mode has no error recovery: the receiver cancels the transfer
+ *   with CAN bytes if a packet is corrupted, and any other control byte received while the packets
+ *   are being sent aborts the transfer. The receiver should only request it if the link is
+ *   reliable and flow-controlled.
+ */
 class XmodemSender {
 public:
     enum Status {
@@ -67,6 +79,7 @@ private:
     size_t packetSize_; // Size of the current XMODEM packet
     size_t packetOffs_; // Number of transmitted bytes of the current packet
     unsigned packetNum_; // Packet number
+    bool streaming_; // Whether the streaming mode is used
 
     std::unique_ptr<char[]> buf_; // Packet buffer
 
@@ -76,6 +89,8 @@ private:
     int sendEot();
     int recvEotAck();
 
+    void nextPacket();
+
     int readCtrl(char* c = nullptr);
     int checkTimeout(unsigned timeout);
     void setState(State state);
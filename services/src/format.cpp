@@ -0,0 +1,578 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+#include "format.h"
+
+#include "system_error.h"
+
+namespace particle {
+
+using detail::FormatArg;
+
+namespace {
+
+// Flags of a conversion specification
+enum SpecFlag {
+    LEFT = 0x01, // '-'
+    PLUS = 0x02, // '+'
+    SPACE = 0x04, // ' '
+    ALT = 0x08, // '#'
+    ZERO = 0x10 // '0'
+};
+
+// Length modifiers of a conversion specification
+enum SpecLength {
+    DEFAULT,
+    HH,
+    H,
+    L,
+    LL,
+    J,
+    Z,
+    T,
+    LONG_DOUBLE
+};
+
+struct Spec {
+    unsigned flags; // Flags
+    int width; // Field width
+    int prec; // Precision or -1 if not specified
+    SpecLength length; // Length modifier
+    char conv; // Conversion specifier
+};
+
+// Size of the buffer for the output of a floating point conversion
+const size_t FLOAT_BUF_SIZE = 64;
+
+// Size of the output buffer. Most of the formatted strings, such as log lines, fit in it entirely
+// and are passed to the appender with a single call
+const size_t OUTPUT_BUF_SIZE = 128;
+
+// Buffers the output so that the appender isn't called for every part of the formatted string
+class Writer {
+public:
+    Writer(appender_fn append, void* appender) :
+            append_(append),
+            appender_(appender),
+            count_(0),
+            bufSize_(0),
+            error_(false) {
+    }
+
+    void write(const char* data, size_t size) {
+        if (size > sizeof(buf_) - bufSize_) {
+            flush();
+            if (size >= sizeof(buf_)) {
+                appendData(data, size);
+                return;
+            }
+        }
+        std::memcpy(buf_ + bufSize_, data, size);
+        bufSize_ += size;
+    }
+
+    void write(char c) {
+        if (bufSize_ == sizeof(buf_)) {
+            flush();
+        }
+        buf_[bufSize_++] = c;
+    }
+
+    void fill(char c, size_t count) {
+        while (count > 0) {
+            if (bufSize_ == sizeof(buf_)) {
+                flush();
+            }
+            const size_t n = std::min(count, sizeof(buf_) - bufSize_);
+            std::memset(buf_ + bufSize_, c, n);
+            bufSize_ += n;
+            count -= n;
+        }
+    }
+
+    int finish() {
+        flush();
+        if (error_) {
+            return SYSTEM_ERROR_IO;
+        }
+        return count_;
+    }
+
+private:
+    char buf_[OUTPUT_BUF_SIZE];
+    appender_fn append_;
+    void* appender_;
+    size_t count_;
+    size_t bufSize_;
+    bool error_;
+
+    void flush() {
+        if (bufSize_ > 0) {
+            appendData(buf_, bufSize_);
+            bufSize_ = 0;
+        }
+    }
+
+    void appendData(const char* data, size_t size) {
+        if (error_) {
+            return;
+        }
+        if (!append_(appender_, (const uint8_t*)data, size)) {
+            error_ = true;
+            return;
+        }
+        count_ += size;
+    }
+};
+
+// Takes the arguments from a va_list based on the length modifiers of the conversion specifications
+class VaListArgs {
+public:
+    explicit VaListArgs(va_list args) {
+        va_copy(args_, args);
+    }
+
+    ~VaListArgs() {
+        va_end(args_);
+    }
+
+    int nextInt() {
+        return va_arg(args_, int);
+    }
+
+    FormatArg next(const Spec& spec) {
+        switch (spec.conv) {
+        case 'd':
+        case 'i': {
+            switch (spec.length) {
+            case HH: return FormatArg((signed char)va_arg(args_, int));
+            case H: return FormatArg((short)va_arg(args_, int));
+            case L: return FormatArg(va_arg(args_, long));
+            case LL: return FormatArg(va_arg(args_, long long));
+            case J: return FormatArg(va_arg(args_, intmax_t));
+            case Z: return FormatArg(va_arg(args_, std::make_signed_t<size_t>));
+            case T: return FormatArg(va_arg(args_, ptrdiff_t));
+            default: return FormatArg(va_arg(args_, int));
+            }
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X': {
+            switch (spec.length) {
+            case HH: return FormatArg((unsigned char)va_arg(args_, unsigned));
+            case H: return FormatArg((unsigned short)va_arg(args_, unsigned));
+            case L: return FormatArg(va_arg(args_, unsigned long));
+            case LL: return FormatArg(va_arg(args_, unsigned long long));
+            case J: return FormatArg(va_arg(args_, uintmax_t));
+            case Z: return FormatArg(va_arg(args_, size_t));
+            case T: return FormatArg(va_arg(args_, std::make_unsigned_t<ptrdiff_t>));
+            default: return FormatArg(va_arg(args_, unsigned));
+            }
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A': {
+            if (spec.length == LONG_DOUBLE) {
+                return FormatArg((double)va_arg(args_, long double));
+            }
+            return FormatArg(va_arg(args_, double));
+        }
+        case 'c':
+            return FormatArg((char)va_arg(args_, int));
+        case 's':
+            return FormatArg(va_arg(args_, const char*));
+        case 'p':
+        case 'n':
+            return FormatArg(va_arg(args_, const void*));
+        default:
+            return FormatArg();
+        }
+    }
+
+private:
+    va_list args_;
+};
+
+// Takes the arguments from an array in order
+class ArrayArgs {
+public:
+    ArrayArgs(const FormatArg* args, size_t count) :
+            args_(args),
+            count_(count),
+            index_(0) {
+    }
+
+    int nextInt() {
+        const auto arg = next(Spec());
+        if (arg.type == FormatArg::INT || arg.type == FormatArg::UINT || arg.type == FormatArg::CHAR) {
+            return arg.i;
+        }
+        return 0;
+    }
+
+    FormatArg next(const Spec& /* spec */) {
+        if (index_ >= count_) {
+            return FormatArg();
+        }
+        return args_[index_++];
+    }
+
+private:
+    const FormatArg* args_;
+    size_t count_;
+    size_t index_;
+};
+
+const char* parseSpec(const char* fmt, Spec* spec) {
+    spec->flags = 0;
+    for (;; ++fmt) {
+        switch (*fmt) {
+        case '-': spec->flags |= LEFT; continue;
+        case '+': spec->flags |= PLUS; continue;
+        case ' ': spec->flags |= SPACE; continue;
+        case '#': spec->flags |= ALT; continue;
+        case '0': spec->flags |= ZERO; continue;
+        }
+        break;
+    }
+    return fmt;
+}
+
+template<typename ArgsT>
+const char* parseWidthAndPrecision(const char* fmt, Spec* spec, ArgsT& args) {
+    spec->width = 0;
+    if (*fmt == '*') {
+        spec->width = args.nextInt();
+        if (spec->width < 0) {
+            spec->flags |= LEFT;
+            spec->width = -spec->width;
+        }
+        ++fmt;
+    } else {
+        while (*fmt >= '0' && *fmt <= '9') {
+            spec->width = spec->width * 10 + (*fmt++ - '0');
+        }
+    }
+    spec->prec = -1;
+    if (*fmt == '.') {
+        ++fmt;
+        if (*fmt == '*') {
+            spec->prec = std::max(args.nextInt(), -1);
+            ++fmt;
+        } else {
+            spec->prec = 0;
+            while (*fmt >= '0' && *fmt <= '9') {
+                spec->prec = spec->prec * 10 + (*fmt++ - '0');
+            }
+        }
+    }
+    return fmt;
+}
+
+const char* parseLength(const char* fmt, Spec* spec) {
+    spec->length = DEFAULT;
+    switch (*fmt) {
+    case 'h':
+        if (*++fmt == 'h') {
+            ++fmt;
+            spec->length = HH;
+        } else {
+            spec->length = H;
+        }
+        break;
+    case 'l':
+        if (*++fmt == 'l') {
+            ++fmt;
+            spec->length = LL;
+        } else {
+            spec->length = L;
+        }
+        break;
+    case 'j': ++fmt; spec->length = J; break;
+    case 'z': ++fmt; spec->length = Z; break;
+    case 't': ++fmt; spec->length = T; break;
+    case 'L': ++fmt; spec->length = LONG_DOUBLE; break;
+    }
+    return fmt;
+}
+
+void pad(Writer& w, const Spec& spec, size_t size, bool left) {
+    if (spec.width > 0 && (size_t)spec.width > size && ((spec.flags & LEFT) != 0) == left) {
+        w.fill(' ', spec.width - size);
+    }
+}
+
+void formatInt(Writer& w, const Spec& spec, unsigned long long val, bool neg) {
+    unsigned base = 10;
+    const char* digitChars = "0123456789abcdef";
+    if (spec.conv == 'x' || spec.conv == 'p') {
+        base = 16;
+    } else if (spec.conv == 'X') {
+        base = 16;
+        digitChars = "0123456789ABCDEF";
+    } else if (spec.conv == 'o') {
+        base = 8;
+    }
+    char digits[24]; // Enough for a 64-bit value in octal
+    char* const end = digits + sizeof(digits);
+    char* p = end;
+    if (val != 0 || spec.prec != 0) {
+        do {
+            *--p = digitChars[val % base];
+            val /= base;
+        } while (val);
+    }
+    const size_t len = end - p;
+    char prefix[2];
+    size_t prefixLen = 0;
+    if (spec.conv == 'd' || spec.conv == 'i') {
+        if (neg) {
+            prefix[prefixLen++] = '-';
+        } else if (spec.flags & PLUS) {
+            prefix[prefixLen++] = '+';
+        } else if (spec.flags & SPACE) {
+            prefix[prefixLen++] = ' ';
+        }
+    } else if (spec.conv == 'p' || ((spec.flags & ALT) && base == 16 && len > 0 && (len > 1 || *p != '0'))) {
+        prefix[prefixLen++] = '0';
+        prefix[prefixLen++] = (spec.conv == 'X') ? 'X' : 'x';
+    }
+    size_t zeros = (spec.prec > 0 && (size_t)spec.prec > len) ? spec.prec - len : 0;
+    if ((spec.flags & ALT) && base == 8 && zeros == 0 && (len == 0 || *p != '0')) {
+        zeros = 1;
+    }
+    size_t size = prefixLen + zeros + len;
+    if ((spec.flags & ZERO) && !(spec.flags & LEFT) && spec.prec < 0 && (size_t)spec.width > size) {
+        zeros += spec.width - size;
+        size = spec.width;
+    }
+    pad(w, spec, size, false);
+    w.write(prefix, prefixLen);
+    w.fill('0', zeros);
+    w.write(p, len);
+    pad(w, spec, size, true);
+}
+
+void formatString(Writer& w, const Spec& spec, const char* str) {
+    if (!str) {
+        str = "(null)";
+    }
+    size_t len = 0;
+    while (str[len] && (spec.prec < 0 || len < (size_t)spec.prec)) {
+        ++len;
+    }
+    pad(w, spec, len, false);
+    w.write(str, len);
+    pad(w, spec, len, true);
+}
+
+void formatChar(Writer& w, const Spec& spec, char c) {
+    pad(w, spec, 1, false);
+    w.write(c);
+    pad(w, spec, 1, true);
+}
+
+// Floating point conversions are rare compared to the other ones and are delegated to the C
+// library so that the formatting is consistent with the rest of the system
+__attribute__((noinline)) void formatDouble(Writer& w, const Spec& spec, double val) {
+    char f[16];
+    size_t n = 0;
+    f[n++] = '%';
+    if (spec.flags & LEFT) {
+        f[n++] = '-';
+    }
+    if (spec.flags & PLUS) {
+        f[n++] = '+';
+    }
+    if (spec.flags & SPACE) {
+        f[n++] = ' ';
+    }
+    if (spec.flags & ALT) {
+        f[n++] = '#';
+    }
+    if (spec.flags & ZERO) {
+        f[n++] = '0';
+    }
+    f[n++] = '*';
+    f[n++] = '.';
+    f[n++] = '*';
+    f[n++] = spec.conv;
+    f[n] = '\0';
+    // Precision of -1 means the default precision
+    char buf[FLOAT_BUF_SIZE];
+    const int r = snprintf(buf, sizeof(buf), f, spec.width, spec.prec, val);
+    if (r <= 0) {
+        return;
+    }
+    if ((size_t)r < sizeof(buf)) {
+        w.write(buf, r);
+    } else {
+        char buf[r + 1]; // Use a larger buffer
+        snprintf(buf, sizeof(buf), f, spec.width, spec.prec, val);
+        w.write(buf, r);
+    }
+}
+
+void formatArg(Writer& w, Spec spec, const FormatArg& arg) {
+    switch (arg.type) {
+    case FormatArg::INT:
+    case FormatArg::UINT:
+    case FormatArg::CHAR: {
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+            if (arg.type == FormatArg::INT || arg.type == FormatArg::CHAR) {
+                const bool neg = arg.i < 0;
+                formatInt(w, spec, neg ? 0ull - (unsigned long long)arg.i : arg.i, neg);
+            } else {
+                spec.conv = 'u';
+                formatInt(w, spec, arg.u, false);
+            }
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X': {
+            unsigned long long val = arg.u;
+            if (arg.size < sizeof(val)) {
+                // Use the representation of a negative value in the original type
+                val &= (1ull << (arg.size * 8)) - 1;
+            }
+            formatInt(w, spec, val, false);
+            break;
+        }
+        case 'c':
+            formatChar(w, spec, (char)arg.i);
+            break;
+        default:
+            if (arg.type == FormatArg::CHAR) {
+                formatChar(w, spec, (char)arg.i);
+            } else if (arg.type == FormatArg::INT) {
+                spec.conv = 'd';
+                formatArg(w, spec, arg);
+            } else {
+                spec.conv = 'u';
+                formatInt(w, spec, arg.u, false);
+            }
+            break;
+        }
+        break;
+    }
+    case FormatArg::DOUBLE: {
+        switch (spec.conv) {
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            break;
+        default:
+            spec.conv = 'g';
+            break;
+        }
+        formatDouble(w, spec, arg.d);
+        break;
+    }
+    case FormatArg::STRING: {
+        if (spec.conv == 'p') {
+            formatInt(w, spec, (uintptr_t)arg.s, false);
+        } else {
+            formatString(w, spec, arg.s);
+        }
+        break;
+    }
+    case FormatArg::POINTER: {
+        spec.conv = 'p';
+        formatInt(w, spec, (uintptr_t)arg.p, false);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+template<typename ArgsT>
+int formatImpl(appender_fn append, void* appender, const char* fmt, ArgsT& args) {
+    if (!fmt) {
+        return 0;
+    }
+    Writer w(append, appender);
+    for (;;) {
+        const char* p = fmt;
+        while (*p && *p != '%') {
+            ++p;
+        }
+        if (p != fmt) {
+            w.write(fmt, p - fmt);
+        }
+        if (!*p) {
+            break;
+        }
+        Spec spec = {};
+        p = parseSpec(p + 1, &spec);
+        p = parseWidthAndPrecision(p, &spec, args);
+        p = parseLength(p, &spec);
+        spec.conv = *p;
+        if (!spec.conv) {
+            break;
+        }
+        fmt = p + 1;
+        if (spec.conv == '%') {
+            w.write('%');
+            continue;
+        }
+        const auto arg = args.next(spec);
+        if (spec.conv == 'n') {
+            continue; // Not supported
+        }
+        if (arg.type == FormatArg::NONE) {
+            // Unknown conversion specifier or missing argument
+            w.write('%');
+            w.write(spec.conv);
+            continue;
+        }
+        formatArg(w, spec, arg);
+    }
+    return w.finish();
+}
+
+} // namespace
+
+int vformat(appender_fn append, void* appender, const char* fmt, va_list args) {
+    VaListArgs a(args);
+    return formatImpl(append, appender, fmt, a);
+}
+
+int formatArgs(appender_fn append, void* appender, const char* fmt, const FormatArg* args, size_t argCount) {
+    ArrayArgs a(args, argCount);
+    return formatImpl(append, appender, fmt, a);
+}
+
+} // namespace particle
@@ -55,6 +55,14 @@ int SystemCache::del(SystemCacheKey key) {
     return tlv_.del(to_underlying(key));
 }
 
+int SystemCache::beginUpdate() {
+    return tlv_.beginUpdate();
+}
+
+int SystemCache::endUpdate() {
+    return tlv_.endUpdate();
+}
+
 } } // particle::services
 
 #endif // HAL_PLATFORM_FILESYSTEM
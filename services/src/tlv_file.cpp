@@ -24,6 +24,7 @@
 #include "service_debug.h"
 #include "system_error.h"
 #include <algorithm>
+#include <memory>
 
 /* FIXME: once filesystem interface is finalized, convert the implementation not to use
  * LittleFS API.
@@ -32,6 +33,19 @@
 using namespace particle::services::settings;
 using namespace particle::fs;
 
+namespace {
+
+/* The file is compacted when the deleted and superseded records take more space than the
+ * current records and at least this many bytes
+ */
+const size_t MIN_COMPACTION_SIZE = 1024;
+
+const size_t COPY_BUFFER_SIZE = 64;
+
+const char TEMP_FILE_SUFFIX[] = ".tmp";
+
+} // namespace
+
 TlvFile::TlvFile(const char* path) {
     SPARK_ASSERT(path != nullptr);
     path_ = strdup(path);
@@ -85,17 +99,44 @@ int TlvFile::purge() {
 int TlvFile::sync() {
     FsLock lk(fs_);
 
-    if (open_) {
-        int r = lfs_file_sync(lfs(), &file_);
-        if (r) {
-            /* Reopen just in case */
-            close();
-            open();
-        }
-        return r;
+    if (!open_) {
+        return SYSTEM_ERROR_INVALID_STATE;
     }
 
-    return SYSTEM_ERROR_INVALID_STATE;
+    syncPending_ = false;
+
+    const size_t garbageSize = dataSize_ - recordsSize_;
+    if (garbageSize >= std::max(recordsSize_, MIN_COMPACTION_SIZE)) {
+        return compact();
+    }
+
+    return syncFile();
+}
+
+int TlvFile::beginUpdate() {
+    FsLock lk(fs_);
+
+    if (!open_) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+
+    ++updateDepth_;
+
+    return 0;
+}
+
+int TlvFile::endUpdate() {
+    FsLock lk(fs_);
+
+    if (!updateDepth_) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+
+    if (--updateDepth_ > 0 || !syncPending_) {
+        return 0;
+    }
+
+    return sync();
 }
 
 ssize_t TlvFile::size() {
@@ -124,14 +165,14 @@ ssize_t TlvFile::get(uint16_t key, uint8_t* value, uint16_t length, int index) {
         return SYSTEM_ERROR_INVALID_ARGUMENT;
     }
 
-    uint16_t dataSize;
     ssize_t ret = SYSTEM_ERROR_NOT_FOUND;
-    ssize_t pos = find(key, index, &dataSize);
-    if (pos >= 0) {
+    const int i = find(key, index);
+    if (i >= 0) {
         /* Found it */
-        const size_t toRead = std::min(length, dataSize);
+        const Record& rec = records_[i];
+        const size_t toRead = std::min(length, rec.length);
         if (toRead) {
-            ret = seek(pos + sizeof(TlvHeader));
+            ret = seek(rec.offset + sizeof(TlvHeader));
             if (ret >= 0) {
                 ret = read(value, toRead);
             }
@@ -153,13 +194,27 @@ int TlvFile::set(uint16_t key, const uint8_t* value, uint16_t length, int index)
         return SYSTEM_ERROR_INVALID_ARGUMENT;
     }
 
+    if (!value && length > 0) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+
     /* Delete previous entry */
-    int ret = del(key, index);
+    int ret = deleteRecords(key, index);
     if (!(ret == 0 || ret == SYSTEM_ERROR_NOT_FOUND)) {
         return ret;
     }
 
-    return add(key, value, length);
+    ret = appendRecord(key, value, length);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = writeFooter();
+    if (ret < 0) {
+        return ret;
+    }
+
+    return commit();
 }
 
 int TlvFile::add(uint16_t key, const uint8_t* value, uint16_t length) {
@@ -174,46 +229,17 @@ int TlvFile::add(uint16_t key, const uint8_t* value, uint16_t length) {
         return SYSTEM_ERROR_INVALID_ARGUMENT;
     }
 
-    FileFooter footer;
-    int ret = readFooter(footer);
+    int ret = appendRecord(key, value, length);
     if (ret < 0) {
         return ret;
     }
-    ssize_t pos = footer.size;
 
-    if (pos < 0) {
-        return pos;
-    }
-
-    ret = seek(pos);
+    ret = writeFooter();
     if (ret < 0) {
         return ret;
     }
 
-    TlvHeader header = {};
-    header.magick = TLV_HEADER_MAGICK;
-    header.key = key;
-    header.length = length;
-
-    /* Write entry header */
-    ret = write((const uint8_t*)&header, sizeof(header));
-    if (ret < 0) {
-        return ret;
-    }
-    /* Write data */
-    ret = write((const uint8_t*)value, length);
-    if (ret < 0) {
-        return ret;
-    }
-    /* Write file footer */
-    footer.magick = TLV_FILE_MAGICK;
-    footer.size += sizeof(header) + length;
-    ret = write((const uint8_t*)&footer, sizeof(footer));
-    if (ret < 0) {
-        return ret;
-    }
-
-    return sync();
+    return commit();
 }
 
 int TlvFile::del(uint16_t key, int index) {
@@ -223,92 +249,17 @@ int TlvFile::del(uint16_t key, int index) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
 
-    int ret = 0;
-
-    bool deleted = false;
-
-    for (;;) {
-        uint16_t dataSize = 0;
-        ssize_t pos = find(key, index, &dataSize);
-        if (pos < 0) {
-            if (index < 0 && deleted) {
-                return ret;
-            }
-            return pos;
-        }
-
-        /* FIXME: this will only work on LittleFS. Provide a different implementation later
-         * when filesystem API is finalized and TlvFile implementation is refactored not to use
-         * LittleFS API.
-         */
-        const ssize_t fileSize = size();
-
-        FileFooter footer;
-        ret = readFooter(footer);
-
-        while (ret == 0) {
-            lfs_file_t f;
-            ret = lfs_file_open(lfs(), &f, path_, LFS_O_RDONLY);
-            if (ret) {
-                break;
-            }
-
-            size_t wpos = pos;
-            size_t rpos = wpos + sizeof(TlvHeader) + dataSize;
-
-            ret = seek(wpos);
-            if (ret < 0) {
-                break;
-            }
-
-            ret = lfs_file_seek(lfs(), &f, rpos, LFS_SEEK_SET);
-            if (ret < 0) {
-                break;
-            }
-
-            for (; rpos < footer.size && ret > 0; ++wpos, ++rpos) {
-                uint8_t tmp;
-                ret = lfs_file_read(lfs(), &f, &tmp, sizeof(tmp));
-                if (ret < 0) {
-                    break;
-                }
-
-                ret = write(&tmp, sizeof(tmp));
-                if (ret < 0) {
-                    break;
-                }
-            }
-
-            if (ret > 0) {
-                /* Write footer */
-                footer.size -= sizeof(TlvHeader) + dataSize;
-                ret = write((const uint8_t*)&footer, sizeof(footer));
-                if (ret < 0) {
-                    break;
-                }
-                /* Truncate */
-                ret = lfs_file_truncate(lfs(), &file_, fileSize - (sizeof(TlvHeader) + dataSize));
-                if (ret < 0) {
-                    break;
-                }
-                ret = sync();
-            }
-
-            lfs_file_close(lfs(), &f);
-
-            break;
-        }
-
-        if (!ret) {
-            deleted = true;
-        }
+    int ret = deleteRecords(key, index);
+    if (ret < 0) {
+        return ret;
+    }
 
-        if (ret || index >= 0) {
-            break;
-        }
+    ret = writeFooter();
+    if (ret < 0) {
+        return ret;
     }
 
-    return ret;
+    return commit();
 }
 
 lfs_t* TlvFile::lfs() {
@@ -336,7 +287,10 @@ int TlvFile::open() {
         goto open_done;
     }
 
-    footer.magick = TLV_FILE_MAGICK;
+    records_.clear();
+    dataSize_ = 0;
+    recordsSize_ = 0;
+    footer.magick = footerMagick();
     footer.size = 0;
 
     /* Validation failed, create anew */
@@ -355,7 +309,7 @@ int TlvFile::open() {
         goto open_done;
     }
 
-    r = sync();
+    r = syncFile();
 
 open_done:
     if (r) {
@@ -369,8 +323,10 @@ int TlvFile::validate() {
     FileFooter footer = {};
     int ret = readFooter(footer);
     if (!ret) {
-        if (footer.magick != TLV_FILE_MAGICK) {
+        if (footer.magick != TLV_FILE_MAGICK && footer.magick != TLV_FILE_LOG_MAGICK) {
             ret = SYSTEM_ERROR_BAD_DATA;
+        } else {
+            ret = load(footer.size);
         }
     }
 
@@ -387,6 +343,10 @@ int TlvFile::close() {
     /* Close */
 
     open_ = false;
+    records_.clear();
+    dataSize_ = 0;
+    recordsSize_ = 0;
+    syncPending_ = false;
 
     return lfs_file_close(lfs(), &file_);
 }
@@ -438,7 +398,7 @@ ssize_t TlvFile::write(const uint8_t* buf, size_t length) {
     ssize_t r = lfs_file_write(lfs(), &file_, buf, length);
     if (r < 0) {
         /* Write operation failed. sync() should discard this cached write */
-        if (sync()) {
+        if (syncFile()) {
             /* If sync fails, try to reopen the file */
             close();
             open();
@@ -468,26 +428,22 @@ int TlvFile::readFooter(FileFooter& footer) {
     return SYSTEM_ERROR_BAD_DATA;
 }
 
-ssize_t TlvFile::find(uint16_t key, int index, uint16_t* dataSize) {
-    FileFooter footer;
-    int r = readFooter(footer);
-    if (r) {
-        return r;
-    }
-
-    ssize_t candidatePos = -1;
-    int candidateIdx = -1;
-    uint16_t candidateSize = 0;
+int TlvFile::load(size_t dataSize) {
+    records_.clear();
+    dataSize_ = 0;
+    recordsSize_ = 0;
 
+    /* Replay the file to find the current records */
     TlvHeader header;
-    for (ssize_t pos = 0; pos >= 0 && (pos + sizeof(TlvHeader)) <= footer.size;) {
-        r = seek(pos);
+    size_t pos = 0;
+    while (pos + sizeof(TlvHeader) <= dataSize) {
+        ssize_t r = seek(pos);
         if (r < 0) {
             return r;
         }
 
-        ssize_t rd = read((uint8_t*)&header, sizeof(header));
-        if (rd < (ssize_t)sizeof(TlvHeader)) {
+        r = read((uint8_t*)&header, sizeof(header));
+        if (r < (ssize_t)sizeof(TlvHeader)) {
             return SYSTEM_ERROR_BAD_DATA;
         }
 
@@ -497,26 +453,219 @@ ssize_t TlvFile::find(uint16_t key, int index, uint16_t* dataSize) {
             continue;
         }
 
-        if (header.key == key) {
-            candidatePos = pos;
-            ++candidateIdx;
-            candidateSize = header.length;
-            if (index >= 0 && candidateIdx >= index) {
-                break;
+        const size_t recordSize = sizeof(TlvHeader) + header.length;
+        if (pos + recordSize > dataSize) {
+            break;
+        }
+
+        if (header.reserved & TLV_HEADER_FLAG_DELETED) {
+            uint32_t offset = 0;
+            if (header.length == sizeof(offset)) {
+                r = read((uint8_t*)&offset, sizeof(offset));
+                if (r < (ssize_t)sizeof(offset)) {
+                    return SYSTEM_ERROR_BAD_DATA;
+                }
+                for (int i = records_.size() - 1; i >= 0; --i) {
+                    if (records_[i].offset == offset) {
+                        recordsSize_ -= sizeof(TlvHeader) + records_[i].length;
+                        records_.removeAt(i);
+                        break;
+                    }
+                }
+            }
+        } else {
+            if (!records_.append({ (uint32_t)pos, header.key, header.length })) {
+                return SYSTEM_ERROR_NO_MEMORY;
+            }
+            recordsSize_ += recordSize;
+        }
+
+        pos += recordSize;
+    }
+
+    dataSize_ = dataSize;
+
+    return 0;
+}
+
+int TlvFile::find(uint16_t key, int index) {
+    int found = SYSTEM_ERROR_NOT_FOUND;
+    int n = 0;
+    for (int i = 0; i < records_.size(); ++i) {
+        if (records_[i].key == key) {
+            if (index < 0) {
+                found = i;
+            } else if (n++ == index) {
+                return i;
             }
         }
+    }
+
+    return found;
+}
+
+int TlvFile::appendRecord(uint16_t key, const uint8_t* value, uint16_t length, uint16_t flags) {
+    const bool deleted = flags & TLV_HEADER_FLAG_DELETED;
+    if (!deleted && !records_.reserve(records_.size() + 1)) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+
+    /* Overwrite the footer, it gets written after the new record */
+    ssize_t ret = seek(dataSize_);
+    if (ret < 0) {
+        return ret;
+    }
+
+    TlvHeader header = {};
+    header.magick = TLV_HEADER_MAGICK;
+    header.key = key;
+    header.length = length;
+    header.reserved = flags;
+
+    /* Write entry header */
+    ret = write((const uint8_t*)&header, sizeof(header));
+    if (ret < 0) {
+        return ret;
+    }
+    /* Write data */
+    if (length > 0) {
+        ret = write(value, length);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    const size_t recordSize = sizeof(TlvHeader) + length;
+    if (!deleted) {
+        records_.append({ (uint32_t)dataSize_, key, length });
+        recordsSize_ += recordSize;
+    }
+    dataSize_ += recordSize;
+
+    return 0;
+}
+
+int TlvFile::deleteRecords(uint16_t key, int index) {
+    int i = find(key, index);
+    if (i < 0) {
+        return i;
+    }
+
+    do {
+        /* Instead of rewriting the file, append a record that marks this one as deleted */
+        const Record rec = records_[i];
+        const uint32_t offset = rec.offset;
+        int ret = appendRecord(key, (const uint8_t*)&offset, sizeof(offset), TLV_HEADER_FLAG_DELETED);
+        if (ret < 0) {
+            return ret;
+        }
+        records_.removeAt(i);
+        recordsSize_ -= sizeof(TlvHeader) + rec.length;
+    } while (index < 0 && (i = find(key, index)) >= 0);
+
+    return 0;
+}
+
+int TlvFile::writeFooter() {
+    ssize_t ret = seek(dataSize_);
+    if (ret < 0) {
+        return ret;
+    }
+
+    FileFooter footer = {};
+    footer.magick = footerMagick();
+    footer.size = dataSize_;
+    ret = write((const uint8_t*)&footer, sizeof(footer));
+    if (ret < 0) {
+        return ret;
+    }
+
+    return 0;
+}
+
+uint32_t TlvFile::footerMagick() const {
+    /* Older versions of the firmware can read the file as long as it doesn't contain deletion
+     * and superseded records
+     */
+    return (dataSize_ == recordsSize_) ? TLV_FILE_MAGICK : TLV_FILE_LOG_MAGICK;
+}
 
-        pos += sizeof(TlvHeader) + header.length;
+int TlvFile::commit() {
+    if (updateDepth_ > 0) {
+        syncPending_ = true;
+        return 0;
     }
 
-    if ((index >= 0 && candidateIdx == index) || (index < 0 && candidateIdx >= 0)) {
-        if (dataSize) {
-            *dataSize = candidateSize;
+    return sync();
+}
+
+int TlvFile::compact() {
+    /* Copy the current records to a temporary file and replace the original file with it.
+     * Renaming is atomic so the file remains valid if the device resets while it's being compacted
+     */
+    const size_t pathLen = strlen(path_);
+    std::unique_ptr<char[]> tmpPath(new(std::nothrow) char[pathLen + sizeof(TEMP_FILE_SUFFIX)]);
+    if (!tmpPath) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    memcpy(tmpPath.get(), path_, pathLen);
+    memcpy(tmpPath.get() + pathLen, TEMP_FILE_SUFFIX, sizeof(TEMP_FILE_SUFFIX));
+
+    lfs_file_t f = {};
+    ssize_t ret = lfs_file_open(lfs(), &f, tmpPath.get(), LFS_O_CREAT | LFS_O_WRONLY | LFS_O_TRUNC);
+    if (ret < 0) {
+        return ret;
+    }
+
+    uint8_t buf[COPY_BUFFER_SIZE];
+    for (int i = 0; i < records_.size() && ret >= 0; ++i) {
+        const Record& rec = records_[i];
+        ret = seek(rec.offset);
+        size_t n = sizeof(TlvHeader) + rec.length;
+        while (n > 0 && ret >= 0) {
+            const size_t chunkSize = std::min(n, sizeof(buf));
+            ret = read(buf, chunkSize);
+            if (ret == (ssize_t)chunkSize) {
+                ret = lfs_file_write(lfs(), &f, buf, chunkSize);
+            } else if (ret >= 0) {
+                ret = SYSTEM_ERROR_BAD_DATA;
+            }
+            n -= chunkSize;
         }
-        return candidatePos;
     }
 
-    return SYSTEM_ERROR_NOT_FOUND;
+    if (ret >= 0) {
+        /* The compacted file contains only the current records */
+        FileFooter footer = {};
+        footer.magick = TLV_FILE_MAGICK;
+        footer.size = recordsSize_;
+        ret = lfs_file_write(lfs(), &f, &footer, sizeof(footer));
+    }
+
+    const int r = lfs_file_close(lfs(), &f);
+    if (ret >= 0) {
+        ret = r;
+    }
+    if (ret < 0) {
+        lfs_remove(lfs(), tmpPath.get());
+        return ret;
+    }
+
+    close();
+    ret = lfs_rename(lfs(), tmpPath.get(), path_);
+    const int r2 = open();
+
+    return (ret < 0) ? ret : r2;
+}
+
+int TlvFile::syncFile() {
+    int r = lfs_file_sync(lfs(), &file_);
+    if (r) {
+        /* Reopen just in case */
+        close();
+        open();
+    }
+    return r;
 }
 
 #endif /* HAL_PLATFORM_FILESYSTEM == 1 */
@@ -38,7 +38,8 @@ enum Ctrl: char {
     ACK = 0x06, // Acknowledgement
     NAK = 0x15, // Negative acknowledgement
     CAN = 0x18, // Cancel transmission
-    C = 0x43 // XMODEM-CRC/1K mode
+    C = 0x43, // XMODEM-CRC/1K mode
+    G = 0x47 // XMODEM-1K-G streaming mode
 };
 
 struct __attribute__((packed)) PacketHeader {
@@ -67,20 +68,31 @@ const unsigned MAX_EOT_RETRY_COUNT = 2;
 // Number of CAN bytes that need to be received in order to cancel the transfer
 const unsigned RECV_CAN_COUNT = 2;
 
+// Lookup table for the CRC-CCITT (XMODEM) algorithm
+struct Crc16Table {
+    uint16_t values[256];
+
+    constexpr Crc16Table() :
+            values() {
+        for (unsigned i = 0; i < 256; ++i) {
+            uint16_t crc = i << 8;
+            for (unsigned j = 0; j < 8; ++j) {
+                crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+            }
+            values[i] = crc;
+        }
+    }
+};
+
+constexpr Crc16Table CRC16_TABLE;
+
 // Calculates a 16-bit checksum using the CRC-CCITT (XMODEM) algorithm
 uint16_t calcCrc16(const char* data, size_t size) {
     uint16_t crc = 0;
     const auto end = data + size;
     while (data < end) {
         const uint8_t c = *data++;
-        crc ^= (uint16_t)c << 8;
-        for (unsigned i = 0; i < 8; ++i) {
-            if (crc & 0x8000) {
-                crc = (crc << 1) ^ 0x1021;
-            } else {
-                crc <<= 1;
-            }
-        }
+        crc = (crc << 8) ^ CRC16_TABLE.values[(crc >> 8) ^ c];
     }
     return crc;
 }
@@ -122,6 +134,7 @@ int XmodemSender::init(Stream* dest, InputStream* src, size_t size) {
     retryCount_ = 0;
     canCount_ = 0;
     packetNum_ = 1;
+    streaming_ = false;
     setState(State::RECV_NCG);
     LOG_DEBUG(TRACE, "Waiting for NCGbyte (0x%02x)", (unsigned char)Ctrl::C);
     return 0;
@@ -170,19 +183,27 @@ int XmodemSender::recvNcg() {
     char c = 0;
     const size_t n = CHECK(readCtrl(&c));
     if (n > 0) {
-        if (c != Ctrl::C) {
+        if (c != Ctrl::C && c != Ctrl::G) {
             LOG(ERROR, "Unexpected NCGbyte: 0x%02x", (unsigned char)c);
             return SYSTEM_ERROR_PROTOCOL;
         }
-        LOG_DEBUG(TRACE, "Received NCGbyte");
+        LOG_DEBUG(TRACE, "Received NCGbyte: 0x%02x", (unsigned char)c);
+        streaming_ = (c == Ctrl::G);
         setState((fileSize_ > 0) ? State::SEND_PACKET : State::SEND_EOT);
     }
-    return Status::RUNNING;    
+    return Status::RUNNING;
 }
 
 int XmodemSender::sendPacket() {
     CHECK(checkTimeout(SEND_TIMEOUT));
-    CHECK(readCtrl()); // Process CAN control bytes
+    char ctrl = 0;
+    const size_t n = CHECK(readCtrl(&ctrl)); // Process CAN control bytes
+    if (n > 0 && streaming_) {
+        // The streaming mode has no error recovery. A receiver that fails to receive a packet is
+        // expected to cancel the transfer
+        LOG(ERROR, "Unexpected control byte: 0x%02x", (unsigned char)ctrl);
+        return SYSTEM_ERROR_PROTOCOL;
+    }
     if (packetSize_ == 0) {
         PacketHeader h = {};
         size_t chunkSize = fileSize_ - fileOffs_;
@@ -218,8 +239,13 @@ int XmodemSender::sendPacket() {
     packetOffs_ += CHECK(destStrm_->write(buf_.get() + packetOffs_, packetSize_ - packetOffs_));
     if (packetOffs_ == packetSize_) {
         CHECK(destStrm_->flush());
-        LOG_DEBUG(TRACE, "Waiting for ACK");
-        setState(State::RECV_PACKET_ACK);
+        if (streaming_) {
+            // Packets are not acknowledged in the streaming mode
+            nextPacket();
+        } else {
+            LOG_DEBUG(TRACE, "Waiting for ACK");
+            setState(State::RECV_PACKET_ACK);
+        }
     }
     return Status::RUNNING;
 }
@@ -242,22 +268,26 @@ int XmodemSender::recvPacketAck() {
             return SYSTEM_ERROR_PROTOCOL;
         }
         LOG_DEBUG(TRACE, "Received ACK");
-        retryCount_ = 0;
-        fileOffs_ += std::min(fileSize_ - fileOffs_, packetSize_ - sizeof(PacketHeader) - sizeof(PacketCrc));
-        if (fileOffs_ < fileSize_) {
-            // Send next packet
-            packetSize_ = 0;
-            packetOffs_ = 0;
-            ++packetNum_;
-            setState(State::SEND_PACKET);
-        } else {
-            // Send "end of transmission" sequence
-            setState(State::SEND_EOT);
-        }
+        nextPacket();
     }
     return Status::RUNNING;
 }
 
+void XmodemSender::nextPacket() {
+    retryCount_ = 0;
+    fileOffs_ += std::min(fileSize_ - fileOffs_, packetSize_ - sizeof(PacketHeader) - sizeof(PacketCrc));
+    if (fileOffs_ < fileSize_) {
+        // Send next packet
+        packetSize_ = 0;
+        packetOffs_ = 0;
+        ++packetNum_;
+        setState(State::SEND_PACKET);
+    } else {
+        // Send "end of transmission" sequence
+        setState(State::SEND_EOT);
+    }
+}
+
 int XmodemSender::sendEot() {
     CHECK(checkTimeout(SEND_TIMEOUT));
     CHECK(readCtrl()); // Process CAN control bytes
@@ -305,7 +335,7 @@ int XmodemSender::readCtrl(char* c) {
             n = 0;
         } else {
             canCount_ = 0;
-            if (cc == Ctrl::C && state_ != State::RECV_NCG && packetNum_ == 1) {
+            if ((cc == Ctrl::C || cc == Ctrl::G) && state_ != State::RECV_NCG && packetNum_ == 1) {
                 // Ignore superfluous NCGbyte's received while we're sending the first packet
                 n = 0;
             } else if (c) {
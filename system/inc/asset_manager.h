@@ -26,9 +26,14 @@
 #include "ota_flash_hal.h"
 #include "stream.h"
 #include "asset_manager_api.h"
+#include "static_recursive_mutex.h"
 
 namespace particle {
 
+class AssetManifest;
+class AssetSeekIndex;
+class InflatorStream;
+
 class Asset {
 public:
     Asset() = default;
@@ -88,6 +93,7 @@ inline bool Asset::operator!=(const Asset& other) const {
 class AssetReader {
 public:
     AssetReader();
+    ~AssetReader();
 
     int init(InputStream* stream);
     int init(const char* filename);
@@ -100,9 +106,14 @@ public:
     size_t size() const;
     bool isCompressed() const;
     size_t originalSize() const;
+    uint32_t crc() const;
 
     int assetStream(InputStream*& stream);
 
+    // Creates a seek index for a compressed asset so that the asset stream can seek to an arbitrary
+    // position without decompressing the asset from the beginning
+    int createSeekIndex(size_t span = 0);
+
 private:
     int calculateCrc(uint32_t* crc);
 
@@ -113,9 +124,11 @@ private:
     bool compressed_;
     size_t size_;
     size_t originalSize_;
+    uint32_t crc_;
 
     std::unique_ptr<InputStream> fileStream_;
-    std::unique_ptr<InputStream> decompressorStream_;
+    std::unique_ptr<AssetSeekIndex> seekIndex_;
+    std::unique_ptr<InflatorStream> decompressorStream_;
     std::unique_ptr<InputStream> proxyStream_;
 
     size_t dataOffset_;
@@ -129,7 +142,7 @@ public:
     int init();
 
     const Vector<Asset>& requiredAssets() const;
-    const Vector<Asset>& availableAssets() const;
+    Vector<Asset> availableAssets() const;
     Vector<Asset> availableAndRequiredAssets() const;
     Vector<Asset> missingAssets() const;
     Vector<Asset> unusedAssets() const;
@@ -145,17 +158,26 @@ public:
 
     int formatStorage(bool remount = false);
 
+    // Performs the full validation of an asset that was reported as available based on the asset
+    // manifest, if it hasn't been validated since boot
+    int validateAsset(AssetReader* reader);
+
 protected:
-    AssetManager() = default;
+    AssetManager();
+    ~AssetManager();
 
 private:
     int parseRequiredAssets();
     int parseAvailableAssets();
     int clearUnusedAssets();
+    int invalidateAsset(const char* name);
 
 private:
     Vector<Asset> requiredAssets_;
     Vector<Asset> availableAssets_;
+    Vector<String> unvalidatedAssets_; // Available assets whose data hasn't been validated since boot
+    std::unique_ptr<AssetManifest> manifest_;
+    mutable StaticRecursiveMutex mutex_; // Protects the available assets and the manifest
     asset_manager_notify_hook hook_ = nullptr;
     void* hookContext_ = nullptr;
 };
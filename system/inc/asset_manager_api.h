@@ -343,7 +343,8 @@ int asset_manager_skip(asset_manager_stream* stream, size_t size, void* reserved
  * 
  * NOTE: This method can only be used to rewind (`offset` = 0), or essentially
  * skip using an absolute offset as opposed to `asset_manager_skip()` taking a relative
- * offset.
+ * offset, unless the asset is not compressed or has a seek index (see
+ * `asset_manager_create_seek_index()`).
  * 
  * @param stream Stream object
  * @param offset Offset within the stream to seek to (0 or an offset past the current stream read point)
@@ -360,6 +361,21 @@ int asset_manager_seek(asset_manager_stream* stream, size_t offset, void* reserv
  */
 void asset_manager_close(asset_manager_stream* stream, void* reserved);
 
+/**
+ * Create a seek index for a compressed asset.
+ *
+ * The index is stored alongside the asset and contains the decompressor state at regular intervals
+ * of the decompressed data. It allows seeking to an arbitrary position in the asset stream without
+ * decompressing the asset from the beginning. Creating the index requires decompressing the entire
+ * asset once. The stream is rewound to the beginning of the asset.
+ *
+ * @param stream Stream object
+ * @param span Distance between two restart points in the decompressed data, or 0 to use the default
+ * @param reserved Reserved (NULL)
+ * @return 0 on success or `system_error_t` error code
+ */
+int asset_manager_create_seek_index(asset_manager_stream* stream, size_t span, void* reserved);
+
 #if !defined(PARTICLE_USER_MODULE) || defined(PARTICLE_USE_UNSTABLE_API)
 /**
  * Format asset storage.
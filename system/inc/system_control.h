@@ -99,6 +99,7 @@ typedef enum ctrl_request_type {
     CTRL_REQUEST_CLOUD_GET_CONNECTION_STATUS = 300,
     CTRL_REQUEST_CLOUD_CONNECT = 301,
     CTRL_REQUEST_CLOUD_DISCONNECT = 302,
+    CTRL_REQUEST_CLOUD_GET_CONNECTION_TRACE = 303,
     // Network management
     CTRL_REQUEST_NETWORK_GET_INTERFACE_LIST = 400,
     CTRL_REQUEST_NETWORK_GET_INTERFACE = 401,
@@ -39,5 +39,6 @@ DYNALIB_FN(10, system_asset_manager, asset_manager_close, void(asset_manager_str
 // UNSTABLE
 DYNALIB_FN(11, system_asset_manager, asset_manager_format_storage, int(void*))
 // /UNSTABLE
+DYNALIB_FN(12, system_asset_manager, asset_manager_create_seek_index, int(asset_manager_stream*, size_t, void*))
 
 DYNALIB_END(system_asset_manager)
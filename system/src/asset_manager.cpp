@@ -20,11 +20,14 @@
 #if HAL_PLATFORM_ASSETS
 
 #include "asset_manager.h"
+#include "asset_manifest.h"
+#include "asset_seek_index.h"
 #include "storage_streams.h"
 #include "check.h"
 #include "ota_flash_hal_impl.h"
 #include "user_hal.h"
 #include <memory>
+#include <mutex>
 #include "logging.h"
 #include "flash_mal.h"
 #include "endian_util.h"
@@ -116,15 +119,22 @@ int parseAssetInfo(InputStream* stream, size_t size, Asset& asset) {
 
 } // anynomous
 
+AssetManager::AssetManager()
+        : manifest_(std::make_unique<AssetManifest>()) {
+}
+
+AssetManager::~AssetManager() = default;
+
 AssetManager& AssetManager::instance() {
     static AssetManager manager;
     return manager;
 }
 
 int AssetManager::init() {
+    std::lock_guard lock(mutex_);
     const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
     CHECK_TRUE(fs, SYSTEM_ERROR_FILE);
-    fs::FsLock lock(fs);
+    fs::FsLock fsLock(fs);
     CHECK(filesystem_mount(fs));
 
     // Best effort: reporting what we can
@@ -138,12 +148,14 @@ const Vector<Asset>& AssetManager::requiredAssets() const {
     return requiredAssets_;
 }
 
-const Vector<Asset>& AssetManager::availableAssets() const {
-    // No thread safety required here, these do not change during device runtime and a copy is returned
+Vector<Asset> AssetManager::availableAssets() const {
+    // An asset may become unavailable if it fails validation when it's opened
+    std::lock_guard lock(mutex_);
     return availableAssets_;
 }
 
 Vector<Asset> AssetManager::availableAndRequiredAssets() const {
+    std::lock_guard lock(mutex_);
     Vector<Asset> res;
     for (const auto& asset: availableAssets_) {
         if (requiredAssets_.contains(asset)) {
@@ -154,9 +166,10 @@ Vector<Asset> AssetManager::availableAndRequiredAssets() const {
 }
 
 Vector<Asset> AssetManager::missingAssets() const {
+    std::lock_guard lock(mutex_);
     Vector<Asset> missing;
-    for (const auto& asset: requiredAssets()) {
-        if (!availableAssets().contains(asset)) {
+    for (const auto& asset: requiredAssets_) {
+        if (!availableAssets_.contains(asset)) {
             // Best-effort
             missing.append(asset);
         }
@@ -171,9 +184,10 @@ Vector<Asset> AssetManager::missingAssets() const {
 }
 
 Vector<Asset> AssetManager::unusedAssets() const {
+    std::lock_guard lock(mutex_);
     Vector<Asset> unused;
-    for (const auto& asset: availableAssets()) {
-        if (!requiredAssets().contains(asset)) {
+    for (const auto& asset: availableAssets_) {
+        if (!requiredAssets_.contains(asset)) {
             // Best-effort
             unused.append(asset);
         }
@@ -253,10 +267,19 @@ int AssetManager::parseRequiredAssets() {
 int AssetManager::parseAvailableAssets() {
     auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
     CHECK_TRUE(fs, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(manifest_, SYSTEM_ERROR_NO_MEMORY);
 
     Vector<Asset> assets;
+    Vector<String> unvalidated;
+
+    std::lock_guard lock(mutex_);
+    const fs::FsLock fsLock(fs);
 
-    const fs::FsLock lock(fs);
+    if (manifest_->load(fs) < 0) {
+        LOG(WARN, "Failed to load asset manifest");
+        manifest_->clear();
+    }
+    bool manifestChanged = false;
 
     lfs_dir_t dir = {};
     CHECK_FS(lfs_dir_open(&fs->instance, &dir, "/"));
@@ -269,42 +292,148 @@ int AssetManager::parseAvailableAssets() {
         if (r != 1) {
             break;
         }
-        if (info.type == LFS_TYPE_DIR) {
+        if (info.type == LFS_TYPE_DIR || AssetManifest::isManifestFile(info.name)) {
             continue;
         }
-        AssetReader reader;
-        r = reader.init(info.name);
-        if (r) {
-            LOG(WARN, "Failed to open asset %s", info.name);
-        } else {
-            reader.validate();
+        Asset asset;
+        uint32_t crc = 0;
+        bool valid = false;
+        {
+            AssetReader reader;
+            r = reader.init(info.name);
+            if (r) {
+                LOG(WARN, "Failed to open asset %s", info.name);
+            } else {
+                // Assets that have been validated before are not read in full here if their size, hash
+                // and module CRC match the manifest. They get validated when they're opened for the
+                // first time
+                auto entry = manifest_->find(info.name);
+                if (entry && entry->asset.storageSize() == info.size && reader.validate(false /* full */) == 0 &&
+                        reader.crc() == entry->crc && reader.asset() == entry->asset) {
+                    if (!assets.append(entry->asset) || !unvalidated.append(entry->asset.name())) {
+                        LOG(WARN, "Failed to add asset %s to the list of available", info.name);
+                    }
+                    continue;
+                }
+                reader.validate();
+            }
+            if (reader.isValid() && reader.size() == info.size) {
+                asset = reader.asset();
+                crc = reader.crc();
+                valid = true;
+            }
+            // The file is closed before it can be removed
         }
-        if (reader.isValid() && reader.size() == info.size) {
-            if (!assets.append(reader.asset())) {
+        if (valid) {
+            if (!assets.append(asset)) {
                 LOG(WARN, "Failed to add asset %s to the list of available", info.name);
             }
+            if (manifest_->set({ asset, crc }) == 0) {
+                manifestChanged = true;
+            }
         } else {
             LOG(WARN, "Invalid asset %s, removing", info.name);
             lfs_remove(&fs->instance, info.name);
+            AssetSeekIndex::remove(fs, info.name);
+            if (manifest_->remove(info.name)) {
+                manifestChanged = true;
+            }
+        }
+    }
+
+    // Remove the entries for the assets that no longer exist
+    for (int i = 0; i < manifest_->entries().size();) {
+        const auto& name = manifest_->entries().at(i).asset.name();
+        bool found = false;
+        for (const auto& asset: assets) {
+            if (asset.name() == name) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            manifest_->remove(name.c_str());
+            manifestChanged = true;
+        } else {
+            ++i;
         }
     }
-    
+    if (manifestChanged && manifest_->save(fs) < 0) {
+        LOG(WARN, "Failed to save asset manifest");
+    }
+
     availableAssets_ = assets;
+    unvalidatedAssets_ = std::move(unvalidated);
     return 0;
 }
 
 int AssetManager::clearUnusedAssets() {
     auto unused = unusedAssets();
+    if (unused.isEmpty()) {
+        return 0;
+    }
+    std::lock_guard lock(mutex_);
+    auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    CHECK_TRUE(fs, SYSTEM_ERROR_INVALID_STATE);
+    const fs::FsLock fsLock(fs);
+    // Update the manifest first so that it never refers to a removed file
+    for (const auto& asset: unused) {
+        manifest_->remove(asset.name().c_str());
+    }
+    CHECK(manifest_->save(fs));
     for (const auto& asset: unused) {
         LOG(INFO, "Removing unused asset %s (hash=%s)", asset.name().c_str(), asset.hash().toString().c_str());
-        auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
-        CHECK_TRUE(fs, SYSTEM_ERROR_INVALID_STATE);
-        const fs::FsLock lock(fs);
         CHECK_FS(lfs_remove(&fs->instance, asset.name().c_str()));
+        CHECK(AssetSeekIndex::remove(fs, asset.name().c_str()));
     }
     return 0;
 }
 
+int AssetManager::invalidateAsset(const char* name) {
+    std::lock_guard lock(mutex_);
+    auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    CHECK_TRUE(fs, SYSTEM_ERROR_INVALID_STATE);
+    const fs::FsLock fsLock(fs);
+    // The asset file may still be open so it's not removed right away. Without a manifest entry,
+    // the file will be fully validated and removed on next boot
+    if (manifest_->remove(name)) {
+        CHECK(manifest_->save(fs));
+    }
+    for (int i = 0; i < availableAssets_.size(); ++i) {
+        if (availableAssets_.at(i).name() == name) {
+            availableAssets_.removeAt(i);
+            break;
+        }
+    }
+    unvalidatedAssets_.removeOne(String(name));
+    return 0;
+}
+
+int AssetManager::validateAsset(AssetReader* reader) {
+    CHECK_TRUE(reader && reader->isValid(), SYSTEM_ERROR_INVALID_ARGUMENT);
+    const auto asset = reader->asset();
+    uint32_t crc = 0;
+    {
+        std::lock_guard lock(mutex_);
+        if (!unvalidatedAssets_.contains(asset.name())) {
+            return 0;
+        }
+        auto entry = manifest_->find(asset.name().c_str());
+        crc = entry ? entry->crc : 0;
+    }
+    // The asset data is read without holding the lock
+    LOG(INFO, "Validating asset %s", asset.name().c_str());
+    const int r = reader->validate(true /* full */);
+    std::lock_guard lock(mutex_);
+    if (r < 0 || reader->crc() != crc) {
+        LOG(ERROR, "Asset %s is corrupted", asset.name().c_str());
+        invalidateAsset(asset.name().c_str());
+        return (r < 0) ? r : SYSTEM_ERROR_BAD_DATA;
+    }
+    unvalidatedAssets_.removeOne(asset.name());
+    return 0;
+}
+
 int AssetManager::storeAsset(const hal_module_t* module) {
     CHECK_TRUE(module, SYSTEM_ERROR_INVALID_ARGUMENT);
 
@@ -313,12 +442,14 @@ int AssetManager::storeAsset(const hal_module_t* module) {
             module->module_info_offset);
     AssetReader reader;
     CHECK(reader.init(&stream));
-    CHECK(reader.validate());
+    // The module CRC is calculated while the data is being copied so that it's only read once
+    CHECK(reader.validate(false /* full */));
     CHECK_TRUE(reader.isValid(), SYSTEM_ERROR_BAD_DATA);
 
     auto info = reader.asset();
     LOG(INFO, "Storing asset %s (hash=%s) size=%u original size=%u", info.name().c_str(), info.hash().toString().c_str(), reader.size(), reader.originalSize());
 
+    std::lock_guard lock(mutex_);
     CHECK(clearUnusedAssets());
 
     CHECK(stream.seek(0));
@@ -326,20 +457,29 @@ int AssetManager::storeAsset(const hal_module_t* module) {
 
     const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
     CHECK_TRUE(fs, SYSTEM_ERROR_FILE);
-    fs::FsLock lock(fs);
+    fs::FsLock fsLock(fs);
 
     // Unmount and remount in order to invalidate access to any of the currently opened assets
     filesystem_unmount(fs);
     availableAssets_.clear();
+    unvalidatedAssets_.clear();
     CHECK(filesystem_mount(fs));
 
+    // Remove the manifest entry before modifying the file
+    if (manifest_->remove(info.name().c_str())) {
+        CHECK(manifest_->save(fs));
+    }
+
     lfs_file_t file = {};
     lfs_remove(&fs->instance, info.name().c_str());
+    CHECK(AssetSeekIndex::remove(fs, info.name().c_str()));
     CHECK_FS(lfs_file_open(&fs->instance, &file, info.name().c_str(), LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND));
-    SCOPE_GUARD({     
+    NAMED_SCOPE_GUARD(fileGuard, {
         lfs_file_close(&fs->instance, &file);
     });
 
+    uint32_t crc = 0;
+    size_t crcLeft = reader.size() - sizeof(uint32_t);
     while (stream.availForRead() > 0) {
         int read = stream.read(tmp, sizeof(tmp));
         if (read < 0 && read != SYSTEM_ERROR_END_OF_STREAM) {
@@ -348,8 +488,25 @@ int AssetManager::storeAsset(const hal_module_t* module) {
         if (read == SYSTEM_ERROR_END_OF_STREAM) {
             break;
         }
+        const size_t crcSize = std::min((size_t)read, crcLeft);
+        if (crcSize > 0) {
+            crc = Compute_CRC32((const uint8_t*)tmp, crcSize, &crc);
+            crcLeft -= crcSize;
+        }
         CHECK_FS(lfs_file_write(&fs->instance, &file, tmp, (size_t)read));
     }
+    fileGuard.dismiss();
+    CHECK_FS(lfs_file_close(&fs->instance, &file));
+
+    if (crcLeft > 0 || crc != reader.crc()) {
+        LOG(ERROR, "Asset %s is corrupted", info.name().c_str());
+        lfs_remove(&fs->instance, info.name().c_str());
+        return SYSTEM_ERROR_BAD_DATA;
+    }
+
+    // The stored data has been validated above so the asset doesn't need to be validated again on boot
+    CHECK(manifest_->set({ info, crc }));
+    CHECK(manifest_->save(fs));
 
     CHECK(setConsumerState(ASSET_MANAGER_CONSUMER_STATE_WANT));
     return 0;
@@ -404,12 +561,15 @@ int AssetManager::prepareForOta(size_t size, unsigned flags, int moduleFunction)
 }
 
 int AssetManager::formatStorage(bool remount) {
+    std::lock_guard lock(mutex_);
     const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
     CHECK_TRUE(fs, SYSTEM_ERROR_FILE);
-    fs::FsLock lock(fs);
+    fs::FsLock fsLock(fs);
     filesystem_unmount(fs);
     filesystem_invalidate(fs);
     availableAssets_.clear();
+    unvalidatedAssets_.clear();
+    manifest_->clear();
     CHECK(filesystem_mount(fs));
     return 0;
 }
@@ -421,10 +581,13 @@ AssetReader::AssetReader()
           compressed_(false),
           size_(0),
           originalSize_(0),
+          crc_(0),
           dataOffset_(0),
           dataSize_(0) {
 }
 
+AssetReader::~AssetReader() = default;
+
 int AssetReader::init(const char* filename) {
     auto stream = std::make_unique<FileInputStream>();
     CHECK_TRUE(stream.get(), SYSTEM_ERROR_NO_MEMORY);
@@ -442,6 +605,9 @@ int AssetReader::init(InputStream* stream) {
 int AssetReader::validate(bool full) {
     // Sanity checks
     CHECK_TRUE(stream_, SYSTEM_ERROR_BAD_DATA);
+    // The reader may have been validated before
+    valid_ = false;
+    CHECK(stream_->seek(0));
     CHECK_TRUE(stream_->availForRead() > (int)(sizeof(module_info_t) + sizeof(compressed_module_header) + sizeof(module_info_suffix_base_t) + sizeof(uint32_t)),
             SYSTEM_ERROR_NOT_ENOUGH_DATA);
     size_t moduleSize = CHECK(stream_->availForRead());
@@ -488,6 +654,7 @@ int AssetReader::validate(bool full) {
     CHECK(parseAssetInfo(stream_, suffix.size - sizeof(module_info_suffix_base_t), asset));
     valid_ = true;
     compressed_ = compressed;
+    crc_ = bigEndianToNative(crc);
     if (compressed) {
         dataOffset_ = sizeof(module_info_t) + compHeader.size;
     }
@@ -532,6 +699,10 @@ size_t AssetReader::originalSize() const {
     return originalSize_;
 }
 
+uint32_t AssetReader::crc() const {
+    return crc_;
+}
+
 int AssetReader::assetStream(InputStream*& stream) {
     CHECK_TRUE(isValid(), SYSTEM_ERROR_INVALID_STATE);
 
@@ -549,6 +720,13 @@ int AssetReader::assetStream(InputStream*& stream) {
         auto stream = std::make_unique<InflatorStream>(proxyStream_.get(), originalSize_);
         CHECK_TRUE(stream, SYSTEM_ERROR_NO_MEMORY);
         CHECK(stream->init());
+        // Use the seek index of the asset if there's one
+        auto index = std::make_unique<AssetSeekIndex>();
+        const int stateSize = stream->stateSize();
+        if (index && stateSize > 0 && index->load(asset_.name().c_str(), crc_, stateSize) == 0) {
+            stream->seekIndex(index.get());
+            seekIndex_ = std::move(index);
+        }
         decompressorStream_ = std::move(stream);
     }
 
@@ -556,6 +734,33 @@ int AssetReader::assetStream(InputStream*& stream) {
     return 0;
 }
 
+int AssetReader::createSeekIndex(size_t span) {
+    InputStream* stream = nullptr;
+    CHECK(assetStream(stream));
+    if (!isCompressed()) {
+        // Uncompressed assets support random access
+        return 0;
+    }
+    if (!span) {
+        span = AssetSeekIndex::DEFAULT_SPAN;
+    }
+    decompressorStream_->seekIndex(nullptr);
+    seekIndex_.reset();
+    auto index = std::make_unique<AssetSeekIndex>();
+    CHECK_TRUE(index, SYSTEM_ERROR_NO_MEMORY);
+    const int stateSize = CHECK(decompressorStream_->stateSize());
+    CHECK(index->create(asset_.name().c_str(), crc_, stateSize, span));
+    NAMED_SCOPE_GUARD(sg, {
+        decompressorStream_->seekIndex(nullptr);
+    });
+    CHECK(decompressorStream_->buildSeekIndex(index.get()));
+    CHECK(index->commit());
+    sg.dismiss();
+    seekIndex_ = std::move(index);
+    LOG(INFO, "Created seek index for asset %s", asset_.name().c_str());
+    return 0;
+}
+
 } // particle
 
 #endif // HAL_PLATFORM_ASSETS
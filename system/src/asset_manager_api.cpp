@@ -117,6 +117,7 @@ int asset_manager_open(asset_manager_stream** stream, const asset_manager_asset*
     CHECK(reader->validate(false));
     CHECK_TRUE(reader->isValid(), SYSTEM_ERROR_NOT_FOUND);
     CHECK_TRUE(reader->asset() == a, SYSTEM_ERROR_NOT_FOUND);
+    CHECK(AssetManager::instance().validateAsset(reader.get()));
     InputStream* assetStream;
     CHECK(reader->assetStream(assetStream));
     *stream = (asset_manager_stream*)reader.get();
@@ -165,6 +166,12 @@ int asset_manager_seek(asset_manager_stream* stream, size_t offset, void* reserv
     return assetStream->seek(offset);
 }
 
+int asset_manager_create_seek_index(asset_manager_stream* stream, size_t span, void* reserved) {
+    CHECK_TRUE(stream, SYSTEM_ERROR_INVALID_ARGUMENT);
+    auto reader = (AssetReader*)(stream);
+    return reader->createSeekIndex(span);
+}
+
 void asset_manager_close(asset_manager_stream* stream, void* reserved) {
     if (!stream) {
         return;
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2023 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_ASSETS
+
+#include "asset_manifest.h"
+#include "check.h"
+#include "logging.h"
+#include "flash_mal.h"
+
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+const char MANIFEST_FILE[] = ".assets";
+const char MANIFEST_TEMP_FILE[] = ".assets.tmp";
+
+const uint32_t MANIFEST_MAGIC = 0x464d5341; // "ASMF"
+const uint16_t MANIFEST_VERSION = 1;
+
+// Maximum size of the manifest file
+const size_t MAX_MANIFEST_SIZE = 16 * 1024;
+
+struct __attribute__((packed)) ManifestHeader {
+    uint32_t magic; // MANIFEST_MAGIC
+    uint16_t version; // MANIFEST_VERSION
+    uint16_t count; // Number of entries
+    uint32_t size; // Size of the entry data
+    uint32_t crc; // CRC-32 of the entry data
+};
+
+// Each entry header is followed by the hash and name data
+struct __attribute__((packed)) ManifestEntryHeader {
+    uint32_t storageSize; // Size of the asset file
+    uint32_t originalSize; // Size of the asset data
+    uint32_t crc; // CRC-32 of the asset module
+    int8_t hashType; // Hash type
+    uint8_t hashSize; // Size of the hash data
+    uint8_t nameSize; // Size of the name
+    uint8_t reserved;
+};
+
+uint32_t calcCrc(const char* data, size_t size) {
+    uint32_t crc = 0;
+    return Compute_CRC32((const uint8_t*)data, size, &crc);
+}
+
+} // anonymous
+
+int AssetManifest::load(filesystem_t* fs) {
+    clear();
+    lfs_info info = {};
+    int r = lfs_stat(&fs->instance, MANIFEST_FILE, &info);
+    if (r == LFS_ERR_NOENT) {
+        return 0;
+    }
+    CHECK_FS(r);
+    if (info.size < sizeof(ManifestHeader) || info.size > MAX_MANIFEST_SIZE) {
+        LOG(WARN, "Invalid asset manifest size: %u", (unsigned)info.size);
+        return 0;
+    }
+    Buffer buf(info.size);
+    CHECK_TRUE(buf.size() == info.size, SYSTEM_ERROR_NO_MEMORY);
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(&fs->instance, &file, MANIFEST_FILE, LFS_O_RDONLY));
+    r = lfs_file_read(&fs->instance, &file, buf.data(), buf.size());
+    lfs_file_close(&fs->instance, &file);
+    CHECK_FS(r);
+    if ((size_t)r != buf.size() || parse(buf.data(), buf.size()) < 0) {
+        LOG(WARN, "Asset manifest is corrupted");
+        clear();
+    }
+    return 0;
+}
+
+int AssetManifest::save(filesystem_t* fs) {
+    if (entries_.isEmpty()) {
+        const int r = lfs_remove(&fs->instance, MANIFEST_FILE);
+        if (r != LFS_ERR_NOENT) {
+            CHECK_FS(r);
+        }
+        return 0;
+    }
+    size_t dataSize = 0;
+    for (const auto& e: entries_) {
+        dataSize += sizeof(ManifestEntryHeader) + e.asset.hash().hash().size() + e.asset.name().length();
+    }
+    const size_t size = sizeof(ManifestHeader) + dataSize;
+    CHECK_TRUE(size <= MAX_MANIFEST_SIZE, SYSTEM_ERROR_TOO_LARGE);
+    Buffer buf(size);
+    CHECK_TRUE(buf.size() == size, SYSTEM_ERROR_NO_MEMORY);
+    char* p = buf.data() + sizeof(ManifestHeader);
+    for (const auto& e: entries_) {
+        const auto& hash = e.asset.hash();
+        const auto& name = e.asset.name();
+        ManifestEntryHeader h = {};
+        h.storageSize = e.asset.storageSize();
+        h.originalSize = e.asset.size();
+        h.crc = e.crc;
+        h.hashType = hash.type();
+        h.hashSize = hash.hash().size();
+        h.nameSize = name.length();
+        memcpy(p, &h, sizeof(h));
+        p += sizeof(h);
+        memcpy(p, hash.hash().data(), h.hashSize);
+        p += h.hashSize;
+        memcpy(p, name.c_str(), h.nameSize);
+        p += h.nameSize;
+    }
+    ManifestHeader h = {};
+    h.magic = MANIFEST_MAGIC;
+    h.version = MANIFEST_VERSION;
+    h.count = entries_.size();
+    h.size = dataSize;
+    h.crc = calcCrc(buf.data() + sizeof(ManifestHeader), dataSize);
+    memcpy(buf.data(), &h, sizeof(h));
+    // Write the new manifest to a temporary file and then replace the original file with it
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(&fs->instance, &file, MANIFEST_TEMP_FILE, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC));
+    int r = lfs_file_write(&fs->instance, &file, buf.data(), buf.size());
+    if (r >= 0 && (size_t)r != buf.size()) {
+        r = LFS_ERR_NOSPC;
+    }
+    const int r2 = lfs_file_close(&fs->instance, &file);
+    if (r >= 0) {
+        r = r2;
+    }
+    if (r < 0) {
+        lfs_remove(&fs->instance, MANIFEST_TEMP_FILE);
+        return filesystem_to_system_error(r);
+    }
+    CHECK_FS(lfs_rename(&fs->instance, MANIFEST_TEMP_FILE, MANIFEST_FILE));
+    return 0;
+}
+
+const AssetManifest::Entry* AssetManifest::find(const char* name) const {
+    for (const auto& e: entries_) {
+        if (e.asset.name() == name) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+int AssetManifest::set(Entry entry) {
+    CHECK_TRUE(entry.asset.isValid(), SYSTEM_ERROR_INVALID_ARGUMENT);
+    CHECK_TRUE(entry.asset.name().length() <= 255 && entry.asset.hash().hash().size() <= 255, SYSTEM_ERROR_INVALID_ARGUMENT);
+    for (auto& e: entries_) {
+        if (e.asset.name() == entry.asset.name()) {
+            e = std::move(entry);
+            return 0;
+        }
+    }
+    CHECK_TRUE(entries_.append(std::move(entry)), SYSTEM_ERROR_NO_MEMORY);
+    return 0;
+}
+
+bool AssetManifest::remove(const char* name) {
+    for (int i = 0; i < entries_.size(); ++i) {
+        if (entries_.at(i).asset.name() == name) {
+            entries_.removeAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AssetManifest::isManifestFile(const char* name) {
+    return !strcmp(name, MANIFEST_FILE) || !strcmp(name, MANIFEST_TEMP_FILE);
+}
+
+int AssetManifest::parse(const char* data, size_t size) {
+    ManifestHeader h = {};
+    memcpy(&h, data, sizeof(h));
+    CHECK_TRUE(h.magic == MANIFEST_MAGIC && h.version == MANIFEST_VERSION, SYSTEM_ERROR_BAD_DATA);
+    CHECK_TRUE(h.size == size - sizeof(h), SYSTEM_ERROR_BAD_DATA);
+    data += sizeof(h);
+    size -= sizeof(h);
+    CHECK_TRUE(h.crc == calcCrc(data, size), SYSTEM_ERROR_BAD_DATA);
+    Vector<Entry> entries;
+    CHECK_TRUE(entries.reserve(h.count), SYSTEM_ERROR_NO_MEMORY);
+    for (unsigned i = 0; i < h.count; ++i) {
+        ManifestEntryHeader eh = {};
+        CHECK_TRUE(size >= sizeof(eh), SYSTEM_ERROR_BAD_DATA);
+        memcpy(&eh, data, sizeof(eh));
+        data += sizeof(eh);
+        size -= sizeof(eh);
+        CHECK_TRUE(size >= (size_t)eh.hashSize + eh.nameSize && eh.nameSize > 0, SYSTEM_ERROR_BAD_DATA);
+        const AssetHash hash(data, eh.hashSize, (AssetHash::Type)eh.hashType);
+        data += eh.hashSize;
+        const String name(data, eh.nameSize);
+        data += eh.nameSize;
+        size -= eh.hashSize + eh.nameSize;
+        Entry e = { Asset(name.c_str(), hash, eh.originalSize, eh.storageSize), eh.crc };
+        CHECK_TRUE(e.asset.isValid(), SYSTEM_ERROR_BAD_DATA);
+        CHECK_TRUE(entries.append(std::move(e)), SYSTEM_ERROR_NO_MEMORY);
+    }
+    CHECK_TRUE(size == 0, SYSTEM_ERROR_BAD_DATA);
+    entries_ = std::move(entries);
+    return 0;
+}
+
+} // particle
+
+#endif // HAL_PLATFORM_ASSETS
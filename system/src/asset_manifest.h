@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2023 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_ASSETS
+
+#include "asset_manager.h"
+#include "filesystem.h"
+
+namespace particle {
+
+/**
+ * Manifest of the validated assets.
+ *
+ * The manifest is stored in the asset filesystem and lists the assets that have been fully
+ * validated, along with their sizes, hashes and module checksums. An asset whose file size matches
+ * its manifest entry doesn't need to be read in full to be reported as available on boot.
+ *
+ * An entry is removed from the manifest before its asset file is modified and added back once the
+ * file has been written and validated, so a manifest entry never refers to a partially written file.
+ *
+ * All methods expect the caller to hold the filesystem lock.
+ */
+class AssetManifest {
+public:
+    /**
+     * Manifest entry.
+     */
+    struct Entry {
+        Asset asset; // Asset info
+        uint32_t crc; // CRC-32 of the asset module
+    };
+
+    /**
+     * Load the manifest from the filesystem.
+     *
+     * If the manifest file is missing or corrupted, the manifest is cleared.
+     *
+     * @return 0 on success, or a negative result code in case of an error.
+     */
+    int load(filesystem_t* fs);
+    /**
+     * Save the manifest to the filesystem.
+     *
+     * The manifest is written to a temporary file which then replaces the original file.
+     *
+     * @return 0 on success, or a negative result code in case of an error.
+     */
+    int save(filesystem_t* fs);
+
+    /**
+     * Find an entry by asset name.
+     *
+     * @return Entry or `nullptr` if the entry is not found.
+     */
+    const Entry* find(const char* name) const;
+    /**
+     * Add or replace an entry.
+     *
+     * @return 0 on success, or a negative result code in case of an error.
+     */
+    int set(Entry entry);
+    /**
+     * Remove an entry.
+     *
+     * @return `true` if the entry was removed, or `false` if it was not found.
+     */
+    bool remove(const char* name);
+    /**
+     * Remove all entries.
+     */
+    void clear();
+
+    /**
+     * Get all entries.
+     */
+    const Vector<Entry>& entries() const;
+
+    /**
+     * Returns `true` if a file in the asset filesystem belongs to the manifest.
+     */
+    static bool isManifestFile(const char* name);
+
+private:
+    Vector<Entry> entries_;
+
+    int parse(const char* data, size_t size);
+};
+
+inline const Vector<AssetManifest::Entry>& AssetManifest::entries() const {
+    return entries_;
+}
+
+inline void AssetManifest::clear() {
+    entries_.clear();
+}
+
+} // particle
+
+#endif // HAL_PLATFORM_ASSETS
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2023 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_ASSETS
+
+#include "asset_seek_index.h"
+#include "check.h"
+#include "scope_guard.h"
+
+namespace particle {
+
+namespace {
+
+const char INDEX_DIR[] = "/.index";
+const char TEMP_FILE_SUFFIX[] = ".tmp";
+
+const uint32_t INDEX_MAGIC = 0x58495341; // "ASIX"
+const uint16_t INDEX_VERSION = 1;
+
+struct __attribute__((packed)) IndexHeader {
+    uint32_t magic; // INDEX_MAGIC
+    uint16_t version; // INDEX_VERSION
+    uint16_t reserved;
+    uint32_t crc; // Module checksum of the asset
+    uint32_t span; // Distance between two checkpoints
+    uint32_t stateSize; // Size of the decompressor state
+};
+
+// Each entry header is followed by the decompressor state
+struct __attribute__((packed)) IndexEntryHeader {
+    uint32_t offset; // Offset in the decompressed data
+    uint32_t compressedOffset; // Offset in the compressed data
+};
+
+struct FileContext {
+    filesystem_t* fs;
+    lfs_file_t* file;
+};
+
+String indexPath(const char* name) {
+    return String(INDEX_DIR) + '/' + name;
+}
+
+int readFile(char* data, size_t size, void* userData) {
+    const auto ctx = (FileContext*)userData;
+    return CHECK_FS(lfs_file_read(&ctx->fs->instance, ctx->file, data, size));
+}
+
+int writeFile(const char* data, size_t size, void* userData) {
+    const auto ctx = (FileContext*)userData;
+    return CHECK_FS(lfs_file_write(&ctx->fs->instance, ctx->file, data, size));
+}
+
+} // anonymous
+
+AssetSeekIndex::AssetSeekIndex()
+        : fs_(nullptr),
+          file_(),
+          crc_(0),
+          stateSize_(0),
+          span_(0),
+          fileOpen_(false) {
+}
+
+AssetSeekIndex::~AssetSeekIndex() {
+    close();
+}
+
+int AssetSeekIndex::load(const char* name, uint32_t crc, size_t stateSize) {
+    close();
+    checkpoints_.clear();
+    fs_ = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    CHECK_TRUE(fs_, SYSTEM_ERROR_INVALID_STATE);
+    const auto path = indexPath(name);
+    const fs::FsLock lock(fs_);
+    lfs_info info = {};
+    CHECK_FS(lfs_stat(&fs_->instance, path.c_str(), &info));
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(&fs_->instance, &file, path.c_str(), LFS_O_RDONLY));
+    SCOPE_GUARD({
+        lfs_file_close(&fs_->instance, &file);
+    });
+    IndexHeader h = {};
+    int r = CHECK_FS(lfs_file_read(&fs_->instance, &file, &h, sizeof(h)));
+    CHECK_TRUE(r == sizeof(h) && h.magic == INDEX_MAGIC && h.version == INDEX_VERSION && h.span > 0, SYSTEM_ERROR_BAD_DATA);
+    // The index is not usable if it was created for a different asset or version of the decompressor
+    CHECK_TRUE(h.crc == crc && h.stateSize == stateSize, SYSTEM_ERROR_NOT_FOUND);
+    const size_t entrySize = sizeof(IndexEntryHeader) + stateSize;
+    CHECK_TRUE(info.size >= sizeof(h) && (info.size - sizeof(h)) % entrySize == 0, SYSTEM_ERROR_BAD_DATA);
+    const size_t count = (info.size - sizeof(h)) / entrySize;
+    Vector<Checkpoint> checkpoints;
+    CHECK_TRUE(checkpoints.reserve(count), SYSTEM_ERROR_NO_MEMORY);
+    for (size_t i = 0; i < count; ++i) {
+        CHECK_FS(lfs_file_seek(&fs_->instance, &file, sizeof(h) + i * entrySize, LFS_SEEK_SET));
+        IndexEntryHeader eh = {};
+        r = CHECK_FS(lfs_file_read(&fs_->instance, &file, &eh, sizeof(eh)));
+        CHECK_TRUE(r == sizeof(eh), SYSTEM_ERROR_BAD_DATA);
+        CHECK_TRUE(checkpoints.isEmpty() || eh.offset > checkpoints.last().offset, SYSTEM_ERROR_BAD_DATA);
+        checkpoints.append({ eh.offset, eh.compressedOffset });
+    }
+    checkpoints_ = std::move(checkpoints);
+    name_ = name;
+    crc_ = crc;
+    stateSize_ = stateSize;
+    span_ = h.span;
+    return 0;
+}
+
+int AssetSeekIndex::create(const char* name, uint32_t crc, size_t stateSize, size_t span) {
+    CHECK_TRUE(name && stateSize > 0 && span > 0, SYSTEM_ERROR_INVALID_ARGUMENT);
+    close();
+    checkpoints_.clear();
+    fs_ = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    CHECK_TRUE(fs_, SYSTEM_ERROR_INVALID_STATE);
+    name_ = name;
+    const auto tempPath = indexPath(name) + TEMP_FILE_SUFFIX;
+    const fs::FsLock lock(fs_);
+    const int r = lfs_mkdir(&fs_->instance, INDEX_DIR);
+    if (r != LFS_ERR_EXIST) {
+        CHECK_FS(r);
+    }
+    CHECK_FS(lfs_file_open(&fs_->instance, &file_, tempPath.c_str(), LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC));
+    fileOpen_ = true;
+    NAMED_SCOPE_GUARD(sg, {
+        close();
+    });
+    IndexHeader h = {};
+    h.magic = INDEX_MAGIC;
+    h.version = INDEX_VERSION;
+    h.crc = crc;
+    h.span = span;
+    h.stateSize = stateSize;
+    const int n = CHECK_FS(lfs_file_write(&fs_->instance, &file_, &h, sizeof(h)));
+    CHECK_TRUE(n == sizeof(h), SYSTEM_ERROR_IO);
+    sg.dismiss();
+    crc_ = crc;
+    stateSize_ = stateSize;
+    span_ = span;
+    return 0;
+}
+
+int AssetSeekIndex::commit() {
+    CHECK_TRUE(fileOpen_, SYSTEM_ERROR_INVALID_STATE);
+    const auto path = indexPath(name_.c_str());
+    const auto tempPath = path + TEMP_FILE_SUFFIX;
+    const fs::FsLock lock(fs_);
+    fileOpen_ = false;
+    int r = lfs_file_close(&fs_->instance, &file_);
+    if (r >= 0) {
+        r = lfs_rename(&fs_->instance, tempPath.c_str(), path.c_str());
+    }
+    if (r < 0) {
+        lfs_remove(&fs_->instance, tempPath.c_str());
+        return filesystem_to_system_error(r);
+    }
+    return 0;
+}
+
+int AssetSeekIndex::find(size_t offset, Checkpoint* checkpoint) {
+    // Checkpoints are sorted by offset
+    int index = -1;
+    for (int i = 0; i < checkpoints_.size() && checkpoints_.at(i).offset <= offset; ++i) {
+        index = i;
+    }
+    CHECK_TRUE(index >= 0, SYSTEM_ERROR_NOT_FOUND);
+    *checkpoint = checkpoints_.at(index);
+    return index;
+}
+
+int AssetSeekIndex::restore(int index, inflate_ctx* ctx) {
+    CHECK_TRUE(index >= 0 && index < checkpoints_.size(), SYSTEM_ERROR_INVALID_ARGUMENT);
+    CHECK_FALSE(fileOpen_, SYSTEM_ERROR_INVALID_STATE);
+    const auto path = indexPath(name_.c_str());
+    const fs::FsLock lock(fs_);
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(&fs_->instance, &file, path.c_str(), LFS_O_RDONLY));
+    SCOPE_GUARD({
+        lfs_file_close(&fs_->instance, &file);
+    });
+    const size_t entrySize = sizeof(IndexEntryHeader) + stateSize_;
+    CHECK_FS(lfs_file_seek(&fs_->instance, &file, sizeof(IndexHeader) + index * entrySize + sizeof(IndexEntryHeader), LFS_SEEK_SET));
+    FileContext fileCtx = { fs_, &file };
+    CHECK(inflate_restore_state(ctx, readFile, &fileCtx));
+    return 0;
+}
+
+int AssetSeekIndex::add(const Checkpoint& checkpoint, inflate_ctx* ctx) {
+    CHECK_TRUE(fileOpen_, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(checkpoints_.isEmpty() || checkpoint.offset > checkpoints_.last().offset, SYSTEM_ERROR_INVALID_ARGUMENT);
+    CHECK_TRUE(inflate_state_size(ctx) == (int)stateSize_, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(checkpoints_.append(checkpoint), SYSTEM_ERROR_NO_MEMORY);
+    NAMED_SCOPE_GUARD(sg, {
+        checkpoints_.takeLast();
+    });
+    const fs::FsLock lock(fs_);
+    IndexEntryHeader eh = {};
+    eh.offset = checkpoint.offset;
+    eh.compressedOffset = checkpoint.compressedOffset;
+    const int n = CHECK_FS(lfs_file_write(&fs_->instance, &file_, &eh, sizeof(eh)));
+    CHECK_TRUE(n == sizeof(eh), SYSTEM_ERROR_IO);
+    FileContext fileCtx = { fs_, &file_ };
+    CHECK(inflate_save_state(ctx, writeFile, &fileCtx));
+    sg.dismiss();
+    return 0;
+}
+
+size_t AssetSeekIndex::span() const {
+    return span_;
+}
+
+int AssetSeekIndex::remove(filesystem_t* fs, const char* name) {
+    const auto path = indexPath(name);
+    const int r = lfs_remove(&fs->instance, path.c_str());
+    if (r != LFS_ERR_NOENT) {
+        CHECK_FS(r);
+    }
+    return 0;
+}
+
+void AssetSeekIndex::close() {
+    if (fileOpen_) {
+        const fs::FsLock lock(fs_);
+        lfs_file_close(&fs_->instance, &file_);
+        lfs_remove(&fs_->instance, (indexPath(name_.c_str()) + TEMP_FILE_SUFFIX).c_str());
+        fileOpen_ = false;
+    }
+}
+
+} // particle
+
+#endif // HAL_PLATFORM_ASSETS
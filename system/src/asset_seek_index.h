@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_ASSETS
+
+#include "storage_streams.h"
+#include "spark_wiring_vector.h"
+#include "spark_wiring_string.h"
+
+namespace particle {
+
+/**
+ * Seek index of a compressed asset.
+ *
+ * The index is stored in the asset filesystem alongside the asset and is bound to the asset's
+ * module checksum, so an index created for different contents of the same asset is never used.
+ */
+class AssetSeekIndex: public InflatorSeekIndex {
+public:
+    // Default distance between two checkpoints in the decompressed data
+    static const size_t DEFAULT_SPAN = 256 * 1024;
+
+    AssetSeekIndex();
+    ~AssetSeekIndex();
+
+    /**
+     * Load an existing index.
+     *
+     * @param name Asset name.
+     * @param crc Module checksum of the asset.
+     * @param stateSize Size of the decompressor state.
+     * @return 0 on success, or a negative result code in case of an error.
+     */
+    int load(const char* name, uint32_t crc, size_t stateSize);
+    /**
+     * Start creating a new index.
+     *
+     * The index is not saved until `commit()` is called.
+     *
+     * @param name Asset name.
+     * @param crc Module checksum of the asset.
+     * @param stateSize Size of the decompressor state.
+     * @param span Distance between two checkpoints in the decompressed data.
+     * @return 0 on success, or a negative result code in case of an error.
+     */
+    int create(const char* name, uint32_t crc, size_t stateSize, size_t span);
+    /**
+     * Save the index that is being created.
+     *
+     * @return 0 on success, or a negative result code in case of an error.
+     */
+    int commit();
+
+    int find(size_t offset, Checkpoint* checkpoint) override;
+    int restore(int index, inflate_ctx* ctx) override;
+    int add(const Checkpoint& checkpoint, inflate_ctx* ctx) override;
+    size_t span() const override;
+
+    /**
+     * Remove the index of an asset.
+     *
+     * The caller is expected to hold the filesystem lock.
+     */
+    static int remove(filesystem_t* fs, const char* name);
+
+private:
+    Vector<Checkpoint> checkpoints_;
+    String name_;
+    filesystem_t* fs_;
+    lfs_file_t file_; // File that is being written
+    uint32_t crc_;
+    size_t stateSize_;
+    size_t span_;
+    bool fileOpen_;
+
+    void close();
+};
+
+} // particle
+
+#endif // HAL_PLATFORM_ASSETS
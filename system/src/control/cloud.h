@@ -28,6 +28,7 @@ namespace cloud {
 int getConnectionStatus(ctrl_request* req);
 int connect(ctrl_request* req);
 int disconnect(ctrl_request* req);
+int getConnectionTrace(ctrl_request* req);
 
 } // particle::ctrl::cloud
 
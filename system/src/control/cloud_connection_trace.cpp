@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cloud.h"
+
+#if SYSTEM_CONTROL_ENABLED
+
+#include "system_cloud_connection_trace.h"
+#include "timer_hal.h"
+#include "endian_util.h"
+#include "check.h"
+
+#include <cstring>
+
+namespace particle {
+
+namespace ctrl {
+
+namespace cloud {
+
+namespace {
+
+// Format of the CTRL_REQUEST_CLOUD_GET_CONNECTION_TRACE reply. All fields are little-endian
+struct __attribute__((packed)) ConnectionTraceHeader {
+    uint32_t time; // Current time in milliseconds
+    uint16_t count; // Number of entries
+};
+
+struct __attribute__((packed)) ConnectionTraceEntry {
+    uint32_t time; // Timestamp in milliseconds
+    uint8_t phase; // Connection phase (see `protocol::ConnectionPhase`)
+};
+
+} // namespace
+
+int getConnectionTrace(ctrl_request* req) {
+    CloudConnectionTrace::Entry entries[CloudConnectionTrace::MAX_ENTRY_COUNT];
+    const size_t count = CloudConnectionTrace::instance()->entries(entries, CloudConnectionTrace::MAX_ENTRY_COUNT);
+    CHECK(system_ctrl_alloc_reply_data(req, sizeof(ConnectionTraceHeader) + count * sizeof(ConnectionTraceEntry), nullptr));
+    ConnectionTraceHeader h = {};
+    h.time = nativeToLittleEndian((uint32_t)HAL_Timer_Get_Milli_Seconds());
+    h.count = nativeToLittleEndian((uint16_t)count);
+    char* d = req->reply_data;
+    memcpy(d, &h, sizeof(h));
+    d += sizeof(h);
+    for (size_t i = 0; i < count; ++i) {
+        ConnectionTraceEntry e = {};
+        e.time = nativeToLittleEndian((uint32_t)entries[i].time);
+        e.phase = entries[i].phase;
+        memcpy(d, &e, sizeof(e));
+        d += sizeof(e);
+    }
+    return 0;
+}
+
+} // particle::ctrl::cloud
+
+} // particle::ctrl
+
+} // particle
+
+#endif // SYSTEM_CONTROL_ENABLED
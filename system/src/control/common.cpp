@@ -24,6 +24,7 @@ LOG_SOURCE_CATEGORY("system.ctrl.common");
 #if HAL_PLATFORM_PROTOBUF
 
 #include "nanopb_misc.h"
+#include "control_request_handler.h"
 #include "spark_wiring_platform.h"
 #include "check.h"
 #include "scope_guard.h"
@@ -34,6 +35,28 @@ namespace particle {
 namespace control {
 namespace common {
 
+namespace {
+
+// nanopb stream writing the encoded data to the reply of a control request
+class ReplyStream: public pb_ostream_t {
+public:
+    explicit ReplyStream(ControlReplyWriter* writer) :
+            pb_ostream_t(),
+            writer_(writer) {
+        pb_ostream_t::state = this;
+        pb_ostream_t::max_size = SIZE_MAX;
+        pb_ostream_t::callback = [](pb_ostream_t* strm, const pb_byte_t* buf, size_t size) {
+            auto self = (ReplyStream*)strm->state;
+            return self->writer_->write((const char*)buf, size) == 0;
+        };
+    }
+
+private:
+    ControlReplyWriter* writer_;
+};
+
+} // namespace
+
 int appendReplySubmessage(ctrl_request* req, size_t offset, const pb_field_iter_t* field, const pb_msgdesc_t* desc,
         const void* src) {
     size_t sz = 0;
@@ -71,48 +94,16 @@ int appendReplySubmessage(ctrl_request* req, size_t offset, const pb_field_iter_
 }
 
 int encodeReplyMessage(ctrl_request* req, const pb_msgdesc_t* desc, const void* src) {
-    pb_ostream_t* stream = nullptr;
-    size_t sz = 0;
-    int ret = SYSTEM_ERROR_UNKNOWN;
-
-    // Calculate size
-    bool res = pb_get_encoded_size(&sz, desc, src);
-    if (!res) {
-        goto cleanup;
-    }
-
-    // Allocate reply data
-    ret = system_ctrl_alloc_reply_data(req, sz, nullptr);
-    if (ret != SYSTEM_ERROR_NONE) {
-        goto cleanup;
-    }
-    ret = SYSTEM_ERROR_UNKNOWN;
-
-    // Allocate ostream
-    stream = pb_ostream_init(nullptr);
-    if (stream == nullptr) {
-        ret = SYSTEM_ERROR_NO_MEMORY;
-        goto cleanup;
-    }
-
-    res = pb_ostream_from_buffer_ex(stream, (pb_byte_t*)req->reply_data, req->reply_size, nullptr);
-    if (!res) {
-        goto cleanup;
-    }
-
-    res = pb_encode(stream, desc, src);
-    if (res) {
-        ret = SYSTEM_ERROR_NONE;
-    }
-
-cleanup:
-    if (stream != nullptr) {
-        pb_ostream_free(stream, nullptr);
-    }
-    if (ret != SYSTEM_ERROR_NONE) {
-        system_ctrl_alloc_reply_data(req, 0, nullptr);
-    }
-    return ret;
+    // Encode the message in a single pass. Large replies are passed to the channel in chunks, so
+    // neither the size of the message needs to be calculated in advance, nor the entire message
+    // needs to be stored in a contiguous buffer
+    ControlReplyWriter writer(req);
+    ReplyStream stream(&writer);
+    if (!pb_encode(&stream, desc, src)) {
+        return (writer.error() < 0) ? writer.error() : SYSTEM_ERROR_UNKNOWN;
+    }
+    CHECK(writer.finish());
+    return 0;
 }
 
 int decodeRequestMessage(ctrl_request* req, const pb_msgdesc_t* desc, void* dst) {
@@ -17,7 +17,9 @@
 
 #include "control_request_handler.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 
 namespace particle {
 
@@ -40,6 +42,10 @@ int ControlRequestChannel::allocReplyData(ctrl_request* req, size_t size) {
     return 0;
 }
 
+int ControlRequestChannel::appendReplyData(ctrl_request* req, const char* data, size_t size) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
 void ControlRequestChannel::freeRequestData(ctrl_request* req) {
     if (!req)
     {
@@ -50,4 +56,123 @@ void ControlRequestChannel::freeRequestData(ctrl_request* req) {
     req->request_size = 0;
 }
 
+ControlReplyWriter::ControlReplyWriter(ctrl_request* req) :
+        req_(req),
+        channel_(static_cast<ControlRequestChannel*>(req->channel)),
+        bufSize_(0),
+        size_(0),
+        error_(0),
+        mode_(Mode::BUFFERED),
+        done_(false) {
+}
+
+ControlReplyWriter::~ControlReplyWriter() {
+    if (!done_ && error_ == 0) {
+        error(SYSTEM_ERROR_CANCELLED);
+    }
+}
+
+int ControlReplyWriter::write(const char* data, size_t size) {
+    if (error_ < 0) {
+        return error_;
+    }
+    if (done_) {
+        return error(SYSTEM_ERROR_INVALID_STATE);
+    }
+    while (size > 0) {
+        if (bufSize_ == BUFFER_SIZE) {
+            const int r = flush();
+            if (r < 0) {
+                return r;
+            }
+        }
+        const size_t n = std::min(size, BUFFER_SIZE - bufSize_);
+        memcpy(buf_ + bufSize_, data, n);
+        bufSize_ += n;
+        size_ += n;
+        data += n;
+        size -= n;
+    }
+    return 0;
+}
+
+int ControlReplyWriter::finish() {
+    if (error_ < 0) {
+        return error_;
+    }
+    if (done_) {
+        return 0;
+    }
+    if (mode_ == Mode::BUFFERED) {
+        // The reply fits in the internal buffer
+        if (bufSize_ > 0) {
+            const int r = channel_->allocReplyData(req_, bufSize_);
+            if (r < 0) {
+                return error(r);
+            }
+            memcpy(req_->reply_data, buf_, bufSize_);
+            bufSize_ = 0;
+        }
+    } else {
+        int r = flush();
+        if (r < 0) {
+            return r;
+        }
+        if (mode_ == Mode::CONTIGUOUS && req_->reply_size != size_) {
+            // Release the unused part of the buffer
+            r = channel_->allocReplyData(req_, size_);
+            if (r < 0) {
+                return error(r);
+            }
+        }
+    }
+    done_ = true;
+    return 0;
+}
+
+int ControlReplyWriter::flush() {
+    if (mode_ == Mode::BUFFERED) {
+        const int r = channel_->appendReplyData(req_, buf_, bufSize_);
+        if (r == 0) {
+            mode_ = Mode::CHUNKED;
+            bufSize_ = 0;
+            return 0;
+        }
+        if (r != SYSTEM_ERROR_NOT_SUPPORTED) {
+            return error(r);
+        }
+        mode_ = Mode::CONTIGUOUS;
+    }
+    if (bufSize_ == 0) {
+        return 0;
+    }
+    if (mode_ == Mode::CHUNKED) {
+        const int r = channel_->appendReplyData(req_, buf_, bufSize_);
+        if (r < 0) {
+            return error(r);
+        }
+    } else {
+        const size_t offs = size_ - bufSize_;
+        if (offs + bufSize_ > req_->reply_size) {
+            // Grow the buffer geometrically to avoid copying the data on every flush
+            const size_t n = std::max(offs + bufSize_, req_->reply_size * 2);
+            const int r = channel_->allocReplyData(req_, n);
+            if (r < 0) {
+                return error(r);
+            }
+        }
+        memcpy(req_->reply_data + offs, buf_, bufSize_);
+    }
+    bufSize_ = 0;
+    return 0;
+}
+
+int ControlReplyWriter::error(int ret) {
+    if (error_ == 0) {
+        error_ = ret;
+        channel_->allocReplyData(req_, 0);
+    }
+    return error_;
+}
+
 } // particle
@@ -35,6 +35,10 @@ public:
     explicit ControlRequestChannel(ControlRequestHandler* handler);
 
     virtual int allocReplyData(ctrl_request* req, size_t size);
+    // Appends data to the reply without storing the entire reply in a contiguous buffer. The
+    // `reply_data` field is not valid for requests whose reply data has been appended this way.
+    // Channels that do not support chunked replies return SYSTEM_ERROR_NOT_SUPPORTED
+    virtual int appendReplyData(ctrl_request* req, const char* data, size_t size);
     virtual void freeRequestData(ctrl_request* req);
     virtual void setResult(ctrl_request* req, int result, ctrl_completion_handler_fn handler = nullptr, void* data = nullptr) = 0;
 
@@ -45,6 +49,53 @@ private:
     ControlRequestHandler* handler_;
 };
 
+// Helper class for writing the reply data of a request incrementally.
+//
+// The data is collected in a small internal buffer first. A reply that fits in that buffer is
+// stored in a contiguous buffer allocated with ControlRequestChannel::allocReplyData(). A larger
+// reply is passed to the channel via ControlRequestChannel::appendReplyData() as it is being
+// written, or, if the channel doesn't support chunked replies, stored in a contiguous buffer that
+// grows geometrically. Either way, the data only needs to be generated once.
+//
+// The reply data is freed if finish() is not called or fails
+class ControlReplyWriter {
+public:
+    // Size of the internal buffer
+    static const size_t BUFFER_SIZE = 128;
+
+    explicit ControlReplyWriter(ctrl_request* req);
+    ~ControlReplyWriter();
+
+    int write(const char* data, size_t size);
+    int finish();
+
+    size_t size() const; // Total size of the written data
+    int error() const; // Result code of the first failed operation
+
+    // Instances of this class are non-copyable
+    ControlReplyWriter(const ControlReplyWriter&) = delete;
+    ControlReplyWriter& operator=(const ControlReplyWriter&) = delete;
+
+private:
+    enum class Mode {
+        BUFFERED, // All data fits in the internal buffer so far
+        CHUNKED, // Data is appended to the reply by the channel
+        CONTIGUOUS // Data is stored in a contiguous reply buffer
+    };
+
+    char buf_[BUFFER_SIZE]; // Internal buffer
+    ctrl_request* req_; // Request object
+    ControlRequestChannel* channel_; // Request channel
+    size_t bufSize_; // Size of the data in the internal buffer
+    size_t size_; // Total size of the written data
+    int error_; // Result code of the first failed operation
+    Mode mode_; // Storage mode
+    bool done_; // Set to `true` when all data has been written successfully
+
+    int flush();
+    int error(int ret);
+};
+
 } // namespace particle
 
 inline particle::ControlRequestChannel::ControlRequestChannel(ControlRequestHandler* handler) :
@@ -54,3 +105,11 @@ inline particle::ControlRequestChannel::ControlRequestChannel(ControlRequestHand
 inline particle::ControlRequestHandler* particle::ControlRequestChannel::handler() const {
     return handler_;
 }
+
+inline size_t particle::ControlReplyWriter::size() const {
+    return size_;
+}
+
+inline int particle::ControlReplyWriter::error() const {
+    return error_;
+}
@@ -133,6 +133,8 @@ int spark_cloud_socket_connect()
 {
     system_cloud_disconnect(false);
 
+    CloudConnectionTrace::instance()->record(protocol::ConnectionPhase::CONNECT_START);
+
 #if HAL_PLATFORM_CLOUD_UDP
     const bool udp = HAL_Feature_Get(FEATURE_CLOUD_UDP);
 #else
@@ -175,6 +177,10 @@ int spark_cloud_socket_connect()
                                  nullptr);
 #endif /* HAL_PLATFORM_CLOUD_UDP */
 
+    if (!r) {
+        CloudConnectionTrace::instance()->record(protocol::ConnectionPhase::SOCKET_CONNECTED);
+    }
+
 #if HAL_PLATFORM_CLOUD_UDP
     if (!r) {
         /* This does not actually save anyhing to persistent storage, just computes the checksum */
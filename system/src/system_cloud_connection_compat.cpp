@@ -109,6 +109,7 @@ int system_cloud_connect(int protocol, const ServerAddress* address, sockaddr* s
         LOG(ERROR, "Failed to determine server address");
         return SYSTEM_ERROR_NETWORK;
     }
+    particle::CloudConnectionTrace::instance()->record(particle::protocol::ConnectionPhase::DNS_RESOLVED);
 
     uint16_t dport = particle::bigEndianToNative(*((uint16_t*)saddr.sa_data));
 
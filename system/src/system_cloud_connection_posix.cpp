@@ -149,6 +149,7 @@ int system_cloud_connect(int protocol, const ServerAddress* address, sockaddr* s
     network_interface_t cloudInterface = particle::system::ConnectionManager::instance()->selectCloudConnectionNetwork();
 
     system_cloud_resolv_address(protocol, address, saddrCache, &info, &type, true /* useCachedAddrInfo */, cloudInterface);
+    particle::CloudConnectionTrace::instance()->record(particle::protocol::ConnectionPhase::DNS_RESOLVED);
 
     int r = SYSTEM_ERROR_NETWORK;
 
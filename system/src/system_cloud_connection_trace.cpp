@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_cloud_connection_trace.h"
+
+#include "timer_hal.h"
+
+#include <algorithm>
+
+namespace particle {
+
+namespace {
+
+CloudConnectionTrace g_cloudConnectionTrace;
+
+} // namespace
+
+CloudConnectionTrace::CloudConnectionTrace() :
+        entries_(),
+        phaseTime_(),
+        phases_(0),
+        next_(0),
+        count_(0),
+        dnsTime_(DIAG_ID_CLOUD_DNS_TIME, DIAG_NAME_CLOUD_DNS_TIME),
+        handshakeTime_(DIAG_ID_CLOUD_HANDSHAKE_TIME, DIAG_NAME_CLOUD_HANDSHAKE_TIME),
+        helloTime_(DIAG_ID_CLOUD_HELLO_TIME, DIAG_NAME_CLOUD_HELLO_TIME),
+        connectTime_(DIAG_ID_CLOUD_CONNECTION_TIME, DIAG_NAME_CLOUD_CONNECTION_TIME) {
+}
+
+void CloudConnectionTrace::record(protocol::ConnectionPhase::Enum phase) {
+    namespace ConnectionPhase = protocol::ConnectionPhase;
+    if (phase < 0 || phase >= ConnectionPhase::PHASE_COUNT) {
+        return;
+    }
+    const auto now = HAL_Timer_Get_Milli_Seconds();
+    entries_[next_] = { now, phase };
+    next_ = (next_ + 1) % MAX_ENTRY_COUNT;
+    if (count_ < MAX_ENTRY_COUNT) {
+        ++count_;
+    }
+    if (phase == ConnectionPhase::CONNECT_START) {
+        phases_ = 0;
+    }
+    phaseTime_[phase] = now;
+    phases_ |= (1 << phase);
+    switch (phase) {
+    case ConnectionPhase::DNS_RESOLVED:
+        dnsTime_ = elapsed(ConnectionPhase::CONNECT_START, now);
+        break;
+    case ConnectionPhase::HANDSHAKE_DONE:
+    case ConnectionPhase::SESSION_RESUMED:
+        handshakeTime_ = elapsed(ConnectionPhase::HANDSHAKE_START, now);
+        break;
+    case ConnectionPhase::HELLO_ACKED:
+        // A Hello sent synchronously is only reported as sent once it's acknowledged, so the time
+        // is measured from the end of the handshake
+        helloTime_ = elapsed((phases_ & (1 << ConnectionPhase::HANDSHAKE_DONE)) ? ConnectionPhase::HANDSHAKE_DONE :
+                ConnectionPhase::SESSION_RESUMED, now);
+        break;
+    case ConnectionPhase::CONNECTED:
+        connectTime_ = elapsed(ConnectionPhase::CONNECT_START, now);
+        break;
+    default:
+        break;
+    }
+}
+
+size_t CloudConnectionTrace::entries(Entry* entries, size_t maxCount) const {
+    const size_t n = std::min(maxCount, count_);
+    // Skip the oldest entries that don't fit in the destination buffer
+    size_t index = (next_ + MAX_ENTRY_COUNT - n) % MAX_ENTRY_COUNT;
+    for (size_t i = 0; i < n; ++i) {
+        entries[i] = entries_[index];
+        index = (index + 1) % MAX_ENTRY_COUNT;
+    }
+    return n;
+}
+
+system_tick_t CloudConnectionTrace::elapsed(protocol::ConnectionPhase::Enum start, system_tick_t now) const {
+    if (!(phases_ & (1 << start))) {
+        return 0; // The phase was not recorded during the current attempt
+    }
+    return now - phaseTime_[start];
+}
+
+CloudConnectionTrace* CloudConnectionTrace::instance() {
+    return &g_cloudConnectionTrace;
+}
+
+} // namespace particle
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "protocol_defs.h"
+#include "spark_wiring_diagnostics.h"
+
+namespace particle {
+
+/**
+ * Tracer of the cloud connection phases.
+ *
+ * The timestamps of the most recent phase transitions are kept in a ring buffer. The durations of
+ * the phases of the last connection attempt are also reported via diagnostic data sources.
+ *
+ * This class is not thread-safe and is meant to be used from the system thread.
+ */
+class CloudConnectionTrace {
+public:
+    /**
+     * Trace entry.
+     */
+    struct Entry {
+        system_tick_t time; // Timestamp in milliseconds
+        protocol::ConnectionPhase::Enum phase; // Connection phase
+    };
+
+    // Maximum number of trace entries
+    static const size_t MAX_ENTRY_COUNT = 32;
+
+    CloudConnectionTrace();
+
+    /**
+     * Record a phase transition.
+     */
+    void record(protocol::ConnectionPhase::Enum phase);
+
+    /**
+     * Get the recorded entries, oldest entry first.
+     *
+     * @return Number of entries copied.
+     */
+    size_t entries(Entry* entries, size_t maxCount) const;
+
+    /**
+     * Get the number of recorded entries.
+     */
+    size_t entryCount() const {
+        return count_;
+    }
+
+    static CloudConnectionTrace* instance();
+
+private:
+    Entry entries_[MAX_ENTRY_COUNT];
+    system_tick_t phaseTime_[protocol::ConnectionPhase::PHASE_COUNT]; // Timestamps of the phases of the current attempt
+    uint32_t phases_; // Phases of the current attempt
+    size_t next_; // Index of the next entry
+    size_t count_; // Number of entries
+    SimpleUnsignedIntegerDiagnosticData dnsTime_;
+    SimpleUnsignedIntegerDiagnosticData handshakeTime_;
+    SimpleUnsignedIntegerDiagnosticData helloTime_;
+    SimpleUnsignedIntegerDiagnosticData connectTime_;
+
+    system_tick_t elapsed(protocol::ConnectionPhase::Enum start, system_tick_t now) const;
+};
+
+} // namespace particle
@@ -690,6 +690,10 @@ void clientMessagesProcessed(void* reserved) {
     }
 }
 
+void notifyConnectionPhase(int phase, void* reserved) {
+    CloudConnectionTrace::instance()->record((protocol::ConnectionPhase::Enum)phase);
+}
+
 bool publishSafeModeEventIfNeeded() {
     if (system_mode() == SAFE_MODE) {
         LOG(INFO, "Sending safe mode event");
@@ -1140,6 +1144,7 @@ void Spark_Protocol_Init(void)
         callbacks.set_time = system_set_time;
         callbacks.notify_client_messages_processed = clientMessagesProcessed;
         callbacks.server_moved = handleServerMovedRequest;
+        callbacks.notify_connection_phase = notifyConnectionPhase;
 
         SparkDescriptor descriptor;
         memset(&descriptor, 0, sizeof(descriptor));
@@ -1181,6 +1186,9 @@ void Spark_Protocol_Init(void)
         // Enable device-initiated describe messages
         spark_protocol_set_connection_property(sp, protocol::Connection::ENABLE_DEVICE_INITIATED_DESCRIBE, 0, nullptr, nullptr);
 
+        // Send the Hello message and the Describe messages in one go when resuming a session
+        spark_protocol_set_connection_property(sp, protocol::Connection::PIPELINE_RESUMED_HELLO, 1, nullptr, nullptr);
+
 #if HAL_PLATFORM_COMPRESSED_OTA
         // Enable compressed/combined OTA updates
         if (bootloader_get_version() >= COMPRESSED_OTA_MIN_BOOTLOADER_VERSION) {
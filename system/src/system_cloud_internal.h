@@ -26,6 +26,7 @@
 #include "spark_wiring_diagnostics.h"
 #include "spark_wiring_cloud.h"
 #include "atomic_flag_mutex.h"
+#include "system_cloud_connection_trace.h"
 
 void Spark_Signal(bool on, unsigned, void*);
 void Spark_SetTime(unsigned long dateTime);
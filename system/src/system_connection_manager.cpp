@@ -184,7 +184,7 @@ int ConnectionManager::testConnections(bool background) {
         testResultsActual_ = false;
 
         LOG_DEBUG(INFO, "Full reachability test started");
-        ConnectionTester tester;
+        ConnectionTester tester(&testState_);
         CHECK(tester.prepare(true /* full test */, lastTestFailed_));
         // Blocking call
         r = tester.runTest();
@@ -195,7 +195,7 @@ int ConnectionManager::testConnections(bool background) {
         testResultsActual_ = false;
         if (!backgroundTestInProgress_) {
             LOG_DEBUG(INFO, "Background reachability test started");
-            backgroundTester_ = std::make_unique<ConnectionTester>();
+            backgroundTester_ = std::make_unique<ConnectionTester>(&testState_);
             CHECK_TRUE(backgroundTester_, SYSTEM_ERROR_NO_MEMORY);
             CHECK(backgroundTester_->prepare(false /* full test*/));
             backgroundTestInProgress_ = true;
@@ -335,7 +335,8 @@ int ConnectionManager::checkCloudConnectionNetwork() {
     return 0;
 }
 
-ConnectionTester::ConnectionTester() {
+ConnectionTester::ConnectionTester(ConnectionTestState* state)
+        : state_(state) {
     for (const auto& i: getSupportedInterfaces()) {
         struct ConnectionMetrics interfaceDiagnostics = {};
         interfaceDiagnostics.interface = i.first;
@@ -347,19 +348,12 @@ ConnectionTester::ConnectionTester() {
 ConnectionTester::~ConnectionTester() {
     for (auto& i: metrics_) {
         sock_close(i.socketDescriptor);
-
-        if (i.txBuffer) {
-            free(i.txBuffer);
-        }
-        if (i.rxBuffer) {
-            free(i.rxBuffer);
-        }
     }
 }
 
 ConnectionMetrics* ConnectionTester::metricsFromSocketDescriptor(int socketDescriptor) {
     for (auto& i : metrics_) {
-        if (i.socketDescriptor == socketDescriptor && i.txBuffer && i.rxBuffer /* sanity check */) {
+        if (i.socketDescriptor == socketDescriptor) {
             return &i;
         }
     }
@@ -368,6 +362,10 @@ ConnectionMetrics* ConnectionTester::metricsFromSocketDescriptor(int socketDescr
 
 bool ConnectionTester::testPacketsOutstanding() {
     for (auto& i : metrics_) {
+        if (i.socketDescriptor < 0) {
+            // Interface is not being tested
+            continue;
+        }
         if (i.txPacketCount != REACHABILITY_TEST_MAX_TX_PACKET_COUNT) {
             return true;
         } else {
@@ -379,24 +377,19 @@ bool ConnectionTester::testPacketsOutstanding() {
     return false;
 }
 
-int ConnectionTester::allocateTestPacketBuffers(ConnectionMetrics* metrics) {
+int ConnectionTester::allocateTestPacketBuffers() {
+    // Test packets are generated and processed one at a time, so all interfaces can share the same
+    // buffers. The buffers are kept between tests to avoid fragmenting the heap
     int maxMessageLength = REACHABILITY_MAX_PAYLOAD_SIZE + sizeof(DTLSPlaintext_t);
-    uint8_t* txBuffer = (uint8_t*)malloc(maxMessageLength);
-    uint8_t* rxBuffer = (uint8_t*)malloc(maxMessageLength);
-
-    if (!(txBuffer && rxBuffer)) {
-        if (txBuffer) {
-            free(txBuffer);
-        }
-        if (rxBuffer) {
-            free(rxBuffer);
+    if (!state_->buffer) {
+        state_->buffer.reset(new(std::nothrow) uint8_t[maxMessageLength * 2]);
+        if (!state_->buffer) {
+            LOG_DEBUG(ERROR, "Failed to allocate connection test buffers of size %d", maxMessageLength);
+            return SYSTEM_ERROR_NO_MEMORY;
         }
-        LOG_DEBUG(ERROR, "%s failed to allocate connection test buffers of size %d", netifToName(metrics->interface), maxMessageLength);
-        return SYSTEM_ERROR_NO_MEMORY;
     }
-
-    metrics->txBuffer = txBuffer;
-    metrics->rxBuffer = rxBuffer;
+    txBuffer_ = state_->buffer.get();
+    rxBuffer_ = state_->buffer.get() + maxMessageLength;
     return 0;
 }
 
@@ -406,15 +399,17 @@ int ConnectionTester::sendTestPacket(ConnectionMetrics* metrics) {
     if (HAL_Timer_Get_Milli_Seconds() >= (metrics->txPacketStartMillis + REACHABILITY_TEST_PACKET_TX_TIMEOUT_MS) && metrics->txPacketCount < REACHABILITY_TEST_MAX_TX_PACKET_COUNT) {
         size_t testPacketSize = CHECK(generateTestPacket(metrics));
 
-        int r = sock_send(metrics->socketDescriptor, metrics->txBuffer, testPacketSize, 0);
+        int r = sock_send(metrics->socketDescriptor, txBuffer_, testPacketSize, 0);
         // Take TX errors into account too
         metrics->txPacketStartMillis = HAL_Timer_Get_Milli_Seconds();
         metrics->txPacketCount++;
-        metrics->testPacketSequenceNumber++;
+        const unsigned seq = metrics->testPacketSequenceNumber++;
         if (r > 0) {
             metrics->txBytes += testPacketSize;
+            prober_.packetSent(metrics->interface, seq, metrics->txPacketStartMillis);
         } else {
             metrics->txPacketErrors++;
+            prober_.packetFailed(metrics->interface, seq);
             LOG_DEBUG(WARN, "Test sock_send failed %d errno %d interface %d", r, errno, metrics->interface);
             return SYSTEM_ERROR_NETWORK;
         }
@@ -429,7 +424,7 @@ int ConnectionTester::receiveTestPacket(ConnectionMetrics* metrics) {
     iovec iov = {};
     msg.msg_iov = &iov;
     msg.msg_iovlen = 1;
-    iov.iov_base = metrics->rxBuffer;
+    iov.iov_base = rxBuffer_;
     iov.iov_len = REACHABILITY_MAX_PAYLOAD_SIZE + sizeof(DTLSPlaintext_t);
     char controlBuf[CMSG_SPACE(sizeof(timespec))] = {};
     msg.msg_control = controlBuf;
@@ -450,7 +445,7 @@ int ConnectionTester::receiveTestPacket(ConnectionMetrics* metrics) {
             rxTimestamp = HAL_Timer_Get_Milli_Seconds();
         }
         // Parse packet
-        auto header = (DTLSPlaintext_t*)metrics->rxBuffer;
+        auto header = (DTLSPlaintext_t*)rxBuffer_;
         header->epoch = bigEndianToNative(header->epoch);
         // LOG(TRACE, "epoch=%04x", header->epoch);
         CHECK_TRUE(header->epoch >= EPOCH_BASE, SYSTEM_ERROR_BAD_DATA);
@@ -474,6 +469,7 @@ int ConnectionTester::receiveTestPacket(ConnectionMetrics* metrics) {
         }
         metrics->rxPacketMask |= (1 << seqNum);
         metrics->totalPacketWaitMillis += (rxTimestamp - sentTimestamp);
+        prober_.packetReceived(metrics->interface, seqNum, rxTimestamp - sentTimestamp);
         metrics->rxPacketCount++;
         metrics->rxBytes += header->length;
         // LOG_DEBUG(TRACE, "Sock %d packet # %u rx < %d", metrics->socketDescriptor, seqNum, r);
@@ -510,8 +506,8 @@ int ConnectionTester::generateTestPacket(ConnectionMetrics* metrics) {
     memcpy(msg.sequence_number + sizeof(ts), &sequenceNumber, sizeof(sequenceNumber));
 
     Random rand;
-    rand.gen((char*)metrics->txBuffer + sizeof(msg), packetDataLength);    
-    memcpy(metrics->txBuffer, &msg, headerLength);
+    rand.gen((char*)txBuffer_ + sizeof(msg), packetDataLength);    
+    memcpy(txBuffer_, &msg, headerLength);
     return totalMessageLength;
 }
 
@@ -546,9 +542,10 @@ int ConnectionTester::pollSockets(struct pollfd* pfds, int socketCount) {
 // GOAL: To maintain a list of which network interface is "best" at any given time
 // 1) Retrieve the server hostname and port. Resolve the hostname to an addrinfo list (ie IP addresses of server)
 // 2) Create a socket for each network interface to test. Bind this socket to the specific interface. Connect the socket
-// 3) Add these created+connected sockets to a pollfd structure. Allocate buffers for the reachability test messages.
-// 4) Poll all the sockets. Polling sends a reachability test message and waits for the response. The test continues for the test duration
-// 5) After polling completes, free the allocated buffers, reset diagnostics and calculate updated metrics. 
+// 3) Add these created+connected sockets to a pollfd structure. Allocate buffers for the reachability test messages, unless they were allocated by a previous test.
+// 4) Poll all the sockets. Polling sends a reachability test message and waits for the response. The test continues for the test duration,
+//    or until one of the interfaces is clearly better than the others
+// 5) After polling completes, calculate updated metrics and update the latency and loss history of the tested interfaces.
 int ConnectionTester::prepare(bool fullTest, bool lastTestFailed) {
     struct addrinfo* info = nullptr;
     CloudServerAddressType type = CLOUD_SERVER_ADDRESS_TYPE_NONE;
@@ -578,6 +575,7 @@ int ConnectionTester::prepare(bool fullTest, bool lastTestFailed) {
     int socketCount = 0;
     auto pfds = std::make_unique<pollfd[]>(metrics_.size());
     CHECK_TRUE(pfds, SYSTEM_ERROR_NO_MEMORY);
+    CHECK(allocateTestPacketBuffers());
 
     int r = SYSTEM_ERROR_NETWORK;
     
@@ -669,7 +667,15 @@ int ConnectionTester::prepare(bool fullTest, bool lastTestFailed) {
             socketCount++;
 
             guard.dismiss();
-            CHECK(allocateTestPacketBuffers(&connectionMetrics));
+
+            const ConnectionHistory* history = nullptr;
+            for (const auto& h: state_->history) {
+                if (h.interface == connectionMetrics.interface) {
+                    history = &h;
+                    break;
+                }
+            }
+            CHECK(prober_.addInterface(connectionMetrics.interface, history));
         }
         if (ok) {
             r = SYSTEM_ERROR_NONE;
@@ -693,18 +699,28 @@ int ConnectionTester::runTest(system_tick_t maxBlockTime) {
     }
 
     auto start = HAL_Timer_Get_Milli_Seconds();
+    network_interface_t winner = NETWORK_INTERFACE_ALL;
 
     // Step 4: Send/Receive data on the sockets for the duration of the test time
     while(testPacketsOutstanding() && HAL_Timer_Get_Milli_Seconds() < endTime_) {
         pollSockets(pfds_.get(), socketCount_);
         SystemISRTaskQueue.process();
+        winner = prober_.winner(HAL_Timer_Get_Milli_Seconds());
+        if (winner != NETWORK_INTERFACE_ALL) {
+            LOG_DEBUG(TRACE, "%s is the best network interface, finishing the test early", netifToName(winner));
+            break;
+        }
         if (HAL_Timer_Get_Milli_Seconds() - start >= maxBlockTime) {
             break;
         }
     }
 
-    finished_ = !testPacketsOutstanding() || HAL_Timer_Get_Milli_Seconds() >= endTime_;
+    finished_ = winner != NETWORK_INTERFACE_ALL || !testPacketsOutstanding() || HAL_Timer_Get_Milli_Seconds() >= endTime_;
     if (finished_) {
+        const auto now = HAL_Timer_Get_Milli_Seconds();
+        if (prober_.updateHistory(&state_->history, now) < 0) {
+            LOG_DEBUG(WARN, "Failed to update network interface history");
+        }
         // Step 5: calculate updated metrics
         for (auto& i: metrics_) {
             if (i.rxPacketCount > 0) {
@@ -717,6 +733,9 @@ int ConnectionTester::runTest(system_tick_t maxBlockTime) {
                         // Received
                         penalty = 0;
                         consecutive = 0;
+                    } else if (!prober_.isPacketLost(i.interface, j, now)) {
+                        // Still in flight, which may be the case if the test has finished early
+                        continue;
                     } else {
                         penalty = i.avgPacketRoundTripTime * (2 << consecutive++) /* 2^(conscutive++) */;
                         LOG_DEBUG(TRACE, "%d: total=%u consecutive=%u penalty=%u resultingScore=%u new=%u", i.interface, i.totalPacketWaitMillis, consecutive, penalty, i.resultingScore, i.resultingScore + penalty);
@@ -23,6 +23,7 @@
 #if HAL_PLATFORM_IFAPI
 
 #include "system_network.h"
+#include "system_connection_prober.h"
 #include "spark_wiring_vector.h"
 #include <memory>
 
@@ -31,8 +32,6 @@ namespace particle { namespace system {
 struct ConnectionMetrics {
     network_interface_t interface;
     int socketDescriptor;
-    uint8_t *txBuffer;
-    uint8_t *rxBuffer;
     uint32_t testPacketSequenceNumber;
     uint32_t txPacketCount;
     uint32_t txPacketErrors;
@@ -51,6 +50,12 @@ struct ConnectionMetrics {
     uint32_t resultingScore;
 };
 
+// State kept between connection tests
+struct ConnectionTestState {
+    std::unique_ptr<uint8_t[]> buffer; // Test packet buffers
+    Vector<ConnectionHistory> history; // Latency and loss history of the network interfaces
+};
+
 class ConnectionTester;
 
 class ConnectionManager {
@@ -80,6 +85,7 @@ private:
     volatile bool checkScheduled_ = false;
     bool backgroundTestInProgress_ = false;
     std::unique_ptr<ConnectionTester> backgroundTester_;
+    ConnectionTestState testState_;
     static constexpr system_tick_t PERIODIC_CHECK_PERIOD_MS = 5 * 60 * 1000;
     system_tick_t nextPeriodicCheck_ = 0;
     bool lastTestFailed_ = false;
@@ -87,7 +93,7 @@ private:
 
 class ConnectionTester {
 public:
-    ConnectionTester();
+    explicit ConnectionTester(ConnectionTestState* state);
     ~ConnectionTester();
 
     int prepare(bool fullTest = true, bool lastTestFailed = false);
@@ -97,7 +103,7 @@ public:
     static const Vector<std::pair<network_interface_t, uint32_t>> getSupportedInterfaces();
 
 private:
-    int allocateTestPacketBuffers(ConnectionMetrics* metrics);
+    int allocateTestPacketBuffers();
     int generateTestPacket(ConnectionMetrics* metrics);
     int pollSockets(struct pollfd * pfds, int socketCount);
     int sendTestPacket(ConnectionMetrics* metrics);
@@ -111,8 +117,12 @@ private:
     const system_tick_t REACHABILITY_TEST_PACKET_TX_TIMEOUT_MS = 250;
     const unsigned REACHABILITY_TEST_MAX_TX_PACKET_COUNT = 10;
 
+    ConnectionTestState* state_;
     Vector<ConnectionMetrics> metrics_;
+    ConnectionProber prober_;
     std::unique_ptr<pollfd[]> pfds_;
+    uint8_t* txBuffer_ = nullptr;
+    uint8_t* rxBuffer_ = nullptr;
     system_tick_t endTime_ = 0;
     bool finished_ = false;
     size_t socketCount_ = 0;
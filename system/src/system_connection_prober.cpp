@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "system_connection_prober.h"
+#include "system_error.h"
+#include "check.h"
+
+namespace particle { namespace system {
+
+namespace {
+
+// Weight of the interface history relative to a single packet of the current test
+const float HISTORY_PRIOR_WEIGHT = 2.0f;
+// Smoothing factor of the interface history
+const float HISTORY_SMOOTHING_FACTOR = 0.25f;
+// Width of the confidence interval of the round-trip time, in standard errors
+const float CONFIDENCE_FACTOR = 2.0f;
+// Minimum standard deviation of the round-trip time relative to its mean. Prevents a few packets
+// with nearly identical timings from producing an overly narrow confidence interval
+const float MIN_RELATIVE_DEVIATION = 0.1f;
+// Maximum packet loss ratio used to calculate the cost of an interface
+const float MAX_LOSS = 0.9f;
+
+const float INFINITE_COST = std::numeric_limits<float>::infinity();
+
+unsigned countBits(uint32_t mask) {
+    unsigned n = 0;
+    while (mask) {
+        mask &= mask - 1;
+        ++n;
+    }
+    return n;
+}
+
+} // namespace
+
+int ConnectionProber::addInterface(network_interface_t iface, const ConnectionHistory* history) {
+    CHECK_FALSE(findProbe(iface), SYSTEM_ERROR_ALREADY_EXISTS);
+    Probe p = {};
+    if (history) {
+        p.history = *history;
+    }
+    p.history.interface = iface;
+    CHECK_TRUE(probes_.append(p), SYSTEM_ERROR_NO_MEMORY);
+    return 0;
+}
+
+void ConnectionProber::clear() {
+    probes_.clear();
+}
+
+void ConnectionProber::packetSent(network_interface_t iface, unsigned seq, system_tick_t time) {
+    const auto p = findProbe(iface);
+    if (p && seq < MAX_PACKET_COUNT) {
+        p->txTime[seq] = time;
+        p->txMask |= (1u << seq);
+    }
+}
+
+void ConnectionProber::packetFailed(network_interface_t iface, unsigned seq) {
+    const auto p = findProbe(iface);
+    if (p && seq < MAX_PACKET_COUNT) {
+        p->failedMask |= (1u << seq);
+    }
+}
+
+void ConnectionProber::packetReceived(network_interface_t iface, unsigned seq, system_tick_t rtt) {
+    const auto p = findProbe(iface);
+    if (!p || seq >= MAX_PACKET_COUNT || (p->rxMask & (1u << seq))) {
+        return;
+    }
+    p->rxMask |= (1u << seq);
+    ++p->rxCount;
+    p->rttSum += rtt;
+    p->rttSquareSum += (float)rtt * rtt;
+}
+
+bool ConnectionProber::isPacketLost(network_interface_t iface, unsigned seq, system_tick_t now) const {
+    const auto p = findProbe(iface);
+    if (!p || seq >= MAX_PACKET_COUNT) {
+        return false;
+    }
+    const uint32_t bit = (1u << seq);
+    if (p->failedMask & bit) {
+        return true;
+    }
+    return (p->txMask & ~p->rxMask & bit) && now - p->txTime[seq] >= lossTimeout(*p);
+}
+
+network_interface_t ConnectionProber::winner(system_tick_t now) const {
+    // Find the interface with the lowest upper bound of the cost
+    int best = -1;
+    Estimate bestEst = {};
+    for (int i = 0; i < probes_.size(); ++i) {
+        if (probes_[i].rxCount < MIN_SAMPLE_COUNT) {
+            continue;
+        }
+        const auto e = estimate(probes_[i], now);
+        if (best < 0 || e.upper < bestEst.upper) {
+            best = i;
+            bestEst = e;
+        }
+    }
+    if (best < 0) {
+        return NETWORK_INTERFACE_ALL;
+    }
+    // Ensure that all other interfaces are worse with enough confidence
+    for (int i = 0; i < probes_.size(); ++i) {
+        if (i == best) {
+            continue;
+        }
+        const auto e = estimate(probes_[i], now);
+        if (e.samples < MIN_SAMPLE_COUNT || e.lower <= bestEst.upper) {
+            return NETWORK_INTERFACE_ALL;
+        }
+    }
+    return probes_[best].history.interface;
+}
+
+int ConnectionProber::updateHistory(Vector<ConnectionHistory>* history, system_tick_t now) const {
+    for (const auto& p: probes_) {
+        const unsigned lost = lostCount(p, now);
+        const unsigned samples = p.rxCount + lost;
+        if (!samples) {
+            continue;
+        }
+        ConnectionHistory* h = nullptr;
+        for (auto& entry: *history) {
+            if (entry.interface == p.history.interface) {
+                h = &entry;
+                break;
+            }
+        }
+        if (!h) {
+            ConnectionHistory entry = {};
+            entry.interface = p.history.interface;
+            CHECK_TRUE(history->append(entry), SYSTEM_ERROR_NO_MEMORY);
+            h = &history->last();
+        }
+        const float loss = (float)lost / samples;
+        if (!h->testCount) {
+            h->loss = loss;
+        } else {
+            h->loss += HISTORY_SMOOTHING_FACTOR * (loss - h->loss);
+        }
+        if (p.rxCount > 0) {
+            const float rtt = p.rttSum / p.rxCount;
+            if (h->rtt <= 0.0f) {
+                h->rtt = rtt;
+            } else {
+                h->rtt += HISTORY_SMOOTHING_FACTOR * (rtt - h->rtt);
+            }
+        }
+        ++h->testCount;
+    }
+    return 0;
+}
+
+ConnectionProber::Estimate ConnectionProber::estimate(const Probe& p, system_tick_t now) const {
+    Estimate e = {};
+    const unsigned lost = lostCount(p, now);
+    e.samples = p.rxCount + lost;
+    if (!p.rxCount) {
+        e.cost = INFINITE_COST;
+        e.lower = INFINITE_COST;
+        e.upper = INFINITE_COST;
+        return e;
+    }
+    // Combine the current results with the history of the interface
+    const float lossWeight = p.history.testCount ? HISTORY_PRIOR_WEIGHT : 0.0f;
+    const float loss = std::min((lost + lossWeight * p.history.loss) / (e.samples + lossWeight), MAX_LOSS);
+    const float rttWeight = (p.history.testCount && p.history.rtt > 0.0f) ? HISTORY_PRIOR_WEIGHT : 0.0f;
+    const float rtt = (p.rttSum + rttWeight * p.history.rtt) / (p.rxCount + rttWeight);
+    float dev = 0.0f;
+    if (p.rxCount > 1) {
+        const float mean = p.rttSum / p.rxCount;
+        const float var = (p.rttSquareSum - p.rxCount * mean * mean) / (p.rxCount - 1);
+        if (var > 0.0f) {
+            dev = std::sqrt(var);
+        }
+    }
+    dev = std::max(dev, rtt * MIN_RELATIVE_DEVIATION);
+    const float margin = CONFIDENCE_FACTOR * dev / std::sqrt(p.rxCount + rttWeight);
+    // A lost packet needs to be resent, which increases the expected delivery time
+    const float k = 1.0f / (1.0f - loss);
+    e.cost = rtt * k;
+    e.lower = std::max(rtt - margin, 0.0f) * k;
+    e.upper = (rtt + margin) * k;
+    return e;
+}
+
+unsigned ConnectionProber::lostCount(const Probe& p, system_tick_t now) const {
+    const system_tick_t timeout = lossTimeout(p);
+    uint32_t lostMask = p.failedMask;
+    const uint32_t pendingMask = p.txMask & ~p.rxMask;
+    for (unsigned i = 0; i < MAX_PACKET_COUNT; ++i) {
+        if ((pendingMask & (1u << i)) && now - p.txTime[i] >= timeout) {
+            lostMask |= (1u << i);
+        }
+    }
+    return countBits(lostMask);
+}
+
+system_tick_t ConnectionProber::lossTimeout(const Probe& p) const {
+    float rtt = p.history.rtt;
+    if (p.rxCount > 0) {
+        rtt = p.rttSum / p.rxCount;
+    }
+    return std::max(MIN_LOSS_TIMEOUT, (system_tick_t)(rtt * 3));
+}
+
+ConnectionProber::Probe* ConnectionProber::findProbe(network_interface_t iface) {
+    for (auto& p: probes_) {
+        if (p.history.interface == iface) {
+            return &p;
+        }
+    }
+    return nullptr;
+}
+
+const ConnectionProber::Probe* ConnectionProber::findProbe(network_interface_t iface) const {
+    return const_cast<ConnectionProber*>(this)->findProbe(iface);
+}
+
+} } // namespace particle::system
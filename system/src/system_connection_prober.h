@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "system_network.h"
+#include "system_tick_hal.h"
+#include "spark_wiring_vector.h"
+
+namespace particle { namespace system {
+
+/**
+ * Latency and packet loss of a network interface averaged across reachability tests.
+ */
+struct ConnectionHistory {
+    network_interface_t interface; // Network interface
+    float rtt; // Smoothed round-trip time in milliseconds
+    float loss; // Smoothed ratio of lost packets
+    unsigned testCount; // Number of tests the averages are based on
+};
+
+/**
+ * Statistics of the reachability test packets sent on multiple network interfaces concurrently.
+ *
+ * The prober tells when one of the interfaces is better than the others with enough confidence
+ * that the test can be finished without waiting for the remaining packets. The latency and loss
+ * history of an interface from previous tests is used as a prior for its current estimates.
+ */
+class ConnectionProber {
+public:
+    // Maximum number of test packets per interface
+    static constexpr unsigned MAX_PACKET_COUNT = 32;
+    // Minimum number of received or lost packets before an interface can be compared with others
+    static constexpr unsigned MIN_SAMPLE_COUNT = 3;
+    // Minimum time after which a test packet that hasn't been received is considered lost
+    static constexpr system_tick_t MIN_LOSS_TIMEOUT = 1000;
+
+    int addInterface(network_interface_t iface, const ConnectionHistory* history = nullptr);
+    void clear();
+
+    void packetSent(network_interface_t iface, unsigned seq, system_tick_t time);
+    void packetFailed(network_interface_t iface, unsigned seq);
+    void packetReceived(network_interface_t iface, unsigned seq, system_tick_t rtt);
+
+    // Returns true if the packet has been sent but not received within the loss timeout
+    bool isPacketLost(network_interface_t iface, unsigned seq, system_tick_t now) const;
+
+    // Returns the interface that is clearly better than the others, or NETWORK_INTERFACE_ALL if
+    // there's not enough data yet
+    network_interface_t winner(system_tick_t now) const;
+
+    // Updates the history of the tested interfaces with the results of this test
+    int updateHistory(Vector<ConnectionHistory>* history, system_tick_t now) const;
+
+    int interfaceCount() const {
+        return probes_.size();
+    }
+
+private:
+    struct Probe {
+        ConnectionHistory history; // History of the interface before this test
+        system_tick_t txTime[MAX_PACKET_COUNT]; // Time each packet was sent
+        uint32_t txMask; // Sent packets
+        uint32_t rxMask; // Received packets
+        uint32_t failedMask; // Packets that couldn't be sent
+        unsigned rxCount; // Number of received packets
+        float rttSum; // Sum of round-trip times
+        float rttSquareSum; // Sum of squared round-trip times
+    };
+
+    // Estimated cost of delivering a packet via an interface, in milliseconds
+    struct Estimate {
+        float cost; // Point estimate
+        float lower; // Lower bound of the confidence interval
+        float upper; // Upper bound of the confidence interval
+        unsigned samples; // Number of received and lost packets
+    };
+
+    Vector<Probe> probes_;
+
+    Estimate estimate(const Probe& p, system_tick_t now) const;
+    unsigned lostCount(const Probe& p, system_tick_t now) const;
+    system_tick_t lossTimeout(const Probe& p) const;
+
+    Probe* findProbe(network_interface_t iface);
+    const Probe* findProbe(network_interface_t iface) const;
+};
+
+} } // namespace particle::system
@@ -45,34 +45,49 @@ namespace {
 
 typedef int(*ReplyFormatterCallback)(Appender*, void* data);
 
+// Appender writing the data to the reply of a control request
+class ReplyAppender: public Appender {
+public:
+    ReplyAppender(ControlReplyWriter* writer, size_t maxSize) :
+            writer_(writer),
+            maxSize_(maxSize),
+            tooLarge_(false) {
+    }
+
+    bool append(const uint8_t* data, size_t size) override {
+        if (size > maxSize_ - writer_->size()) {
+            tooLarge_ = true;
+            return false;
+        }
+        return writer_->write((const char*)data, size) == 0;
+    }
+
+    bool tooLarge() const {
+        return tooLarge_;
+    }
+
+private:
+    ControlReplyWriter* writer_;
+    size_t maxSize_;
+    bool tooLarge_;
+};
+
 int formatReplyData(ctrl_request* req, ReplyFormatterCallback callback, void* data = nullptr,
         size_t maxSize = std::numeric_limits<size_t>::max()) {
-    size_t bufSize = std::min((size_t)128, maxSize); // Initial size of the reply buffer
-    for (;;) {
-        int ret = system_ctrl_alloc_reply_data(req, bufSize, nullptr);
-        if (ret != 0) {
-            system_ctrl_alloc_reply_data(req, 0, nullptr);
-            return ret;
-        }
-        BufferAppender appender(req->reply_data, bufSize);
-        ret = callback(&appender, data);
-        if (ret != 0) {
-            system_ctrl_alloc_reply_data(req, 0, nullptr);
-            return ret;
-        }
-        const size_t size = appender.dataSize();
-        if (size > maxSize) {
-            system_ctrl_alloc_reply_data(req, 0, nullptr);
-            return SYSTEM_ERROR_TOO_LARGE;
-        }
-        if (size > bufSize) {
-            // Increase the buffer size and format the data once again
-            bufSize = std::min(size + size / 16, maxSize);
-            continue;
-        }
-        req->reply_size = size;
-        return 0; // OK
+    // Format the data in a single pass. Large replies are passed to the channel in chunks
+    ControlReplyWriter writer(req);
+    ReplyAppender appender(&writer, maxSize);
+    const int ret = callback(&appender, data);
+    if (appender.tooLarge()) {
+        return SYSTEM_ERROR_TOO_LARGE;
     }
+    if (writer.error() < 0) {
+        return writer.error();
+    }
+    if (ret != 0) {
+        return ret;
+    }
+    return writer.finish();
 }
 
 SystemControl g_systemControl;
@@ -334,6 +349,10 @@ void SystemControl::processRequest(ctrl_request* req, ControlRequestChannel* cha
         setResult(req, ctrl::cloud::disconnect(req));
         break;
     }
+    case CTRL_REQUEST_CLOUD_GET_CONNECTION_TRACE: {
+        setResult(req, ctrl::cloud::getConnectionTrace(req));
+        break;
+    }
 #if HAL_USE_SOCKET_HAL_POSIX && HAL_PLATFORM_IFAPI
     case CTRL_REQUEST_NETWORK_GET_INTERFACE_LIST: {
         setResult(req, control::network::getInterfaceList(req));
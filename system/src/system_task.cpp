@@ -383,6 +383,7 @@ void handle_cloud_connection(bool force_events)
                     cloud_failed_connection_attempts = 0;
                     protocol::v2::CoapChannel::instance()->open();
                     CloudDiagnostics::instance()->status(CloudDiagnostics::CONNECTED);
+                    CloudConnectionTrace::instance()->record(protocol::ConnectionPhase::CONNECTED);
                     system_notify_event(cloud_status, cloud_status_connected);
                     if (system_mode() == SAFE_MODE) {
 /* FIXME: there should be macro that checks for NetworkManager availability */
@@ -34,6 +34,8 @@
 #include "debug.h"
 #include "security_mode.h"
 
+#include <algorithm>
+
 // FIXME: we should not be polluting our code with such generic macro names
 #undef RESET
 #undef SET
@@ -228,6 +230,13 @@ particle::UsbControlRequestChannel::~UsbControlRequestChannel() {
 
 int particle::UsbControlRequestChannel::allocReplyData(ctrl_request* ctrlReq, size_t size) {
     const auto req = static_cast<Request*>(ctrlReq);
+    if (req->replyFrames) {
+        if (size > 0) {
+            return SYSTEM_ERROR_INVALID_STATE; // Chunked reply data cannot be reallocated
+        }
+        freeReplyFrames(req);
+        return SYSTEM_ERROR_NONE;
+    }
     if (size > 0) {
         const auto data = (char*)t_realloc(req->reply_data, size);
         if (!data) {
@@ -242,6 +251,53 @@ int particle::UsbControlRequestChannel::allocReplyData(ctrl_request* ctrlReq, si
     return SYSTEM_ERROR_NONE;
 }
 
+int particle::UsbControlRequestChannel::appendReplyData(ctrl_request* ctrlReq, const char* data, size_t size) {
+    const auto req = static_cast<Request*>(ctrlReq);
+    if (req->reply_data) {
+        return SYSTEM_ERROR_INVALID_STATE; // Reply data is stored in a contiguous buffer
+    }
+    while (size > 0) {
+        auto frame = req->replyFrame; // Last frame
+        if (frame && frame->size == frame->capacity && frame->capacity < USB_REQUEST_REPLY_FRAME_SIZE) {
+            // Only the first frame can be smaller than the frame size. Grow it geometrically until
+            // it reaches the frame size, so that a small reply doesn't take a whole frame
+            const size_t capacity = std::min(std::max(frame->size + size, frame->capacity * 2), USB_REQUEST_REPLY_FRAME_SIZE);
+            const auto f = (ReplyFrame*)t_realloc(frame, sizeof(ReplyFrame) + capacity);
+            if (!f) {
+                return SYSTEM_ERROR_NO_MEMORY;
+            }
+            f->capacity = capacity;
+            req->replyFrames = f;
+            req->replyFrame = f;
+            frame = f;
+        } else if (!frame || frame->size == frame->capacity) {
+            // The first frame is sized to fit the pending data, all subsequent frames are full-size
+            const size_t capacity = frame ? USB_REQUEST_REPLY_FRAME_SIZE : std::min(size, USB_REQUEST_REPLY_FRAME_SIZE);
+            const auto f = (ReplyFrame*)t_malloc(sizeof(ReplyFrame) + capacity);
+            if (!f) {
+                return SYSTEM_ERROR_NO_MEMORY;
+            }
+            f->next = nullptr;
+            f->size = 0;
+            f->capacity = capacity;
+            if (frame) {
+                frame->next = f;
+            } else {
+                req->replyFrames = f;
+            }
+            req->replyFrame = f;
+            frame = f;
+        }
+        const size_t n = std::min(size, frame->capacity - frame->size);
+        memcpy(frame->data() + frame->size, data, n);
+        frame->size += n;
+        req->reply_size += n;
+        data += n;
+        size -= n;
+    }
+    return SYSTEM_ERROR_NONE;
+}
+
 void particle::UsbControlRequestChannel::freeRequestData(ctrl_request* ctrlReq) {
     const auto req = static_cast<Request*>(ctrlReq);
     if (req->flags & RequestFlag::POOLED_REQ_DATA) {
@@ -262,6 +318,28 @@ void particle::UsbControlRequestChannel::setResult(ctrl_request* ctrlReq, int re
     if (req->request_data) {
         freeRequestData(req);
     }
+    if (req->replyFrames) {
+        // Release the unused part of the last frame
+        ReplyFrame* prev = nullptr;
+        auto frame = req->replyFrames;
+        while (frame->next) {
+            prev = frame;
+            frame = frame->next;
+        }
+        if (frame->size < frame->capacity) {
+            const auto f = (ReplyFrame*)t_realloc(frame, sizeof(ReplyFrame) + frame->size);
+            if (f) {
+                f->capacity = f->size;
+                if (prev) {
+                    prev->next = f;
+                } else {
+                    req->replyFrames = f;
+                }
+            }
+        }
+        // Reset the read position
+        req->replyFrame = req->replyFrames;
+    }
     req->handler = handler;
     req->handlerData = data;
     ATOMIC_BLOCK() {
@@ -316,6 +394,8 @@ bool particle::UsbControlRequestChannel::processInitRequest(HAL_USB_SetupRequest
     req->task.req = req;
     req->handler = nullptr;
     req->handlerData = nullptr;
+    req->replyFrames = nullptr;
+    req->replyFrame = nullptr;
     req->offset = 0;
     req->result = SYSTEM_ERROR_UNKNOWN;
     req->id = ++lastReqId_;
@@ -454,7 +534,54 @@ bool particle::UsbControlRequestChannel::processRecvRequest(HAL_USB_SetupRequest
             size == 0 || req->offset + size > req->reply_size) { // Unexpected size
         return false;
     }
-    if (size <= MIN_WLENGTH) {
+    if (req->replyFrames) {
+        // Chunked reply data. The host reads the data sequentially, so the current frame always
+        // contains the byte at the current offset
+        auto frame = req->replyFrame;
+        size_t pos = req->offset % USB_REQUEST_REPLY_FRAME_SIZE; // Offset in the current frame
+        if (size <= MIN_WLENGTH) {
+            // Use the internal buffer provided by the HAL. A small chunk may span two frames
+            if (!halReq->data) {
+                return false;
+            }
+            auto d = (char*)halReq->data;
+            size_t n = size;
+            while (n > 0) {
+                const size_t c = std::min(n, frame->size - pos);
+                memcpy(d, frame->data() + pos, c);
+                d += c;
+                n -= c;
+                pos += c;
+                if (pos == USB_REQUEST_REPLY_FRAME_SIZE) {
+                    frame = frame->next;
+                    pos = 0;
+                }
+            }
+        } else {
+            // Provide a buffer to the HAL
+            if (pos + size <= frame->size) {
+                halReq->data = (uint8_t*)frame->data() + pos;
+                if (pos + size == USB_REQUEST_REPLY_FRAME_SIZE) {
+                    frame = frame->next;
+                }
+            } else {
+                // The chunk spans two frames. The data that has already been read from the current
+                // frame is no longer needed, so the chunk is assembled at the beginning of that frame.
+                // All frames but the last one are full-size, so a chunk that is not larger than the
+                // frame size never spans more than two frames
+                if (size > frame->capacity) {
+                    return false; // Hosts don't request more than 4096 bytes in a control transfer
+                }
+                const auto next = frame->next;
+                const size_t n = frame->size - pos;
+                memmove(frame->data(), frame->data() + pos, n);
+                memcpy(frame->data() + n, next->data(), size - n);
+                halReq->data = (uint8_t*)frame->data();
+                frame = next;
+            }
+        }
+        req->replyFrame = frame;
+    } else if (size <= MIN_WLENGTH) {
         // Use the internal buffer provided by the HAL
         if (!halReq->data) {
             return false;
@@ -555,6 +682,18 @@ bool particle::UsbControlRequestChannel::processVendorRequest(HAL_USB_SetupReque
     return true;
 }
 
+void particle::UsbControlRequestChannel::freeReplyFrames(Request* req) {
+    auto frame = req->replyFrames;
+    while (frame) {
+        const auto next = frame->next;
+        t_free(frame);
+        frame = next;
+    }
+    req->replyFrames = nullptr;
+    req->replyFrame = nullptr;
+    req->reply_size = 0;
+}
+
 // Note: This method is called from an ISR
 void particle::UsbControlRequestChannel::finishActiveRequest(Request* req) {
     // Update list of active requests
@@ -576,7 +715,7 @@ void particle::UsbControlRequestChannel::finishActiveRequest(Request* req) {
             system_pool_free(req->request_data, nullptr);
             req->request_data = nullptr;
         }
-        if (!req->request_data && !req->reply_data && !req->handler) {
+        if (!req->request_data && !req->reply_data && !req->replyFrames && !req->handler) {
             systemPoolDelete(req);
         } else {
             // Free the request data asynchronously
@@ -590,7 +729,7 @@ void particle::UsbControlRequestChannel::finishRequest(Request* req) {
     if (req->request_data) {
         freeRequestData(req);
     }
-    if (req->reply_data) {
+    if (req->reply_data || req->replyFrames) {
         allocReplyData(req, 0);
     }
     if (req->handler) {
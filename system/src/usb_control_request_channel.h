@@ -36,6 +36,10 @@ const size_t USB_REQUEST_MAX_PAYLOAD_SIZE = 65535;
 // Maximum size of a request buffer that can be allocated from the memory pool
 const size_t USB_REQUEST_MAX_POOLED_BUFFER_SIZE = 64;
 
+// Size of a frame used to store chunked reply data. The host reads the reply data in chunks of up
+// to 4096 bytes. A chunk that spans two frames is assembled in the frame where it starts
+const size_t USB_REQUEST_REPLY_FRAME_SIZE = 4096;
+
 // Invalid request ID
 const uint16_t USB_REQUEST_INVALID_ID = 0;
 
@@ -47,6 +51,7 @@ public:
 
     // ControlRequestChannel
     virtual int allocReplyData(ctrl_request* ctrlReq, size_t size) override;
+    virtual int appendReplyData(ctrl_request* ctrlReq, const char* data, size_t size) override;
     virtual void freeRequestData(ctrl_request* ctrlReq) override;
     virtual void setResult(ctrl_request* req, int result, ctrl_completion_handler_fn handler, void* data) override;
 
@@ -67,6 +72,17 @@ private:
 
     struct Request;
 
+    // Frame of chunked reply data
+    struct ReplyFrame {
+        ReplyFrame* next; // Next frame
+        size_t size; // Size of the frame data
+        size_t capacity; // Size of the frame buffer
+
+        char* data() {
+            return (char*)(this + 1); // Frame data follows the header
+        }
+    };
+
     // ISR task data
     struct RequestTask: ISRTaskQueue::Task {
         Request* req;
@@ -79,6 +95,8 @@ private:
         Request* next; // Next element in a list
         ctrl_completion_handler_fn handler; // Completion handler
         void* handlerData; // Completion handler data
+        ReplyFrame* replyFrames; // Chunked reply data
+        ReplyFrame* replyFrame; // Last frame while the reply is being written, or the frame being read
         size_t offset; // Offset in the request or reply data
         int result; // Result code
         uint16_t id; // Request ID
@@ -99,6 +117,8 @@ private:
     bool processResetRequest(HAL_USB_SetupRequest* halReq);
     bool processVendorRequest(HAL_USB_SetupRequest* halReq);
 
+    void freeReplyFrames(Request* req);
+
     void finishActiveRequest(Request* req);
     void finishRequest(Request* req);
 
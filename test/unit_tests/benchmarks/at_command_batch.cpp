@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "at_command_batch.h"
+#include "at_parser.h"
+#include "at_response.h"
+
+#include "bench.h"
+#include "pty_stream.h"
+
+#include <thread>
+#include <string>
+
+#include <unistd.h>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+// Commands sent by the NCP clients during the modem initialization and registration polling
+const char* const COMMANDS[] = {
+    "+CEDRXS=0",
+    "+CPSMS=0",
+    "+QDSIM=0",
+    "+CGEREP=1,0",
+    "+CREG?",
+    "+CGREG?",
+    "+CEREG?",
+    "+COPS?"
+};
+
+const size_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+// Command line that stops the emulated DCE
+const char EXIT_CMD_LINE[] = "AT+EXIT\r";
+
+bool writeAll(int fd, const std::string& data) {
+    size_t offs = 0;
+    while (offs < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + offs, data.size() - offs);
+        if (n <= 0) {
+            return false;
+        }
+        offs += n;
+    }
+    return true;
+}
+
+// Emulates a DCE that executes the command lines received over the slave side of a pseudoterminal.
+// Every query command reports an information response with the command name as the prefix
+void runDce(int fd) {
+    std::string data;
+    char buf[256];
+    for (;;) {
+        const ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            return;
+        }
+        data.append(buf, n);
+        size_t pos = 0;
+        while ((pos = data.find('\r')) != std::string::npos) {
+            const auto line = data.substr(0, pos + 1);
+            data.erase(0, pos + 1);
+            if (line == EXIT_CMD_LINE) {
+                return;
+            }
+            std::string resp;
+            size_t begin = 2; // Skip "AT"
+            for (;;) {
+                const size_t end = std::min(line.find(';', begin), line.size() - 1);
+                const auto cmd = line.substr(begin, end - begin);
+                if (!cmd.empty() && cmd.back() == '?') {
+                    resp += "\r\n" + cmd.substr(0, cmd.size() - 1) + ": 0,1\r\n";
+                }
+                if (end == line.size() - 1) {
+                    break;
+                }
+                begin = end + 1;
+            }
+            resp += "\r\nOK\r\n";
+            if (!writeAll(fd, resp)) {
+                return;
+            }
+        }
+    }
+}
+
+// The commands are sent over a pseudoterminal, so the round trip time of each command line includes
+// two context switches, similarly to a UART serviced by an interrupt handler
+void atCommandSequence(Benchmark& b, bool batched) {
+    PtyStream pty;
+    if (!pty.isValid()) {
+        return b.fail("posix_openpt() failed");
+    }
+    const int fd = pty.openSlave();
+    if (fd < 0) {
+        return b.fail("Unable to open the slave side of the pseudoterminal");
+    }
+    std::thread t(runDce, fd);
+    AtParser parser;
+    if (parser.init(AtParserConfig().stream(&pty).echoEnabled(false).logEnabled(false)) < 0) {
+        b.fail("Unable to initialize the AT parser");
+    } else {
+        b.run([&]() {
+            int r = AtResponse::OK;
+            if (batched) {
+                auto batch = parser.batch();
+                for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+                    batch.add(COMMANDS[i]);
+                }
+                r = batch.exec();
+            } else {
+                for (size_t i = 0; i < COMMAND_COUNT && r == AtResponse::OK; ++i) {
+                    r = parser.execCommand("AT%s", COMMANDS[i]);
+                }
+            }
+            if (r != AtResponse::OK) {
+                b.fail("Command failed");
+            }
+        });
+    }
+    pty.write(EXIT_CMD_LINE, sizeof(EXIT_CMD_LINE) - 1);
+    t.join();
+    close(fd);
+}
+
+} // namespace
+
+BENCHMARK("AtCommandBatch/sequence/sequential", atCommandSequence, false);
+BENCHMARK("AtCommandBatch/sequence/batched", atCommandSequence, true);
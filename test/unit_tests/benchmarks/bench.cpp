@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+#ifdef __GLIBC__
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+} // extern "C"
+
+#endif // defined(__GLIBC__)
+
+namespace {
+
+std::atomic<uint64_t> g_allocCount(0);
+std::atomic<uint64_t> g_allocBytes(0);
+
+inline void countAlloc(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+std::vector<particle::bench::BenchmarkInfo>& registry() {
+    static std::vector<particle::bench::BenchmarkInfo> r;
+    return r;
+}
+
+} // namespace
+
+#ifdef __GLIBC__
+
+// The allocation functions below override the ones provided by glibc. Operator new and most of
+// the standard library go through malloc(), so they don't need to be overridden separately
+extern "C" {
+
+void* malloc(size_t size) {
+    countAlloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    countAlloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (size > 0) {
+        countAlloc(size);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+#endif // defined(__GLIBC__)
+
+namespace particle {
+
+namespace bench {
+
+AllocStats AllocStats::current() {
+    AllocStats s;
+    s.count = g_allocCount.load(std::memory_order_relaxed);
+    s.bytes = g_allocBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool AllocStats::supported() {
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+}
+
+Benchmark::Benchmark(std::string name, unsigned minTime) :
+        result_(),
+        bytesProcessed_(0),
+        minTime_(minTime),
+        hasResult_(false) {
+    result_.name = std::move(name);
+}
+
+void Benchmark::finish(uint64_t iterations, Clock::duration time, const AllocStats& allocs) {
+    const double ns = std::chrono::duration<double, std::nano>(time).count();
+    result_.iterations = iterations;
+    result_.nsPerOp = ns / iterations;
+    result_.allocsPerOp = (double)allocs.count / iterations;
+    result_.bytesPerOp = (double)allocs.bytes / iterations;
+    result_.mbPerSec = 0;
+    if (bytesProcessed_ > 0 && ns > 0) {
+        result_.mbPerSec = (double)bytesProcessed_ * iterations / (ns / 1e9) / (1024 * 1024);
+    }
+    hasResult_ = true;
+}
+
+uint64_t Benchmark::nextIterations(uint64_t iterations, Clock::duration time, Clock::duration minTime) {
+    // Predict the number of iterations needed to reach the minimum run time, with a 20% margin.
+    // Grow no more than 100x at a time in case the timing of the previous run was inaccurate
+    uint64_t n = iterations * 100;
+    if (time.count() > 0) {
+        n = (uint64_t)((double)iterations * minTime.count() / time.count() * 1.2);
+    }
+    n = std::min(n, iterations * 100);
+    n = std::max(n, iterations + 1);
+    return std::min(n, MAX_ITERATIONS);
+}
+
+Registration::Registration(const char* name, Function fn) {
+    registry().push_back(BenchmarkInfo{ name, std::move(fn) });
+}
+
+std::vector<BenchmarkInfo> registeredBenchmarks() {
+    // Benchmarks of the same component are kept in the order in which they are defined in the source
+    // file, so that e.g. "Foo/64" is reported before "Foo/1024"
+    auto r = registry();
+    std::stable_sort(r.begin(), r.end(), [](const BenchmarkInfo& b1, const BenchmarkInfo& b2) {
+        return b1.name.substr(0, b1.name.find('/')) < b2.name.substr(0, b2.name.find('/'));
+    });
+    return r;
+}
+
+} // namespace bench
+
+} // namespace particle
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Registers a benchmark.
+ *
+ * ```cpp
+ * void ringBufferPut(Benchmark& b, size_t size) {
+ *     // Set up the test data
+ *     b.run([&]() {
+ *         // Code being measured
+ *     });
+ * }
+ *
+ * BENCHMARK("RingBuffer/put/64", ringBufferPut, 64);
+ * ```
+ *
+ * @param _name Benchmark name.
+ * @param _fn Benchmark function.
+ * @param ... Additional arguments passed to the benchmark function.
+ */
+#define BENCHMARK(_name, _fn, ...) \
+        static const ::particle::bench::Registration BENCH_PP_CAT(benchmarkReg, __LINE__)(_name, \
+                [](::particle::bench::Benchmark& b) { \
+                    _fn(b, ##__VA_ARGS__); \
+                })
+
+#define BENCH_PP_CAT(_a, _b) BENCH_PP_CAT_(_a, _b)
+#define BENCH_PP_CAT_(_a, _b) _a##_b
+
+namespace particle {
+
+namespace bench {
+
+/**
+ * Heap usage counters.
+ *
+ * The counters are maintained by the `malloc()` family functions defined in bench.cpp.
+ */
+struct AllocStats {
+    uint64_t count; // Number of allocations
+    uint64_t bytes; // Number of bytes allocated
+
+    /**
+     * Returns the current values of the counters.
+     */
+    static AllocStats current();
+    /**
+     * Returns `true` if the allocations can be counted on this platform.
+     */
+    static bool supported();
+};
+
+/**
+ * Benchmark result.
+ */
+struct Result {
+    std::string name; // Benchmark name
+    uint64_t iterations; // Number of iterations
+    double nsPerOp; // Nanoseconds per iteration
+    double allocsPerOp; // Number of heap allocations per iteration
+    double bytesPerOp; // Number of bytes allocated on the heap per iteration
+    double mbPerSec; // Throughput in megabytes per second (0 if not applicable)
+};
+
+/**
+ * Benchmark context.
+ */
+class Benchmark {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Default minimum duration of a benchmark run in milliseconds.
+     */
+    static const unsigned DEFAULT_MIN_TIME = 250;
+    /**
+     * Maximum number of iterations.
+     */
+    static const uint64_t MAX_ITERATIONS = 1000000000;
+
+    /**
+     * Constructor.
+     *
+     * @param name Benchmark name.
+     * @param minTime Minimum duration of the benchmark run in milliseconds.
+     */
+    explicit Benchmark(std::string name, unsigned minTime = DEFAULT_MIN_TIME);
+
+    /**
+     * Runs the code being measured.
+     *
+     * The function is invoked repeatedly until the minimum duration of the benchmark run is
+     * reached. Anything that needs to be set up before the measurement should be done before
+     * calling this method.
+     *
+     * @param fn Function to invoke.
+     */
+    template<typename FnT>
+    void run(FnT&& fn);
+    /**
+     * Sets the number of bytes processed in each iteration.
+     *
+     * If set, the throughput is reported in addition to the time per iteration.
+     *
+     * @param size Number of bytes.
+     * @return This object.
+     */
+    Benchmark& bytesProcessed(size_t size);
+    /**
+     * Marks the benchmark as failed.
+     *
+     * @param msg Error message.
+     */
+    void fail(std::string msg);
+
+    /**
+     * Returns the benchmark result.
+     */
+    const Result& result() const;
+    /**
+     * Returns `true` if `run()` has been called.
+     */
+    bool hasResult() const;
+    /**
+     * Returns the error message if the benchmark has failed.
+     */
+    const std::string& error() const;
+
+private:
+    Result result_;
+    std::string error_;
+    size_t bytesProcessed_;
+    unsigned minTime_;
+    bool hasResult_;
+
+    void finish(uint64_t iterations, Clock::duration time, const AllocStats& allocs);
+
+    static uint64_t nextIterations(uint64_t iterations, Clock::duration time, Clock::duration minTime);
+};
+
+/**
+ * Benchmark registration.
+ *
+ * @see `BENCHMARK()`
+ */
+class Registration {
+public:
+    typedef std::function<void(Benchmark&)> Function;
+
+    Registration(const char* name, Function fn);
+};
+
+/**
+ * Registered benchmark.
+ */
+struct BenchmarkInfo {
+    std::string name; // Benchmark name
+    Registration::Function fn; // Benchmark function
+};
+
+/**
+ * Returns all registered benchmarks grouped by component.
+ */
+std::vector<BenchmarkInfo> registeredBenchmarks();
+
+/**
+ * Prevents the compiler from optimizing out a computation whose result is otherwise unused.
+ *
+ * @param val Value.
+ */
+template<typename T>
+inline void doNotOptimize(const T& val) {
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+/**
+ * Prevents the compiler from reordering or eliding memory writes across this call.
+ */
+inline void clobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+template<typename FnT>
+inline void Benchmark::run(FnT&& fn) {
+    const auto minTime = std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(minTime_));
+    uint64_t n = 1;
+    for (;;) {
+        const auto allocs = AllocStats::current();
+        const auto t1 = Clock::now();
+        for (uint64_t i = 0; i < n; ++i) {
+            fn();
+        }
+        const auto t2 = Clock::now();
+        const auto allocs2 = AllocStats::current();
+        if (t2 - t1 >= minTime || n >= MAX_ITERATIONS) {
+            finish(n, t2 - t1, AllocStats{ allocs2.count - allocs.count, allocs2.bytes - allocs.bytes });
+            break;
+        }
+        n = nextIterations(n, t2 - t1, minTime);
+    }
+}
+
+inline Benchmark& Benchmark::bytesProcessed(size_t size) {
+    bytesProcessed_ = size;
+    return *this;
+}
+
+inline void Benchmark::fail(std::string msg) {
+    if (error_.empty()) {
+        error_ = std::move(msg);
+    }
+}
+
+inline const Result& Benchmark::result() const {
+    return result_;
+}
+
+inline bool Benchmark::hasResult() const {
+    return hasResult_;
+}
+
+inline const std::string& Benchmark::error() const {
+    return error_;
+}
+
+} // namespace bench
+
+} // namespace particle
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_ble_scan.h"
+
+#include "bench.h"
+
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstring>
+
+using namespace particle::ble;
+using namespace particle::bench;
+
+namespace {
+
+// Synthetic stream of scan reports: every device is seen several times, in random order, and
+// advertises a typical set of AD structures
+
+const unsigned REPORTS_PER_DEVICE = 10;
+
+struct ScanReport {
+    hal_ble_addr_t addr;
+    std::string advData;
+    std::string srData;
+};
+
+std::string ad(uint8_t type, const std::string& data) {
+    return std::string(1, (char)(data.size() + 1)) + (char)type + data;
+}
+
+std::vector<ScanReport> makeScanReports(unsigned deviceCount) {
+    std::mt19937 gen(0);
+    std::vector<ScanReport> devices(deviceCount);
+    for (unsigned i = 0; i < deviceCount; ++i) {
+        auto& d = devices[i];
+        for (auto& b: d.addr.addr) {
+            b = (uint8_t)gen();
+        }
+        d.addr.addr_type = BLE_SIG_ADDR_TYPE_RANDOM_STATIC;
+        const uint16_t uuid = 0x1800 + i % 32;
+        d.advData = ad(BLE_SIG_AD_TYPE_FLAGS, "\x06") +
+                ad(BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, std::string((const char*)&uuid, sizeof(uuid))) +
+                ad(BLE_SIG_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, "\x62\x06" + std::to_string(i));
+        d.srData = ad(BLE_SIG_AD_TYPE_COMPLETE_LOCAL_NAME, "device" + std::to_string(i));
+    }
+    std::vector<ScanReport> reports;
+    for (unsigned i = 0; i < REPORTS_PER_DEVICE; ++i) {
+        reports.insert(reports.end(), devices.begin(), devices.end());
+    }
+    std::shuffle(reports.begin(), reports.end(), gen);
+    return reports;
+}
+
+// Duplicate check as it was done before BleAddressSet: a linear search over the addresses of
+// the discovered devices
+void dedupeLinear(Benchmark& b, unsigned deviceCount) {
+    const auto reports = makeScanReports(deviceCount);
+    b.run([&]() {
+        std::vector<hal_ble_addr_t> cached;
+        unsigned found = 0;
+        for (const auto& r: reports) {
+            const bool seen = std::any_of(cached.begin(), cached.end(), [&](const hal_ble_addr_t& a) {
+                return a.addr_type == r.addr.addr_type && !memcmp(a.addr, r.addr.addr, BLE_SIG_ADDR_LEN);
+            });
+            if (!seen) {
+                cached.push_back(r.addr);
+                ++found;
+            }
+        }
+        doNotOptimize(found);
+    });
+}
+
+void dedupeHashed(Benchmark& b, unsigned deviceCount) {
+    const auto reports = makeScanReports(deviceCount);
+    b.run([&]() {
+        BleAddressSet cached;
+        unsigned found = 0;
+        for (const auto& r: reports) {
+            if (cached.insert(r.addr)) {
+                ++found;
+            }
+        }
+        doNotOptimize(found);
+    });
+}
+
+// Finds an AD structure the same way as BleAdvertisingData::locate()
+const uint8_t* locate(const std::string& data, uint8_t type, size_t* len) {
+    const auto d = (const uint8_t*)data.data();
+    for (size_t i = 0; (i + 3) <= data.size(); i += (d[i] + 1)) {
+        const size_t adsLen = d[i];
+        if ((i + adsLen + 1) > data.size()) {
+            break;
+        }
+        if (adsLen >= 1 && d[i + 1] == type) {
+            *len = adsLen - 1;
+            return d + i + 2;
+        }
+    }
+    *len = 0;
+    return nullptr;
+}
+
+// Lookups made by the scan filters before the advertising data was indexed: each filter walked
+// the data once per AD type. The temporary Strings and Vectors the filters allocated are not
+// included
+void filterLocate(Benchmark& b, unsigned deviceCount) {
+    const auto reports = makeScanReports(deviceCount);
+    static const uint8_t types[] = {
+        BLE_SIG_AD_TYPE_SHORT_LOCAL_NAME,
+        BLE_SIG_AD_TYPE_COMPLETE_LOCAL_NAME,
+        BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_MORE_AVAILABLE,
+        BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE,
+        BLE_SIG_AD_TYPE_128BIT_SERVICE_UUID_MORE_AVAILABLE,
+        BLE_SIG_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE,
+        BLE_SIG_AD_TYPE_APPEARANCE,
+        BLE_SIG_AD_TYPE_MANUFACTURER_SPECIFIC_DATA
+    };
+    b.run([&]() {
+        size_t total = 0;
+        for (const auto& r: reports) {
+            for (uint8_t type: types) {
+                size_t len = 0;
+                locate(r.advData, type, &len);
+                total += len;
+                locate(r.srData, type, &len);
+                total += len;
+            }
+        }
+        doNotOptimize(total);
+    });
+}
+
+void filterIndex(Benchmark& b, unsigned deviceCount) {
+    const auto reports = makeScanReports(deviceCount);
+    hal_ble_uuid_t uuid = {};
+    uuid.type = BLE_UUID_TYPE_16BIT;
+    uuid.uuid16 = 0x1801;
+    b.run([&]() {
+        size_t total = 0;
+        for (const auto& r: reports) {
+            const BleAdStructureIndex adv((const uint8_t*)r.advData.data(), r.advData.size());
+            const BleAdStructureIndex sr((const uint8_t*)r.srData.data(), r.srData.size());
+            size_t len = 0;
+            adv.deviceName(&len);
+            total += len;
+            sr.deviceName(&len);
+            total += len;
+            adv.customData(&len);
+            total += len;
+            sr.customData(&len);
+            total += len;
+            total += adv.appearance() + sr.appearance();
+            total += adv.containsServiceUuid(uuid) + sr.containsServiceUuid(uuid);
+        }
+        doNotOptimize(total);
+    });
+}
+
+} // namespace
+
+BENCHMARK("BleScan/dedupe/linear/20", dedupeLinear, 20);
+BENCHMARK("BleScan/dedupe/linear/200", dedupeLinear, 200);
+BENCHMARK("BleScan/dedupe/hashed/20", dedupeHashed, 20);
+BENCHMARK("BleScan/dedupe/hashed/200", dedupeHashed, 200);
+BENCHMARK("BleScan/filter/locate/200", filterLocate, 200);
+BENCHMARK("BleScan/filter/index/200", filterIndex, 200);
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffered_serial.h"
+
+#include "bench.h"
+
+#include <atomic>
+#include <thread>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+const size_t DATA_SIZE = 64 * 1024;
+const size_t SERIAL_BUFFER_SIZE = 64; // Default SERIAL_BUFFER_SIZE, see usart_hal.h
+
+// Connected pair of sockets. The data sent to the peer socket is consumed by a separate thread
+class SocketPair {
+public:
+    SocketPair() :
+            stop_(false) {
+        fds_[0] = fds_[1] = -1;
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds_) < 0) {
+            return;
+        }
+        thread_ = std::thread([this]() {
+            char buf[4096];
+            while (!stop_) {
+                if (recv(fds_[1], buf, sizeof(buf), 0) <= 0) {
+                    break;
+                }
+            }
+        });
+    }
+
+    ~SocketPair() {
+        stop_ = true;
+        if (fds_[0] >= 0) {
+            shutdown(fds_[0], SHUT_RDWR);
+        }
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        for (int fd: fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    int send(const char* data, size_t size) {
+        return ::send(fds_[0], data, size, 0);
+    }
+
+    int receive(char* data, size_t size) {
+        const int r = ::recv(fds_[0], data, size, MSG_DONTWAIT);
+        return (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) ? 0 : r;
+    }
+
+    bool isValid() const {
+        return fds_[0] >= 0;
+    }
+
+private:
+    std::thread thread_;
+    std::atomic<bool> stop_;
+    int fds_[2];
+};
+
+// Every byte is sent with a separate socket call, as done by the gcc USART before buffering was added
+void writeUnbuffered(Benchmark& b) {
+    SocketPair s;
+    if (!s.isValid()) {
+        return b.fail("socketpair() failed");
+    }
+    const std::string data(DATA_SIZE, 'a');
+    b.bytesProcessed(data.size());
+    b.run([&]() {
+        for (char c: data) {
+            s.send(&c, 1);
+        }
+    });
+}
+
+void writeBuffered(Benchmark& b, size_t bufSize) {
+    SocketPair s;
+    if (!s.isValid()) {
+        return b.fail("socketpair() failed");
+    }
+    std::string rxBuf(bufSize, '\0');
+    std::string txBuf(bufSize, '\0');
+    BufferedSerialIo io([&](const char* data, size_t size) { return s.send(data, size); },
+            [&](char* data, size_t size) { return s.receive(data, size); });
+    io.init(&rxBuf[0], rxBuf.size(), &txBuf[0], txBuf.size());
+    io.start();
+    const std::string data(DATA_SIZE, 'a');
+    b.bytesProcessed(data.size());
+    b.run([&]() {
+        // Write byte by byte, as hal_usart_write() does
+        for (char c: data) {
+            io.write(&c, 1);
+        }
+        io.flush();
+    });
+}
+
+} // namespace
+
+BENCHMARK("BufferedSerialIo/write/unbuffered", writeUnbuffered);
+BENCHMARK("BufferedSerialIo/write/64", writeBuffered, SERIAL_BUFFER_SIZE);
+BENCHMARK("BufferedSerialIo/write/1K", writeBuffered, 1024);
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "coap_message_decoder.h"
+#include "coap_message_encoder.h"
+
+#include "bench.h"
+
+#include <string>
+
+using namespace particle::protocol;
+using namespace particle::bench;
+
+namespace {
+
+const size_t MAX_MESSAGE_SIZE = 1024;
+
+// Encodes a request similar to the ones used for function calls and variable requests
+int encodeRequest(char* buf, size_t size, const std::string& payload) {
+    CoapMessageEncoder e(buf, size);
+    e.type(CoapType::CON);
+    e.code(CoapCode::POST);
+    e.id(0x1234);
+    e.token("\x01\x02\x03\x04", 4);
+    e.option(CoapOption::URI_PATH, "f");
+    e.option(CoapOption::URI_PATH, "digitalWrite");
+    e.option(CoapOption::CONTENT_FORMAT, (unsigned)CoapContentFormat::TEXT_PLAIN);
+    e.option(CoapOption::URI_QUERY, "args=D7,HIGH");
+    e.option(CoapOption::BLOCK1, 0x0au);
+    e.option(CoapOption::SIZE1, (unsigned)payload.size());
+    e.payload(payload.data(), payload.size());
+    return e.encode();
+}
+
+std::string encodeRequest(size_t payloadSize) {
+    std::string buf(MAX_MESSAGE_SIZE, '\0');
+    const int r = encodeRequest(&buf[0], buf.size(), std::string(payloadSize, 'x'));
+    if (r < 0 || (size_t)r > buf.size()) {
+        return std::string();
+    }
+    buf.resize(r);
+    return buf;
+}
+
+void coapEncode(Benchmark& b, size_t payloadSize) {
+    const std::string payload(payloadSize, 'x');
+    char buf[MAX_MESSAGE_SIZE] = {};
+    b.run([&]() {
+        const int r = encodeRequest(buf, sizeof(buf), payload);
+        if (r < 0 || (size_t)r > sizeof(buf)) {
+            b.fail("Unable to encode message");
+        }
+        doNotOptimize(buf);
+    });
+}
+
+void coapDecode(Benchmark& b, size_t payloadSize) {
+    const auto msg = encodeRequest(payloadSize);
+    if (msg.empty()) {
+        b.fail("Unable to encode message");
+        return;
+    }
+    b.bytesProcessed(msg.size());
+    b.run([&]() {
+        CoapMessageDecoder d;
+        if (d.decode(msg.data(), msg.size()) < 0) {
+            b.fail("Unable to decode message");
+        }
+        doNotOptimize(d);
+    });
+}
+
+void coapDecodeAndIterateOptions(Benchmark& b) {
+    const auto msg = encodeRequest(0 /* payloadSize */);
+    if (msg.empty()) {
+        b.fail("Unable to encode message");
+        return;
+    }
+    b.run([&]() {
+        CoapMessageDecoder d;
+        d.decode(msg.data(), msg.size());
+        size_t size = 0;
+        auto it = d.options();
+        while (it.next()) {
+            size += it.size();
+        }
+        doNotOptimize(size);
+    });
+}
+
+void coapFindOption(Benchmark& b) {
+    const auto msg = encodeRequest(0 /* payloadSize */);
+    CoapMessageDecoder d;
+    if (msg.empty() || d.decode(msg.data(), msg.size()) < 0) {
+        b.fail("Unable to decode message");
+        return;
+    }
+    b.run([&]() {
+        // The last option in the message
+        auto it = d.findOption(CoapOption::SIZE1);
+        doNotOptimize(it.toUInt());
+    });
+}
+
+// Decodes a request and looks up the options that a request handler typically needs
+void coapDecodeAndFindOptions(Benchmark& b) {
+    const auto msg = encodeRequest(0 /* payloadSize */);
+    if (msg.empty()) {
+        b.fail("Unable to encode message");
+        return;
+    }
+    b.run([&]() {
+        CoapMessageDecoder d;
+        d.decode(msg.data(), msg.size());
+        unsigned n = 0;
+        n += d.findOption(CoapOption::URI_PATH).size();
+        n += d.findOption(CoapOption::CONTENT_FORMAT).toUInt();
+        n += d.findOption(CoapOption::URI_QUERY).size();
+        n += d.findOption(CoapOption::BLOCK1).toUInt();
+        n += d.findOption(CoapOption::BLOCK2).toUInt(); // Missing option
+        n += d.findOption(CoapOption::SIZE1).toUInt();
+        doNotOptimize(n);
+    });
+}
+
+} // namespace
+
+BENCHMARK("CoapMessageEncoder/encode/0", coapEncode, 0);
+BENCHMARK("CoapMessageEncoder/encode/512", coapEncode, 512);
+BENCHMARK("CoapMessageDecoder/decode/0", coapDecode, 0);
+BENCHMARK("CoapMessageDecoder/decode/512", coapDecode, 512);
+BENCHMARK("CoapMessageDecoder/decode+options", coapDecodeAndIterateOptions);
+BENCHMARK("CoapMessageDecoder/decode+find_options", coapDecodeAndFindOptions);
+BENCHMARK("CoapMessageDecoder/find_option", coapFindOption);
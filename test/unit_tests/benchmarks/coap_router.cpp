@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "v2/coap_router.h"
+
+#include "bench.h"
+
+#include <string>
+#include <vector>
+
+using namespace particle::protocol::v2;
+using namespace particle::bench;
+
+namespace {
+
+int requestCallback(coap_message* msg, const char* uri, int method, int reqId, void* arg) {
+    return 0;
+}
+
+// Registers handlers for paths similar to the ones used by the system and application code,
+// e.g. "L/ledger3/s", "E/event3" and "x3/*/y"
+bool addRoutes(CoapRouter& router, int count) {
+    CoapRouter::Handler h = {};
+    h.callback = requestCallback;
+    for (int i = 0; i < count; ++i) {
+        std::string path;
+        switch (i % 3) {
+        case 0: path = "L/ledger" + std::to_string(i) + "/s"; break;
+        case 1: path = "E/event" + std::to_string(i); break;
+        default: path = "x" + std::to_string(i) + "/*/y"; break;
+        }
+        if (router.add(path.data(), path.size(), COAP_METHOD_POST, h) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void coapRouterFind(Benchmark& b, int routeCount, const char* path) {
+    CoapRouter router;
+    if (!addRoutes(router, routeCount)) {
+        b.fail("Unable to register handlers");
+        return;
+    }
+    const std::string p(path);
+    if (!router.find(p.data(), p.size(), COAP_METHOD_POST)) {
+        b.fail("Handler not found");
+        return;
+    }
+    b.run([&]() {
+        auto h = router.find(p.data(), p.size(), COAP_METHOD_POST);
+        doNotOptimize(h);
+    });
+}
+
+void coapRouterAdd(Benchmark& b, int routeCount) {
+    b.run([&]() {
+        CoapRouter router;
+        if (!addRoutes(router, routeCount)) {
+            b.fail("Unable to register handlers");
+        }
+        doNotOptimize(router);
+    });
+}
+
+} // namespace
+
+BENCHMARK("CoapRouter/find/10", coapRouterFind, 10, "L/ledger6/s");
+BENCHMARK("CoapRouter/find/100", coapRouterFind, 100, "L/ledger66/s");
+BENCHMARK("CoapRouter/find_wildcard/10", coapRouterFind, 10, "x5/abc/y/z");
+BENCHMARK("CoapRouter/find_wildcard/100", coapRouterFind, 100, "x65/abc/y/z");
+BENCHMARK("CoapRouter/add/100", coapRouterAdd, 100);
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eeprom_emulation.h"
+#include "flash_storage.h"
+
+#include "bench.h"
+
+#include <memory>
+#include <cstring>
+
+using namespace particle::bench;
+
+namespace {
+
+// Same layout as in the unit tests: two pages of different sizes
+const size_t PAGE_SIZE = 0x4000;
+const uintptr_t BASE_ADDRESS = 0xC000;
+
+using TestStore = RAMFlashStorage<BASE_ADDRESS, 2 /* Sectors */, PAGE_SIZE>;
+using TestEEPROM = EEPROMEmulation<TestStore, BASE_ADDRESS, PAGE_SIZE, BASE_ADDRESS + PAGE_SIZE, PAGE_SIZE / 4>;
+
+std::unique_ptr<TestEEPROM> makeEEPROM() {
+    std::unique_ptr<TestEEPROM> eeprom(new TestEEPROM());
+    eeprom->init();
+    return eeprom;
+}
+
+void eepromGetUsedPage(Benchmark& b) {
+    auto eeprom = makeEEPROM();
+    // Fill most of the active page with records. A read needs to scan all of them to find the
+    // latest value of a byte
+    const size_t recordCount = PAGE_SIZE / 4 / sizeof(TestEEPROM::Record) * 3 / 4;
+    for (size_t i = 0; i < recordCount; ++i) {
+        eeprom->put(i % 64, (uint8_t)i);
+    }
+    b.run([&]() {
+        uint8_t v = 0;
+        eeprom->get(10, v);
+        doNotOptimize(v);
+    });
+}
+
+void eepromGet(Benchmark& b, size_t size) {
+    auto eeprom = makeEEPROM();
+    std::unique_ptr<uint8_t[]> data(new uint8_t[size]());
+    eeprom->put(0, data.get(), size);
+    b.bytesProcessed(size);
+    b.run([&]() {
+        eeprom->get(0, data.get(), size);
+        clobberMemory();
+    });
+}
+
+void eepromPut(Benchmark& b, size_t size) {
+    auto eeprom = makeEEPROM();
+    std::unique_ptr<uint8_t[]> data(new uint8_t[size]());
+    uint8_t value = 0;
+    b.bytesProcessed(size);
+    b.run([&]() {
+        // Change the data on every iteration so that new records get written and the pages
+        // get swapped periodically
+        memset(data.get(), ++value, size);
+        eeprom->put(0, data.get(), size);
+    });
+}
+
+} // namespace
+
+BENCHMARK("EEPROMEmulation/get/1", eepromGet, 1);
+BENCHMARK("EEPROMEmulation/get/64", eepromGet, 64);
+BENCHMARK("EEPROMEmulation/get_used_page", eepromGetUsedPage);
+BENCHMARK("EEPROMEmulation/put/1", eepromPut, 1);
+BENCHMARK("EEPROMEmulation/put/64", eepromPut, 64);
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filesystem_block_cache.h"
+#include "sparse_buffer.h"
+
+#include "bench.h"
+
+#include <string>
+#include <cstring>
+
+using namespace particle;
+using namespace particle::fs;
+using namespace particle::bench;
+
+namespace {
+
+const size_t BLOCK_SIZE = 4096;
+const size_t LINE_SIZE = 256;
+
+// Emulates the external flash of the virtual device
+class SparseBlockDevice: public BlockDevice {
+public:
+    SparseBlockDevice() :
+            buf_(0xff) {
+    }
+
+    int read(uint32_t block, size_t offs, void* data, size_t size) override {
+        auto s = buf_.read(block * BLOCK_SIZE + offs, size);
+        std::memcpy(data, s.data(), size);
+        return 0;
+    }
+
+    int prog(uint32_t block, size_t offs, const void* data, size_t size) override {
+        const size_t addr = block * BLOCK_SIZE + offs;
+        std::string s = buf_.read(addr, size);
+        for (size_t i = 0; i < size; ++i) {
+            s[i] &= ((const char*)data)[i];
+        }
+        buf_.write(addr, s);
+        return 0;
+    }
+
+    int erase(uint32_t block) override {
+        buf_.erase(block * BLOCK_SIZE, BLOCK_SIZE);
+        return 0;
+    }
+
+private:
+    SparseBuffer buf_;
+};
+
+// Reads the first lines of a number of metadata blocks, the way littlefs walks a directory tree
+void blockCacheDirWalk(Benchmark& b, size_t lineCount, size_t dirCount) {
+    SparseBlockDevice dev;
+    for (size_t i = 0; i < dirCount; ++i) {
+        std::string s(BLOCK_SIZE / 2, (char)i);
+        dev.prog(i, 0, s.data(), s.size());
+    }
+    BlockCache cache(&dev);
+    if (cache.init({ LINE_SIZE, lineCount, 0 }) < 0) {
+        b.fail("BlockCache::init() failed");
+        return;
+    }
+    char buf[LINE_SIZE] = {};
+    b.run([&]() {
+        for (size_t i = 0; i < dirCount; ++i) {
+            for (size_t offs = 0; offs < LINE_SIZE * 2; offs += LINE_SIZE) {
+                int r = cache.read(i, offs, buf, sizeof(buf));
+                doNotOptimize(r);
+            }
+        }
+    });
+}
+
+// Programs a block in small chunks, the way littlefs appends entries to a metadata block
+void blockCacheProg(Benchmark& b, size_t writeBufSize, size_t chunkSize) {
+    SparseBlockDevice dev;
+    BlockCache cache(&dev);
+    if (cache.init({ LINE_SIZE, 0, writeBufSize }) < 0) {
+        b.fail("BlockCache::init() failed");
+        return;
+    }
+    std::string data(chunkSize, 'a');
+    b.bytesProcessed(BLOCK_SIZE);
+    b.run([&]() {
+        cache.erase(0);
+        for (size_t offs = 0; offs + chunkSize <= BLOCK_SIZE; offs += chunkSize) {
+            cache.prog(0, offs, data.data(), data.size());
+        }
+        cache.sync();
+    });
+}
+
+} // namespace
+
+BENCHMARK("BlockCache/dir_walk/uncached", blockCacheDirWalk, 0, 16);
+BENCHMARK("BlockCache/dir_walk/32_lines", blockCacheDirWalk, 32, 16);
+BENCHMARK("BlockCache/dir_walk/8_lines", blockCacheDirWalk, 8, 16);
+BENCHMARK("BlockCache/prog/write_through", blockCacheProg, 0, 256);
+BENCHMARK("BlockCache/prog/write_behind", blockCacheProg, 4096, 256);
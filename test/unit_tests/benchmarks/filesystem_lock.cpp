@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "static_recursive_mutex.h"
+
+#include "bench.h"
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+using namespace particle::bench;
+
+namespace {
+
+// Time a background thread holds the lock to emulate a long write, e.g. a chunk of an asset. The
+// thread sleeps rather than spins as most of that time is spent waiting for the flash
+const auto HOLD_TIME = std::chrono::microseconds(200);
+
+// Time a background thread spends without holding the lock, e.g. receiving the next chunk
+const auto IDLE_TIME = std::chrono::microseconds(50);
+
+// Measures the time it takes to perform a short operation on the default filesystem while other
+// threads keep performing long operations on the asset storage. The filesystem HAL uses the same
+// mutex type, see filesystem_lock.cpp. With a global lock, both filesystems share one mutex
+void fsLockContention(Benchmark& b, bool globalLock, unsigned writerCount) {
+    StaticRecursiveMutex defaultFsMutex;
+    StaticRecursiveMutex assetFsMutex;
+    auto& writerMutex = globalLock ? defaultFsMutex : assetFsMutex;
+    std::atomic_bool stop(false);
+    std::vector<std::thread> writers;
+    for (unsigned i = 0; i < writerCount; ++i) {
+        writers.emplace_back([&]() {
+            while (!stop) {
+                writerMutex.lock();
+                std::this_thread::sleep_for(HOLD_TIME);
+                writerMutex.unlock();
+                std::this_thread::sleep_for(IDLE_TIME);
+            }
+        });
+    }
+    b.run([&]() {
+        defaultFsMutex.lock();
+        clobberMemory();
+        defaultFsMutex.unlock();
+    });
+    stop = true;
+    for (auto& t: writers) {
+        t.join();
+    }
+}
+
+} // namespace
+
+BENCHMARK("FsLock/uncontended", fsLockContention, false, 0);
+BENCHMARK("FsLock/global_lock/1", fsLockContention, true, 1);
+BENCHMARK("FsLock/global_lock/3", fsLockContention, true, 3);
+BENCHMARK("FsLock/instance_lock/1", fsLockContention, false, 1);
+BENCHMARK("FsLock/instance_lock/3", fsLockContention, false, 3);
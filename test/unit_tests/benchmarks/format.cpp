@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "format.h"
+#include "spark_wiring_print.h"
+
+#include "bench.h"
+
+#include <cstdio>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+const char* const SHORT_FORMAT = "%d";
+const char* const LONG_FORMAT = "%010u %s:%d, %s: %s";
+
+class NullPrint: public Print {
+public:
+    size_t write(uint8_t /* c */) override {
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        doNotOptimize(data);
+        return size;
+    }
+};
+
+// Formatting path used by Print::printf() before it was switched to the streaming formatter: the
+// output is formatted into a small stack buffer and formatted again if it doesn't fit
+size_t printfTwoPass(Print& p, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+size_t printfTwoPass(Print& p, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    va_list args2;
+    va_copy(args2, args);
+    char buf[20];
+    size_t n = vsnprintf(buf, sizeof(buf), fmt, args);
+    if (n < sizeof(buf)) {
+        n = p.write((const uint8_t*)buf, n);
+    } else {
+        char buf[n + 1];
+        vsnprintf(buf, n + 1, fmt, args2);
+        n = p.write((const uint8_t*)buf, n);
+    }
+    va_end(args2);
+    va_end(args);
+    return n;
+}
+
+void formatShort(Benchmark& b, int impl) {
+    NullPrint p;
+    b.run([&]() {
+        size_t n = 0;
+        if (impl == 0) {
+            n = printfTwoPass(p, SHORT_FORMAT, 12345);
+        } else if (impl == 1) {
+            n = p.printf(SHORT_FORMAT, 12345);
+        } else {
+            n = p.format(SHORT_FORMAT, 12345);
+        }
+        doNotOptimize(n);
+    });
+}
+
+void formatLong(Benchmark& b, int impl) {
+    NullPrint p;
+    b.run([&]() {
+        size_t n = 0;
+        if (impl == 0) {
+            n = printfTwoPass(p, LONG_FORMAT, 1234567u, "spark_wiring_print.cpp", 123, "INFO", "Connecting to the cloud");
+        } else if (impl == 1) {
+            n = p.printf(LONG_FORMAT, 1234567u, "spark_wiring_print.cpp", 123, "INFO", "Connecting to the cloud");
+        } else {
+            n = p.format(LONG_FORMAT, 1234567u, "spark_wiring_print.cpp", 123, "INFO", "Connecting to the cloud");
+        }
+        doNotOptimize(n);
+    });
+}
+
+} // namespace
+
+BENCHMARK("Format/short/vsnprintf_two_pass", formatShort, 0);
+BENCHMARK("Format/short/printf", formatShort, 1);
+BENCHMARK("Format/short/format", formatShort, 2);
+BENCHMARK("Format/long/vsnprintf_two_pass", formatLong, 0);
+BENCHMARK("Format/long/printf", formatLong, 1);
+BENCHMARK("Format/long/format", formatLong, 2);
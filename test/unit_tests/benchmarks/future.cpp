@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_async.h"
+
+#include "bench.h"
+
+#include <mutex>
+#include <condition_variable>
+
+using namespace particle::bench;
+
+namespace {
+
+// All callbacks are invoked synchronously in the benchmark thread
+struct Context {
+    typedef std::mutex Mutex;
+
+    class Semaphore {
+    public:
+        Semaphore() :
+                count_(0) {
+        }
+
+        bool isValid() const {
+            return true;
+        }
+
+        void give() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++count_;
+            cond_.notify_one();
+        }
+
+        bool take(system_tick_t timeout) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this]() { return count_ > 0; });
+            --count_;
+            return true;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        unsigned count_;
+    };
+
+    static void processApplicationEvents() {
+    }
+
+    static bool invokeApplicationCallback(void (*callback)(void* data), void* data) {
+        callback(data);
+        return true;
+    }
+
+    static bool isApplicationThreadCurrent() {
+        return true;
+    }
+};
+
+template<typename ResultT>
+using Future = particle::Future<ResultT, Context>;
+
+template<typename ResultT>
+using Promise = particle::Promise<ResultT, Context>;
+
+void futureCreate(Benchmark& b) {
+    b.run([&]() {
+        Promise<int> p;
+        auto f = p.future();
+        doNotOptimize(f);
+    });
+}
+
+void futureResolve(Benchmark& b) {
+    b.run([&]() {
+        Promise<int> p;
+        auto f = p.future();
+        p.setResult(1);
+        doNotOptimize(f.result());
+    });
+}
+
+void futureResolveWithCallbacks(Benchmark& b) {
+    int sum = 0;
+    b.run([&]() {
+        Promise<int> p;
+        auto f = p.future();
+        f.onSuccess([&sum](int v) {
+            sum += v;
+        });
+        f.onError([&sum](const particle::Error& e) {
+            sum -= 1;
+        });
+        p.setResult(1);
+    });
+    doNotOptimize(sum);
+}
+
+void futureThen(Benchmark& b) {
+    b.run([&]() {
+        Promise<int> p;
+        auto f = p.future().then([](int v) {
+            return v + 1;
+        });
+        p.setResult(1);
+        doNotOptimize(f.result());
+    });
+}
+
+void futureWhenAll(Benchmark& b) {
+    b.run([&]() {
+        Promise<int> p1;
+        Promise<void> p2;
+        auto f = particle::whenAll(p1.future(), p2.future());
+        p1.setResult(1);
+        p2.setResult();
+        doNotOptimize(f.isSucceeded());
+    });
+}
+
+} // namespace
+
+BENCHMARK("Future/create", futureCreate);
+BENCHMARK("Future/resolve", futureResolve);
+BENCHMARK("Future/resolve_with_callbacks", futureResolveWithCallbacks);
+BENCHMARK("Future/then", futureThen);
+BENCHMARK("Future/when_all", futureWhenAll);
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "inflate.h"
+
+#include "bench.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstring>
+
+using namespace particle::bench;
+
+namespace {
+
+const unsigned WINDOW_BITS = 15;
+
+// Returns data that compresses roughly as well as a typical firmware binary
+std::string genCompressibleData(size_t size) {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<unsigned> chunkSize(4, 64);
+    std::uniform_int_distribution<unsigned> byte(0, 255);
+    std::string d;
+    d.reserve(size);
+    while (d.size() < size) {
+        const size_t n = chunkSize(gen);
+        if (d.size() > n && gen() % 2) {
+            d.append(d, gen() % (d.size() - n), n); // Repeat a previous chunk
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                d += (char)byte(gen);
+            }
+        }
+    }
+    d.resize(size);
+    return d;
+}
+
+// Compresses data in the raw deflate format, as done by the compressed OTA tooling
+std::string deflateData(const std::string& data) {
+    z_stream strm = {};
+    if (deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, -(int)WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::string();
+    }
+    std::string out(deflateBound(&strm, data.size()), '\0');
+    strm.next_in = (Bytef*)data.data();
+    strm.avail_in = data.size();
+    strm.next_out = (Bytef*)&out[0];
+    strm.avail_out = out.size();
+    const int r = deflate(&strm, Z_FINISH);
+    deflateEnd(&strm);
+    if (r != Z_STREAM_END) {
+        return std::string();
+    }
+    out.resize(strm.total_out);
+    return out;
+}
+
+int discardOutput(const char* data, size_t size, void* userData) {
+    *(size_t*)userData += size;
+    return size;
+}
+
+void inflateData(Benchmark& b, size_t size, size_t chunkSize) {
+    const auto data = deflateData(genCompressibleData(size));
+    if (data.empty()) {
+        b.fail("Unable to compress data");
+        return;
+    }
+    inflate_ctx* ctx = nullptr;
+    inflate_opts opts = {};
+    opts.window_bits = WINDOW_BITS;
+    size_t outSize = 0;
+    if (inflate_create(&ctx, &opts, discardOutput, &outSize) < 0) {
+        b.fail("inflate_create() failed");
+        return;
+    }
+    b.bytesProcessed(size);
+    b.run([&]() {
+        inflate_reset(ctx);
+        outSize = 0;
+        size_t offs = 0;
+        int r = 0;
+        do {
+            // Feed the data in chunks, as it would be received over the network
+            size_t n = std::min(chunkSize, data.size() - offs);
+            const unsigned flags = (offs + n < data.size()) ? INFLATE_HAS_MORE_INPUT : 0;
+            r = inflate_input(ctx, data.data() + offs, &n, flags);
+            offs += n;
+        } while (r == INFLATE_NEEDS_MORE_INPUT || r == INFLATE_HAS_MORE_OUTPUT);
+        if (r != INFLATE_DONE || outSize != size) {
+            b.fail("inflate_input() failed");
+        }
+    });
+    inflate_destroy(ctx);
+}
+
+// Reads random blocks of decompressed data, optionally using saved decompressor states as restart points
+class RandomReader {
+public:
+    RandomReader(std::string data, size_t size) :
+            data_(std::move(data)),
+            ctx_(nullptr),
+            size_(size),
+            outPos_(0),
+            readPos_(0),
+            readSize_(0),
+            readBuf_(nullptr) {
+    }
+
+    ~RandomReader() {
+        inflate_destroy(ctx_);
+    }
+
+    int init() {
+        inflate_opts opts = {};
+        opts.window_bits = WINDOW_BITS;
+        return inflate_create(&ctx_, &opts, output, this);
+    }
+
+    int buildIndex(size_t span) {
+        inflate_reset(ctx_);
+        outPos_ = 0;
+        readSize_ = 0;
+        size_t offs = 0;
+        size_t next = span;
+        int r = 0;
+        do {
+            r = feed(&offs);
+            if (r == INFLATE_NEEDS_MORE_INPUT && outPos_ >= next) {
+                Checkpoint cp = { outPos_, offs, std::string() };
+                r = inflate_save_state(ctx_, [](const char* data, size_t size, void* userData) {
+                    ((std::string*)userData)->append(data, size);
+                    return (int)size;
+                }, &cp.state);
+                if (r < 0) {
+                    return r;
+                }
+                index_.push_back(std::move(cp));
+                next = outPos_ + span;
+                r = INFLATE_NEEDS_MORE_INPUT;
+            }
+        } while (r == INFLATE_NEEDS_MORE_INPUT || r == INFLATE_HAS_MORE_OUTPUT);
+        return (r == INFLATE_DONE && outPos_ == size_) ? 0 : -1;
+    }
+
+    int read(size_t pos, char* buf, size_t size) {
+        const Checkpoint* cp = nullptr;
+        for (const auto& c: index_) {
+            if (c.offset > pos) {
+                break;
+            }
+            cp = &c;
+        }
+        size_t offs = 0;
+        if (cp) {
+            std::pair<const std::string*, size_t> src(&cp->state, 0);
+            const int r = inflate_restore_state(ctx_, [](char* data, size_t size, void* userData) {
+                auto src = (std::pair<const std::string*, size_t>*)userData;
+                memcpy(data, src->first->data() + src->second, size);
+                src->second += size;
+                return (int)size;
+            }, &src);
+            if (r < 0) {
+                return r;
+            }
+            outPos_ = cp->offset;
+            offs = cp->compressedOffset;
+        } else {
+            inflate_reset(ctx_);
+            outPos_ = 0;
+        }
+        readPos_ = pos;
+        readSize_ = size;
+        readBuf_ = buf;
+        int r = 0;
+        do {
+            r = feed(&offs);
+        } while (outPos_ < readPos_ + readSize_ && (r == INFLATE_NEEDS_MORE_INPUT || r == INFLATE_HAS_MORE_OUTPUT));
+        return (outPos_ >= readPos_ + readSize_) ? 0 : -1;
+    }
+
+    size_t indexSize() const {
+        return index_.size();
+    }
+
+private:
+    struct Checkpoint {
+        size_t offset;
+        size_t compressedOffset;
+        std::string state;
+    };
+
+    std::vector<Checkpoint> index_;
+    std::string data_;
+    inflate_ctx* ctx_;
+    size_t size_;
+    size_t outPos_;
+    size_t readPos_;
+    size_t readSize_;
+    char* readBuf_;
+
+    int feed(size_t* offs) {
+        size_t n = std::min<size_t>(512, data_.size() - *offs);
+        const unsigned flags = (*offs + n < data_.size()) ? INFLATE_HAS_MORE_INPUT : 0;
+        const int r = inflate_input(ctx_, data_.data() + *offs, &n, flags);
+        *offs += n;
+        return r;
+    }
+
+    static int output(const char* data, size_t size, void* userData) {
+        const auto self = (RandomReader*)userData;
+        // Copy the part of the output that overlaps with the requested block
+        const size_t begin = std::max(self->outPos_, self->readPos_);
+        const size_t end = std::min(self->outPos_ + size, self->readPos_ + self->readSize_);
+        if (begin < end) {
+            memcpy(self->readBuf_ + (begin - self->readPos_), data + (begin - self->outPos_), end - begin);
+        }
+        self->outPos_ += size;
+        return size;
+    }
+};
+
+void randomRead(Benchmark& b, size_t size, size_t span) {
+    const size_t blockSize = 4096;
+    const auto decomp = genCompressibleData(size);
+    RandomReader reader(deflateData(decomp), size);
+    if (reader.init() < 0) {
+        b.fail("inflate_create() failed");
+        return;
+    }
+    if (span > 0 && (reader.buildIndex(span) < 0 || reader.indexSize() == 0)) {
+        b.fail("Unable to build the seek index");
+        return;
+    }
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<size_t> pos(0, size - blockSize);
+    std::string buf(blockSize, '\0');
+    b.bytesProcessed(blockSize);
+    b.run([&]() {
+        const size_t p = pos(gen);
+        if (reader.read(p, &buf[0], blockSize) < 0 || memcmp(buf.data(), decomp.data() + p, blockSize) != 0) {
+            b.fail("Unable to read data");
+        }
+    });
+}
+
+} // namespace
+
+BENCHMARK("inflate/4K/chunk_512", inflateData, 4096, 512);
+BENCHMARK("inflate/256K/chunk_512", inflateData, 256 * 1024, 512);
+BENCHMARK("inflate/256K/chunk_4K", inflateData, 256 * 1024, 4096);
+
+// Random 4KB reads from a 2MB compressed asset, with and without a seek index
+BENCHMARK("inflate/random_read_4K/2M/no_index", randomRead, 2 * 1024 * 1024, 0);
+BENCHMARK("inflate/random_read_4K/2M/span_64K", randomRead, 2 * 1024 * 1024, 64 * 1024);
+BENCHMARK("inflate/random_read_4K/2M/span_256K", randomRead, 2 * 1024 * 1024, 256 * 1024);
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_logging.h"
+
+#include "bench.h"
+
+using namespace spark;
+using namespace particle::bench;
+
+namespace {
+
+// Output stream that discards all data
+class NullPrint: public Print {
+public:
+    size_t write(const uint8_t* data, size_t size) override {
+        return size;
+    }
+
+    size_t write(uint8_t b) override {
+        return 1;
+    }
+};
+
+// Log handler that counts the messages without formatting them
+class CountingLogHandler: public LogHandler {
+public:
+    explicit CountingLogHandler(LogLevel level = LOG_LEVEL_INFO, LogCategoryFilters filters = {}) :
+            LogHandler(level, std::move(filters)),
+            count_(0) {
+    }
+
+    size_t count() const {
+        return count_;
+    }
+
+protected:
+    void logMessage(const char* msg, LogLevel level, const char* category, const LogAttributes& attr) override {
+        ++count_;
+    }
+
+private:
+    size_t count_;
+};
+
+// Adds a log handler for the duration of a benchmark
+class HandlerGuard {
+public:
+    explicit HandlerGuard(LogHandler* handler) :
+            handler_(handler) {
+        LogManager::instance()->addHandler(handler_);
+    }
+
+    ~HandlerGuard() {
+        LogManager::instance()->removeHandler(handler_);
+    }
+
+private:
+    LogHandler* handler_;
+};
+
+LogCategoryFilters makeFilters() {
+    // Filters similar to the ones used in applications that enable tracing for select modules
+    return {
+        { "app", LOG_LEVEL_ALL },
+        { "app.network", LOG_LEVEL_WARN },
+        { "app.sensor", LOG_LEVEL_TRACE },
+        { "comm", LOG_LEVEL_WARN },
+        { "comm.protocol", LOG_LEVEL_ERROR },
+        { "net.ppp", LOG_LEVEL_NONE },
+        { "ncp.at", LOG_LEVEL_INFO },
+        { "system.ledger", LOG_LEVEL_TRACE }
+    };
+}
+
+void logEnabled(Benchmark& b) {
+    CountingLogHandler handler;
+    HandlerGuard g(&handler);
+    const Logger log("app");
+    b.run([&]() {
+        log.info("Temperature: %d.%d C", 23, 5);
+    });
+}
+
+void logDisabled(Benchmark& b) {
+    CountingLogHandler handler(LOG_LEVEL_WARN);
+    HandlerGuard g(&handler);
+    const Logger log("app");
+    b.run([&]() {
+        // Filtered out by the handler's level
+        log.trace("Temperature: %d.%d C", 23, 5);
+    });
+}
+
+void logCategoryFilters(Benchmark& b) {
+    CountingLogHandler handler(LOG_LEVEL_INFO, makeFilters());
+    HandlerGuard g(&handler);
+    const Logger log("app.sensor.temp");
+    b.run([&]() {
+        log.info("Temperature: %d.%d C", 23, 5);
+    });
+}
+
+void logStreamHandler(Benchmark& b) {
+    NullPrint out;
+    StreamLogHandler handler(out, LOG_LEVEL_INFO);
+    HandlerGuard g(&handler);
+    const Logger log("app");
+    b.run([&]() {
+        log.info("Temperature: %d.%d C", 23, 5);
+    });
+}
+
+void logMultipleHandlers(Benchmark& b) {
+    NullPrint out;
+    StreamLogHandler handler1(out, LOG_LEVEL_INFO);
+    CountingLogHandler handler2(LOG_LEVEL_INFO, makeFilters());
+    CountingLogHandler handler3(LOG_LEVEL_ERROR);
+    HandlerGuard g1(&handler1);
+    HandlerGuard g2(&handler2);
+    HandlerGuard g3(&handler3);
+    const Logger log("app.network");
+    b.run([&]() {
+        log.info("Connected to %s:%d", "10.0.0.1", 5684);
+    });
+}
+
+} // namespace
+
+BENCHMARK("LogManager/message", logEnabled);
+BENCHMARK("LogManager/message_filtered_out", logDisabled);
+BENCHMARK("LogManager/category_filters", logCategoryFilters);
+BENCHMARK("LogManager/stream_handler", logStreamHandler);
+BENCHMARK("LogManager/multiple_handlers", logMultipleHandlers);
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+
+#include <regex>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace particle::bench;
+
+namespace {
+
+const char USAGE[] =
+        "Usage: benchmarks [options]\n"
+        "\n"
+        "Options:\n"
+        "  -f, --filter <regex>  Run only the benchmarks whose names match a regular expression\n"
+        "  -t, --min-time <ms>   Minimum duration of each benchmark run in milliseconds (default: 250)\n"
+        "  -j, --json <file>     Write the results to a file in JSON format\n"
+        "  -l, --list            List the benchmarks and exit\n"
+        "  -h, --help            Show this message and exit\n";
+
+struct Options {
+    std::string filter;
+    std::string jsonFile;
+    unsigned minTime = Benchmark::DEFAULT_MIN_TIME;
+    bool list = false;
+    bool help = false;
+};
+
+bool parseOptions(int argc, char* argv[], Options* opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* const arg = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if ((!strcmp(arg, "-f") || !strcmp(arg, "--filter")) && hasValue) {
+            opts->filter = argv[++i];
+        } else if ((!strcmp(arg, "-t") || !strcmp(arg, "--min-time")) && hasValue) {
+            opts->minTime = strtoul(argv[++i], nullptr, 10);
+        } else if ((!strcmp(arg, "-j") || !strcmp(arg, "--json")) && hasValue) {
+            opts->jsonFile = argv[++i];
+        } else if (!strcmp(arg, "-l") || !strcmp(arg, "--list")) {
+            opts->list = true;
+        } else if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            opts->help = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string escapeJson(const std::string& str) {
+    std::string s;
+    for (char c: str) {
+        if (c == '"' || c == '\\') {
+            s += '\\';
+        }
+        s += c;
+    }
+    return s;
+}
+
+bool writeJson(const std::string& file, const std::vector<Result>& results) {
+    std::ofstream out(file);
+    if (!out) {
+        return false;
+    }
+    out << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << ((i > 0) ? "," : "") << "\n    {"
+                << "\"name\": \"" << escapeJson(r.name) << "\", "
+                << "\"iterations\": " << r.iterations << ", "
+                << "\"ns_per_op\": " << r.nsPerOp << ", "
+                << "\"allocs_per_op\": " << r.allocsPerOp << ", "
+                << "\"bytes_per_op\": " << r.bytesPerOp;
+        if (r.mbPerSec > 0) {
+            out << ", \"mb_per_sec\": " << r.mbPerSec;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+    return (bool)out;
+}
+
+void printHeader() {
+    printf("%-48s %12s %12s %10s %10s %10s\n", "benchmark", "iterations", "ns/op", "allocs/op", "B/op", "MB/s");
+}
+
+void printResult(const Result& r) {
+    printf("%-48s %12llu %12.1f ", r.name.c_str(), (unsigned long long)r.iterations, r.nsPerOp);
+    if (AllocStats::supported()) {
+        printf("%10.2f %10.1f ", r.allocsPerOp, r.bytesPerOp);
+    } else {
+        printf("%10s %10s ", "-", "-");
+    }
+    if (r.mbPerSec > 0) {
+        printf("%10.1f\n", r.mbPerSec);
+    } else {
+        printf("%10s\n", "-");
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    if (!parseOptions(argc, argv, &opts)) {
+        fputs(USAGE, stderr);
+        return 1;
+    }
+    if (opts.help) {
+        fputs(USAGE, stdout);
+        return 0;
+    }
+    std::regex filter;
+    try {
+        filter = std::regex(opts.filter);
+    } catch (const std::regex_error& e) {
+        fprintf(stderr, "Invalid filter expression: %s\n", e.what());
+        return 1;
+    }
+    std::vector<Result> results;
+    bool failed = false;
+    for (const auto& info: registeredBenchmarks()) {
+        if (!std::regex_search(info.name, filter)) {
+            continue;
+        }
+        if (opts.list) {
+            printf("%s\n", info.name.c_str());
+            continue;
+        }
+        if (results.empty() && !failed) {
+            printHeader();
+        }
+        Benchmark b(info.name, opts.minTime);
+        info.fn(b);
+        if (!b.error().empty() || !b.hasResult()) {
+            fprintf(stderr, "%s: %s\n", info.name.c_str(), b.error().empty() ? "run() was not called" :
+                    b.error().c_str());
+            failed = true;
+            continue;
+        }
+        printResult(b.result());
+        fflush(stdout);
+        results.push_back(b.result());
+    }
+    if (!opts.jsonFile.empty() && !writeJson(opts.jsonFile, results)) {
+        fprintf(stderr, "Unable to write file: %s\n", opts.jsonFile.c_str());
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
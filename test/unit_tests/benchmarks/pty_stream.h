@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "stream.h"
+#include "system_error.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace particle {
+
+namespace bench {
+
+/**
+ * Non-blocking stream over the master side of a pseudoterminal.
+ *
+ * Both sides of the pseudoterminal are configured in raw mode. The peer side is opened with
+ * `openSlave()`.
+ */
+class PtyStream: public Stream {
+public:
+    PtyStream() :
+            fd_(-1) {
+        fd_ = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd_ < 0) {
+            return;
+        }
+        if (grantpt(fd_) < 0 || unlockpt(fd_) < 0) {
+            close(fd_);
+            fd_ = -1;
+            return;
+        }
+        makeRaw(fd_);
+    }
+
+    ~PtyStream() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    int read(char* data, size_t size) override {
+        const ssize_t n = ::read(fd_, data, size);
+        if (n < 0) {
+            return (errno == EAGAIN) ? 0 : SYSTEM_ERROR_IO;
+        }
+        return n;
+    }
+
+    int peek(char* data, size_t size) override {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+
+    int skip(size_t size) override {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+
+    int availForRead() override {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+
+    int write(const char* data, size_t size) override {
+        const ssize_t n = ::write(fd_, data, size);
+        if (n < 0) {
+            return (errno == EAGAIN) ? 0 : SYSTEM_ERROR_IO;
+        }
+        return n;
+    }
+
+    int flush() override {
+        return 0;
+    }
+
+    int availForWrite() override {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        struct pollfd p = {};
+        p.fd = fd_;
+        if (flags & READABLE) {
+            p.events |= POLLIN;
+        }
+        if (flags & WRITABLE) {
+            p.events |= POLLOUT;
+        }
+        const int r = poll(&p, 1, (timeout > 0) ? (int)timeout : -1 /* Infinite */);
+        if (r < 0) {
+            return SYSTEM_ERROR_IO;
+        }
+        if (r == 0) {
+            return SYSTEM_ERROR_TIMEOUT;
+        }
+        unsigned events = 0;
+        if (p.revents & POLLIN) {
+            events |= READABLE;
+        }
+        if (p.revents & POLLOUT) {
+            events |= WRITABLE;
+        }
+        return events ? (int)events : SYSTEM_ERROR_IO;
+    }
+
+    // Opens the slave side of the pseudoterminal in blocking mode
+    int openSlave() const {
+        const int fd = open(ptsname(fd_), O_RDWR | O_NOCTTY);
+        if (fd >= 0) {
+            makeRaw(fd);
+        }
+        return fd;
+    }
+
+    bool isValid() const {
+        return fd_ >= 0;
+    }
+
+private:
+    int fd_;
+
+    static void makeRaw(int fd) {
+        struct termios t = {};
+        tcgetattr(fd, &t);
+        cfmakeraw(&t);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+};
+
+} // namespace bench
+
+} // namespace particle
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ringbuffer.h"
+
+#include "bench.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+using namespace particle::services;
+using namespace particle::bench;
+
+namespace {
+
+const size_t BUFFER_SIZE = 4096;
+
+void ringBufferPutGet(Benchmark& b, size_t size) {
+    std::vector<uint8_t> storage(BUFFER_SIZE);
+    RingBuffer<uint8_t> buf(storage.data(), storage.size());
+    std::vector<uint8_t> data(size, 0xaa);
+    b.bytesProcessed(size);
+    b.run([&]() {
+        buf.put(data.data(), data.size());
+        buf.get(data.data(), data.size());
+        clobberMemory();
+    });
+}
+
+void ringBufferPutGetByte(Benchmark& b, size_t size) {
+    std::vector<uint8_t> storage(BUFFER_SIZE);
+    RingBuffer<uint8_t> buf(storage.data(), storage.size());
+    b.bytesProcessed(size);
+    b.run([&]() {
+        for (size_t i = 0; i < size; ++i) {
+            buf.put((uint8_t)i);
+        }
+        uint8_t v = 0;
+        for (size_t i = 0; i < size; ++i) {
+            buf.get(&v);
+        }
+        doNotOptimize(v);
+    });
+}
+
+void ringBufferAcquireConsume(Benchmark& b, size_t size) {
+    std::vector<uint8_t> storage(BUFFER_SIZE);
+    RingBuffer<uint8_t> buf(storage.data(), storage.size());
+    b.bytesProcessed(size);
+    b.run([&]() {
+        // Zero-copy access, as used by the serial drivers
+        buf.acquireBegin();
+        size_t n = std::min(size, buf.acquirable());
+        auto p = buf.acquire(n);
+        memset(p, 0x55, n);
+        buf.acquireCommit(n);
+        n = std::min(n, buf.consumable());
+        p = buf.consume(n);
+        doNotOptimize(*p);
+        buf.consumeCommit(n);
+    });
+}
+
+} // namespace
+
+BENCHMARK("RingBuffer/put+get/16", ringBufferPutGet, 16);
+BENCHMARK("RingBuffer/put+get/256", ringBufferPutGet, 256);
+BENCHMARK("RingBuffer/put+get/1024", ringBufferPutGet, 1024);
+BENCHMARK("RingBuffer/put+get_byte/256", ringBufferPutGetByte, 256);
+BENCHMARK("RingBuffer/acquire+consume/64", ringBufferAcquireConsume, 64);
+BENCHMARK("RingBuffer/acquire+consume/1024", ringBufferAcquireConsume, 1024);
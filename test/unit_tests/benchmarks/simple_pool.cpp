@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simple_pool_allocator.h"
+
+#include "bench.h"
+
+#include <random>
+#include <vector>
+
+using namespace particle::bench;
+
+namespace {
+
+const size_t POOL_SIZE = 16 * 1024;
+
+void poolAllocFree(Benchmark& b, size_t size) {
+    std::vector<char> buf(POOL_SIZE);
+    SimpleStaticPool pool(buf.data(), buf.size());
+    b.run([&]() {
+        void* p = pool.alloc(size);
+        doNotOptimize(p);
+        pool.free(p);
+    });
+}
+
+void poolAllocFreeLifo(Benchmark& b, size_t count) {
+    std::vector<char> buf(POOL_SIZE);
+    SimpleStaticPool pool(buf.data(), buf.size());
+    std::vector<void*> ptrs(count);
+    b.run([&]() {
+        for (size_t i = 0; i < count; ++i) {
+            ptrs[i] = pool.alloc(32);
+        }
+        for (size_t i = count; i > 0; --i) {
+            pool.free(ptrs[i - 1]);
+        }
+    });
+}
+
+void poolAllocFreeFragmented(Benchmark& b, size_t size) {
+    std::vector<char> buf(POOL_SIZE);
+    SimpleStaticPool pool(buf.data(), buf.size());
+    // Fill the pool with blocks of random sizes and free every other block so that the allocations
+    // have to be served from a free list populated with blocks of different sizes
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<size_t> dist(8, 128);
+    std::vector<void*> ptrs;
+    for (;;) {
+        void* p = pool.alloc(dist(gen));
+        if (!p) {
+            break;
+        }
+        ptrs.push_back(p);
+    }
+    for (size_t i = 0; i < ptrs.size(); i += 2) {
+        pool.free(ptrs[i]);
+    }
+    b.run([&]() {
+        void* p = pool.alloc(size);
+        doNotOptimize(p);
+        pool.free(p);
+    });
+}
+
+} // namespace
+
+BENCHMARK("SimpleBasePool/alloc+free/16", poolAllocFree, 16);
+BENCHMARK("SimpleBasePool/alloc+free/256", poolAllocFree, 256);
+BENCHMARK("SimpleBasePool/alloc+free_lifo/64", poolAllocFreeLifo, 64);
+BENCHMARK("SimpleBasePool/alloc+free_fragmented/16", poolAllocFreeFragmented, 16);
+BENCHMARK("SimpleBasePool/alloc+free_fragmented/100", poolAllocFreeFragmented, 100);
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The system socket headers need to be included before socket_hal.h, see socket_hal.cpp
+#include "boost_asio_wrap.h"
+#define HAL_SOCKET_HAL_COMPAT_NO_SOCKADDR (1)
+#include "socket_hal.h"
+
+#include "bench.h"
+
+#include <thread>
+#include <string>
+
+using namespace particle::bench;
+
+namespace ip = boost::asio::ip;
+
+namespace {
+
+// Echoes the data received over an accepted connection until the peer closes it
+void runEchoPeer(ip::tcp::acceptor* acceptor) {
+    ip::tcp::socket sock(acceptor->get_executor());
+    boost::system::error_code ec;
+    acceptor->accept(sock, ec);
+    if (ec) {
+        return;
+    }
+    // Send the echoed data without waiting for the previous segments to be acknowledged
+    sock.set_option(ip::tcp::no_delay(true), ec);
+    char buf[4096];
+    for (;;) {
+        const size_t n = sock.read_some(boost::asio::buffer(buf), ec);
+        if (ec || boost::asio::write(sock, boost::asio::buffer(buf, n), ec) != n) {
+            break;
+        }
+    }
+}
+
+// Sends a message over a TCP socket created with the socket HAL and polls the socket until the
+// message is echoed back by a peer running in another thread
+void tcpEcho(Benchmark& b, size_t msgSize) {
+    boost::asio::io_service service;
+    ip::tcp::acceptor acceptor(service, ip::tcp::endpoint(ip::address_v4::loopback(), 0 /* port */));
+    const uint16_t port = acceptor.local_endpoint().port();
+    std::thread t(runEchoPeer, &acceptor);
+    const sock_handle_t sock = socket_create(AF_INET, SOCK_STREAM, IPPROTO_TCP, 0 /* port */, 0 /* nif */);
+    sockaddr_t addr = {};
+    addr.sa_family = AF_INET;
+    addr.sa_data[0] = port >> 8;
+    addr.sa_data[1] = port & 0xff;
+    addr.sa_data[2] = 127;
+    addr.sa_data[5] = 1;
+    if (!socket_handle_valid(sock) || socket_connect(sock, &addr, sizeof(addr)) != 0) {
+        b.fail("Unable to connect to the peer");
+    } else {
+        const std::string msg(msgSize, 'a');
+        std::string buf(msgSize, '\0');
+        b.bytesProcessed(msgSize);
+        b.run([&]() {
+            if (socket_send(sock, msg.data(), msg.size()) != (sock_result_t)msg.size()) {
+                return b.fail("socket_send() failed");
+            }
+            size_t size = 0;
+            while (size < msgSize) {
+                const sock_result_t r = socket_receive(sock, &buf[size], msgSize - size, 0 /* timeout */);
+                if (r < 0) {
+                    return b.fail("socket_receive() failed");
+                }
+                size += r;
+            }
+        });
+    }
+    if (socket_handle_valid(sock)) {
+        socket_close(sock);
+    }
+    // The peer thread exits once the connection is closed. Cancel the accept operation in case the
+    // connection hasn't been established
+    boost::system::error_code ec;
+    acceptor.close(ec);
+    t.join();
+}
+
+} // namespace
+
+// Used by the socket HAL for debug output. Defined in core_hal.cpp, which is not built here
+extern "C" void core_log(const char* msg, ...) {
+}
+
+BENCHMARK("socket_hal/tcp_echo/64", tcpEcho, 64);
+BENCHMARK("socket_hal/tcp_echo/1K", tcpEcho, 1024);
+BENCHMARK("socket_hal/tcp_echo/16K", tcpEcho, 16 * 1024);
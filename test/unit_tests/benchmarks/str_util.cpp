@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "str_util.h"
+
+#include "bench.h"
+
+#include <random>
+#include <string>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+std::string randomData(size_t size) {
+    std::mt19937 gen(0);
+    std::string data(size, '\0');
+    for (auto& c: data) {
+        c = gen();
+    }
+    return data;
+}
+
+void strToHex(Benchmark& b, size_t size) {
+    const auto data = randomData(size);
+    std::string hex(size * 2 + 1, '\0');
+    b.bytesProcessed(size);
+    b.run([&]() {
+        doNotOptimize(toHex(data.data(), data.size(), &hex[0], hex.size()));
+    });
+}
+
+void strFromHex(Benchmark& b, size_t size) {
+    const auto data = randomData(size);
+    std::string hex(size * 2 + 1, '\0');
+    toHex(data.data(), data.size(), &hex[0], hex.size());
+    std::string out(size, '\0');
+    b.bytesProcessed(size * 2);
+    b.run([&]() {
+        doNotOptimize(fromHex(hex.data(), size * 2, &out[0], out.size()));
+    });
+}
+
+void strEqualsIgnoreCase(Benchmark& b, size_t size) {
+    std::string str1(size * 2 + 1, '\0');
+    const auto data = randomData(size);
+    toHex(data.data(), data.size(), &str1[0], str1.size());
+    str1.resize(size);
+    auto str2 = str1;
+    toUpperCase(&str2[0], str2.size());
+    b.bytesProcessed(size);
+    b.run([&]() {
+        doNotOptimize(equalsIgnoreCase(str1.data(), str1.size(), str2.data(), str2.size()));
+    });
+}
+
+} // namespace
+
+BENCHMARK("str_util/toHex/12", strToHex, 12); // Device ID
+BENCHMARK("str_util/toHex/256", strToHex, 256);
+BENCHMARK("str_util/fromHex/12", strFromHex, 12);
+BENCHMARK("str_util/fromHex/256", strFromHex, 256);
+BENCHMARK("str_util/equalsIgnoreCase/32", strEqualsIgnoreCase, 32);
+BENCHMARK("str_util/equalsIgnoreCase/256", strEqualsIgnoreCase, 256);
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_string.h"
+#include "spark_wiring_string_builder.h"
+
+#include "bench.h"
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+const char FRAGMENT[] = "\"key\":12345,";
+
+// Builds a string by appending short fragments to it, e.g. when formatting a JSON document
+void stringAppend(Benchmark& b, size_t count) {
+    b.bytesProcessed(count * (sizeof(FRAGMENT) - 1));
+    b.run([&]() {
+        String s;
+        for (size_t i = 0; i < count; ++i) {
+            s += FRAGMENT;
+        }
+        doNotOptimize(s.c_str());
+    });
+}
+
+void stringReserveAppend(Benchmark& b, size_t count) {
+    b.bytesProcessed(count * (sizeof(FRAGMENT) - 1));
+    b.run([&]() {
+        String s;
+        s.reserve(count * (sizeof(FRAGMENT) - 1));
+        for (size_t i = 0; i < count; ++i) {
+            s += FRAGMENT;
+        }
+        doNotOptimize(s.c_str());
+    });
+}
+
+void stringBuilderAppend(Benchmark& b, size_t count) {
+    b.bytesProcessed(count * (sizeof(FRAGMENT) - 1));
+    b.run([&]() {
+        StringBuilder sb;
+        for (size_t i = 0; i < count; ++i) {
+            sb += FRAGMENT;
+        }
+        auto s = sb.toString();
+        doNotOptimize(s.c_str());
+    });
+}
+
+// Reuses the chunks of a builder across iterations
+void stringBuilderAppendReuse(Benchmark& b, size_t count) {
+    StringBuilder sb;
+    b.bytesProcessed(count * (sizeof(FRAGMENT) - 1));
+    b.run([&]() {
+        sb.clear();
+        for (size_t i = 0; i < count; ++i) {
+            sb += FRAGMENT;
+        }
+        auto s = sb.toString();
+        doNotOptimize(s.c_str());
+    });
+}
+
+} // namespace
+
+BENCHMARK("String/append/16", stringAppend, 16);
+BENCHMARK("String/append/256", stringAppend, 256);
+BENCHMARK("String/reserve+append/256", stringReserveAppend, 256);
+BENCHMARK("StringBuilder/append/16", stringBuilderAppend, 16);
+BENCHMARK("StringBuilder/append/256", stringBuilderAppend, 256);
+BENCHMARK("StringBuilder/append_reuse/256", stringBuilderAppendReuse, 256);
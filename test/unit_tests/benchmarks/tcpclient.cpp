@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The system socket headers need to be included before socket_hal.h, see socket_hal.cpp
+#include "boost_asio_wrap.h"
+#define HAL_SOCKET_HAL_COMPAT_NO_SOCKADDR (1)
+// Wiring defines its own INADDR_NONE constant
+#undef INADDR_NONE
+#include "spark_wiring_tcpclient.h"
+#include "system_network.h"
+
+#include "bench.h"
+
+#include <thread>
+#include <atomic>
+#include <string>
+
+using namespace particle::bench;
+
+namespace ip = boost::asio::ip;
+
+namespace {
+
+// A request is written in small pieces, e.g. the header fields of an HTTP request, and is echoed
+// back by the peer
+const size_t WRITE_SIZE = 16;
+const size_t WRITE_COUNT = 64;
+const size_t REQUEST_SIZE = WRITE_SIZE * WRITE_COUNT;
+
+// Echoes the data received over an accepted connection until the peer closes it. A read returns
+// at least one segment, so the number of reads is a lower bound of the number of segments sent
+// by the client
+void runEchoPeer(ip::tcp::acceptor* acceptor, std::atomic<bool>* accepted, std::atomic<unsigned>* reads) {
+    ip::tcp::socket sock(acceptor->get_executor());
+    boost::system::error_code ec;
+    acceptor->accept(sock, ec);
+    if (ec) {
+        return;
+    }
+    sock.set_option(ip::tcp::no_delay(true), ec);
+    *accepted = true;
+    char buf[4096];
+    for (;;) {
+        const size_t n = sock.read_some(boost::asio::buffer(buf), ec);
+        if (ec || boost::asio::write(sock, boost::asio::buffer(buf, n), ec) != n) {
+            break;
+        }
+        ++*reads;
+    }
+}
+
+// Sends requests over a loopback connection to a peer running in another thread. Fails if a
+// buffered request takes more than one segment
+void tcpEcho(Benchmark& b, size_t txBufSize) {
+    boost::asio::io_service service;
+    ip::tcp::acceptor acceptor(service, ip::tcp::endpoint(ip::address_v4::loopback(), 0 /* port */));
+    std::atomic<bool> accepted(false);
+    std::atomic<unsigned> peerReads(0);
+    std::thread t(runEchoPeer, &acceptor, &accepted, &peerReads);
+    TCPClient client;
+    if (!client.connect(IPAddress(127, 0, 0, 1), acceptor.local_endpoint().port())) {
+        b.fail("Unable to connect to the peer");
+    } else if (txBufSize && !client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, txBufSize)) {
+        b.fail("Unable to allocate the send buffer");
+    } else {
+        while (!accepted) {
+            std::this_thread::yield();
+        }
+        const std::string piece(WRITE_SIZE, 'a');
+        char buf[REQUEST_SIZE];
+        uint64_t requests = 0;
+        b.bytesProcessed(REQUEST_SIZE);
+        b.run([&]() {
+            for (size_t i = 0; i < WRITE_COUNT; ++i) {
+                if (client.write((const uint8_t*)piece.data(), piece.size()) != piece.size()) {
+                    return b.fail("TCPClient::write() failed");
+                }
+            }
+            size_t size = 0;
+            while (size < REQUEST_SIZE) {
+                const int r = client.read((uint8_t*)buf + size, REQUEST_SIZE - size);
+                if (r > 0) {
+                    size += r;
+                } else if (!client.connected()) {
+                    return b.fail("Connection closed");
+                }
+            }
+            ++requests;
+        });
+        // The peer has echoed every request, so all its reads have been counted
+        const double readsPerRequest = (double)peerReads / requests;
+        if (txBufSize && readsPerRequest > 1.5) {
+            b.fail("Too many segments per request: " + std::to_string(readsPerRequest));
+        }
+    }
+    client.stop();
+    boost::system::error_code ec;
+    acceptor.close(ec);
+    t.join();
+}
+
+} // namespace
+
+bool network_ready(network_handle_t network, uint32_t param1, void* reserved) {
+    return true;
+}
+
+BENCHMARK("TCPClient/echo/unbuffered/64x16", tcpEcho, 0);
+BENCHMARK("TCPClient/echo/buffered/64x16", tcpEcho, 1024);
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tlv_file.h"
+
+#include "mock/filesystem.h"
+
+#include "bench.h"
+
+#include <random>
+#include <vector>
+
+using namespace particle;
+using namespace particle::bench;
+using particle::services::settings::TlvFile;
+
+namespace {
+
+const size_t OP_COUNT = 10000;
+const unsigned KEY_COUNT = 16;
+const size_t MAX_VALUE_SIZE = 64;
+
+struct Op {
+    uint16_t key;
+    uint16_t size; // 0 for a read
+};
+
+// Performs a sequence of random reads and writes, with reads being three times as frequent, the
+// way the system cache is used. The file is stored in the in-memory filesystem used by the tests
+void tlvFileRandomOps(Benchmark& b, bool batched) {
+    MockRepository mocks;
+    test::Filesystem fs(&mocks);
+    TlvFile file("/sys/bench.dat");
+    if (file.init() < 0) {
+        b.fail("TlvFile::init() failed");
+        return;
+    }
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<unsigned> keyDist(1, KEY_COUNT);
+    std::uniform_int_distribution<unsigned> sizeDist(1, MAX_VALUE_SIZE);
+    std::uniform_int_distribution<unsigned> opDist(0, 3);
+    std::vector<Op> ops;
+    for (size_t i = 0; i < OP_COUNT; ++i) {
+        ops.push_back({ (uint16_t)keyDist(gen), (uint16_t)(opDist(gen) ? 0 : sizeDist(gen)) });
+    }
+    uint8_t buf[MAX_VALUE_SIZE] = {};
+    for (unsigned key = 1; key <= KEY_COUNT; ++key) {
+        file.set(key, buf, sizeof(buf), 0);
+    }
+    b.run([&]() {
+        if (batched) {
+            file.beginUpdate();
+        }
+        for (const auto& op: ops) {
+            if (op.size) {
+                file.set(op.key, buf, op.size, 0);
+            } else {
+                auto r = file.get(op.key, buf, sizeof(buf), 0);
+                doNotOptimize(r);
+            }
+        }
+        if (batched) {
+            file.endUpdate();
+        }
+    });
+    file.deInit();
+}
+
+} // namespace
+
+BENCHMARK("TlvFile/random_10k", tlvFileRandomOps, false);
+BENCHMARK("TlvFile/random_10k/batched", tlvFileRandomOps, true);
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_udp_packet.h"
+
+#include "bench.h"
+
+#include <vector>
+#include <cstring>
+
+using namespace particle::bench;
+using particle::detail::UdpPacketPool;
+
+namespace {
+
+// Simulates a flood of datagrams received in bursts of the given size. The datagrams are copied
+// from the "network stack" into the receive buffer like the socket HAL would do it
+
+const size_t PACKET_SIZE = 512;
+
+struct Datagram {
+    std::vector<uint8_t> data;
+    IPAddress remoteIP;
+    uint16_t remotePort;
+};
+
+std::vector<Datagram> makeBurst(size_t count, size_t size) {
+    std::vector<Datagram> burst(count);
+    for (size_t i = 0; i < count; ++i) {
+        burst[i].data.assign(size, (uint8_t)i);
+        burst[i].remoteIP = IPAddress(192, 168, 1, i);
+        burst[i].remotePort = 5683;
+    }
+    return burst;
+}
+
+unsigned consume(const uint8_t* data, size_t size) {
+    unsigned sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+// UDP::parsePacket() followed by UDP::read(): each datagram is copied into the instance buffer
+// and then into the application buffer, and the address of the sender is stored in the instance
+void floodCopy(Benchmark& b, size_t burstSize, size_t packetSize) {
+    auto burst = makeBurst(burstSize, packetSize);
+    std::vector<uint8_t> buf(PACKET_SIZE);
+    std::vector<uint8_t> appBuf(PACKET_SIZE);
+    IPAddress remoteIP;
+    uint16_t remotePort = 0;
+    b.bytesProcessed(burstSize * packetSize).run([&]() {
+        unsigned sum = 0;
+        for (const auto& d: burst) {
+            std::memcpy(buf.data(), d.data.data(), d.data.size());
+            remoteIP = d.remoteIP;
+            remotePort = d.remotePort;
+            doNotOptimize(remoteIP);
+            doNotOptimize(remotePort);
+            std::memcpy(appBuf.data(), buf.data(), d.data.size());
+            sum += consume(appBuf.data(), d.data.size());
+        }
+        doNotOptimize(sum);
+    });
+}
+
+// UDP::poll() followed by UDP::receivePacket(UDP::Packet&): the datagrams are queued in the pool
+// and processed in place
+void floodPool(Benchmark& b, size_t burstSize, size_t packetSize) {
+    auto burst = makeBurst(burstSize, packetSize);
+    UdpPacketPool pool(burstSize, PACKET_SIZE);
+    if (pool.init() < 0) {
+        b.fail("UdpPacketPool::init() failed");
+        return;
+    }
+    b.bytesProcessed(burstSize * packetSize).run([&]() {
+        for (const auto& d: burst) {
+            auto slot = pool.spare();
+            std::memcpy(slot->data, d.data.data(), d.data.size());
+            pool.commit(d.data.size(), d.remoteIP, d.remotePort);
+        }
+        unsigned sum = 0;
+        while (auto slot = pool.pop()) {
+            sum += consume(slot->data, slot->size);
+            UdpPacketPool::releaseSlot(slot);
+        }
+        doNotOptimize(sum);
+    });
+}
+
+// A burst that is twice as large as the queue: half of the datagrams are dropped
+void floodPoolOverflow(Benchmark& b, size_t burstSize, size_t packetSize) {
+    auto burst = makeBurst(burstSize, packetSize);
+    UdpPacketPool pool(burstSize / 2, PACKET_SIZE);
+    if (pool.init() < 0) {
+        b.fail("UdpPacketPool::init() failed");
+        return;
+    }
+    b.bytesProcessed(burstSize * packetSize).run([&]() {
+        for (const auto& d: burst) {
+            auto slot = pool.spare();
+            std::memcpy(slot->data, d.data.data(), d.data.size());
+            pool.commit(d.data.size(), d.remoteIP, d.remotePort);
+        }
+        unsigned sum = 0;
+        while (auto slot = pool.pop()) {
+            sum += consume(slot->data, slot->size);
+            UdpPacketPool::releaseSlot(slot);
+        }
+        doNotOptimize(sum);
+    });
+    if (pool.droppedCount() == 0) {
+        b.fail("No packets were dropped");
+    }
+}
+
+} // namespace
+
+BENCHMARK("UdpFlood/copy/16x64", floodCopy, 16, 64);
+BENCHMARK("UdpFlood/copy/16x512", floodCopy, 16, 512);
+BENCHMARK("UdpFlood/pool/16x64", floodPool, 16, 64);
+BENCHMARK("UdpFlood/pool/16x512", floodPool, 16, 512);
+BENCHMARK("UdpFlood/pool_overflow/16x64", floodPoolOverflow, 16, 64);
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "update_pipeline.h"
+
+#include "bench.h"
+
+#include <boost/crc.hpp>
+#include <zlib.h>
+
+#include <random>
+#include <fstream>
+#include <filesystem>
+#include <string>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+const size_t DATA_SIZE = 4 * 1024 * 1024;
+
+std::string genRandomData(size_t size) {
+    std::mt19937 gen(0);
+    std::string d(size, '\0');
+    for (auto& c: d) {
+        c = (char)gen();
+    }
+    return d;
+}
+
+// Two checksums standing in for the CRC-32 and SHA-256 calculated when a module is installed
+struct Checksums {
+    boost::crc_32_type crc;
+    uLong adler = adler32(0, Z_NULL, 0);
+
+    void updateCrc(const char* data, size_t size) {
+        crc.process_bytes(data, size);
+    }
+
+    void updateAdler(const char* data, size_t size) {
+        adler = adler32(adler, (const Bytef*)data, size);
+    }
+};
+
+std::string tempFileName() {
+    return (std::filesystem::temp_directory_path() / "update_pipeline_bench.bin").string();
+}
+
+// Writes the data to a file and then reads it back to calculate the checksums
+void verifyAfterWrite(Benchmark& b, size_t chunkSize) {
+    const auto data = genRandomData(DATA_SIZE);
+    const auto file = tempFileName();
+    b.bytesProcessed(data.size());
+    std::string buf(chunkSize, '\0');
+    b.run([&]() {
+        {
+            std::ofstream out(file, std::ios::binary | std::ios::trunc);
+            for (size_t offs = 0; offs < data.size(); offs += chunkSize) {
+                out.seekp(offs);
+                out.write(data.data() + offs, std::min(chunkSize, data.size() - offs));
+            }
+        }
+        std::ifstream in(file, std::ios::binary);
+        Checksums c;
+        size_t left = data.size();
+        while (left > 0) {
+            const size_t n = std::min(left, chunkSize);
+            in.read(&buf[0], n);
+            c.updateCrc(buf.data(), n);
+            c.updateAdler(buf.data(), n);
+            left -= n;
+        }
+        if (c.crc.checksum() == 0) {
+            b.fail("Unexpected checksum");
+        }
+    });
+    std::filesystem::remove(file);
+}
+
+// Calculates the checksums as the chunks are being written
+void verifyWhileWritingSync(Benchmark& b, size_t chunkSize) {
+    const auto data = genRandomData(DATA_SIZE);
+    const auto file = tempFileName();
+    b.bytesProcessed(data.size());
+    b.run([&]() {
+        Checksums c;
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        for (size_t offs = 0; offs < data.size(); offs += chunkSize) {
+            const size_t n = std::min(chunkSize, data.size() - offs);
+            out.seekp(offs);
+            out.write(data.data() + offs, n);
+            c.updateCrc(data.data() + offs, n);
+            c.updateAdler(data.data() + offs, n);
+        }
+        out.close();
+        if (c.crc.checksum() == 0) {
+            b.fail("Unexpected checksum");
+        }
+    });
+    std::filesystem::remove(file);
+}
+
+// Calculates the checksums in the writer thread as the chunks are being written
+void verifyWhileWriting(Benchmark& b, size_t chunkSize) {
+    const auto data = genRandomData(DATA_SIZE);
+    const auto file = tempFileName();
+    b.bytesProcessed(data.size());
+    b.run([&]() {
+        Checksums c;
+        AsyncFileWriter w;
+        w.open(file, [&](size_t offset, const char* data, size_t size) {
+            c.updateCrc(data, size);
+            c.updateAdler(data, size);
+        });
+        for (size_t offs = 0; offs < data.size(); offs += chunkSize) {
+            w.write(offs, data.data() + offs, std::min(chunkSize, data.size() - offs));
+        }
+        w.close();
+        if (c.crc.checksum() == 0) {
+            b.fail("Unexpected checksum");
+        }
+    });
+    std::filesystem::remove(file);
+}
+
+} // namespace
+
+BENCHMARK("UpdatePipeline/verifyAfterWrite/512", verifyAfterWrite, 512);
+BENCHMARK("UpdatePipeline/verifyAfterWrite/16K", verifyAfterWrite, 16 * 1024);
+BENCHMARK("UpdatePipeline/verifyWhileWritingSync/512", verifyWhileWritingSync, 512);
+BENCHMARK("UpdatePipeline/verifyWhileWritingSync/16K", verifyWhileWritingSync, 16 * 1024);
+BENCHMARK("UpdatePipeline/verifyWhileWriting/512", verifyWhileWriting, 512);
+BENCHMARK("UpdatePipeline/verifyWhileWriting/16K", verifyWhileWriting, 16 * 1024);
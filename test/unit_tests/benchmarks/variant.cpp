@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_variant.h"
+#include "spark_wiring_print.h"
+#include "spark_wiring_stream.h"
+
+#include "bench.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+// Print implementation that writes to a preallocated buffer so that the stream itself doesn't
+// contribute to the heap usage of the benchmark
+class BufferPrint: public Print {
+public:
+    explicit BufferPrint(size_t size) :
+            buf_(size),
+            size_(0) {
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        size = std::min(size, buf_.size() - size_);
+        memcpy(buf_.data() + size_, data, size);
+        size_ += size;
+        return size;
+    }
+
+    size_t write(uint8_t b) override {
+        return write(&b, 1);
+    }
+
+    const char* data() const {
+        return (const char*)buf_.data();
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    void reset() {
+        size_ = 0;
+    }
+
+private:
+    std::vector<uint8_t> buf_;
+    size_t size_;
+};
+
+class BufferStream: public Stream {
+public:
+    BufferStream(const char* data, size_t size) :
+            data_(data),
+            size_(size),
+            pos_(0) {
+    }
+
+    size_t readBytes(char* data, size_t size) override {
+        size = std::min(size, size_ - pos_);
+        memcpy(data, data_ + pos_, size);
+        pos_ += size;
+        return size;
+    }
+
+    int read() override {
+        if (pos_ == size_) {
+            return -1;
+        }
+        return (uint8_t)data_[pos_++];
+    }
+
+    int peek() override {
+        if (pos_ == size_) {
+            return -1;
+        }
+        return (uint8_t)data_[pos_];
+    }
+
+    int available() override {
+        return size_ - pos_;
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        return 0;
+    }
+
+    size_t write(uint8_t b) override {
+        return 0;
+    }
+
+    void flush() override {
+    }
+
+    void reset() {
+        pos_ = 0;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+// Returns a document similar to the ones exchanged with the Cloud via ledgers and events
+Variant makeDocument(int readingCount) {
+    VariantMap location;
+    location.set("lat", 43.6425662);
+    location.set("lon", -79.3870568);
+    location.set("alt", 112);
+    VariantArray readings;
+    for (int i = 0; i < readingCount; ++i) {
+        readings.append(i * 1.5);
+    }
+    VariantArray tags;
+    tags.append("outdoor");
+    tags.append("battery");
+    tags.append("north-wing");
+    VariantMap doc;
+    doc.set("name", "sensor-0001");
+    doc.set("id", 1234567);
+    doc.set("online", true);
+    doc.set("temp", 23.5);
+    doc.set("firmware", "6.1.0");
+    doc.set("location", std::move(location));
+    doc.set("tags", std::move(tags));
+    doc.set("readings", std::move(readings));
+    return Variant(std::move(doc));
+}
+
+void variantToCbor(Benchmark& b, int readingCount) {
+    const auto doc = makeDocument(readingCount);
+    const size_t size = getCBORSize(doc);
+    BufferPrint out(size);
+    b.bytesProcessed(size);
+    b.run([&]() {
+        out.reset();
+        if (encodeToCBOR(doc, out) < 0) {
+            b.fail("encodeToCBOR() failed");
+        }
+        clobberMemory();
+    });
+}
+
+void variantFromCbor(Benchmark& b, int readingCount) {
+    const auto doc = makeDocument(readingCount);
+    BufferPrint out(getCBORSize(doc));
+    if (encodeToCBOR(doc, out) < 0) {
+        b.fail("encodeToCBOR() failed");
+        return;
+    }
+    BufferStream in(out.data(), out.size());
+    b.bytesProcessed(out.size());
+    b.run([&]() {
+        in.reset();
+        Variant v;
+        if (decodeFromCBOR(v, in) < 0) {
+            b.fail("decodeFromCBOR() failed");
+        }
+        doNotOptimize(v);
+    });
+}
+
+void variantToJson(Benchmark& b, int readingCount) {
+    const auto doc = makeDocument(readingCount);
+    b.bytesProcessed(doc.toJSON().length());
+    b.run([&]() {
+        auto json = doc.toJSON();
+        doNotOptimize(json);
+    });
+}
+
+void variantFromJson(Benchmark& b, int readingCount) {
+    const auto json = makeDocument(readingCount).toJSON();
+    b.bytesProcessed(json.length());
+    b.run([&]() {
+        auto v = Variant::fromJSON(json.c_str());
+        doNotOptimize(v);
+    });
+}
+
+} // namespace
+
+BENCHMARK("Variant/to_cbor/small", variantToCbor, 4);
+BENCHMARK("Variant/to_cbor/large", variantToCbor, 256);
+BENCHMARK("Variant/from_cbor/small", variantFromCbor, 4);
+BENCHMARK("Variant/from_cbor/large", variantFromCbor, 256);
+BENCHMARK("Variant/to_json/small", variantToJson, 4);
+BENCHMARK("Variant/to_json/large", variantToJson, 256);
+BENCHMARK("Variant/from_json/small", variantFromJson, 4);
+BENCHMARK("Variant/from_json/large", variantFromJson, 256);
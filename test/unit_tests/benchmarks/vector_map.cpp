@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_vector.h"
+#include "spark_wiring_map.h"
+#include "spark_wiring_string.h"
+
+#include "bench.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+void vectorAppend(Benchmark& b, int count, bool reserve) {
+    b.run([&]() {
+        Vector<int> v;
+        if (reserve && !v.reserve(count)) {
+            b.fail("Unable to reserve memory");
+        }
+        for (int i = 0; i < count; ++i) {
+            v.append(i);
+        }
+        doNotOptimize(v.data());
+    });
+}
+
+void vectorInsertFront(Benchmark& b, int count) {
+    b.run([&]() {
+        Vector<int> v;
+        v.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            v.prepend(i);
+        }
+        doNotOptimize(v.data());
+    });
+}
+
+void vectorOfStringsAppend(Benchmark& b, int count) {
+    Vector<String> strs;
+    for (int i = 0; i < count; ++i) {
+        strs.append(String::format("string%d", i));
+    }
+    b.run([&]() {
+        Vector<String> v;
+        for (const auto& s: strs) {
+            v.append(s);
+        }
+        doNotOptimize(v.data());
+    });
+}
+
+// Returns the keys in a random but reproducible order
+std::vector<int> randomKeys(int count) {
+    std::vector<int> keys;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back(i * 7);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+    return keys;
+}
+
+std::vector<String> randomStringKeys(int count) {
+    std::vector<String> keys;
+    for (int key: randomKeys(count)) {
+        keys.push_back(String::format("key%d", key));
+    }
+    return keys;
+}
+
+void mapSet(Benchmark& b, int count) {
+    const auto keys = randomKeys(count);
+    b.run([&]() {
+        Map<int, int> m;
+        for (int key: keys) {
+            m.set(key, key);
+        }
+        doNotOptimize(m.size());
+    });
+}
+
+void mapGet(Benchmark& b, int count) {
+    const auto keys = randomKeys(count);
+    Map<int, int> m;
+    for (int key: keys) {
+        m.set(key, key);
+    }
+    b.run([&]() {
+        int sum = 0;
+        for (int key: keys) {
+            sum += m.get(key);
+        }
+        doNotOptimize(sum);
+    });
+}
+
+void mapSetString(Benchmark& b, int count) {
+    const auto keys = randomStringKeys(count);
+    b.run([&]() {
+        Map<String, int> m;
+        for (int i = 0; i < count; ++i) {
+            m.set(keys[i], i);
+        }
+        doNotOptimize(m.size());
+    });
+}
+
+void mapGetString(Benchmark& b, int count) {
+    const auto keys = randomStringKeys(count);
+    Map<String, int> m;
+    for (int i = 0; i < count; ++i) {
+        m.set(keys[i], i);
+    }
+    b.run([&]() {
+        int sum = 0;
+        for (const auto& key: keys) {
+            sum += m.get(key);
+        }
+        doNotOptimize(sum);
+    });
+}
+
+} // namespace
+
+BENCHMARK("Vector/append/1000", vectorAppend, 1000, false /* reserve */);
+BENCHMARK("Vector/append_reserved/1000", vectorAppend, 1000, true /* reserve */);
+BENCHMARK("Vector/prepend/100", vectorInsertFront, 100);
+BENCHMARK("Vector/append_string/100", vectorOfStringsAppend, 100);
+
+BENCHMARK("Map/set/10", mapSet, 10);
+BENCHMARK("Map/set/100", mapSet, 100);
+BENCHMARK("Map/get/10", mapGet, 10);
+BENCHMARK("Map/get/100", mapGet, 100);
+BENCHMARK("Map/set_string/100", mapSetString, 100);
+BENCHMARK("Map/get_string/100", mapGetString, 100);
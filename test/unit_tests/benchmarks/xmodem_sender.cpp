@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "xmodem_sender.h"
+#include "stream.h"
+
+#include "bench.h"
+#include "pty_stream.h"
+
+#include <thread>
+#include <string>
+#include <cstring>
+
+#include <unistd.h>
+
+using namespace particle;
+using namespace particle::bench;
+
+namespace {
+
+const size_t DATA_SIZE = 64 * 1024;
+
+const char STX = 0x02;
+const char EOT = 0x04;
+const char ACK = 0x06;
+
+class StringInputStream: public InputStream {
+public:
+    explicit StringInputStream(const std::string& data) :
+            data_(data),
+            offs_(0) {
+    }
+
+    int read(char* data, size_t size) override {
+        size = std::min(size, data_.size() - offs_);
+        memcpy(data, data_.data() + offs_, size);
+        offs_ += size;
+        return size;
+    }
+
+    int peek(char* data, size_t size) override {
+        size = std::min(size, data_.size() - offs_);
+        memcpy(data, data_.data() + offs_, size);
+        return size;
+    }
+
+    int skip(size_t size) override {
+        size = std::min(size, data_.size() - offs_);
+        offs_ += size;
+        return size;
+    }
+
+    int availForRead() override {
+        return data_.size() - offs_;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        return READABLE;
+    }
+
+private:
+    const std::string& data_;
+    size_t offs_;
+};
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::read(fd, data, size);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Receives 1K packets without validating them. Packets are acknowledged unless the streaming mode
+// is requested
+void receive(int fd, char ncg) {
+    const char ack = ACK;
+    if (::write(fd, &ncg, 1) != 1) {
+        return;
+    }
+    char buf[1024 + 4];
+    for (;;) {
+        char c = 0;
+        if (!readAll(fd, &c, 1)) {
+            return;
+        }
+        if (c == EOT) {
+            ::write(fd, &ack, 1);
+            return;
+        }
+        if (c != STX || !readAll(fd, buf, sizeof(buf))) {
+            return;
+        }
+        if (ncg != 'G' && ::write(fd, &ack, 1) != 1) {
+            return;
+        }
+    }
+}
+
+// The packets are sent over a pseudoterminal, so the round trip time of an ACK includes two
+// context switches, similarly to a UART serviced by an interrupt handler
+void xmodemTransfer(Benchmark& b, char ncg) {
+    PtyStream pty;
+    if (!pty.isValid()) {
+        return b.fail("posix_openpt() failed");
+    }
+    const int fd = pty.openSlave();
+    if (fd < 0) {
+        return b.fail("Unable to open the slave side of the pseudoterminal");
+    }
+    const std::string data(DATA_SIZE, 'a');
+    b.bytesProcessed(data.size());
+    b.run([&]() {
+        std::thread t(receive, fd, ncg);
+        StringInputStream src(data);
+        XmodemSender sender;
+        int r = sender.init(&pty, &src, data.size());
+        if (r == 0) {
+            do {
+                r = sender.run();
+                std::this_thread::yield();
+            } while (r == XmodemSender::RUNNING);
+        }
+        t.join();
+        if (r != XmodemSender::DONE) {
+            b.fail("Transfer failed");
+        }
+    });
+    close(fd);
+}
+
+} // namespace
+
+BENCHMARK("XmodemSender/transfer/C", xmodemTransfer, 'C');
+BENCHMARK("XmodemSender/transfer/G", xmodemTransfer, 'G');
@@ -435,6 +435,30 @@ TEST_CASE("CoapMessageDecoder") {
             CHECK(it.next() == false);
             CHECK(it == CoapOptionIterator());
         }
+        SECTION("options that don't fit in the option index") {
+            const unsigned optCount = CoapMessageDecoder::MAX_INDEXED_OPTION_COUNT + 4;
+            auto buf = std::string("\x42\x45\x04\xd2\xaa\xbb", 6);
+            for (unsigned i = 0; i < optCount; ++i) {
+                buf += (i == 0) ? '\x11' : '\x21'; // Option numbers: 1, 3, 5, ...
+                buf += (char)('a' + i);
+            }
+            CHECK(d.decode(buf.data(), buf.size()) == (int)buf.size());
+            for (unsigned i = 0; i < optCount; ++i) {
+                auto it = d.findOption(i * 2 + 1);
+                CHECK(it.option() == i * 2 + 1);
+                CHECK(std::string(it.data(), it.size()) == std::string(1, 'a' + i));
+                // The iterator returned by findOption() can be used to iterate over the remaining options
+                if (i < optCount - 1) {
+                    CHECK(it.next());
+                    CHECK(it.option() == i * 2 + 3);
+                    CHECK(std::string(it.data(), it.size()) == std::string(1, 'a' + i + 1));
+                } else {
+                    CHECK(it.next() == false);
+                }
+                CHECK(!d.hasOption(i * 2 + 2));
+            }
+            CHECK(!d.hasOption(0));
+        }
     }
     SECTION("decodes payload data correctly") {
         auto d = makeDecoder();
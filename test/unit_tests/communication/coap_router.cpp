@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <string>
+
+#include "v2/coap_router.h"
+#include "system_error.h"
+
+#include <catch2/catch.hpp>
+
+using namespace particle::protocol::v2;
+
+namespace {
+
+int requestCallback(coap_message* msg, const char* uri, int method, int reqId, void* arg) {
+    return 0;
+}
+
+// Handlers are told apart by their callback argument
+int ids[16] = {};
+
+CoapRouter::Handler handler(int id) {
+    CoapRouter::Handler h = {};
+    h.callback = requestCallback;
+    h.callbackArg = &ids[id];
+    return h;
+}
+
+int add(CoapRouter& router, const std::string& path, int id, unsigned method = COAP_METHOD_POST) {
+    return router.add(path.data(), path.size(), method, handler(id));
+}
+
+void remove(CoapRouter& router, const std::string& path, unsigned method = COAP_METHOD_POST) {
+    router.remove(path.data(), path.size(), method);
+}
+
+// Returns the ID of the handler found for a path, or -1 if no handler was found
+int find(const CoapRouter& router, const std::string& path, unsigned method = COAP_METHOD_POST) {
+    auto h = router.find(path.data(), path.size(), method);
+    if (!h) {
+        return -1;
+    }
+    return (int*)h->callbackArg - ids;
+}
+
+} // namespace
+
+TEST_CASE("CoapRouter") {
+    CoapRouter router;
+
+    SECTION("finds no handler if none are registered") {
+        CHECK(router.isEmpty());
+        CHECK(find(router, "a") == -1);
+        CHECK(find(router, "") == -1);
+    }
+
+    SECTION("matches a handler registered for a path and the paths nested under it") {
+        REQUIRE(add(router, "a/b", 1) == 0);
+        CHECK(find(router, "a/b") == 1);
+        CHECK(find(router, "a/b/c/d") == 1);
+        CHECK(find(router, "a") == -1);
+        CHECK(find(router, "a/c") == -1);
+        CHECK(find(router, "a/bc") == -1);
+    }
+
+    SECTION("matches any segment with a wildcard") {
+        REQUIRE(add(router, "a/*/c", 1) == 0);
+        CHECK(find(router, "a/b/c") == 1);
+        CHECK(find(router, "a/xyz/c/d") == 1);
+        CHECK(find(router, "a/b/d") == -1);
+        CHECK(find(router, "a/b") == -1);
+    }
+
+    SECTION("prefers an exact segment over a wildcard at the same depth") {
+        REQUIRE(add(router, "a/*", 1) == 0);
+        REQUIRE(add(router, "a/b", 2) == 0);
+        CHECK(find(router, "a/b") == 2);
+        CHECK(find(router, "a/b/c") == 2);
+        CHECK(find(router, "a/c") == 1);
+    }
+
+    SECTION("prefers a longer wildcard path over a shorter exact one") {
+        REQUIRE(add(router, "a/b", 1) == 0);
+        REQUIRE(add(router, "a/*", 2) == 0);
+        REQUIRE(add(router, "a/*/c", 3) == 0);
+        CHECK(find(router, "a/b/c") == 3);
+        CHECK(find(router, "a/b/d") == 1);
+        CHECK(find(router, "a/x/d") == 2);
+    }
+
+    SECTION("falls back to the handler registered for the root path") {
+        REQUIRE(add(router, "", 1) == 0);
+        REQUIRE(add(router, "a/b", 2) == 0);
+        CHECK(find(router, "") == 1);
+        CHECK(find(router, "x") == 1);
+        CHECK(find(router, "a") == 1);
+        CHECK(find(router, "a/b") == 2);
+    }
+
+    SECTION("only matches handlers registered for the request method") {
+        REQUIRE(add(router, "a", 1, COAP_METHOD_GET) == 0);
+        REQUIRE(add(router, "a/b", 2, COAP_METHOD_POST) == 0);
+        CHECK(find(router, "a/b", COAP_METHOD_GET) == 1);
+        CHECK(find(router, "a/b", COAP_METHOD_POST) == 2);
+        CHECK(find(router, "a/b", COAP_METHOD_PUT) == -1);
+        CHECK(add(router, "a", 3, 32) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(find(router, "a", 32) == -1);
+    }
+
+    SECTION("replaces the handler of a path that is registered again") {
+        REQUIRE(add(router, "a/*", 1) == 0);
+        REQUIRE(add(router, "a/*", 2) == 0);
+        CHECK(find(router, "a/b") == 2);
+        remove(router, "a/*");
+        CHECK(find(router, "a/b") == -1);
+        CHECK(router.isEmpty());
+    }
+
+    SECTION("prunes the nodes that are left without handlers") {
+        REQUIRE(add(router, "a", 1) == 0);
+        REQUIRE(add(router, "a/b/c", 2) == 0);
+        REQUIRE(add(router, "a/*/d", 3) == 0);
+        remove(router, "a/b/c");
+        CHECK(find(router, "a/b/c") == 1);
+        remove(router, "a/*/d");
+        CHECK(find(router, "a/x/d") == 1);
+        CHECK_FALSE(router.isEmpty());
+        // The router is only empty if the nodes for the removed paths were deleted
+        remove(router, "a");
+        CHECK(find(router, "a") == -1);
+        CHECK(router.isEmpty());
+        // Removing an unknown path has no effect
+        REQUIRE(add(router, "a", 1) == 0);
+        remove(router, "a/b");
+        remove(router, "a", COAP_METHOD_GET);
+        CHECK(find(router, "a") == 1);
+    }
+}
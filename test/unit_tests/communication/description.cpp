@@ -581,4 +581,70 @@ TEST_CASE("Description") {
         CHECK(m.option(CoapOption::CONTENT_FORMAT).toUInt() == (unsigned)(CoapContentFormat::APPLICATION_OCTET_STREAM));
         d.sendMessage(CoapMessage().type(CoapType::ACK).code(CoapCode::EMPTY).id(m.id()));
     }
+
+    SECTION("serializes the Describe data once per application state") {
+        uint32_t checksum = 1;
+        When(Method(cb, appStateSelectorInfo)).AlwaysDo([&](SparkAppStateSelector::Enum selector,
+                SparkAppStateUpdate::Enum operation, uint32_t data, void* reserved) {
+            return checksum;
+        });
+        When(Method(cb, appendAppInfo)).AlwaysDo([](appender_fn append, void* arg, void* reserved) {
+            auto s = std::string(PROTOCOL_BUFFER_SIZE, 'b');
+            append(arg, (const uint8_t*)s.data(), s.size());
+            return true;
+        });
+        for (int i = 0; i < 3; ++i) {
+            if (i == 2) {
+                // Change the application state
+                checksum = 2;
+            }
+            // Send a blockwise request to the server
+            d.get()->sendRequest(DescriptionType::DESCRIBE_APPLICATION);
+            auto m = d.receiveMessage();
+            CHECK(m.option(CoapOption::BLOCK1).toUInt() == BlockOption().index(0).more(true));
+            CHECK(m.payload() == "{" + std::string(BLOCK_SIZE - 1, 'b'));
+            d.sendMessage(CoapMessage().type(CoapType::ACK).code(CoapCode::EMPTY).id(m.id()));
+            m = d.receiveMessage();
+            CHECK(m.option(CoapOption::BLOCK1).toUInt() == BlockOption().index(1).more(false));
+            CHECK(m.payload() == std::string(PROTOCOL_BUFFER_SIZE - BLOCK_SIZE + 1, 'b') + '}');
+            d.sendMessage(CoapMessage().type(CoapType::ACK).code(CoapCode::EMPTY).id(m.id()));
+            CHECK(d.describeAckFlags() == DescriptionType::DESCRIBE_APPLICATION);
+        }
+        // Request the same data as a blockwise response
+        d.sendRequest(DescriptionType::DESCRIBE_APPLICATION);
+        d.skipMessages(1); // ACK
+        auto m = d.receiveMessage();
+        CHECK(m.option(CoapOption::BLOCK2).toUInt() == BlockOption().index(0).more(true));
+        CHECK(m.payload() == "{" + std::string(BLOCK_SIZE - 1, 'b'));
+        d.sendMessage(CoapMessage().type(CoapType::ACK).code(CoapCode::EMPTY).id(m.id()));
+        d.sendRequest(DescriptionType::DESCRIBE_APPLICATION, BlockOption().index(1));
+        d.skipMessages(1); // ACK
+        m = d.receiveMessage();
+        CHECK(m.option(CoapOption::BLOCK2).toUInt() == BlockOption().index(1).more(false));
+        CHECK(m.payload() == std::string(PROTOCOL_BUFFER_SIZE - BLOCK_SIZE + 1, 'b') + '}');
+        d.sendMessage(CoapMessage().type(CoapType::ACK).code(CoapCode::EMPTY).id(m.id()));
+        // append_app_info() should have been called once for each application state
+        Verify(Method(cb, appendAppInfo)).Twice();
+    }
+
+    SECTION("serializes the system Describe data again in a new session") {
+        When(Method(cb, appStateSelectorInfo)).AlwaysReturn(1);
+        When(Method(cb, appendSystemInfo)).AlwaysDo([](appender_fn append, void* arg, void* reserved) {
+            auto s = "{" + std::string(BLOCK_SIZE, 'a') + "}";
+            append(arg, (const uint8_t*)s.data(), s.size());
+            return true;
+        });
+        for (int i = 0; i < 2; ++i) {
+            d.get()->sendRequest(DescriptionType::DESCRIBE_SYSTEM);
+            auto m = d.receiveMessage();
+            CHECK(m.payload() == "{" + std::string(BLOCK_SIZE, 'a') + "}");
+            d.sendMessage(CoapMessage().type(CoapType::ACK).code(CoapCode::EMPTY).id(m.id()));
+        }
+        Verify(Method(cb, appendSystemInfo)).Once();
+        d.get()->reset();
+        d.get()->sendRequest(DescriptionType::DESCRIBE_SYSTEM);
+        auto m = d.receiveMessage();
+        CHECK(m.payload() == "{" + std::string(BLOCK_SIZE, 'a') + "}");
+        Verify(Method(cb, appendSystemInfo)).Twice();
+    }
 }
@@ -50,14 +50,24 @@ bool appendMetricsCallback(appender_fn append, void* arg, uint32_t flags, uint32
     return false;
 }
 
+uint32_t appStateSelectorInfoCallback(SparkAppStateSelector::Enum selector, SparkAppStateUpdate::Enum operation,
+        uint32_t data, void* reserved) {
+    if (g_callbacks) {
+        return g_callbacks->appStateSelectorInfo(selector, operation, data, reserved);
+    }
+    return 0;
+}
+
 } // namespace
 
 DescriptorCallbacks::DescriptorCallbacks() :
-        desc_() {
+        desc_(),
+        lastChecksum_(0) {
     desc_.size = sizeof(desc_);
     desc_.append_system_info = appendSystemInfoCallback;
     desc_.append_app_info = appendAppInfoCallback;
     desc_.append_metrics = appendMetricsCallback;
+    desc_.app_state_selector_info = appStateSelectorInfoCallback;
     g_callbacks = this;
 }
 
@@ -36,9 +36,13 @@ public:
     virtual bool appendSystemInfo(appender_fn append, void* arg, void* reserved);
     virtual bool appendAppInfo(appender_fn append, void* arg, void* reserved);
     virtual bool appendMetrics(appender_fn append, void* arg, uint32_t flags, uint32_t page, void* reserved);
+    // By default, a different checksum is computed on each call so that no Describe data is reused
+    virtual uint32_t appStateSelectorInfo(SparkAppStateSelector::Enum selector, SparkAppStateUpdate::Enum operation,
+            uint32_t data, void* reserved);
 
 private:
     SparkDescriptor desc_;
+    uint32_t lastChecksum_;
 };
 
 inline const SparkDescriptor& DescriptorCallbacks::get() const {
@@ -57,6 +61,11 @@ inline bool DescriptorCallbacks::appendMetrics(appender_fn append, void* arg, ui
     return false;
 }
 
+inline uint32_t DescriptorCallbacks::appStateSelectorInfo(SparkAppStateSelector::Enum selector, SparkAppStateUpdate::Enum operation,
+        uint32_t data, void* reserved) {
+    return ++lastChecksum_;
+}
+
 } // namespace test
 
 } // namespace protocol
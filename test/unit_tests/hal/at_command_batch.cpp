@@ -0,0 +1,269 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstring>
+
+#include "at_command_batch.h"
+#include "at_parser.h"
+#include "at_response.h"
+#include "stream.h"
+#include "system_error.h"
+
+#include "util/catch.h"
+
+using namespace particle;
+
+namespace {
+
+// A stream emulating a DCE that executes extended syntax commands as described in V.250
+class TestDce: public Stream {
+public:
+    // Registers the response lines for a command
+    void response(const std::string& cmd, const std::vector<std::string>& lines) {
+        responses_[cmd] = lines;
+    }
+
+    // Makes a command fail
+    void fail(const std::string& cmd) {
+        failing_.insert(cmd);
+    }
+
+    // Makes a command fail only the first time it's executed
+    void failOnce(const std::string& cmd) {
+        failingOnce_.insert(cmd);
+    }
+
+    // Returns the command lines received from the DTE
+    const std::vector<std::string>& commandLines() const {
+        return cmdLines_;
+    }
+
+    int read(char* data, size_t size) override {
+        const size_t n = std::min(size, in_.size());
+        memcpy(data, in_.data(), n);
+        in_.erase(0, n);
+        return n;
+    }
+
+    int peek(char* data, size_t size) override {
+        const size_t n = std::min(size, in_.size());
+        memcpy(data, in_.data(), n);
+        return n;
+    }
+
+    int skip(size_t size) override {
+        const size_t n = std::min(size, in_.size());
+        in_.erase(0, n);
+        return n;
+    }
+
+    int availForRead() override {
+        return in_.size();
+    }
+
+    int write(const char* data, size_t size) override {
+        out_.append(data, size);
+        size_t pos = 0;
+        while ((pos = out_.find('\r')) != std::string::npos) {
+            const auto line = out_.substr(0, pos);
+            out_.erase(0, pos + 1);
+            execute(line);
+        }
+        return size;
+    }
+
+    int flush() override {
+        return 0;
+    }
+
+    int availForWrite() override {
+        return 1024;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        if ((flags & READABLE) && in_.empty()) {
+            return SYSTEM_ERROR_TIMEOUT; // The DCE has nothing else to send
+        }
+        return flags;
+    }
+
+private:
+    std::map<std::string, std::vector<std::string>> responses_;
+    std::set<std::string> failing_;
+    std::set<std::string> failingOnce_;
+    std::vector<std::string> cmdLines_;
+    std::string in_, out_;
+
+    void execute(const std::string& line) {
+        cmdLines_.push_back(line);
+        REQUIRE(line.substr(0, 2) == "AT");
+        size_t pos = 2;
+        for (;;) {
+            const size_t end = std::min(line.find(';', pos), line.size());
+            const auto cmd = line.substr(pos, end - pos);
+            const auto it = responses_.find(cmd);
+            if (it != responses_.end()) {
+                for (const auto& l: it->second) {
+                    in_ += "\r\n" + l + "\r\n";
+                }
+            }
+            if (failing_.count(cmd) || failingOnce_.erase(cmd)) {
+                in_ += "\r\nERROR\r\n";
+                return; // The rest of the command line is not processed
+            }
+            if (end == line.size()) {
+                break;
+            }
+            pos = end + 1;
+        }
+        in_ += "\r\nOK\r\n";
+    }
+};
+
+int appendLine(const char* line, void* data) {
+    static_cast<std::vector<std::string>*>(data)->push_back(line);
+    return 0;
+}
+
+int failHandler(const char* line, void* data) {
+    ++*static_cast<int*>(data);
+    return SYSTEM_ERROR_BAD_DATA;
+}
+
+} // namespace
+
+TEST_CASE("AtCommandBatch") {
+    TestDce dce;
+    AtParser parser;
+    REQUIRE(parser.init(AtParserConfig().stream(&dce).echoEnabled(false).logEnabled(false)) == 0);
+
+    SECTION("sends the commands in a single command line in the order in which they were added") {
+        auto batch = parser.batch();
+        batch.add("+CREG=2").add("AT+CGREG=2").addf("+CEREG=%d", 2);
+        CHECK(batch.size() == 3);
+        CHECK(batch.exec() == AtResponse::OK);
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+CREG=2;+CGREG=2;+CEREG=2" });
+    }
+
+    SECTION("dispatches the response lines to the handlers of the commands") {
+        dce.response("+CSQ", { "+CSQ: 10,99" });
+        dce.response("+CREG?", { "+CREG: 2,1", "+UNKNOWN: 1" });
+        dce.response("+COPS?", { "+COPS: 0,2,\"310410\",7" });
+        std::vector<std::string> csq, creg, cops;
+        CHECK(parser.batch()
+                .add("+CSQ", "+CSQ:", appendLine, &csq)
+                .add("+CREG?", "+CREG:", appendLine, &creg)
+                .add("+COPS?", "+COPS:", appendLine, &cops)
+                .exec() == AtResponse::OK);
+        CHECK(csq == std::vector<std::string>{ "+CSQ: 10,99" });
+        CHECK(creg == std::vector<std::string>{ "+CREG: 2,1" });
+        CHECK(cops == std::vector<std::string>{ "+COPS: 0,2,\"310410\",7" });
+    }
+
+    SECTION("reads the entire response if a handler fails") {
+        dce.response("+CSQ", { "+CSQ: 10,99" });
+        dce.response("+CREG?", { "+CREG: 2,1" });
+        int failCount = 0;
+        std::vector<std::string> creg;
+        CHECK(parser.batch()
+                .add("+CSQ", "+CSQ:", failHandler, &failCount)
+                .add("+CREG?", "+CREG:", appendLine, &creg)
+                .exec() == SYSTEM_ERROR_BAD_DATA);
+        CHECK(failCount == 1);
+        CHECK(creg == std::vector<std::string>{ "+CREG: 2,1" });
+        CHECK(parser.execCommand("AT") == AtResponse::OK);
+    }
+
+    SECTION("stops on the first failed command by default") {
+        dce.response("+A", { "+A: 1" });
+        dce.response("+C", { "+C: 3" });
+        dce.fail("+B");
+        std::vector<std::string> a, c;
+        CHECK(parser.batch()
+                .add("+A", "+A:", appendLine, &a)
+                .add("+B")
+                .add("+C", "+C:", appendLine, &c)
+                .exec() == AtResponse::ERROR);
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+A;+B;+C" });
+        CHECK(a == std::vector<std::string>{ "+A: 1" });
+        CHECK(c.empty());
+    }
+
+    SECTION("executes the remaining commands one at a time if requested") {
+        dce.response("+A", { "+A: 1" });
+        dce.response("+B", { "+B: 2" });
+        dce.response("+D", { "+D: 4" });
+        dce.fail("+C");
+        std::vector<std::string> a, b, d;
+        CHECK(parser.batch()
+                .add("+A", "+A:", appendLine, &a)
+                .add("+B", "+B:", appendLine, &b)
+                .add("+C")
+                .add("+D", "+D:", appendLine, &d)
+                .continueOnError()
+                .exec() == AtResponse::ERROR);
+        // The commands are resent starting with the one following the last command that reported
+        // a response
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+A;+B;+C;+D", "AT+C", "AT+D" });
+        CHECK(a == std::vector<std::string>{ "+A: 1" });
+        CHECK(b == std::vector<std::string>{ "+B: 2" });
+        CHECK(d == std::vector<std::string>{ "+D: 4" });
+    }
+
+    SECTION("matches the responses by command name if no handlers are registered") {
+        dce.response("+A", { "+A: 1" });
+        dce.response("+B=\"x\"", { "+B: 2" });
+        dce.response("+D?", { "+D: 4" });
+        dce.fail("+C");
+        CHECK(parser.batch().add("+A").add("+B=\"x\"").add("+C").add("+D?").continueOnError().exec() ==
+                AtResponse::ERROR);
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+A;+B=\"x\";+C;+D?", "AT+C", "AT+D?" });
+    }
+
+    SECTION("returns the result of the resent commands") {
+        dce.response("+A", { "+A: 1" });
+        dce.failOnce("+B");
+        CHECK(parser.batch().add("+A").add("+B").add("+C").continueOnError().exec() == AtResponse::OK);
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+A;+B;+C", "AT+B", "AT+C" });
+    }
+
+    SECTION("resends all commands if none of them reported a response") {
+        dce.fail("+B=2");
+        CHECK(parser.batch().add("+A=1").add("+B=2").add("+C=3").continueOnError().exec() ==
+                AtResponse::ERROR);
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+A=1;+B=2;+C=3", "AT+A=1", "AT+B=2", "AT+C=3" });
+    }
+
+    SECTION("doesn't resend the commands if the last command has failed after reporting a response") {
+        dce.response("+A", { "+A: 1" });
+        dce.response("+B", { "+B: 2" });
+        dce.fail("+B");
+        CHECK(parser.batch().add("+A").add("+B").continueOnError().exec() == AtResponse::ERROR);
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+A;+B" });
+    }
+
+    SECTION("gives precedence to the registered prefixes when matching the responses") {
+        dce.response("+COPS?", { "+COPS: 0,2,\"310410\",7" });
+        std::vector<std::string> cops;
+        CHECK(parser.batch().add("+COPS=3,2").add("+COPS?", "+COPS:", appendLine, &cops).exec() == AtResponse::OK);
+        CHECK(cops == std::vector<std::string>{ "+COPS: 0,2,\"310410\",7" });
+    }
+
+    SECTION("doesn't resend the commands if the batch succeeds") {
+        CHECK(parser.batch().add("+A").add("+B").continueOnError().exec() == AtResponse::OK);
+        CHECK(dce.commandLines() == std::vector<std::string>{ "AT+A;+B" });
+    }
+
+    SECTION("fails if the batch is too large") {
+        auto batch = parser.batch();
+        for (size_t i = 0; i <= AtCommandBatch::MAX_COMMAND_COUNT; ++i) {
+            batch.add("+A");
+        }
+        CHECK(batch.error() == SYSTEM_ERROR_TOO_LARGE);
+        CHECK(batch.exec() == SYSTEM_ERROR_TOO_LARGE);
+        const std::string cmd(AtCommandBatch::MAX_COMMAND_LINE_SIZE, 'A');
+        CHECK(parser.batch().add(cmd.c_str()).error() == SYSTEM_ERROR_TOO_LARGE);
+        CHECK(dce.commandLines().empty());
+    }
+}
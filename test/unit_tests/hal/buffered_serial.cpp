@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffered_serial.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+using namespace particle;
+
+TEST_CASE("BufferedSerialIo") {
+    std::mutex mutex;
+    std::string sent;
+    std::string toRecv;
+    std::atomic<unsigned> sendCount(0);
+    std::atomic<size_t> maxSendSize(1024);
+    BufferedSerialIo io([&](const char* data, size_t size) {
+        ++sendCount;
+        size = std::min(size, maxSendSize.load());
+        std::lock_guard<std::mutex> lock(mutex);
+        sent.append(data, size);
+        return (int)size;
+    }, [&](char* data, size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size = std::min(size, toRecv.size());
+        memcpy(data, toRecv.data(), size);
+        toRecv.erase(0, size);
+        return (int)size;
+    });
+    char rxBuf[64] = {};
+    char txBuf[64] = {};
+    io.init(rxBuf, sizeof(rxBuf), txBuf, sizeof(txBuf));
+    io.start();
+
+    SECTION("sends and receives data") {
+        const std::string d(1000, 'a');
+        CHECK(io.write(d.data(), d.size()) == d.size());
+        io.flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            CHECK(sent == d);
+            toRecv = "abc";
+        }
+        for (unsigned i = 0; i < 100 && io.available() < 3; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(io.read() == 'a');
+        CHECK(io.read() == 'b');
+        CHECK(io.read() == 'c');
+        CHECK(io.read() == -1);
+    }
+
+    SECTION("sends all data if the transport accepts it in small portions") {
+        maxSendSize = 7;
+        const std::string d(1000, 'b');
+        CHECK(io.write(d.data(), d.size()) == d.size());
+        io.flush();
+        std::lock_guard<std::mutex> lock(mutex);
+        CHECK(sent == d);
+    }
+
+    SECTION("doesn't retry sending data immediately if the transport doesn't accept it") {
+        maxSendSize = 0;
+        const std::string d(10, 'c');
+        CHECK(io.write(d.data(), d.size()) == d.size());
+        const auto t1 = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t1).count();
+        // The thread tries sending the data roughly once per poll interval
+        CHECK(sendCount <= ms / BufferedSerialIo::POLL_INTERVAL + 1);
+        maxSendSize = 1024;
+        io.flush();
+        std::lock_guard<std::mutex> lock(mutex);
+        CHECK(sent == d);
+    }
+
+    io.stop();
+}
@@ -0,0 +1,223 @@
+#include <cstring>
+
+#include "dns_cache.h"
+#include "system_error.h"
+
+#include "util/catch.h"
+
+using namespace particle;
+
+namespace {
+
+const uint32_t TTL = 1000;
+const uint32_t NOW = 1700000000;
+
+DnsCache::Address ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    DnsCache::Address addr = {};
+    addr.family = DnsCache::IPV4;
+    addr.data[0] = a;
+    addr.data[1] = b;
+    addr.data[2] = c;
+    addr.data[3] = d;
+    return addr;
+}
+
+DnsCache::Address ipv6(uint8_t last) {
+    DnsCache::Address addr = {};
+    addr.family = DnsCache::IPV6;
+    addr.data[0] = 0x20;
+    addr.data[1] = 0x01;
+    addr.data[15] = last;
+    return addr;
+}
+
+} // namespace
+
+namespace particle {
+
+bool operator==(const DnsCache::Address& a1, const DnsCache::Address& a2) {
+    return a1.family == a2.family && std::memcmp(a1.data, a2.data, sizeof(a1.data)) == 0;
+}
+
+} // namespace particle
+
+TEST_CASE("DnsCache") {
+    DnsCache cache(TTL);
+    DnsCache::Address addr = {};
+    unsigned flags = 0;
+
+    SECTION("returns a cached address until it expires") {
+        CHECK(cache.get("example.com", DnsCache::IPV4, NOW, &addr) == SYSTEM_ERROR_NOT_FOUND);
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        CHECK(cache.size() == 1);
+        CHECK(cache.isModified());
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + 1, &addr, &flags) == 0);
+        CHECK(addr == ipv4(1, 2, 3, 4));
+        CHECK(flags == DnsCache::REFRESH);
+        CHECK(cache.get("example.com", DnsCache::IPV6, NOW + 1, &addr) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(cache.get("example.org", DnsCache::IPV4, NOW + 1, &addr) == SYSTEM_ERROR_NOT_FOUND);
+        // Expired entries are still returned for a while so that they can be used as a fallback
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + TTL, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::EXPIRED);
+        CHECK(cache.get("example.com", DnsCache::IPV4, NOW + TTL + DnsCache::MAX_STALE_TIME, &addr) == SYSTEM_ERROR_NOT_FOUND);
+    }
+
+    SECTION("returns a restored entry only once if the current time is unknown until it's confirmed") {
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        uint8_t data[DnsCache::MAX_SAVED_SIZE] = {};
+        const int n = cache.save(data, sizeof(data));
+        REQUIRE(n > 0);
+        DnsCache restored(TTL);
+        REQUIRE(restored.load(data, n) == 0);
+        REQUIRE(restored.get("example.com", DnsCache::IPV4, 0, &addr, &flags) == 0);
+        CHECK(addr == ipv4(1, 2, 3, 4));
+        CHECK(flags == DnsCache::REFRESH);
+        // The address returned previously may not have worked
+        REQUIRE(restored.get("example.com", DnsCache::IPV4, 0, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::EXPIRED);
+        // Confirming the address doesn't change the saved expiration time
+        REQUIRE(restored.put("example.com", ipv4(1, 2, 3, 4), 0) == 0);
+        CHECK_FALSE(restored.isModified());
+        REQUIRE(restored.get("example.com", DnsCache::IPV4, 0, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::REFRESH);
+        REQUIRE(restored.get("example.com", DnsCache::IPV4, 0, &addr, &flags) == 0);
+        CHECK(flags == 0);
+        REQUIRE(restored.get("example.com", DnsCache::IPV4, NOW + 1, &addr, &flags) == 0);
+        CHECK(flags == 0);
+    }
+
+    SECTION("caches addresses resolved while the current time is unknown") {
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), 0) == 0);
+        CHECK(cache.isModified());
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, 0, &addr, &flags) == 0);
+        CHECK(addr == ipv4(1, 2, 3, 4));
+        CHECK(flags == DnsCache::REFRESH);
+        // Once the time is known, the entry is only used as a fallback
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::EXPIRED);
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + DnsCache::MAX_STALE_TIME, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::EXPIRED);
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + 1, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::REFRESH);
+    }
+
+    SECTION("requests a refresh of an entry on lookup unless a refresh is in progress") {
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + 1, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::REFRESH);
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + 2, &addr, &flags) == 0);
+        CHECK(flags == 0);
+        cache.refreshFailed("example.com", DnsCache::IPV4);
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + 3, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::REFRESH);
+        REQUIRE(cache.put("example.com", ipv4(5, 6, 7, 8), NOW + 4) == 0);
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + 5, &addr, &flags) == 0);
+        CHECK(addr == ipv4(5, 6, 7, 8));
+        CHECK(flags == DnsCache::REFRESH);
+        // Expired entries need to be resolved in the foreground
+        REQUIRE(cache.get("example.com", DnsCache::IPV4, NOW + 4 + TTL, &addr, &flags) == 0);
+        CHECK(flags == DnsCache::EXPIRED);
+    }
+
+    SECTION("prefers unexpired IPv4 addresses when any address family is requested") {
+        REQUIRE(cache.put("example.com", ipv6(1), NOW) == 0);
+        REQUIRE(cache.get("example.com", DnsCache::ANY, NOW, &addr) == 0);
+        CHECK(addr == ipv6(1));
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        REQUIRE(cache.get("example.com", DnsCache::ANY, NOW, &addr) == 0);
+        CHECK(addr == ipv4(1, 2, 3, 4));
+        REQUIRE(cache.put("example.com", ipv6(1), NOW + TTL / 2) == 0);
+        REQUIRE(cache.get("example.com", DnsCache::ANY, NOW + TTL, &addr, &flags) == 0);
+        CHECK(addr == ipv6(1));
+        CHECK_FALSE(flags & DnsCache::EXPIRED);
+    }
+
+    SECTION("replaces expired and least recently used entries when full") {
+        char host[32] = {};
+        for (size_t i = 0; i < DnsCache::MAX_ENTRY_COUNT; ++i) {
+            snprintf(host, sizeof(host), "host%u", (unsigned)i);
+            REQUIRE(cache.put(host, ipv4(10, 0, 0, i), NOW + i) == 0);
+        }
+        REQUIRE(cache.get("host0", DnsCache::IPV4, NOW + 100, &addr) == 0);
+        REQUIRE(cache.put("new1", ipv4(10, 0, 1, 1), NOW + 100) == 0);
+        CHECK(cache.size() == DnsCache::MAX_ENTRY_COUNT);
+        CHECK(cache.get("host0", DnsCache::IPV4, NOW + 100, &addr) == 0);
+        CHECK(cache.get("host1", DnsCache::IPV4, NOW + 100, &addr) == SYSTEM_ERROR_NOT_FOUND);
+        // Make host5 expire before the others
+        REQUIRE(cache.put("host5", ipv4(10, 0, 0, 5), NOW + 100 - TTL) == 0);
+        REQUIRE(cache.put("new2", ipv4(10, 0, 1, 2), NOW + 100) == 0);
+        CHECK(cache.get("host5", DnsCache::IPV4, NOW + 100, &addr) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(cache.get("host2", DnsCache::IPV4, NOW + 100, &addr) == 0);
+    }
+
+    SECTION("removes entries") {
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        REQUIRE(cache.put("example.com", ipv6(1), NOW) == 0);
+        REQUIRE(cache.put("example.org", ipv4(5, 6, 7, 8), NOW) == 0);
+        cache.remove("example.com", DnsCache::IPV6);
+        CHECK(cache.size() == 2);
+        CHECK(cache.get("example.com", DnsCache::IPV6, NOW, &addr) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(cache.get("example.com", DnsCache::IPV4, NOW, &addr) == 0);
+        cache.remove("example.com");
+        CHECK(cache.size() == 1);
+        CHECK(cache.get("example.com", DnsCache::ANY, NOW, &addr) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(cache.get("example.org", DnsCache::ANY, NOW, &addr) == 0);
+        cache.clear();
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("rejects invalid entries") {
+        CHECK(cache.put("", ipv4(1, 2, 3, 4), NOW) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        std::string longName(DnsCache::MAX_HOST_NAME_LENGTH + 1, 'a');
+        CHECK(cache.put(longName.c_str(), ipv4(1, 2, 3, 4), NOW) == SYSTEM_ERROR_TOO_LARGE);
+        DnsCache::Address a = {};
+        CHECK(cache.put("example.com", a, NOW) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("saves and restores its contents") {
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        REQUIRE(cache.put("example.com", ipv6(1), NOW + 10) == 0);
+        REQUIRE(cache.put("device.udp.particle.io", ipv4(5, 6, 7, 8), NOW + 20) == 0);
+        uint8_t data[DnsCache::MAX_SAVED_SIZE] = {};
+        const int n = cache.save(data, sizeof(data));
+        REQUIRE(n > 0);
+        CHECK_FALSE(cache.isModified());
+        CHECK(cache.save(data, n - 1) == SYSTEM_ERROR_TOO_LARGE);
+
+        DnsCache restored(TTL);
+        REQUIRE(restored.load(data, n) == 0);
+        CHECK(restored.size() == 3);
+        CHECK_FALSE(restored.isModified());
+        REQUIRE(restored.get("example.com", DnsCache::IPV6, NOW + TTL, &addr, &flags) == 0);
+        CHECK(addr == ipv6(1));
+        CHECK(flags == DnsCache::REFRESH);
+        REQUIRE(restored.get("example.com", DnsCache::IPV4, NOW + TTL, &addr, &flags) == 0);
+        CHECK(addr == ipv4(1, 2, 3, 4));
+        CHECK(flags == DnsCache::EXPIRED);
+        REQUIRE(restored.get("device.udp.particle.io", DnsCache::IPV4, NOW + 20, &addr) == 0);
+        CHECK(addr == ipv4(5, 6, 7, 8));
+
+        // Truncated or corrupted data
+        for (int i = 0; i < n; ++i) {
+            CHECK(restored.load(data, i) == SYSTEM_ERROR_BAD_DATA);
+        }
+        data[0] = 0xff;
+        CHECK(restored.load(data, n) == SYSTEM_ERROR_BAD_DATA);
+        CHECK(restored.size() == 0);
+    }
+
+    SECTION("limits how often an entry's lifetime extension marks the cache as modified") {
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW) == 0);
+        uint8_t data[DnsCache::MAX_SAVED_SIZE] = {};
+        REQUIRE(cache.save(data, sizeof(data)) > 0);
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW + TTL / 2 - 1) == 0);
+        CHECK_FALSE(cache.isModified());
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 4), NOW + TTL / 2) == 0);
+        CHECK(cache.isModified());
+        REQUIRE(cache.save(data, sizeof(data)) > 0);
+        REQUIRE(cache.put("example.com", ipv4(1, 2, 3, 5), NOW + TTL / 2) == 0);
+        CHECK(cache.isModified());
+    }
+}
@@ -0,0 +1,230 @@
+#include <string>
+#include <cstring>
+
+#include "filesystem_block_cache.h"
+#include "system_error.h"
+
+#include "util/catch.h"
+
+using namespace particle::fs;
+
+namespace {
+
+const size_t BLOCK_SIZE = 1024;
+const size_t BLOCK_COUNT = 8;
+const size_t LINE_SIZE = 64;
+
+class TestBlockDevice: public BlockDevice {
+public:
+    TestBlockDevice() :
+            data_(BLOCK_SIZE * BLOCK_COUNT, '\xff'),
+            reads(0),
+            progs(0),
+            erases(0),
+            error(0) {
+    }
+
+    int read(uint32_t block, size_t offs, void* data, size_t size) override {
+        REQUIRE(block < BLOCK_COUNT);
+        REQUIRE(offs + size <= BLOCK_SIZE);
+        ++reads;
+        memcpy(data, data_.data() + block * BLOCK_SIZE + offs, size);
+        return 0;
+    }
+
+    int prog(uint32_t block, size_t offs, const void* data, size_t size) override {
+        REQUIRE(block < BLOCK_COUNT);
+        REQUIRE(offs + size <= BLOCK_SIZE);
+        ++progs;
+        if (error) {
+            return error;
+        }
+        auto d = (const char*)data;
+        for (size_t i = 0; i < size; ++i) {
+            data_[block * BLOCK_SIZE + offs + i] &= d[i];
+        }
+        return 0;
+    }
+
+    int erase(uint32_t block) override {
+        REQUIRE(block < BLOCK_COUNT);
+        ++erases;
+        data_.replace(block * BLOCK_SIZE, BLOCK_SIZE, BLOCK_SIZE, '\xff');
+        return 0;
+    }
+
+    std::string data(uint32_t block, size_t offs, size_t size) const {
+        return data_.substr(block * BLOCK_SIZE + offs, size);
+    }
+
+    std::string data_;
+    unsigned reads;
+    unsigned progs;
+    unsigned erases;
+    int error;
+};
+
+std::string read(BlockCache& cache, uint32_t block, size_t offs, size_t size) {
+    std::string s(size, '\0');
+    REQUIRE(cache.read(block, offs, s.data(), s.size()) == 0);
+    return s;
+}
+
+void prog(BlockCache& cache, uint32_t block, size_t offs, const std::string& data) {
+    REQUIRE(cache.prog(block, offs, data.data(), data.size()) == 0);
+}
+
+} // namespace
+
+TEST_CASE("BlockCache") {
+    TestBlockDevice dev;
+    BlockCache cache(&dev);
+
+    SECTION("caches read data in lines") {
+        REQUIRE(cache.init({ LINE_SIZE, 4, 0 }) == 0);
+        dev.prog(1, 0, "abcdefgh", 8);
+        CHECK(read(cache, 1, 2, 4) == "cdef");
+        CHECK(dev.reads == 1);
+        CHECK(read(cache, 1, 0, 8) == "abcdefgh");
+        CHECK(dev.reads == 1);
+        // Read that crosses a line boundary
+        CHECK(read(cache, 1, LINE_SIZE - 2, 4) == std::string(4, '\xff'));
+        CHECK(dev.reads == 2);
+    }
+
+    SECTION("reads of multiple full lines bypass the cache") {
+        REQUIRE(cache.init({ LINE_SIZE, 4, 0 }) == 0);
+        read(cache, 2, 0, LINE_SIZE * 2);
+        read(cache, 2, 0, LINE_SIZE * 2);
+        CHECK(dev.reads == 2);
+    }
+
+    SECTION("evicts the least recently used line") {
+        REQUIRE(cache.init({ LINE_SIZE, 2, 0 }) == 0);
+        read(cache, 0, 0, 1);
+        read(cache, 1, 0, 1);
+        read(cache, 0, 0, 1); // Block 1 is now the least recently used one
+        read(cache, 2, 0, 1);
+        CHECK(dev.reads == 3);
+        read(cache, 0, 0, 1);
+        CHECK(dev.reads == 3);
+        read(cache, 1, 0, 1);
+        CHECK(dev.reads == 4);
+    }
+
+    SECTION("keeps the lines of pinned blocks") {
+        REQUIRE(cache.init({ LINE_SIZE, 2, 0 }) == 0);
+        REQUIRE(cache.pin(0) == 0);
+        read(cache, 0, 0, 1);
+        for (uint32_t b = 1; b < BLOCK_COUNT; ++b) {
+            read(cache, b, 0, 1);
+        }
+        CHECK(dev.reads == BLOCK_COUNT);
+        read(cache, 0, 0, 1);
+        CHECK(dev.reads == BLOCK_COUNT);
+        cache.unpin(0);
+        read(cache, 1, 0, 1);
+        read(cache, 2, 0, 1);
+        read(cache, 0, 0, 1);
+        CHECK(dev.reads == BLOCK_COUNT + 3);
+    }
+
+    SECTION("programming invalidates the affected lines") {
+        REQUIRE(cache.init({ LINE_SIZE, 4, 0 }) == 0);
+        CHECK(read(cache, 3, 0, 4) == std::string(4, '\xff'));
+        prog(cache, 3, 2, "ab");
+        CHECK(dev.progs == 1);
+        CHECK(read(cache, 3, 0, 4) == "\xff\xff" "ab");
+        CHECK(dev.reads == 2);
+        REQUIRE(cache.erase(3) == 0);
+        CHECK(read(cache, 3, 0, 4) == std::string(4, '\xff'));
+        CHECK(dev.reads == 3);
+    }
+
+    SECTION("buffers and merges writes") {
+        REQUIRE(cache.init({ LINE_SIZE, 4, 256 }) == 0);
+        prog(cache, 4, 0, "abcd");
+        prog(cache, 4, 4, "efgh");
+        prog(cache, 5, 8, "ijkl");
+        CHECK(dev.progs == 0);
+        // Buffered data is visible to reads
+        CHECK(read(cache, 4, 2, 4) == "cdef");
+        CHECK(read(cache, 5, 6, 8) == "\xff\xff" "ijkl" "\xff\xff");
+        CHECK(dev.data(4, 0, 8) == std::string(8, '\xff'));
+        REQUIRE(cache.sync() == 0);
+        CHECK(dev.progs == 2);
+        CHECK(dev.data(4, 0, 8) == "abcdefgh");
+        CHECK(dev.data(5, 8, 4) == "ijkl");
+    }
+
+    SECTION("flushes the write buffer when it's full") {
+        REQUIRE(cache.init({ LINE_SIZE, 0, 64 }) == 0);
+        prog(cache, 0, 0, std::string(48, 'a'));
+        prog(cache, 1, 0, std::string(32, 'b'));
+        CHECK(dev.progs == 1);
+        CHECK(dev.data(0, 0, 48) == std::string(48, 'a'));
+        // Writes larger than the buffer go directly to the device
+        prog(cache, 2, 0, std::string(128, 'c'));
+        CHECK(dev.progs == 3);
+        CHECK(dev.data(1, 0, 32) == std::string(32, 'b'));
+        CHECK(dev.data(2, 0, 128) == std::string(128, 'c'));
+    }
+
+    SECTION("discards buffered writes to an erased block") {
+        REQUIRE(cache.init({ LINE_SIZE, 4, 256 }) == 0);
+        prog(cache, 6, 0, "abcd");
+        prog(cache, 7, 0, "efgh");
+        REQUIRE(cache.erase(6) == 0);
+        CHECK(dev.progs == 1);
+        CHECK(dev.erases == 1);
+        CHECK(dev.data(6, 0, 4) == std::string(4, '\xff'));
+        CHECK(dev.data(7, 0, 4) == "efgh");
+    }
+
+    SECTION("keeps the buffered writes and reports the error until they're written") {
+        REQUIRE(cache.init({ LINE_SIZE, 4, 256 }) == 0);
+        prog(cache, 0, 0, "abcd");
+        prog(cache, 1, 0, "efgh");
+        CHECK(read(cache, 0, 0, 4) == "abcd");
+        dev.error = SYSTEM_ERROR_IO;
+        CHECK(cache.sync() == SYSTEM_ERROR_IO);
+        CHECK(cache.sync() == SYSTEM_ERROR_IO);
+        CHECK(cache.erase(2) == SYSTEM_ERROR_IO);
+        CHECK(dev.erases == 0);
+        // The data is still visible to reads
+        CHECK(read(cache, 0, 0, 4) == "abcd");
+        CHECK(read(cache, 1, 0, 4) == "efgh");
+        dev.error = 0;
+        CHECK(cache.sync() == 0);
+        CHECK(dev.data(0, 0, 4) == "abcd");
+        CHECK(dev.data(1, 0, 4) == "efgh");
+        const unsigned progs = dev.progs;
+        CHECK(cache.sync() == 0);
+        CHECK(dev.progs == progs);
+    }
+
+    SECTION("reports write errors through a subsequent prog") {
+        REQUIRE(cache.init({ LINE_SIZE, 0, 64 }) == 0);
+        prog(cache, 0, 0, std::string(48, 'a'));
+        dev.error = SYSTEM_ERROR_IO;
+        CHECK(cache.prog(1, 0, std::string(32, 'b').data(), 32) == SYSTEM_ERROR_IO);
+        dev.error = 0;
+        prog(cache, 1, 0, std::string(32, 'b'));
+        REQUIRE(cache.sync() == 0);
+        CHECK(dev.data(0, 0, 48) == std::string(48, 'a'));
+        CHECK(dev.data(1, 0, 32) == std::string(32, 'b'));
+    }
+
+    SECTION("keeps the writes to a block that couldn't be erased") {
+        REQUIRE(cache.init({ LINE_SIZE, 4, 256 }) == 0);
+        prog(cache, 6, 0, "abcd");
+        prog(cache, 7, 0, "efgh");
+        dev.error = SYSTEM_ERROR_IO;
+        CHECK(cache.erase(6) == SYSTEM_ERROR_IO);
+        CHECK(read(cache, 6, 0, 4) == "abcd");
+        dev.error = 0;
+        REQUIRE(cache.sync() == 0);
+        CHECK(dev.data(6, 0, 4) == "abcd");
+        CHECK(dev.data(7, 0, 4) == "efgh");
+    }
+}
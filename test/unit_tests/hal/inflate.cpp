@@ -437,3 +437,85 @@ TEST_CASE("inflate_input()") {
         }
     }
 }
+
+TEST_CASE("inflate_save_state()") {
+    Inflate infl;
+
+    SECTION("saves a state that can be used to resume the decompression") {
+        auto decomp = genCompressibleData(200000);
+        auto comp = deflate(decomp);
+        const size_t chunkSize = 256;
+        std::string state;
+        size_t stateCompOffs = 0;
+        size_t stateDecompOffs = 0;
+        int r = 0;
+        size_t offs = 0;
+        do {
+            size_t size = std::min(chunkSize, comp.size() - offs);
+            bool hasMore = (offs + size < comp.size());
+            r = infl.input(comp.data() + offs, size, Options().hasMoreInput(hasMore));
+            offs += size;
+            if (r == INFLATE_NEEDS_MORE_INPUT && state.empty() && offs >= comp.size() / 2) {
+                REQUIRE(inflate_state_size(infl.instance()) > 0);
+                r = inflate_save_state(infl.instance(), [](const char* data, size_t size, void* userData) {
+                    ((std::string*)userData)->append(data, size);
+                    return (int)size;
+                }, &state);
+                REQUIRE(r == 0);
+                REQUIRE(state.size() == (size_t)inflate_state_size(infl.instance()));
+                stateCompOffs = offs;
+                stateDecompOffs = infl.output().size();
+                r = INFLATE_NEEDS_MORE_INPUT;
+            }
+        } while (r == INFLATE_NEEDS_MORE_INPUT);
+        REQUIRE(r == INFLATE_DONE);
+        REQUIRE(infl.output() == decomp);
+        REQUIRE(!state.empty());
+        // Resume the decompression using a different instance
+        Inflate infl2;
+        size_t stateOffs = 0;
+        std::pair<std::string*, size_t*> ctx(&state, &stateOffs);
+        r = inflate_restore_state(infl2.instance(), [](char* data, size_t size, void* userData) {
+            auto ctx = (std::pair<std::string*, size_t*>*)userData;
+            size = std::min(size, ctx->first->size() - *ctx->second);
+            memcpy(data, ctx->first->data() + *ctx->second, size);
+            *ctx->second += size;
+            return (int)size;
+        }, &ctx);
+        REQUIRE(r == 0);
+        REQUIRE(stateOffs == state.size());
+        size_t size = comp.size() - stateCompOffs;
+        r = infl2.input(comp.data() + stateCompOffs, size);
+        CHECK(r == INFLATE_DONE);
+        CHECK(infl2.output() == decomp.substr(stateDecompOffs));
+    }
+
+    SECTION("fails if not all output data has been consumed") {
+        auto decomp = genCompressibleData(50000);
+        auto comp = deflate(decomp);
+        infl.outputFn([](const char* data, size_t size, Output* out) {
+            return 0;
+        });
+        int r = infl.input(comp.data(), comp.size());
+        REQUIRE(r == INFLATE_HAS_MORE_OUTPUT);
+        r = inflate_save_state(infl.instance(), dummyOutputCallback, nullptr);
+        CHECK(r == SYSTEM_ERROR_INVALID_STATE);
+    }
+}
+
+TEST_CASE("inflate_restore_state()") {
+    Inflate infl;
+
+    SECTION("fails if the state data is malformed") {
+        std::string state = genRandomData(1000);
+        auto read = [](char* data, size_t size, void* userData) {
+            auto s = (std::string*)userData;
+            size = std::min(size, s->size());
+            memcpy(data, s->data(), size);
+            s->erase(0, size);
+            return (int)size;
+        };
+        int r = inflate_restore_state(infl.instance(), read, &state);
+        CHECK(r == SYSTEM_ERROR_BAD_DATA);
+    }
+}
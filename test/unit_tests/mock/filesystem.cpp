@@ -87,6 +87,24 @@ Filesystem::Filesystem(MockRepository* mocks) :
     mocks_->OnCallFunc(lfs_remove).Do([this](lfs_t* lfs, const char* path) {
         return this->remove(lfs, path);
     });
+    mocks_->OnCallFunc(lfs_rename).Do([this](lfs_t* lfs, const char* oldpath, const char* newpath) {
+        return this->rename(lfs, oldpath, newpath);
+    });
+    mocks_->OnCallFunc(lfs_stat).Do([this](lfs_t* lfs, const char* path, struct lfs_info* info) {
+        return this->stat(lfs, path, info);
+    });
+    mocks_->OnCallFunc(lfs_mkdir).Do([this](lfs_t* lfs, const char* path) {
+        return this->mkdir(lfs, path);
+    });
+    mocks_->OnCallFunc(lfs_dir_open).Do([this](lfs_t* lfs, lfs_dir_t* dir, const char* path) {
+        return this->dirOpen(lfs, dir, path);
+    });
+    mocks_->OnCallFunc(lfs_dir_close).Do([this](lfs_t* lfs, lfs_dir_t* dir) {
+        return this->dirClose(lfs, dir);
+    });
+    mocks_->OnCallFunc(lfs_dir_read).Do([this](lfs_t* lfs, lfs_dir_t* dir, struct lfs_info* info) {
+        return this->dirRead(lfs, dir, info);
+    });
 }
 
 Filesystem::~Filesystem() noexcept(false) {
@@ -151,6 +169,7 @@ void Filesystem::remove(const std::string& path) {
 void Filesystem::clear() {
     root_.entries.clear();
     fdMap_.clear();
+    dirMap_.clear();
     lastFd_ = 0;
 }
 
@@ -288,7 +307,7 @@ lfs_ssize_t Filesystem::read(lfs_t* lfs, lfs_file_t* file, void* buf, lfs_size_t
             return LFS_ERR_BADF;
         }
         const auto e = it->second;
-        auto d = e->data;
+        const auto& d = e->data;
         auto pos = file->pos;
         if (pos > d.size()) {
             pos = d.size();
@@ -452,6 +471,145 @@ int Filesystem::remove(lfs_t* lfs, const char* path) {
     }
 }
 
+int Filesystem::rename(lfs_t* lfs, const char* oldpath, const char* newpath) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !oldpath || !newpath) {
+            throw std::runtime_error("lfs_rename() has been called with invalid arguments");
+        }
+        const auto e = findEntry(oldpath);
+        if (!e) {
+            return LFS_ERR_NOENT;
+        }
+        if (e->type != EntryType::FILE) {
+            throw std::runtime_error("Renaming directories is not supported");
+        }
+        if (!e->fds.empty()) {
+            throw std::runtime_error("Detected an attempt to rename an open file");
+        }
+        auto dest = findEntry(newpath);
+        if (dest) {
+            if (dest->type != EntryType::FILE) {
+                return LFS_ERR_ISDIR;
+            }
+            if (!dest->fds.empty()) {
+                throw std::runtime_error("Detected an attempt to replace an open file");
+            }
+        } else {
+            dest = createEntry(newpath, EntryType::FILE);
+        }
+        dest->data = std::move(e->data);
+        removeEntry(e);
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::stat(lfs_t* lfs, const char* path, struct lfs_info* info) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !path || !info) {
+            throw std::runtime_error("lfs_stat() has been called with invalid arguments");
+        }
+        const auto e = findEntry(path);
+        if (!e) {
+            return LFS_ERR_NOENT;
+        }
+        *info = {};
+        info->type = (e->type == EntryType::DIR) ? LFS_TYPE_DIR : LFS_TYPE_REG;
+        info->size = e->data.size();
+        strncpy(info->name, e->name.c_str(), sizeof(info->name) - 1);
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::mkdir(lfs_t* lfs, const char* path) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !path) {
+            throw std::runtime_error("lfs_mkdir() has been called with invalid arguments");
+        }
+        if (findEntry(path)) {
+            return LFS_ERR_EXIST;
+        }
+        createEntry(path, EntryType::DIR);
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::dirOpen(lfs_t* lfs, lfs_dir_t* dir, const char* path) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !dir || !path) {
+            throw std::runtime_error("lfs_dir_open() has been called with invalid arguments");
+        }
+        auto e = splitPath(path).empty() ? &root_ : findEntry(path);
+        if (!e) {
+            return LFS_ERR_NOENT;
+        }
+        if (e->type != EntryType::DIR) {
+            return LFS_ERR_NOTDIR;
+        }
+        dir->fd = ++lastFd_;
+        dir->pos = 0;
+        dirMap_.insert(std::make_pair(dir->fd, Dir{ e, std::string() }));
+        return LFS_ERR_OK;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::dirClose(lfs_t* lfs, lfs_dir_t* dir) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !dir) {
+            throw std::runtime_error("lfs_dir_close() has been called with invalid arguments");
+        }
+        if (!dirMap_.erase(dir->fd)) {
+            throw std::runtime_error("lfs_dir_close() has been called for an already closed directory");
+        }
+        dir->fd = 0;
+        return LFS_ERR_OK;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::dirRead(lfs_t* lfs, lfs_dir_t* dir, struct lfs_info* info) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !dir || !info) {
+            throw std::runtime_error("lfs_dir_read() has been called with invalid arguments");
+        }
+        const auto it = dirMap_.find(dir->fd);
+        if (it == dirMap_.end()) {
+            throw std::runtime_error("lfs_dir_read() has been called for a closed directory");
+        }
+        auto& d = it->second;
+        *info = {};
+        // LittleFS reports the "." and ".." entries first
+        if (dir->pos < 2) {
+            info->type = LFS_TYPE_DIR;
+            strcpy(info->name, dir->pos ? ".." : ".");
+            ++dir->pos;
+            return 1;
+        }
+        // Entries can be removed while the directory is being read
+        const auto& entries = d.entry->entries;
+        const auto e = d.lastName.empty() ? entries.begin() : entries.upper_bound(d.lastName);
+        if (e == entries.end()) {
+            return 0;
+        }
+        info->type = (e->second.type == EntryType::DIR) ? LFS_TYPE_DIR : LFS_TYPE_REG;
+        info->size = e->second.data.size();
+        strncpy(info->name, e->first.c_str(), sizeof(info->name) - 1);
+        d.lastName = e->first;
+        ++dir->pos;
+        return 1;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
 } // namespace test
 
 } // namespace particle
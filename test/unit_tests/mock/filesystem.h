@@ -74,8 +74,14 @@ private:
         }
     };
 
+    struct Dir {
+        Entry* entry;
+        std::string lastName; // Name of the last entry read from the directory
+    };
+
     Entry root_;
     std::unordered_map<int, Entry*> fdMap_;
+    std::unordered_map<int, Dir> dirMap_;
     MockRepository* mocks_;
     int lastFd_;
     bool checkOpenFiles_;
@@ -94,10 +100,16 @@ private:
     int truncate(lfs_t* lfs, lfs_file_t* file, lfs_off_t size);
     int sync(lfs_t* lfs, lfs_file_t* file);
     int remove(lfs_t* lfs, const char* path);
+    int rename(lfs_t* lfs, const char* oldpath, const char* newpath);
+    int stat(lfs_t* lfs, const char* path, struct lfs_info* info);
+    int mkdir(lfs_t* lfs, const char* path);
+    int dirOpen(lfs_t* lfs, lfs_dir_t* dir, const char* path);
+    int dirClose(lfs_t* lfs, lfs_dir_t* dir);
+    int dirRead(lfs_t* lfs, lfs_dir_t* dir, struct lfs_info* info);
 };
 
 inline bool Filesystem::hasOpenFiles() const {
-    return !fdMap_.empty();
+    return !fdMap_.empty() || !dirMap_.empty();
 }
 
 inline void Filesystem::autoCheckOpenFiles(bool enabled) {
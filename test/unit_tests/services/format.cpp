@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+
+#include "format.h"
+#include "system_error.h"
+
+#include <catch2/catch.hpp>
+
+using namespace particle;
+
+namespace {
+
+class StringAppender: public Appender {
+public:
+    std::string str;
+    unsigned calls;
+
+    explicit StringAppender(size_t maxSize = (size_t)-1) :
+            calls(0),
+            maxSize_(maxSize) {
+    }
+
+    bool append(const uint8_t* data, size_t size) override {
+        ++calls;
+        if (str.size() + size > maxSize_) {
+            return false;
+        }
+        str.append((const char*)data, size);
+        return true;
+    }
+
+private:
+    size_t maxSize_;
+};
+
+std::string vformatStr(const char* fmt, va_list args) {
+    StringAppender a;
+    int r = vformat(Appender::callback, &a, fmt, args);
+    REQUIRE(r == (int)a.str.size());
+    return a.str;
+}
+
+std::string formatStr(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+std::string formatStr(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    auto s = vformatStr(fmt, args);
+    va_end(args);
+    return s;
+}
+
+std::string snprintfStr(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+std::string snprintfStr(const char* fmt, ...) {
+    char buf[512];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return buf;
+}
+
+#define CHECK_SAME_AS_SNPRINTF(...) \
+        CHECK(formatStr(__VA_ARGS__) == snprintfStr(__VA_ARGS__))
+
+template<typename... ArgsT>
+std::string typedFormatStr(const char* fmt, const ArgsT&... args) {
+    StringAppender a;
+    int r = format(a, fmt, args...);
+    REQUIRE(r == (int)a.str.size());
+    return a.str;
+}
+
+} // namespace
+
+TEST_CASE("vformat()") {
+    SECTION("formats integers") {
+        CHECK_SAME_AS_SNPRINTF("%d %i %u", 0, -123, 456u);
+        CHECK_SAME_AS_SNPRINTF("%d %d", INT_MIN, INT_MAX);
+        CHECK_SAME_AS_SNPRINTF("%lld %llu", LLONG_MIN, ULLONG_MAX);
+        CHECK_SAME_AS_SNPRINTF("%ld %lu %zu %jd", -1L, 2UL, (size_t)3, (intmax_t)-4);
+        CHECK_SAME_AS_SNPRINTF("%hhd %hhu %hd %hu", -1, 255, -1, 65535);
+        CHECK_SAME_AS_SNPRINTF("%x %X %o", 0xabcdu, 0xabcdu, 0777u);
+        CHECK_SAME_AS_SNPRINTF("%#x %#X %#o %#x %#o", 0xabu, 0xabu, 8u, 0u, 0u);
+        CHECK_SAME_AS_SNPRINTF("%llx %hhx", 0x123456789abcdefull, 0x1ff);
+    }
+
+    SECTION("supports flags, width and precision for integers") {
+        CHECK_SAME_AS_SNPRINTF("[%5d] [%-5d] [%05d] [%+d] [% d] [%+5d]", 42, 42, -42, 42, 42, -42);
+        CHECK_SAME_AS_SNPRINTF("[%.3d] [%8.3d] [%-8.3d] [%.0d] [%5.0d]", 7, -7, 7, 0, 0);
+        CHECK_SAME_AS_SNPRINTF("[%#08x] [%#8x] [%#-8x] [%#.4x] [%010lld]", 0xabu, 0xabu, 0xabu, 0xabu, -123LL);
+        CHECK_SAME_AS_SNPRINTF("[%*d] [%-*d] [%*d] [%.*d] [%.*d]", 6, 1, 6, 1, -6, 1, 4, 1, -1, 1);
+    }
+
+    SECTION("formats strings and characters") {
+        CHECK_SAME_AS_SNPRINTF("%s|%10s|%-10s|%.2s|%10.2s|%c|%3c|%-3c|", "abc", "abc", "abc", "abc", "abc", 'x', 'y', 'z');
+        CHECK_SAME_AS_SNPRINTF("%s", "");
+        CHECK_SAME_AS_SNPRINTF("100%%");
+    }
+
+    SECTION("formats floating point numbers") {
+        CHECK_SAME_AS_SNPRINTF("%f %.2f %10.3f %-10.1f| %e %g %G", 3.14159, -2.5, 1.0, 0.25, 12345.678, 0.0001, 1e20);
+        CHECK_SAME_AS_SNPRINTF("%+08.2f %Lf", 3.14159, (long double)1.5);
+        CHECK_SAME_AS_SNPRINTF("%f", 1e100);
+    }
+
+    SECTION("formats pointers") {
+        CHECK(formatStr("%p", (void*)0x1234) == "0x1234");
+    }
+
+    SECTION("writes long strings") {
+        std::string s(1000, 'a');
+        CHECK(formatStr("%s%s", s.c_str(), s.c_str()) == s + s);
+        CHECK(formatStr("%1000d", 1) == std::string(999, ' ') + "1");
+    }
+
+    SECTION("writes the output in chunks") {
+        StringAppender a;
+        CHECK(format(a, "%d%d%d%d", 1, 2, 3, 4) == 4);
+        CHECK(a.str == "1234");
+        CHECK(a.calls == 1);
+    }
+
+    SECTION("fails if the appender fails") {
+        StringAppender a(10);
+        CHECK(format(a, "%s", std::string(100, 'a').c_str()) == SYSTEM_ERROR_IO);
+    }
+
+    SECTION("writes nothing if the format string is null") {
+        StringAppender a;
+        CHECK(format(a, nullptr) == 0);
+        CHECK(a.calls == 0);
+    }
+}
+
+TEST_CASE("format()") {
+    SECTION("doesn't need length modifiers") {
+        CHECK(typedFormatStr("%d %d %u %x", (int64_t)INT64_MIN, (int8_t)-1, (uint64_t)UINT64_MAX, (uint16_t)0xabcd) ==
+                "-9223372036854775808 -1 18446744073709551615 abcd");
+        CHECK(typedFormatStr("%x %x", (int8_t)-1, (int32_t)-1) == "ff ffffffff");
+    }
+
+    SECTION("formats arguments of mismatched types using their default conversion") {
+        CHECK(typedFormatStr("%s %d %x %s", 123, "abc", 1.5, 'c') == "123 abc 1.5 c");
+        CHECK(typedFormatStr("%d %c", 'a', 98) == "97 b");
+    }
+
+    SECTION("supports the other format features") {
+        CHECK(typedFormatStr("[%5s] [%-4d] [%#06x] [%.2f] [%*d]", "ab", 1, 255u, 2.346, 3, 7) ==
+                "[   ab] [1   ] [0x00ff] [2.35] [  7]");
+        CHECK(typedFormatStr("%d%%", 50) == "50%");
+    }
+
+    SECTION("formats enums, booleans and pointers") {
+        enum class E: uint8_t { A = 200 };
+        CHECK(typedFormatStr("%d %d", E::A, true) == "200 1");
+        CHECK(typedFormatStr("%p %p", (const void*)0x10, nullptr) == "0x10 0x0");
+    }
+
+    SECTION("handles missing arguments") {
+        CHECK(typedFormatStr("%d %s", 1) == "1 %s");
+    }
+}
@@ -100,3 +100,79 @@ TEST_CASE("toHex()") {
         CHECK((uint8_t)buf[0] == 0xff);
     }
 }
+
+TEST_CASE("fromHex()") {
+    char buf[100] = {};
+
+    SECTION("parses a hex-encoded string") {
+        auto n = fromHex("0123456789abcdefABCDEF", 22, buf, sizeof(buf));
+        CHECK(n == 11);
+        CHECK(memcmp(buf, "\x01\x23\x45\x67\x89\xab\xcd\xef\xab\xcd\xef", 11) == 0);
+    }
+    SECTION("stops at the first invalid character") {
+        auto n = fromHex("0123x567", 8, buf, sizeof(buf));
+        CHECK(n == 2);
+        CHECK(memcmp(buf, "\x01\x23", 2) == 0);
+        n = fromHex("01234x67", 8, buf, sizeof(buf));
+        CHECK(n == 2);
+    }
+    SECTION("ignores the trailing odd character") {
+        auto n = fromHex("01234", 5, buf, sizeof(buf));
+        CHECK(n == 2);
+    }
+    SECTION("destination buffer can be smaller than necessary to store the entire data") {
+        auto n = fromHex("01234567", 8, buf, 3);
+        CHECK(n == 3);
+        CHECK(memcmp(buf, "\x01\x23\x45", 3) == 0);
+        n = fromHex("01234567", 8, buf, 0);
+        CHECK(n == 0);
+    }
+    SECTION("round-trips every byte value") {
+        char data[256] = {};
+        for (unsigned i = 0; i < sizeof(data); ++i) {
+            data[i] = i;
+        }
+        char hex[sizeof(data) * 2 + 1] = {};
+        CHECK(toHex(data, sizeof(data), hex, sizeof(hex)) == sizeof(data) * 2);
+        toUpperCase(hex);
+        char data2[sizeof(data)] = {};
+        CHECK(fromHex(hex, sizeof(hex) - 1, data2, sizeof(data2)) == sizeof(data2));
+        CHECK(memcmp(data, data2, sizeof(data)) == 0);
+    }
+}
+
+TEST_CASE("compareIgnoreCase()") {
+    SECTION("compares strings ignoring the case of ASCII letters") {
+        CHECK(compareIgnoreCase("", "") == 0);
+        CHECK(compareIgnoreCase("Content-Type", "content-type") == 0);
+        CHECK(compareIgnoreCase("abc", "ABD") < 0);
+        CHECK(compareIgnoreCase("ABD", "abc") > 0);
+        CHECK(compareIgnoreCase("abc", "ABCD") < 0);
+        CHECK(compareIgnoreCase("abcd", "ABC") > 0);
+        CHECK(compareIgnoreCase("[", "{") != 0); // Not letters
+    }
+    SECTION("equalsIgnoreCase() compares strings of any length") {
+        CHECK(equalsIgnoreCase("abcdefghijklmnopqrstuvwxyz", "ABCDEFGHIJKLMNOPQRSTUVWXYZ"));
+        CHECK(equalsIgnoreCase("0123456789abcdefX", "0123456789ABCDEFx"));
+        CHECK_FALSE(equalsIgnoreCase("0123456789abcdefX", "0123456789ABCDEFy"));
+        CHECK_FALSE(equalsIgnoreCase("abc", "abcd"));
+        CHECK_FALSE(equalsIgnoreCase("@", "`")); // Differ in the 0x20 bit but are not letters
+        CHECK_FALSE(equalsIgnoreCase("@[\\]^_@[\\]", "`{|}~\x7f`{|}"));
+        CHECK_FALSE(equalsIgnoreCase("\xc1\xc2\xc3\xc4", "\xe1\xe2\xe3\xe4")); // Not ASCII
+    }
+}
+
+TEST_CASE("startsWithIgnoreCase()") {
+    CHECK(startsWithIgnoreCase("AT+CREG?", "at"));
+    CHECK(startsWithIgnoreCase("at+creg?", "AT+CREG"));
+    CHECK(startsWithIgnoreCase("abc", ""));
+    CHECK_FALSE(startsWithIgnoreCase("a", "ab"));
+    CHECK_FALSE(startsWithIgnoreCase("+CREG", "AT"));
+}
+
+TEST_CASE("endsWithIgnoreCase()") {
+    CHECK(endsWithIgnoreCase("image.PNG", ".png"));
+    CHECK(endsWithIgnoreCase("abc", ""));
+    CHECK_FALSE(endsWithIgnoreCase("c", "bc"));
+    CHECK_FALSE(endsWithIgnoreCase("image.jpg", ".png"));
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tlv_file.h"
+#include "system_error.h"
+
+#include "mock/filesystem.h"
+
+#include <catch2/catch.hpp>
+#include <hippomocks.h>
+
+#include <string>
+#include <cstring>
+
+using namespace particle;
+using particle::services::settings::TlvFile;
+
+namespace {
+
+const char* const FILE_PATH = "/sys/test.dat";
+
+std::string u16(uint16_t val) {
+    return std::string((const char*)&val, sizeof(val));
+}
+
+std::string u32(uint32_t val) {
+    return std::string((const char*)&val, sizeof(val));
+}
+
+// Serializes a file in the format used by older versions of the firmware
+std::string legacyFile(const std::string& records) {
+    return records + u32(0) + u32(records.size()) + u16(0) + u16(0) +
+            u32(services::settings::TLV_FILE_MAGICK);
+}
+
+std::string legacyRecord(uint16_t key, const std::string& data) {
+    return u16(services::settings::TLV_HEADER_MAGICK) + u16(key) + u16(data.size()) + u16(0) + data;
+}
+
+uint32_t fileMagick(test::Filesystem& fs) {
+    const auto d = fs.readFile(FILE_PATH);
+    REQUIRE(d.size() >= 4);
+    uint32_t magick = 0;
+    memcpy(&magick, d.data() + d.size() - 4, 4);
+    return magick;
+}
+
+std::string get(TlvFile& file, uint16_t key, int index = 0) {
+    char buf[64] = {};
+    const ssize_t r = file.get(key, (uint8_t*)buf, sizeof(buf), index);
+    if (r < 0) {
+        return std::string();
+    }
+    return std::string(buf, r);
+}
+
+int set(TlvFile& file, uint16_t key, const std::string& data) {
+    return file.set(key, (const uint8_t*)data.data(), data.size(), 0);
+}
+
+int add(TlvFile& file, uint16_t key, const std::string& data) {
+    return file.add(key, (const uint8_t*)data.data(), data.size());
+}
+
+} // namespace
+
+TEST_CASE("TlvFile") {
+    MockRepository mocks;
+    test::Filesystem fs(&mocks);
+    TlvFile file(FILE_PATH);
+    REQUIRE(file.init() == 0);
+    CHECK(fs.hasDir("/sys"));
+
+    SECTION("stores and updates values") {
+        CHECK(file.get(1, nullptr, 0) == SYSTEM_ERROR_NOT_FOUND);
+        REQUIRE(set(file, 1, "abc") == 0);
+        REQUIRE(set(file, 2, "def") == 0);
+        CHECK(get(file, 1) == "abc");
+        CHECK(get(file, 2) == "def");
+        REQUIRE(set(file, 1, "ghij") == 0);
+        CHECK(get(file, 1) == "ghij");
+        CHECK(get(file, 2) == "def");
+        REQUIRE(file.del(2) == 0);
+        CHECK(file.get(2, nullptr, 0) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(file.del(2) == SYSTEM_ERROR_NOT_FOUND);
+        // Reopen the file
+        REQUIRE(file.deInit() == 0);
+        REQUIRE(file.init() == 0);
+        CHECK(get(file, 1) == "ghij");
+        CHECK(file.get(2, nullptr, 0) == SYSTEM_ERROR_NOT_FOUND);
+    }
+
+    SECTION("appends updates to the file") {
+        REQUIRE(set(file, 1, "abc") == 0);
+        const auto data = fs.readFile(FILE_PATH);
+        REQUIRE(set(file, 1, "def") == 0);
+        REQUIRE(file.del(1) == 0);
+        const auto& newData = fs.readFile(FILE_PATH);
+        CHECK(newData.size() > data.size());
+        // Everything but the footer is preserved
+        CHECK(newData.compare(0, data.size() - 16, data, 0, data.size() - 16) == 0);
+    }
+
+    SECTION("keeps multiple values per key") {
+        REQUIRE(add(file, 1, "a") == 0);
+        REQUIRE(add(file, 1, "b") == 0);
+        REQUIRE(add(file, 1, "c") == 0);
+        CHECK(get(file, 1, 0) == "a");
+        CHECK(get(file, 1, 1) == "b");
+        CHECK(get(file, 1, 2) == "c");
+        CHECK(get(file, 1, -1) == "c");
+        REQUIRE(file.del(1, 1) == 0);
+        REQUIRE(file.deInit() == 0);
+        REQUIRE(file.init() == 0);
+        CHECK(get(file, 1, 0) == "a");
+        CHECK(get(file, 1, 1) == "c");
+        REQUIRE(file.del(1) == 0);
+        CHECK(file.get(1, nullptr, 0, -1) == SYSTEM_ERROR_NOT_FOUND);
+    }
+
+    SECTION("reads files in the legacy format") {
+        REQUIRE(file.deInit() == 0);
+        fs.writeFile(FILE_PATH, legacyFile(legacyRecord(1, "abc") + legacyRecord(2, "def")));
+        REQUIRE(file.init() == 0);
+        CHECK(get(file, 1) == "abc");
+        CHECK(get(file, 2) == "def");
+        REQUIRE(set(file, 1, "ghi") == 0);
+        REQUIRE(file.deInit() == 0);
+        const auto& data = fs.readFile(FILE_PATH);
+        CHECK(data.substr(data.size() - 4) == u32(services::settings::TLV_FILE_LOG_MAGICK));
+        REQUIRE(file.init() == 0);
+        CHECK(get(file, 1) == "ghi");
+        CHECK(get(file, 2) == "def");
+    }
+
+    SECTION("uses the legacy format while the file contains only current records") {
+        CHECK(fileMagick(fs) == services::settings::TLV_FILE_MAGICK);
+        REQUIRE(set(file, 1, "abc") == 0);
+        REQUIRE(add(file, 2, "def") == 0);
+        CHECK(fileMagick(fs) == services::settings::TLV_FILE_MAGICK);
+        REQUIRE(file.deInit() == 0);
+        // The file can be read by older versions of the firmware
+        CHECK(fs.readFile(FILE_PATH) == legacyFile(legacyRecord(1, "abc") + legacyRecord(2, "def")));
+        REQUIRE(file.init() == 0);
+        REQUIRE(set(file, 1, "ghi") == 0);
+        CHECK(fileMagick(fs) == services::settings::TLV_FILE_LOG_MAGICK);
+    }
+
+    SECTION("recreates an invalid file") {
+        REQUIRE(file.deInit() == 0);
+        fs.writeFile(FILE_PATH, "garbage");
+        REQUIRE(file.init() == 0);
+        CHECK(file.size() == 16);
+        REQUIRE(set(file, 1, "abc") == 0);
+        CHECK(get(file, 1) == "abc");
+    }
+
+    SECTION("compacts the file") {
+        const std::string val(50, 'a');
+        REQUIRE(set(file, 2, "def") == 0);
+        size_t maxSize = 0;
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(set(file, 1, val + std::to_string(i)) == 0);
+            maxSize = std::max<size_t>(maxSize, file.size());
+        }
+        CHECK(maxSize < 2048);
+        CHECK(get(file, 1) == val + "99");
+        CHECK(get(file, 2) == "def");
+        CHECK_FALSE(fs.hasFile(std::string(FILE_PATH) + ".tmp"));
+        REQUIRE(file.deInit() == 0);
+        REQUIRE(file.init() == 0);
+        CHECK(get(file, 1) == val + "99");
+        CHECK(get(file, 2) == "def");
+        // A compacted file can be read by older versions of the firmware
+        const size_t compactedSize = 16 /* Footer */ + 8 * 2 /* Headers */ + 3 + val.size() + 2;
+        for (int i = 0; i < 100 && fs.readFile(FILE_PATH).size() != compactedSize; ++i) {
+            REQUIRE(set(file, 1, val + "99") == 0);
+        }
+        REQUIRE(fs.readFile(FILE_PATH).size() == compactedSize);
+        CHECK(fileMagick(fs) == services::settings::TLV_FILE_MAGICK);
+    }
+
+    SECTION("defers syncing the file until the update ends") {
+        int syncCount = 0;
+        mocks.OnCallFunc(lfs_file_sync).Do([&](lfs_t*, lfs_file_t*) {
+            ++syncCount;
+            return 0;
+        });
+        REQUIRE(file.beginUpdate() == 0);
+        REQUIRE(file.beginUpdate() == 0);
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(set(file, i + 1, std::to_string(i)) == 0);
+        }
+        REQUIRE(file.endUpdate() == 0);
+        CHECK(syncCount == 0);
+        // The changes are visible before the file is synced
+        CHECK(get(file, 5) == "4");
+        REQUIRE(file.endUpdate() == 0);
+        CHECK(syncCount == 1);
+        CHECK(file.endUpdate() == SYSTEM_ERROR_INVALID_STATE);
+        REQUIRE(set(file, 1, "abc") == 0);
+        CHECK(syncCount == 2);
+    }
+
+    REQUIRE(file.deInit() == 0);
+}
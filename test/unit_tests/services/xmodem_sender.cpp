@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "xmodem_sender.h"
+#include "stream.h"
+#include "system_error.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <cstring>
+
+using namespace particle;
+
+namespace {
+
+const char SOH = 0x01;
+const char STX = 0x02;
+const char EOT = 0x04;
+const char ACK = 0x06;
+const char NAK = 0x15;
+const char CAN = 0x18;
+
+// Bitwise implementation of the CRC-CCITT (XMODEM) algorithm
+uint16_t calcCrc16(const char* data, size_t size) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= (uint16_t)(uint8_t)data[i] << 8;
+        for (unsigned j = 0; j < 8; ++j) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+std::string genRandomData(size_t size) {
+    std::mt19937 gen(0);
+    std::string d(size, '\0');
+    for (auto& c: d) {
+        c = (char)gen();
+    }
+    return d;
+}
+
+class StringInputStream: public InputStream {
+public:
+    explicit StringInputStream(std::string data) :
+            data_(std::move(data)),
+            offs_(0) {
+    }
+
+    int read(char* data, size_t size) override {
+        size = std::min(size, data_.size() - offs_);
+        memcpy(data, data_.data() + offs_, size);
+        offs_ += size;
+        return size;
+    }
+
+    int peek(char* data, size_t size) override {
+        size = std::min(size, data_.size() - offs_);
+        memcpy(data, data_.data() + offs_, size);
+        return size;
+    }
+
+    int skip(size_t size) override {
+        size = std::min(size, data_.size() - offs_);
+        offs_ += size;
+        return size;
+    }
+
+    int availForRead() override {
+        return data_.size() - offs_;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        return (offs_ < data_.size()) ? (int)InputStream::READABLE : SYSTEM_ERROR_END_OF_STREAM;
+    }
+
+private:
+    std::string data_;
+    size_t offs_;
+};
+
+// Stream connected to a minimal XMODEM receiver. The data written by the sender is processed
+// synchronously, and the receiver's replies are returned by subsequent reads
+class ReceiverStream: public Stream {
+public:
+    explicit ReceiverStream(char ncg) :
+            ncg_(ncg),
+            expectedNum_(1),
+            packetCount_(0),
+            ackCount_(0),
+            nakCount_(0),
+            packetNakCount_(0),
+            nakPacketNum_(0),
+            nakPacketCount_(0),
+            cancelPacketNum_(0),
+            done_(false),
+            failed_(false) {
+        reply_ += ncg;
+    }
+
+    // NAK each packet `count` times before accepting it. A packet number of 0 applies to all packets
+    ReceiverStream& nakPacket(unsigned num, unsigned count = 1) {
+        nakPacketNum_ = num;
+        nakPacketCount_ = count;
+        return *this;
+    }
+
+    // Cancel the transfer once the packet with the specified number is received
+    ReceiverStream& cancelAtPacket(unsigned num) {
+        cancelPacketNum_ = num;
+        return *this;
+    }
+
+    int read(char* data, size_t size) override {
+        size = std::min(size, reply_.size());
+        memcpy(data, reply_.data(), size);
+        reply_.erase(0, size);
+        return size;
+    }
+
+    int peek(char* data, size_t size) override {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+
+    int skip(size_t size) override {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+
+    int availForRead() override {
+        return reply_.size();
+    }
+
+    int write(const char* data, size_t size) override {
+        // Accept the data in small chunks to exercise partial writes
+        size = std::min(size, WRITE_CHUNK_SIZE);
+        recv_.append(data, size);
+        while (process()) {
+        }
+        return size;
+    }
+
+    int flush() override {
+        return 0;
+    }
+
+    int availForWrite() override {
+        return WRITE_CHUNK_SIZE;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+
+    const std::string& data() const {
+        return data_;
+    }
+
+    // Number of packets received, including the retransmitted ones
+    unsigned packetCount() const {
+        return packetCount_;
+    }
+
+    // Number of ACKs and NAKs sent for the packets
+    unsigned ackCount() const {
+        return ackCount_;
+    }
+
+    unsigned nakCount() const {
+        return nakCount_;
+    }
+
+    bool done() const {
+        return done_;
+    }
+
+    bool failed() const {
+        return failed_;
+    }
+
+private:
+    static constexpr size_t WRITE_CHUNK_SIZE = 100;
+
+    std::string recv_;
+    std::string reply_;
+    std::string data_;
+    char ncg_;
+    unsigned expectedNum_;
+    unsigned packetCount_;
+    unsigned ackCount_;
+    unsigned nakCount_;
+    unsigned packetNakCount_;
+    unsigned nakPacketNum_;
+    unsigned nakPacketCount_;
+    unsigned cancelPacketNum_;
+    bool done_;
+    bool failed_;
+
+    bool process() {
+        if (recv_.empty() || done_ || failed_) {
+            return false;
+        }
+        if (recv_[0] == EOT) {
+            recv_.erase(0, 1);
+            reply_ += ACK;
+            done_ = true;
+            return false;
+        }
+        if (recv_[0] != SOH && recv_[0] != STX) {
+            failed_ = true;
+            return false;
+        }
+        const size_t dataSize = (recv_[0] == STX) ? 1024 : 128;
+        if (recv_.size() < dataSize + 5) {
+            return false;
+        }
+        const auto p = recv_.substr(1, dataSize + 4);
+        recv_.erase(0, dataSize + 5);
+        ++packetCount_;
+        const uint8_t num = p[0];
+        const uint16_t crc = ((uint16_t)(uint8_t)p[dataSize + 2] << 8) | (uint8_t)p[dataSize + 3];
+        if ((uint8_t)p[1] != (uint8_t)~num || crc != calcCrc16(p.data() + 2, dataSize)) {
+            failed_ = true;
+            return false;
+        }
+        if (num == (uint8_t)(expectedNum_ - 1) && ncg_ == 'C') {
+            reply(ACK); // Duplicate packet
+            return true;
+        }
+        if (num != (uint8_t)expectedNum_) {
+            failed_ = true;
+            return false;
+        }
+        if (cancelPacketNum_ == expectedNum_) {
+            reply_ += CAN;
+            reply_ += CAN;
+            return false;
+        }
+        if ((nakPacketNum_ == 0 || nakPacketNum_ == expectedNum_) && packetNakCount_ < nakPacketCount_) {
+            ++packetNakCount_;
+            ++nakCount_;
+            reply(NAK);
+            return true;
+        }
+        data_.append(p.data() + 2, dataSize);
+        packetNakCount_ = 0;
+        ++expectedNum_;
+        if (ncg_ == 'C') {
+            reply(ACK);
+        }
+        return true;
+    }
+
+    void reply(char c) {
+        reply_ += c;
+        ++ackCount_;
+    }
+};
+
+int transfer(ReceiverStream* recv, const std::string& data) {
+    StringInputStream src(data);
+    XmodemSender sender;
+    REQUIRE(sender.init(recv, &src, data.size()) == 0);
+    int r = 0;
+    do {
+        r = sender.run();
+    } while (r == XmodemSender::RUNNING);
+    return r;
+}
+
+void checkData(const ReceiverStream& recv, const std::string& data) {
+    REQUIRE(!recv.failed());
+    // The last packet is padded with zeros
+    REQUIRE(recv.data().size() >= data.size());
+    CHECK(recv.data().substr(0, data.size()) == data);
+}
+
+} // namespace
+
+TEST_CASE("XmodemSender") {
+    const auto data = genRandomData(16 * 1024 + 300);
+    const unsigned packetCount = 19; // 16 1K packets and 3 128-byte packets
+
+    SECTION("waits for an ACK after each packet if the receiver initiates the transfer with 'C'") {
+        ReceiverStream recv('C');
+        CHECK(transfer(&recv, data) == XmodemSender::DONE);
+        CHECK(recv.done());
+        checkData(recv, data);
+        CHECK(recv.packetCount() == packetCount);
+        CHECK(recv.ackCount() == packetCount);
+    }
+
+    SECTION("streams the packets without waiting for ACKs if the receiver initiates the transfer with 'G'") {
+        ReceiverStream recv('G');
+        CHECK(transfer(&recv, data) == XmodemSender::DONE);
+        CHECK(recv.done());
+        checkData(recv, data);
+        CHECK(recv.packetCount() == packetCount);
+        CHECK(recv.ackCount() == 0);
+    }
+
+    SECTION("resends a packet after a NAK") {
+        ReceiverStream recv('C');
+        recv.nakPacket(3);
+        CHECK(transfer(&recv, data) == XmodemSender::DONE);
+        checkData(recv, data);
+        CHECK(recv.nakCount() == 1);
+        CHECK(recv.packetCount() == packetCount + 1);
+    }
+
+    SECTION("resets the retry count once a packet is acknowledged") {
+        ReceiverStream recv('C');
+        recv.nakPacket(0 /* All packets */, 2);
+        CHECK(transfer(&recv, data) == XmodemSender::DONE);
+        checkData(recv, data);
+        CHECK(recv.nakCount() == packetCount * 2);
+    }
+
+    SECTION("fails if a packet is not acknowledged after several retries") {
+        ReceiverStream recv('C');
+        recv.nakPacket(3, 3);
+        CHECK(transfer(&recv, data) == SYSTEM_ERROR_LIMIT_EXCEEDED);
+        CHECK(!recv.done());
+    }
+
+    SECTION("fails if the receiver sends a NAK in the streaming mode") {
+        ReceiverStream recv('G');
+        recv.nakPacket(3);
+        CHECK(transfer(&recv, data) == SYSTEM_ERROR_PROTOCOL);
+        CHECK(!recv.done());
+    }
+
+    SECTION("stops if the receiver cancels the transfer") {
+        for (char ncg: { 'C', 'G' }) {
+            ReceiverStream recv(ncg);
+            recv.cancelAtPacket(3);
+            CHECK(transfer(&recv, data) == SYSTEM_ERROR_CANCELLED);
+            CHECK(!recv.done());
+        }
+    }
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Subset of the platform-specific BLE definitions needed to build the tests with HAL_PLATFORM_BLE
+// enabled
+
+/* Maximum length of advertising and scan response data */
+#define BLE_MAX_ADV_DATA_LEN                        31
+
+#define BLE_MAX_SUPPORTED_ADV_DATA_LEN              BLE_MAX_ADV_DATA_LEN
+
+/* Maximum length of the buffer to store scan report data */
+#define BLE_MAX_SCAN_REPORT_BUF_LEN                 255
+
+typedef uint16_t hal_ble_attr_handle_t;
+typedef uint16_t hal_ble_conn_handle_t;
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+
+namespace particle {
+
+namespace test {
+
+/**
+ * Fake socket used by the socket HAL stubs defined in socket_hal_compat.cpp.
+ *
+ * All socket handles created or used by the code under test refer to the current instance.
+ */
+class FakeSocket {
+public:
+    struct Datagram {
+        std::string data; // Datagram data
+        uint8_t addr[4]; // IPv4 address of the sender
+        uint16_t port; // Port of the sender
+    };
+
+    std::string sent; // Data sent to the socket
+    std::string received; // Stream data to be received
+    std::deque<Datagram> datagrams; // Datagrams to be received
+    unsigned sendCount; // Number of send calls
+    unsigned receiveCount; // Number of receive calls
+    size_t maxSendSize; // Maximum number of bytes accepted by a send call
+    unsigned sendDelay; // Time in milliseconds each send call takes
+    bool closed; // Whether the socket has been closed
+
+    FakeSocket() :
+            sendCount(0),
+            receiveCount(0),
+            maxSendSize((size_t)-1),
+            sendDelay(0),
+            closed(false) {
+        instance_ = this;
+    }
+
+    ~FakeSocket() {
+        instance_ = nullptr;
+    }
+
+    FakeSocket(const FakeSocket&) = delete;
+    FakeSocket& operator=(const FakeSocket&) = delete;
+
+    static FakeSocket* instance() {
+        return instance_;
+    }
+
+private:
+    static FakeSocket* instance_;
+};
+
+} // namespace test
+
+} // namespace particle
@@ -30,6 +30,18 @@ filesystem_t* filesystem_get_instance(filesystem_instance_t index, void* reserve
     return &fs;
 }
 
+int filesystem_mount(filesystem_t* fs) {
+    return 0;
+}
+
+int filesystem_unmount(filesystem_t* fs) {
+    return 0;
+}
+
+int filesystem_invalidate(filesystem_t* fs) {
+    return 0;
+}
+
 int filesystem_lock(filesystem_t* fs) {
     return 0;
 }
@@ -78,6 +90,30 @@ int lfs_remove(lfs_t* lfs, const char* path) {
     return 0;
 }
 
+int lfs_rename(lfs_t* lfs, const char* oldpath, const char* newpath) {
+    return 0;
+}
+
+int lfs_stat(lfs_t* lfs, const char* path, struct lfs_info* info) {
+    return 0;
+}
+
+int lfs_mkdir(lfs_t* lfs, const char* path) {
+    return 0;
+}
+
+int lfs_dir_open(lfs_t* lfs, lfs_dir_t* dir, const char* path) {
+    return 0;
+}
+
+int lfs_dir_close(lfs_t* lfs, lfs_dir_t* dir) {
+    return 0;
+}
+
+int lfs_dir_read(lfs_t* lfs, lfs_dir_t* dir, struct lfs_info* info) {
+    return 0;
+}
+
 int filesystem_to_system_error(int error) {
     return error;
 }
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define EXTERNAL_FLASH_ASSET_STORAGE_PAGE_COUNT (512)
+#define EXTERNAL_FLASH_ASSET_STORAGE_SIZE (EXTERNAL_FLASH_ASSET_STORAGE_PAGE_COUNT * 4096)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t Compute_CRC32(const uint8_t* pBuffer, uint32_t bufferSize, uint32_t const* p_crc);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
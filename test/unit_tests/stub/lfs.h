@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016 Particle Industries, Inc.  All rights reserved.
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
  *
  * This library is free software; you can redistribute it and/or
  * modify it under the terms of the GNU Lesser General Public
@@ -15,16 +15,6 @@
  * License along with this library; if not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "spark_wiring_async.h"
+#pragma once
 
-void particle::detail::futureCallbackWrapper(void* data) {
-    if (!data) {
-        return;
-    }
-    auto callbackPtr = static_cast<const std::function<void()>*>(data);
-    if (!callbackPtr) {
-        return;
-    }
-    (*callbackPtr)();
-    delete callbackPtr;
-}
+#include "filesystem.h"
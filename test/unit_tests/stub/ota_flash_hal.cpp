@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ota_flash_hal_impl.h"
+#include "ota_module.h"
+#include "storage_hal.h"
+#include "user_hal.h"
+#include "flash_mal.h"
+#include "system_error.h"
+
+const module_bounds_t module_user = {};
+const module_bounds_t module_user_mono = {};
+
+const module_bounds_t* find_module_bounds(uint8_t module_function, uint8_t module_index, uint8_t mcu_identifier) {
+    return nullptr;
+}
+
+int hal_user_module_get_descriptor(hal_user_module_descriptor* desc) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+int hal_storage_read(hal_storage_id id, uintptr_t addr, uint8_t* buf, size_t size) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+uint32_t Compute_CRC32(const uint8_t* pBuffer, uint32_t bufferSize, uint32_t const* p_crc) {
+    uint32_t crc = (p_crc ? *p_crc : 0) ^ ~0u;
+    while (bufferSize--) {
+        crc ^= *pBuffer++;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+    return crc ^ ~0u;
+}
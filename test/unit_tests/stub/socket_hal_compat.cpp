@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+#include "socket_hal_compat.h"
+#include "fake_socket.h"
+
+using particle::test::FakeSocket;
+
+FakeSocket* FakeSocket::instance_ = nullptr;
+
+namespace {
+
+const sock_handle_t FAKE_SOCKET_HANDLE = 1;
+
+FakeSocket* openSocket() {
+    auto sock = FakeSocket::instance();
+    return (sock && !sock->closed) ? sock : nullptr;
+}
+
+} // namespace
+
+uint8_t socket_active_status(sock_handle_t sd) {
+    return openSocket() ? SOCKET_STATUS_ACTIVE : SOCKET_STATUS_INACTIVE;
+}
+
+uint8_t socket_handle_valid(sock_handle_t sd) {
+    return sd != socket_handle_invalid();
+}
+
+sock_handle_t socket_handle_invalid() {
+    return -1;
+}
+
+sock_handle_t socket_create(uint8_t family, uint8_t type, uint8_t protocol, uint16_t port, network_interface_t nif) {
+    return openSocket() ? FAKE_SOCKET_HANDLE : socket_handle_invalid();
+}
+
+sock_result_t socket_connect(sock_handle_t sd, const sockaddr_t* addr, long addrlen) {
+    return openSocket() ? 0 : -1;
+}
+
+sock_result_t socket_close(sock_handle_t sd) {
+    auto sock = FakeSocket::instance();
+    if (sock) {
+        sock->closed = true;
+    }
+    return 0;
+}
+
+sock_result_t socket_send_ex(sock_handle_t sd, const void* buffer, socklen_t len, uint32_t flags, system_tick_t timeout, void* reserved) {
+    auto sock = openSocket();
+    if (!sock) {
+        return -1;
+    }
+    if (sock->sendDelay) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(sock->sendDelay));
+    }
+    const size_t n = std::min((size_t)len, sock->maxSendSize);
+    sock->sent.append((const char*)buffer, n);
+    ++sock->sendCount;
+    return n;
+}
+
+sock_result_t socket_sendto(sock_handle_t sd, const void* buffer, socklen_t len, uint32_t flags, sockaddr_t* addr, socklen_t addr_size) {
+    return socket_send_ex(sd, buffer, len, flags, 0 /* timeout */, nullptr /* reserved */);
+}
+
+sock_result_t socket_receive(sock_handle_t sd, void* buffer, socklen_t len, system_tick_t timeout) {
+    auto sock = openSocket();
+    if (!sock) {
+        return -1;
+    }
+    ++sock->receiveCount;
+    const size_t n = std::min((size_t)len, sock->received.size());
+    std::copy_n(sock->received.begin(), n, (char*)buffer);
+    sock->received.erase(0, n);
+    return n;
+}
+
+sock_result_t socket_receivefrom_ex(sock_handle_t sd, void* buffer, socklen_t len, uint32_t flags, sockaddr_t* addr, socklen_t* addr_size, system_tick_t timeout, void* reserved) {
+    auto sock = openSocket();
+    if (!sock) {
+        return -1;
+    }
+    ++sock->receiveCount;
+    if (sock->datagrams.empty()) {
+        return 0;
+    }
+    const auto& d = sock->datagrams.front();
+    // The remainder of the datagram that doesn't fit in the buffer is discarded
+    const size_t n = std::min((size_t)len, d.data.size());
+    std::copy_n(d.data.begin(), n, (char*)buffer);
+    if (addr) {
+        addr->sa_family = AF_INET;
+        addr->sa_data[0] = d.port >> 8;
+        addr->sa_data[1] = d.port & 0xff;
+        std::copy_n(d.addr, 4, &addr->sa_data[2]);
+    }
+    sock->datagrams.pop_front();
+    return n;
+}
+
+sock_result_t socket_join_multicast(const HAL_IPAddress* address, network_interface_t nif, socket_multicast_info_t* reserved) {
+    return -1;
+}
+
+sock_result_t socket_leave_multicast(const HAL_IPAddress* address, network_interface_t nif, socket_multicast_info_t* reserved) {
+    return -1;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "asset_manager.h"
+#include "asset_manager_api.h"
+#include "module_info.h"
+#include "flash_mal.h"
+#include "storage_hal.h"
+#include "endian_util.h"
+#include "system_error.h"
+
+#include "mock/filesystem.h"
+
+#include <catch2/catch.hpp>
+#include <hippomocks.h>
+
+#include <zlib.h>
+
+#include <string>
+#include <stdexcept>
+
+using namespace particle;
+
+namespace {
+
+const char* const ASSET_NAME = "asset.txt";
+const char* const MANIFEST_FILE = ".assets";
+
+template<typename T>
+std::string bytes(const T& val) {
+    return std::string((const char*)&val, sizeof(val));
+}
+
+std::string deflateRaw(const std::string& data) {
+    z_stream strm = {};
+    if (deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, -15 /* windowBits */, 8 /* memLevel */, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2() failed");
+    }
+    std::string out(deflateBound(&strm, data.size()), '\0');
+    strm.next_in = (Bytef*)data.data();
+    strm.avail_in = data.size();
+    strm.next_out = (Bytef*)&out.front();
+    strm.avail_out = out.size();
+    const int r = deflate(&strm, Z_FINISH);
+    deflateEnd(&strm);
+    if (r != Z_STREAM_END) {
+        throw std::runtime_error("deflate() failed");
+    }
+    out.resize(strm.total_out);
+    return out;
+}
+
+// Serializes a compressed asset module as stored in the asset filesystem
+std::string assetModule(const std::string& name, const std::string& data, char hashByte = 'h') {
+    compressed_module_header compHeader = {};
+    compHeader.size = sizeof(compHeader);
+    compHeader.original_size = data.size();
+
+    module_info_name_ext_t nameExt = {};
+    nameExt.ext.type = MODULE_INFO_EXTENSION_NAME;
+    nameExt.ext.length = sizeof(nameExt) + name.size() + 1;
+    module_info_hash_ext_t hashExt = {};
+    hashExt.ext.type = MODULE_INFO_EXTENSION_HASH;
+    hashExt.ext.length = sizeof(hashExt);
+    hashExt.hash.type = MODULE_INFO_HASH_TYPE_SHA256;
+    hashExt.hash.length = sizeof(hashExt.hash.hash);
+    memset(hashExt.hash.hash, hashByte, sizeof(hashExt.hash.hash));
+    module_info_extension_t endExt = {};
+    endExt.type = MODULE_INFO_EXTENSION_END;
+    endExt.length = sizeof(endExt);
+    const auto exts = bytes(nameExt) + name + '\0' + bytes(hashExt) + bytes(endExt);
+    module_info_suffix_base_t suffix = {};
+    suffix.size = sizeof(suffix) + exts.size();
+
+    const auto body = bytes(compHeader) + deflateRaw(data) + exts + bytes(suffix);
+    module_info_t prefix = {};
+    prefix.module_start_address = (const void*)0;
+    prefix.module_end_address = (const void*)(sizeof(prefix) + body.size());
+    prefix.flags = MODULE_INFO_FLAG_DROP_MODULE_INFO | MODULE_INFO_FLAG_COMPRESSED;
+    prefix.module_function = MODULE_FUNCTION_ASSET;
+
+    const auto module = bytes(prefix) + body;
+    const uint32_t crc = nativeToBigEndian(Compute_CRC32((const uint8_t*)module.data(), module.size(), nullptr));
+    return module + bytes(crc);
+}
+
+int readAsset(const Asset& asset, std::string* data) {
+    asset_manager_asset a = {};
+    a.name = asset.name().c_str();
+    a.hash_type = asset.hash().type();
+    a.hash_length = asset.hash().hash().size();
+    a.hash = asset.hash().hash().data();
+    asset_manager_stream* stream = nullptr;
+    int r = asset_manager_open(&stream, &a, nullptr);
+    if (r < 0) {
+        return r;
+    }
+    data->clear();
+    char buf[128];
+    for (;;) {
+        r = asset_manager_read(stream, buf, sizeof(buf), nullptr);
+        if (r <= 0) {
+            break;
+        }
+        data->append(buf, r);
+    }
+    asset_manager_close(stream, nullptr);
+    return (r == SYSTEM_ERROR_END_OF_STREAM) ? 0 : r;
+}
+
+hal_module_t halModule(const std::string& module) {
+    hal_module_t m = {};
+    m.bounds.location = MODULE_BOUNDS_LOC_INTERNAL_FLASH;
+    m.info.module_start_address = (const void*)0;
+    m.info.module_end_address = (const void*)(module.size() - 4 /* CRC-32 */);
+    m.info.module_function = MODULE_FUNCTION_ASSET;
+    return m;
+}
+
+} // namespace
+
+TEST_CASE("AssetManager") {
+    MockRepository mocks;
+    test::Filesystem fs(&mocks);
+    auto& manager = AssetManager::instance();
+    REQUIRE(manager.formatStorage() == 0);
+
+    const std::string data(10000, 'a');
+    const auto module = assetModule(ASSET_NAME, data);
+    fs.writeFile(ASSET_NAME, module);
+
+    // The asset is fully validated and added to the manifest on first boot
+    REQUIRE(manager.init() == 0);
+    REQUIRE(manager.availableAssets().size() == 1);
+    CHECK(fs.hasFile(MANIFEST_FILE));
+
+    SECTION("an asset listed in the manifest can be opened after a reboot") {
+        REQUIRE(manager.init() == 0);
+        const auto assets = manager.availableAssets();
+        REQUIRE(assets.size() == 1);
+        std::string d;
+        CHECK(readAsset(assets.first(), &d) == 0);
+        CHECK(d == data);
+        // Open the asset again after it has been validated
+        CHECK(readAsset(assets.first(), &d) == 0);
+        CHECK(d == data);
+        CHECK(manager.availableAssets().size() == 1);
+    }
+
+    SECTION("an asset listed in the manifest that has been corrupted can't be opened") {
+        auto m = module;
+        m[sizeof(module_info_t) + sizeof(compressed_module_header) + 1] ^= 0xff;
+        fs.writeFile(ASSET_NAME, m);
+        REQUIRE(manager.init() == 0);
+        const auto assets = manager.availableAssets();
+        REQUIRE(assets.size() == 1);
+        std::string d;
+        CHECK(readAsset(assets.first(), &d) == SYSTEM_ERROR_BAD_DATA);
+        CHECK(manager.availableAssets().isEmpty());
+        // The file is validated in full and removed on next boot
+        REQUIRE(manager.init() == 0);
+        CHECK(manager.availableAssets().isEmpty());
+        CHECK(!fs.hasFile(ASSET_NAME));
+    }
+
+    SECTION("an asset that doesn't match its manifest entry is validated in full on boot") {
+        // Same name and size but a different hash
+        const auto m = assetModule(ASSET_NAME, data, 'x');
+        REQUIRE(m.size() == module.size());
+        fs.writeFile(ASSET_NAME, m);
+        REQUIRE(manager.init() == 0);
+        const auto assets = manager.availableAssets();
+        REQUIRE(assets.size() == 1);
+        CHECK(assets.first().hash().hash().data()[0] == 'x');
+        std::string d;
+        CHECK(readAsset(assets.first(), &d) == 0);
+        CHECK(d == data);
+    }
+
+    SECTION("an asset can be stored from a module in the internal flash") {
+        const std::string data2(20000, 'b');
+        const auto m = assetModule("asset2.txt", data2);
+        mocks.OnCallFunc(hal_storage_read).Do([&](hal_storage_id id, uintptr_t addr, uint8_t* buf, size_t size) {
+            REQUIRE(id == HAL_STORAGE_ID_INTERNAL_FLASH);
+            REQUIRE(addr + size <= m.size());
+            memcpy(buf, m.data() + addr, size);
+            return (int)size;
+        });
+        // The system cache file used to store the consumer state is kept open
+        fs.autoCheckOpenFiles(false);
+        const auto hm = halModule(m);
+        REQUIRE(manager.storeAsset(&hm) == 0);
+        CHECK(fs.readFile("asset2.txt") == m);
+        // Assets not required by the application are removed before a new asset is stored
+        CHECK(!fs.hasFile(ASSET_NAME));
+        // The stored asset is listed in the manifest and can be opened after a reboot
+        REQUIRE(manager.init() == 0);
+        const auto assets = manager.availableAssets();
+        REQUIRE(assets.size() == 1);
+        std::string d;
+        CHECK(readAsset(assets.first(), &d) == 0);
+        CHECK(d == data2);
+    }
+
+    SECTION("a corrupted asset module is not stored") {
+        auto m = assetModule("asset2.txt", std::string(20000, 'b'));
+        m[sizeof(module_info_t) + sizeof(compressed_module_header) + 1] ^= 0xff;
+        mocks.OnCallFunc(hal_storage_read).Do([&](hal_storage_id id, uintptr_t addr, uint8_t* buf, size_t size) {
+            REQUIRE(addr + size <= m.size());
+            memcpy(buf, m.data() + addr, size);
+            return (int)size;
+        });
+        const auto hm = halModule(m);
+        CHECK(manager.storeAsset(&hm) == SYSTEM_ERROR_BAD_DATA);
+        CHECK(!fs.hasFile("asset2.txt"));
+        REQUIRE(manager.init() == 0);
+        CHECK(manager.availableAssets().isEmpty());
+    }
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_cloud_connection_trace.h"
+#include "control/cloud.h"
+#include "timer_hal.h"
+#include "endian_util.h"
+
+#include "mock/control.h"
+
+#include <catch2/catch.hpp>
+#include <hippomocks.h>
+
+#include <cstring>
+
+using namespace particle;
+
+namespace ConnectionPhase = particle::protocol::ConnectionPhase;
+
+namespace {
+
+const size_t MAX_ENTRY_COUNT = CloudConnectionTrace::MAX_ENTRY_COUNT;
+
+system_tick_t g_millis = 0;
+
+uint32_t diagValue(uint16_t id) {
+    // Sources can no longer be registered once the service is started. The global instance of the
+    // tracer has been registered by this point
+    diag_command(DIAG_SERVICE_CMD_START, nullptr, nullptr);
+    AbstractUnsignedIntegerDiagnosticData::IntType val = 0;
+    REQUIRE(AbstractUnsignedIntegerDiagnosticData::get(id, val) == 0);
+    return val;
+}
+
+template<typename T>
+T readLittleEndian(const std::string& data, size_t offs) {
+    T val = 0;
+    REQUIRE(offs + sizeof(val) <= data.size());
+    memcpy(&val, data.data() + offs, sizeof(val));
+    return littleEndianToNative(val);
+}
+
+} // namespace
+
+TEST_CASE("CloudConnectionTrace") {
+    MockRepository mocks;
+    mocks.OnCallFunc(HAL_Timer_Get_Milli_Seconds).Do([]() {
+        return g_millis;
+    });
+    g_millis = 1000;
+
+    SECTION("entries are returned oldest first") {
+        CloudConnectionTrace t;
+        CHECK(t.entryCount() == 0);
+        t.record(ConnectionPhase::CONNECT_START);
+        g_millis += 10;
+        t.record(ConnectionPhase::DNS_RESOLVED);
+        g_millis += 20;
+        t.record(ConnectionPhase::SOCKET_CONNECTED);
+        CloudConnectionTrace::Entry e[CloudConnectionTrace::MAX_ENTRY_COUNT] = {};
+        REQUIRE(t.entries(e, MAX_ENTRY_COUNT) == 3);
+        CHECK(e[0].phase == ConnectionPhase::CONNECT_START);
+        CHECK(e[0].time == 1000);
+        CHECK(e[1].phase == ConnectionPhase::DNS_RESOLVED);
+        CHECK(e[1].time == 1010);
+        CHECK(e[2].phase == ConnectionPhase::SOCKET_CONNECTED);
+        CHECK(e[2].time == 1030);
+        // Only the most recent entries are returned if the buffer is too small
+        REQUIRE(t.entries(e, 2) == 2);
+        CHECK(e[0].phase == ConnectionPhase::DNS_RESOLVED);
+        CHECK(e[1].phase == ConnectionPhase::SOCKET_CONNECTED);
+    }
+
+    SECTION("the oldest entries are overwritten when the buffer is full") {
+        CloudConnectionTrace t;
+        const size_t n = MAX_ENTRY_COUNT + 5;
+        for (size_t i = 0; i < n; ++i) {
+            t.record((ConnectionPhase::Enum)(i % ConnectionPhase::PHASE_COUNT));
+            ++g_millis;
+        }
+        CHECK(t.entryCount() == MAX_ENTRY_COUNT);
+        CloudConnectionTrace::Entry e[CloudConnectionTrace::MAX_ENTRY_COUNT] = {};
+        REQUIRE(t.entries(e, MAX_ENTRY_COUNT) == MAX_ENTRY_COUNT);
+        for (size_t i = 0; i < MAX_ENTRY_COUNT; ++i) {
+            const size_t j = i + n - MAX_ENTRY_COUNT;
+            CHECK(e[i].phase == (ConnectionPhase::Enum)(j % ConnectionPhase::PHASE_COUNT));
+            CHECK(e[i].time == 1000 + j);
+        }
+    }
+
+    SECTION("invalid phases are ignored") {
+        CloudConnectionTrace t;
+        t.record((ConnectionPhase::Enum)-1);
+        t.record(ConnectionPhase::PHASE_COUNT);
+        CHECK(t.entryCount() == 0);
+    }
+
+    SECTION("durations of the last connection attempt are reported as diagnostic data") {
+        auto t = CloudConnectionTrace::instance();
+        t->record(ConnectionPhase::CONNECT_START);
+        g_millis += 100;
+        t->record(ConnectionPhase::DNS_RESOLVED);
+        g_millis += 50;
+        t->record(ConnectionPhase::SOCKET_CONNECTED);
+        t->record(ConnectionPhase::HANDSHAKE_START);
+        g_millis += 1000;
+        t->record(ConnectionPhase::HANDSHAKE_DONE);
+        // A synchronous Hello is reported as sent once it's acknowledged
+        g_millis += 200;
+        t->record(ConnectionPhase::HELLO_SENT);
+        t->record(ConnectionPhase::HELLO_ACKED);
+        g_millis += 300;
+        t->record(ConnectionPhase::CONNECTED);
+        CHECK(diagValue(DIAG_ID_CLOUD_DNS_TIME) == 100);
+        CHECK(diagValue(DIAG_ID_CLOUD_HANDSHAKE_TIME) == 1000);
+        CHECK(diagValue(DIAG_ID_CLOUD_HELLO_TIME) == 200);
+        CHECK(diagValue(DIAG_ID_CLOUD_CONNECTION_TIME) == 1650);
+
+        // Resumed session with a pipelined Hello. Phases of the previous attempt are not used
+        t->record(ConnectionPhase::CONNECT_START);
+        g_millis += 10;
+        t->record(ConnectionPhase::SOCKET_CONNECTED);
+        t->record(ConnectionPhase::HANDSHAKE_START);
+        g_millis += 20;
+        t->record(ConnectionPhase::SESSION_RESUMED);
+        t->record(ConnectionPhase::HELLO_SENT);
+        g_millis += 30;
+        t->record(ConnectionPhase::HELLO_ACKED);
+        t->record(ConnectionPhase::CONNECTED);
+        CHECK(diagValue(DIAG_ID_CLOUD_DNS_TIME) == 100); // Not updated
+        CHECK(diagValue(DIAG_ID_CLOUD_HANDSHAKE_TIME) == 20);
+        CHECK(diagValue(DIAG_ID_CLOUD_HELLO_TIME) == 30);
+        CHECK(diagValue(DIAG_ID_CLOUD_CONNECTION_TIME) == 60);
+    }
+
+    SECTION("getConnectionTrace() replies with the recorded entries") {
+        test::SystemControl ctrl(&mocks);
+        auto t = CloudConnectionTrace::instance();
+        t->record(ConnectionPhase::CONNECT_START);
+        g_millis += 5;
+        t->record(ConnectionPhase::DNS_RESOLVED);
+        g_millis += 7;
+        CloudConnectionTrace::Entry e[CloudConnectionTrace::MAX_ENTRY_COUNT] = {};
+        const size_t count = t->entries(e, MAX_ENTRY_COUNT);
+        REQUIRE(count >= 2);
+
+        auto req = ctrl.makeRequest(CTRL_REQUEST_CLOUD_GET_CONNECTION_TRACE);
+        REQUIRE(ctrl::cloud::getConnectionTrace(req.get()) == 0);
+        const auto d = req->replyData();
+        REQUIRE(d.size() == 6 + count * 5);
+        CHECK(readLittleEndian<uint32_t>(d, 0) == 1012);
+        CHECK(readLittleEndian<uint16_t>(d, 4) == count);
+        for (size_t i = 0; i < count; ++i) {
+            CHECK(readLittleEndian<uint32_t>(d, 6 + i * 5) == e[i].time);
+            CHECK((uint8_t)d.at(6 + i * 5 + 4) == e[i].phase);
+        }
+        CHECK(readLittleEndian<uint32_t>(d, 6 + (count - 2) * 5) == 1000);
+        CHECK((uint8_t)d.at(6 + (count - 2) * 5 + 4) == ConnectionPhase::CONNECT_START);
+        CHECK(readLittleEndian<uint32_t>(d, 6 + (count - 1) * 5) == 1005);
+        CHECK((uint8_t)d.at(6 + (count - 1) * 5 + 4) == ConnectionPhase::DNS_RESOLVED);
+    }
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <map>
+#include <random>
+
+#include "system_connection_prober.h"
+
+#include "util/catch.h"
+
+using namespace particle;
+using namespace particle::system;
+
+namespace {
+
+const network_interface_t ETHERNET = NETWORK_INTERFACE_ETHERNET;
+const network_interface_t WIFI = 4;
+const network_interface_t CELLULAR = 5;
+
+const system_tick_t TX_INTERVAL = 250;
+const unsigned MAX_TX_COUNT = 10;
+const system_tick_t TEST_DURATION = 5000;
+
+// Simulated network interface
+struct Interface {
+    network_interface_t iface;
+    system_tick_t rtt; // Mean round-trip time
+    system_tick_t jitter; // Maximum deviation from the mean round-trip time
+    double loss; // Packet loss probability
+};
+
+// Sends test packets on the simulated interfaces the same way ConnectionTester does it
+class ProbeSimulation {
+public:
+    explicit ProbeSimulation(std::vector<Interface> ifaces, const Vector<ConnectionHistory>& history = Vector<ConnectionHistory>()) :
+            ifaces_(std::move(ifaces)),
+            rand_(12345),
+            now_(0),
+            txCount_(0) {
+        for (const auto& i: ifaces_) {
+            const ConnectionHistory* h = nullptr;
+            for (const auto& entry: history) {
+                if (entry.interface == i.iface) {
+                    h = &entry;
+                }
+            }
+            REQUIRE(prober.addInterface(i.iface, h) == 0);
+        }
+    }
+
+    // Runs the test until there's a winner or the test duration elapses
+    network_interface_t run() {
+        for (now_ = 0; now_ < TEST_DURATION; ++now_) {
+            if (now_ % TX_INTERVAL == 0 && txCount_ < MAX_TX_COUNT) {
+                send();
+            }
+            auto it = pending_.begin();
+            while (it != pending_.end() && it->first <= now_) {
+                prober.packetReceived(it->second.iface, it->second.seq, now_ - it->second.txTime);
+                it = pending_.erase(it);
+            }
+            const auto w = prober.winner(now_);
+            if (w != NETWORK_INTERFACE_ALL) {
+                return w;
+            }
+        }
+        return NETWORK_INTERFACE_ALL;
+    }
+
+    system_tick_t now() const {
+        return now_;
+    }
+
+    ConnectionProber prober;
+
+private:
+    struct Packet {
+        network_interface_t iface;
+        unsigned seq;
+        system_tick_t txTime;
+    };
+
+    std::vector<Interface> ifaces_;
+    std::multimap<system_tick_t, Packet> pending_; // Packets in flight by arrival time
+    std::mt19937 rand_;
+    system_tick_t now_;
+    unsigned txCount_;
+
+    void send() {
+        for (const auto& i: ifaces_) {
+            prober.packetSent(i.iface, txCount_, now_);
+            if (std::uniform_real_distribution<double>(0, 1)(rand_) < i.loss) {
+                continue;
+            }
+            const int jitter = std::uniform_int_distribution<int>(-(int)i.jitter, i.jitter)(rand_);
+            pending_.insert(std::make_pair(now_ + i.rtt + jitter, Packet{ i.iface, txCount_, now_ }));
+        }
+        ++txCount_;
+    }
+};
+
+} // namespace
+
+TEST_CASE("ConnectionProber") {
+    SECTION("picks a clearly faster interface before the test window elapses") {
+        ProbeSimulation sim({ { WIFI, 40, 10, 0 }, { CELLULAR, 400, 100, 0 } });
+        CHECK(sim.run() == WIFI);
+        // Three packets sent 250ms apart should be enough
+        CHECK(sim.now() < 1000);
+    }
+
+    SECTION("picks an interface without packet loss over a lossy one") {
+        ProbeSimulation sim({ { ETHERNET, 50, 5, 0.8 }, { CELLULAR, 80, 5, 0 } });
+        CHECK(sim.run() == CELLULAR);
+        CHECK(sim.now() < TEST_DURATION);
+    }
+
+    SECTION("picks the only working interface once its packets have been received") {
+        ProbeSimulation sim({ { WIFI, 300, 50, 1.0 }, { ETHERNET, 20, 2, 0 } });
+        CHECK(sim.run() == ETHERNET);
+        // The third packet sent on the other interface is considered lost after the loss timeout
+        CHECK(sim.now() <= 2 * TX_INTERVAL + ConnectionProber::MIN_LOSS_TIMEOUT);
+    }
+
+    SECTION("picks a single interface as soon as enough packets have been received") {
+        ProbeSimulation sim({ { CELLULAR, 200, 50, 0 } });
+        CHECK(sim.run() == CELLULAR);
+        CHECK(sim.now() < 1000);
+    }
+
+    SECTION("doesn't pick a winner among similar interfaces") {
+        ProbeSimulation sim({ { WIFI, 60, 20, 0 }, { ETHERNET, 55, 20, 0 } });
+        CHECK(sim.run() == NETWORK_INTERFACE_ALL);
+    }
+
+    SECTION("doesn't pick a winner if no packets are received") {
+        ProbeSimulation sim({ { WIFI, 60, 20, 1.0 }, { ETHERNET, 55, 20, 1.0 } });
+        CHECK(sim.run() == NETWORK_INTERFACE_ALL);
+    }
+
+    SECTION("considers packets lost after the loss timeout") {
+        ConnectionProber p;
+        REQUIRE(p.addInterface(WIFI) == 0);
+        p.packetSent(WIFI, 0, 100);
+        p.packetSent(WIFI, 1, 200);
+        p.packetFailed(WIFI, 2);
+        p.packetReceived(WIFI, 1, 50);
+        CHECK_FALSE(p.isPacketLost(WIFI, 0, 100 + ConnectionProber::MIN_LOSS_TIMEOUT - 1));
+        CHECK(p.isPacketLost(WIFI, 0, 100 + ConnectionProber::MIN_LOSS_TIMEOUT));
+        CHECK_FALSE(p.isPacketLost(WIFI, 1, 10000));
+        CHECK(p.isPacketLost(WIFI, 2, 0));
+        // Packets that haven't been sent are not lost
+        CHECK_FALSE(p.isPacketLost(WIFI, 3, 10000));
+        CHECK_FALSE(p.isPacketLost(CELLULAR, 0, 10000));
+    }
+
+    SECTION("keeps a moving average of the latency and loss of each interface") {
+        Vector<ConnectionHistory> history;
+        {
+            ConnectionProber p;
+            REQUIRE(p.addInterface(WIFI) == 0);
+            REQUIRE(p.addInterface(CELLULAR) == 0);
+            for (unsigned i = 0; i < 4; ++i) {
+                p.packetSent(WIFI, i, 0);
+                p.packetReceived(WIFI, i, 100);
+                p.packetSent(CELLULAR, i, 0);
+            }
+            p.packetReceived(CELLULAR, 0, 400);
+            REQUIRE(p.updateHistory(&history, 5000) == 0);
+        }
+        REQUIRE(history.size() == 2);
+        CHECK(history[0].interface == WIFI);
+        CHECK(history[0].rtt == Approx(100));
+        CHECK(history[0].loss == Approx(0));
+        CHECK(history[0].testCount == 1);
+        CHECK(history[1].interface == CELLULAR);
+        CHECK(history[1].rtt == Approx(400));
+        CHECK(history[1].loss == Approx(0.75));
+        {
+            ConnectionProber p;
+            REQUIRE(p.addInterface(WIFI, &history[0]) == 0);
+            for (unsigned i = 0; i < 4; ++i) {
+                p.packetSent(WIFI, i, 0);
+                p.packetReceived(WIFI, i, 200);
+            }
+            REQUIRE(p.updateHistory(&history, 5000) == 0);
+        }
+        REQUIRE(history.size() == 2);
+        CHECK(history[0].rtt == Approx(125));
+        CHECK(history[0].testCount == 2);
+        // Interfaces that weren't tested keep their history
+        CHECK(history[1].rtt == Approx(400));
+        CHECK(history[1].testCount == 1);
+    }
+
+    SECTION("uses the history to make a decision sooner") {
+        Vector<ConnectionHistory> history;
+        history.append({ WIFI, 40, 0, 5 });
+        history.append({ CELLULAR, 400, 0.5f, 5 });
+        ProbeSimulation withHistory({ { WIFI, 40, 10, 0 }, { CELLULAR, 400, 100, 0.5 } }, history);
+        CHECK(withHistory.run() == WIFI);
+        ProbeSimulation withoutHistory({ { WIFI, 40, 10, 0 }, { CELLULAR, 400, 100, 0.5 } });
+        CHECK(withoutHistory.run() == WIFI);
+        CHECK(withHistory.now() <= withoutHistory.now());
+    }
+}
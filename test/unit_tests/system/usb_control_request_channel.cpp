@@ -765,6 +765,121 @@ TEST_CASE("UsbControlRequestChannel") {
         }
     }
 
+    SECTION("chunked reply data") {
+        const size_t size = USB_REQUEST_REPLY_FRAME_SIZE * 4 + 100;
+        const std::string data = randomBytes(size);
+        channel.requestHandler([=](ctrl_request* req, ControlRequestChannel* ch) {
+            ControlReplyWriter writer(req);
+            // Write the data in small portions, similarly to how a nanopb stream does it
+            for (size_t offs = 0; offs < data.size(); offs += 10) {
+                REQUIRE(writer.write(data.data() + offs, std::min(data.size() - offs, (size_t)10)) == 0);
+            }
+            REQUIRE(writer.finish() == 0);
+            REQUIRE(req->reply_data == nullptr); // The reply is not stored in a contiguous buffer
+            REQUIRE(req->reply_size == data.size());
+            ch->setResult(req, SYSTEM_ERROR_NONE);
+        });
+        CHECK(channel.serviceRequest(ServiceRequest::INIT).type(TEST_REQ).send());
+        uint16_t id = channel.serviceReply().id();
+        CHECK(processNextTask());
+        CHECK(channel.serviceRequest(ServiceRequest::CHECK).id(id).send());
+        auto rep = channel.serviceReply();
+        CHECK(rep.status() == ServiceReply::OK);
+        CHECK(rep.size() == size);
+
+        SECTION("does not require a contiguous buffer for the entire reply") {
+            // Measure the peak heap usage while the reply was being written. The heap allocator is
+            // not used for anything else in this test. The overhead is limited to the unused part
+            // of the last frame, which is released once the reply is complete, and its trimmed copy
+            const size_t peakSize = channel.heapAllocator().peakAllocSize();
+            CHECK(peakSize >= size);
+            CHECK(peakSize < size + USB_REQUEST_REPLY_FRAME_SIZE * 2);
+        }
+        SECTION("can be transferred to the client in chunks of the frame size") {
+            std::string d;
+            for (size_t offs = 0; offs < size; offs += USB_REQUEST_REPLY_FRAME_SIZE) {
+                const size_t n = std::min(size - offs, USB_REQUEST_REPLY_FRAME_SIZE);
+                CHECK(channel.serviceRequest(ServiceRequest::RECV).id(id).size(n).send());
+                d += channel.serviceReply().data();
+            }
+            CHECK(d == data);
+            processAllTasks();
+            channel.checkMemory();
+        }
+        SECTION("can be transferred to the client in small chunks spanning several frames") {
+            const size_t chunkSize = 48; // Not a divisor of the frame size
+            std::string d;
+            for (size_t offs = 0; offs < size; offs += chunkSize) {
+                const size_t n = std::min(size - offs, chunkSize);
+                CHECK(channel.serviceRequest(ServiceRequest::RECV).id(id).size(n).send());
+                d += channel.serviceReply().data();
+            }
+            CHECK(d == data);
+            processAllTasks();
+            channel.checkMemory();
+        }
+        SECTION("can be transferred to the client in large chunks spanning several frames") {
+            const size_t chunkSize = 1000; // Not a divisor of the frame size
+            std::string d;
+            for (size_t offs = 0; offs < size; offs += chunkSize) {
+                const size_t n = std::min(size - offs, chunkSize);
+                CHECK(channel.serviceRequest(ServiceRequest::RECV).id(id).size(n).send());
+                d += channel.serviceReply().data();
+            }
+            CHECK(d == data);
+            processAllTasks();
+            channel.checkMemory();
+        }
+        SECTION("can be transferred to the client in chunks of the frame size that are not aligned to frames") {
+            CHECK(channel.serviceRequest(ServiceRequest::RECV).id(id).size(MIN_WLENGTH).send());
+            std::string d = channel.serviceReply().data();
+            for (size_t offs = MIN_WLENGTH; offs < size; offs += USB_REQUEST_REPLY_FRAME_SIZE) {
+                const size_t n = std::min(size - offs, USB_REQUEST_REPLY_FRAME_SIZE);
+                CHECK(channel.serviceRequest(ServiceRequest::RECV).id(id).size(n).send());
+                d += channel.serviceReply().data();
+            }
+            CHECK(d == data);
+            processAllTasks();
+            channel.checkMemory();
+        }
+        SECTION("fails if a chunk larger than the frame size spans several frames") {
+            CHECK(channel.serviceRequest(ServiceRequest::RECV).id(id).size(MIN_WLENGTH).send());
+            CHECK_FALSE(channel.serviceRequest(ServiceRequest::RECV).id(id).size(USB_REQUEST_REPLY_FRAME_SIZE + 1).send());
+        }
+        SECTION("is freed when the request is cancelled") {
+            CHECK(channel.serviceRequest(ServiceRequest::RESET).id(id).send());
+            processAllTasks();
+            channel.checkMemory();
+        }
+    }
+
+    SECTION("chunked reply data smaller than a frame") {
+        const size_t size = 1000;
+        const std::string data = randomBytes(size);
+        channel.requestHandler([=](ctrl_request* req, ControlRequestChannel* ch) {
+            ControlReplyWriter writer(req);
+            for (size_t offs = 0; offs < data.size(); offs += 10) {
+                REQUIRE(writer.write(data.data() + offs, std::min(data.size() - offs, (size_t)10)) == 0);
+            }
+            REQUIRE(writer.finish() == 0);
+            REQUIRE(req->reply_data == nullptr);
+            REQUIRE(req->reply_size == data.size());
+            ch->setResult(req, SYSTEM_ERROR_NONE);
+        });
+        CHECK(channel.serviceRequest(ServiceRequest::INIT).type(TEST_REQ).send());
+        uint16_t id = channel.serviceReply().id();
+        CHECK(processNextTask());
+        // The frame grows with the reply instead of being allocated at the full frame size. The peak
+        // usage includes the copies made while the frame is reallocated
+        const size_t peakSize = channel.heapAllocator().peakAllocSize();
+        CHECK(peakSize >= size);
+        CHECK(peakSize < size * 3);
+        CHECK(channel.serviceRequest(ServiceRequest::RECV).id(id).size(size).send());
+        CHECK(channel.serviceReply().data() == data);
+        processAllTasks();
+        channel.checkMemory();
+    }
+
     SECTION("RESET request") {
         SECTION("can cancel an active request by its ID") {
             CHECK(channel.serviceRequest(ServiceRequest::INIT).type(TEST_REQ).send());
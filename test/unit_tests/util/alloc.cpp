@@ -7,6 +7,7 @@
 
 test::Allocator::Allocator(size_t padding) :
         allocSize_(0),
+        peakAllocSize_(0),
         padding_(padding),
         failed_(false) {
 }
@@ -20,6 +21,9 @@ void* test::Allocator::malloc(size_t size) {
     void* const ptr = buf.data();
     alloc_.insert(std::make_pair(ptr, std::move(buf)));
     allocSize_ += size;
+    if (allocSize_ > peakAllocSize_) {
+        peakAllocSize_ = allocSize_;
+    }
     return ptr;
 }
 
@@ -77,8 +81,8 @@ void test::Allocator::free(void* ptr) {
         f.data = (std::string)f.buffer; // User data before free() has been called
         alloc_.erase(it);
         const bool ok = f.buffer.isPaddingValid();
+        allocSize_ -= f.buffer.size(); // Before the buffer is moved
         free_.insert(std::make_pair(ptr, std::move(f)));
-        allocSize_ -= f.buffer.size();
         if (!ok) {
             throw std::runtime_error("Buffer overflow detected");
         }
@@ -111,6 +115,7 @@ void test::Allocator::reset() {
     free_.clear();
     allocLimit_ = boost::none;
     allocSize_ = 0;
+    peakAllocSize_ = 0;
     failed_ = false;
 }
 
@@ -119,6 +124,11 @@ size_t test::Allocator::allocSize() const {
     return allocSize_;
 }
 
+size_t test::Allocator::peakAllocSize() const {
+    const std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return peakAllocSize_;
+}
+
 test::Allocator& test::Allocator::allocLimit(size_t size) {
     const std::lock_guard<std::recursive_mutex> lock(mutex_);
     allocLimit_ = size;
@@ -20,6 +20,7 @@ public:
     void free(void* ptr);
 
     size_t allocSize() const;
+    size_t peakAllocSize() const;
     Allocator& allocLimit(size_t size);
     Allocator& noAllocLimit();
 
@@ -40,7 +41,7 @@ private:
     std::unordered_map<void*, Buffer> alloc_;
     std::unordered_map<void*, FreedBuffer> free_;
     boost::optional<size_t> allocLimit_;
-    size_t allocSize_, padding_;
+    size_t allocSize_, peakAllocSize_, padding_;
     bool failed_;
 
     mutable std::recursive_mutex mutex_;
@@ -1,9 +1,14 @@
+#include <boost/optional.hpp>
+
 #include "spark_wiring_async.h"
 
 #include <deque>
 #include <thread>
-
-#include <boost/optional.hpp>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <string>
 
 #include "completion_handler.h"
 
@@ -19,6 +24,44 @@ class Context {
 public:
     typedef std::function<void()> Event;
 
+    typedef std::mutex Mutex;
+
+    class Semaphore {
+    public:
+        Semaphore() :
+                count_(0) {
+        }
+
+        bool isValid() const {
+            return true;
+        }
+
+        void give() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++count_;
+            cond_.notify_one();
+        }
+
+        bool take(system_tick_t timeout) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const auto ready = [this]() {
+                return count_ > 0;
+            };
+            if (!timeout) {
+                cond_.wait(lock, ready);
+            } else if (!cond_.wait_for(lock, std::chrono::milliseconds(timeout), ready)) {
+                return false;
+            }
+            --count_;
+            return true;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        unsigned count_;
+    };
+
     void processEvents() {
         if (!events_.empty()) {
             Event event = events_.front();
@@ -53,7 +96,13 @@ public:
     }
 
     static bool isApplicationThreadCurrent() {
-        return true; // TODO
+        return std::this_thread::get_id() == appThreadId();
+    }
+
+    // The thread running the tests is considered the application thread
+    static std::thread::id appThreadId() {
+        static const std::thread::id id = std::this_thread::get_id();
+        return id;
     }
 
 private:
@@ -372,6 +421,218 @@ TEST_CASE("Future<int>") {
     }
 }
 
+TEST_CASE("Future callbacks") {
+    resetContext();
+
+    SECTION("multiple callbacks are invoked in the order of registration") {
+        ::Promise<int> p;
+        ::Future<int> f = p.future();
+        std::vector<int> calls;
+        f.onSuccess([&calls](int r) {
+            calls.push_back(r);
+        });
+        f.onError([&calls](Error) {
+            calls.push_back(-1);
+        });
+        f.onSuccess([&calls](int r) {
+            calls.push_back(r + 1);
+        });
+        f.onSuccess([&calls](int r) {
+            calls.push_back(r + 2);
+        });
+        p.setResult(1);
+        CHECK(calls == std::vector<int>({ 1, 2, 3 }));
+    }
+
+    SECTION("callbacks are invoked in the application thread") {
+        ::Promise<int> p;
+        ::Future<int> f = p.future();
+        std::thread::id id;
+        f.onSuccess([&id](int) {
+            id = std::this_thread::get_id();
+        });
+        std::thread t([&p]() {
+            p.setResult(1);
+        });
+        t.join();
+        CHECK(id == std::thread::id());
+        Context::processApplicationEvents();
+        CHECK(id == std::this_thread::get_id());
+    }
+
+    SECTION("small callbacks are stored inline") {
+        int a = 0, b = 0;
+        auto fn = [&a, &b](int v) {
+            a = b = v;
+        };
+        CHECK(detail::InlineFunction<void(int)>::isInline<decltype(fn)>());
+        char buf[128] = {};
+        auto bigFn = [buf](int v) {
+            return buf[0] + v;
+        };
+        CHECK_FALSE(detail::InlineFunction<void(int)>::isInline<decltype(bigFn)>());
+        // Large function objects are allocated on the heap
+        int result = 0;
+        detail::InlineFunction<void(int)> f([buf, &result](int v) {
+            result = v + buf[0];
+        });
+        detail::InlineFunction<void(int)> f2(std::move(f));
+        CHECK_FALSE((bool)f);
+        f2(1);
+        CHECK(result == 1);
+    }
+}
+
+TEST_CASE("Future::then()") {
+    resetContext();
+
+    SECTION("continuation is invoked with the result of the future") {
+        ::Promise<int> p;
+        ::Future<std::string> f = p.future().then([](int r) {
+            return std::to_string(r);
+        });
+        CHECK(f.isDone() == false);
+        p.setResult(123);
+        CHECK(f.isSucceeded() == true);
+        CHECK(f.result() == "123");
+    }
+
+    SECTION("continuations can be chained") {
+        ::Promise<void> p;
+        bool called = false;
+        ::Future<void> f = p.future().then([]() {
+            return 1;
+        }).then([](int r) {
+            return r + 1;
+        }).then([&called](int r) {
+            called = (r == 2);
+        });
+        p.setResult();
+        CHECK(f.isSucceeded() == true);
+        CHECK(called == true);
+    }
+
+    SECTION("future returned by the continuation is unwrapped") {
+        ::Promise<int> p1;
+        ::Promise<int> p2;
+        ::Future<int> f = p1.future().then([&p2](int) {
+            return p2.future();
+        });
+        p1.setResult(1);
+        CHECK(f.isDone() == false);
+        p2.setResult(2);
+        CHECK(f.isDone() == true);
+        CHECK(f.result() == 2);
+    }
+
+    SECTION("error is propagated without invoking the continuation") {
+        ::Promise<int> p;
+        bool called = false;
+        ::Future<int> f = p.future().then([&called](int r) {
+            called = true;
+            return r;
+        });
+        p.setError(Error::UNKNOWN);
+        CHECK(f.isFailed() == true);
+        CHECK(f.error() == Error::UNKNOWN);
+        CHECK(called == false);
+    }
+
+    SECTION("cancellation is propagated as an error") {
+        ::Promise<int> p;
+        ::Future<int> f1 = p.future();
+        ::Future<int> f2 = f1.then([](int r) {
+            return r;
+        });
+        CHECK(f1.cancel() == true);
+        CHECK(f2.isFailed() == true);
+        CHECK(f2.error() == Error::CANCELLED);
+    }
+}
+
+TEST_CASE("whenAll()") {
+    resetContext();
+
+    SECTION("succeeds when all futures succeed") {
+        ::Promise<int> p1;
+        ::Promise<void> p2;
+        ::Future<void> f = whenAll(p1.future(), p2.future());
+        p1.setResult(1);
+        CHECK(f.isDone() == false);
+        p2.setResult();
+        CHECK(f.isSucceeded() == true);
+    }
+
+    SECTION("fails as soon as any future fails") {
+        ::Promise<int> p1;
+        ::Promise<int> p2;
+        ::Future<void> f = whenAll(p1.future(), p2.future());
+        p2.setError(Error::TIMEOUT);
+        CHECK(f.isFailed() == true);
+        CHECK(f.error() == Error::TIMEOUT);
+        p1.setResult(1);
+        CHECK(f.error() == Error::TIMEOUT);
+    }
+
+    SECTION("accepts already completed futures") {
+        ::Future<void> f = whenAll(::Future<int>(1), ::Future<void>());
+        CHECK(f.isSucceeded() == true);
+    }
+}
+
+TEST_CASE("whenAny()") {
+    resetContext();
+
+    SECTION("returns the index of the first completed future") {
+        ::Promise<int> p1;
+        ::Promise<void> p2;
+        ::Promise<int> p3;
+        ::Future<size_t> f = whenAny(p1.future(), p2.future(), p3.future());
+        CHECK(f.isDone() == false);
+        p2.setError(Error::UNKNOWN);
+        CHECK(f.isDone() == true);
+        CHECK(f.result() == 1);
+        p1.setResult(1);
+        CHECK(f.result() == 1);
+    }
+}
+
+TEST_CASE("Future::wait() in a non-application thread") {
+    resetContext();
+
+    SECTION("blocks until the future is completed") {
+        ::Promise<int> p;
+        ::Future<int> f = p.future();
+        std::atomic<bool> done(false);
+        int result = 0;
+        std::thread t([&]() {
+            CHECK(f.wait() == true);
+            result = f.result();
+            done = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(done == false);
+        p.setResult(123);
+        t.join();
+        CHECK(done == true);
+        CHECK(result == 123);
+    }
+
+    SECTION("returns false on timeout") {
+        ::Promise<int> p;
+        ::Future<int> f = p.future();
+        bool ok = true;
+        std::thread t([&]() {
+            ok = f.wait(10);
+        });
+        t.join();
+        CHECK(ok == false);
+        // The future can still be completed after the waiting thread has timed out
+        p.setResult(1);
+        CHECK(f.result() == 1);
+    }
+}
+
 TEST_CASE("AdaptedFuture<int>") {
     using Future = ::Future<int>;
     using AdaptedFuture = ::AdaptedFuture<int, 1>; // Default value is 1
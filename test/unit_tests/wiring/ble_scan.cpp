@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_ble_scan.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace particle::ble;
+
+namespace {
+
+hal_ble_addr_t makeAddress(unsigned n, ble_sig_addr_type_t type = BLE_SIG_ADDR_TYPE_PUBLIC) {
+    hal_ble_addr_t addr = {};
+    for (size_t i = 0; i < BLE_SIG_ADDR_LEN; ++i) {
+        addr.addr[i] = (uint8_t)(n >> (i * 8));
+    }
+    addr.addr_type = type;
+    return addr;
+}
+
+// Serializes an AD structure
+std::string ad(uint8_t type, const std::string& data) {
+    return std::string(1, (char)(data.size() + 1)) + (char)type + data;
+}
+
+hal_ble_uuid_t uuid16(uint16_t val) {
+    hal_ble_uuid_t uuid = {};
+    uuid.type = BLE_UUID_TYPE_16BIT;
+    uuid.uuid16 = val;
+    return uuid;
+}
+
+hal_ble_uuid_t uuid128(char fill) {
+    hal_ble_uuid_t uuid = {};
+    uuid.type = BLE_UUID_TYPE_128BIT;
+    memset(uuid.uuid128, fill, sizeof(uuid.uuid128));
+    return uuid;
+}
+
+std::string deviceName(const BleAdStructureIndex& index) {
+    size_t len = 0;
+    const uint8_t* name = index.deviceName(&len);
+    return std::string((const char*)name, len);
+}
+
+std::string customData(const BleAdStructureIndex& index) {
+    size_t len = 0;
+    const uint8_t* data = index.customData(&len);
+    return std::string((const char*)data, len);
+}
+
+} // namespace
+
+TEST_CASE("BleAddressSet") {
+    BleAddressSet set;
+
+    SECTION("reports an address only once") {
+        CHECK(set.insert(makeAddress(1)));
+        CHECK_FALSE(set.insert(makeAddress(1)));
+        CHECK(set.contains(makeAddress(1)));
+        CHECK_FALSE(set.contains(makeAddress(2)));
+        CHECK(set.size() == 1);
+    }
+
+    SECTION("distinguishes addresses by type") {
+        CHECK(set.insert(makeAddress(1, BLE_SIG_ADDR_TYPE_PUBLIC)));
+        CHECK(set.insert(makeAddress(1, BLE_SIG_ADDR_TYPE_RANDOM_STATIC)));
+        CHECK(set.size() == 2);
+    }
+
+    SECTION("grows as more addresses are added") {
+        const unsigned n = BleAddressSet::INITIAL_CAPACITY * 20;
+        for (unsigned i = 0; i < n; ++i) {
+            REQUIRE(set.insert(makeAddress(i * 7919)));
+        }
+        CHECK(set.size() == n);
+        for (unsigned i = 0; i < n; ++i) {
+            CHECK_FALSE(set.insert(makeAddress(i * 7919)));
+        }
+    }
+
+    SECTION("stops caching addresses once the maximum capacity is reached") {
+        const unsigned maxCount = BleAddressSet::MAX_CAPACITY * 3 / 4;
+        for (unsigned i = 0; i < maxCount; ++i) {
+            REQUIRE(set.insert(makeAddress(i)));
+        }
+        CHECK(set.size() == maxCount);
+        // New devices are reported every time they're seen
+        CHECK(set.insert(makeAddress(maxCount)));
+        CHECK(set.insert(makeAddress(maxCount)));
+        CHECK(set.size() == maxCount);
+        // Known devices are still filtered out
+        CHECK_FALSE(set.insert(makeAddress(0)));
+    }
+}
+
+TEST_CASE("BleAdStructureIndex") {
+    SECTION("returns default values for empty data") {
+        const uint8_t d[1] = {};
+        const BleAdStructureIndex index(d, 0);
+        CHECK(deviceName(index).empty());
+        CHECK(customData(index).empty());
+        CHECK(index.appearance() == BLE_SIG_APPEARANCE_UNKNOWN);
+        CHECK_FALSE(index.hasServiceUuids());
+        CHECK_FALSE(index.containsServiceUuid(uuid16(0x180d)));
+    }
+
+    SECTION("finds the AD structures used by the scan filters") {
+        const auto d = ad(BLE_SIG_AD_TYPE_FLAGS, "\x06") +
+                ad(BLE_SIG_AD_TYPE_COMPLETE_LOCAL_NAME, "complete") +
+                ad(BLE_SIG_AD_TYPE_APPEARANCE, "\x41\x03") +
+                ad(BLE_SIG_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, "\x62\x06" "abc");
+        const BleAdStructureIndex index((const uint8_t*)d.data(), d.size());
+        CHECK(deviceName(index) == "complete");
+        CHECK(index.appearance() == (ble_sig_appearance_t)0x0341);
+        CHECK(customData(index) == std::string("\x62\x06" "abc"));
+    }
+
+    SECTION("prefers the short device name and uses the first occurrence of each type") {
+        const auto d = ad(BLE_SIG_AD_TYPE_COMPLETE_LOCAL_NAME, "complete") +
+                ad(BLE_SIG_AD_TYPE_SHORT_LOCAL_NAME, "short1") +
+                ad(BLE_SIG_AD_TYPE_SHORT_LOCAL_NAME, "short2") +
+                ad(BLE_SIG_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, "x") +
+                ad(BLE_SIG_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, "y");
+        const BleAdStructureIndex index((const uint8_t*)d.data(), d.size());
+        CHECK(deviceName(index) == "short1");
+        CHECK(customData(index) == "x");
+    }
+
+    SECTION("matches service UUIDs of the same type") {
+        const auto d = ad(BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_MORE_AVAILABLE, std::string("\x0d\x18\x0f\x18", 4)) +
+                ad(BLE_SIG_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE, std::string(16, 'u'));
+        const BleAdStructureIndex index((const uint8_t*)d.data(), d.size());
+        CHECK(index.hasServiceUuids());
+        CHECK(index.containsServiceUuid(uuid16(0x180d)));
+        CHECK(index.containsServiceUuid(uuid16(0x180f)));
+        CHECK_FALSE(index.containsServiceUuid(uuid16(0x1810)));
+        CHECK(index.containsServiceUuid(uuid128('u')));
+        CHECK_FALSE(index.containsServiceUuid(uuid128('v')));
+    }
+
+    SECTION("ignores truncated AD structures") {
+        // The length of the last structure exceeds the size of the data
+        auto d = ad(BLE_SIG_AD_TYPE_SHORT_LOCAL_NAME, "name") + ad(BLE_SIG_AD_TYPE_APPEARANCE, "\x41\x03");
+        d.resize(d.size() - 1);
+        const BleAdStructureIndex index((const uint8_t*)d.data(), d.size());
+        CHECK(deviceName(index) == "name");
+        CHECK(index.appearance() == BLE_SIG_APPEARANCE_UNKNOWN);
+        // A service UUID list shorter than a UUID doesn't count
+        const auto d2 = ad(BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, "\x0d");
+        const BleAdStructureIndex index2((const uint8_t*)d2.data(), d2.size());
+        CHECK_FALSE(index2.hasServiceUuids());
+    }
+}
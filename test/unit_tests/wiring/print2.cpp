@@ -2,6 +2,7 @@
 #include "util/catch.h"
 #include "spark_wiring_print.h"
 #include <string>
+#include <algorithm>
 
 class BufferPrint : public Print
 {
@@ -20,6 +21,42 @@ public:
     }
 };
 
+// Accepts a limited amount of data and counts the calls to write()
+class LimitedPrint : public Print
+{
+    std::string value;
+    size_t limit;
+    unsigned writes;
+
+public:
+    explicit LimitedPrint(size_t limit = 1024) : limit(limit), writes(0)
+    {
+    }
+
+    size_t write(uint8_t c)
+    {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* data, size_t size)
+    {
+        ++writes;
+        size = std::min(size, limit - value.size());
+        value.append((const char*)data, size);
+        return size;
+    }
+
+    const std::string& result()
+    {
+        return value;
+    }
+
+    unsigned writeCount()
+    {
+        return writes;
+    }
+};
+
 
 SCENARIO("Print.printf() with a small string", "[print]")
 {
@@ -56,3 +93,20 @@ SCENARIO("Print.printf() with a a > 20 char string", "[print]")
     print.printf("abcdabcdabcdabcd %d xyzxyzxyzxyzxyzxyzxyzxyz", 100);
     REQUIRE("abcdabcdabcdabcd 100 xyzxyzxyzxyzxyzxyzxyzxyz" == print.result());
 }
+
+SCENARIO("Print.printf() writes a short string with a single call", "[print]")
+{
+    LimitedPrint print;
+    const std::string s(100, 'a');
+    REQUIRE(print.printf("%s %d %s", s.c_str(), 100, "xyz") == 108);
+    REQUIRE(print.result() == s + " 100 xyz");
+    REQUIRE(print.writeCount() == 1);
+}
+
+SCENARIO("Print.printf() reports a partial write", "[print]")
+{
+    LimitedPrint print(10);
+    REQUIRE(print.printlnf("abcdabcd %d", 100) == 10);
+    REQUIRE(print.result() == "abcdabcd 1");
+    REQUIRE(print.getWriteError() != 0);
+}
@@ -5,6 +5,9 @@
 #include "util/catch.h"
 
 #include "spark_wiring_string.h"
+#include "spark_wiring_string_builder.h"
+
+using particle::StringBuilder;
 
 TEST_CASE("Can use HEX radix with String numeric conversion constructors") {
 
@@ -238,6 +241,98 @@ TEST_CASE("String resize") {
     }
 }
 
+TEST_CASE("String capacity") {
+    SECTION("grows geometrically when appending to a string") {
+        String s;
+        unsigned reallocs = 0;
+        unsigned capacity = s.capacity();
+        for (int i = 0; i < 1000; ++i) {
+            s += 'a';
+            if (s.capacity() != capacity) {
+                capacity = s.capacity();
+                ++reallocs;
+            }
+        }
+        CHECK(s.length() == 1000);
+        CHECK(s == String(std::string(1000, 'a').c_str()));
+        CHECK(reallocs <= 12);
+    }
+
+    SECTION("shrink_to_fit() reduces the capacity to the string length") {
+        String s("abc");
+        s += "def";
+        CHECK(s.capacity() > 6);
+        CHECK(s.shrink_to_fit());
+        CHECK(s.capacity() == 6);
+        CHECK(s == "abcdef");
+        CHECK(s.shrink_to_fit());
+        CHECK(s.capacity() == 6);
+    }
+
+    SECTION("reserve() allocates exactly as much as requested") {
+        String s;
+        CHECK(s.reserve(100));
+        CHECK(s.capacity() == 100);
+        s += std::string(100, 'a').c_str();
+        CHECK(s.capacity() == 100);
+    }
+}
+
+TEST_CASE("StringBuilder") {
+    StringBuilder b;
+
+    SECTION("is empty by default") {
+        CHECK(b.isEmpty());
+        CHECK(b.length() == 0);
+        CHECK(b.toString() == "");
+    }
+
+    SECTION("concatenates the appended data") {
+        b.append("abc");
+        b.append(String("def"));
+        b.append('g');
+        b.append("hijk", 2);
+        b += "ij";
+        b.print(123);
+        b.printf("%s", "xyz");
+        CHECK(b.length() == 17);
+        CHECK(b.toString() == "abcdefghiij123xyz");
+    }
+
+    SECTION("can build a string that spans multiple chunks") {
+        std::string expected;
+        for (int i = 0; i < 1000; ++i) {
+            b.print(i);
+            expected += std::to_string(i);
+        }
+        auto s = b.toString();
+        CHECK(s.length() == expected.size());
+        CHECK(std::string(s.c_str()) == expected);
+        CHECK(s.capacity() == s.length());
+        char buf[11] = {};
+        CHECK(b.toString(buf, sizeof(buf)) == 10);
+        CHECK(std::string(buf) == expected.substr(0, 10));
+    }
+
+    SECTION("clear() discards the appended data") {
+        b.append(std::string(5000, 'a').c_str());
+        b.clear();
+        CHECK(b.isEmpty());
+        b.append("abc");
+        CHECK(b.toString() == "abc");
+    }
+
+    SECTION("can be moved") {
+        b.append("abc");
+        StringBuilder b2(std::move(b));
+        CHECK(b.isEmpty());
+        CHECK(b2.toString() == "abc");
+        b = std::move(b2);
+        CHECK(b2.isEmpty());
+        CHECK(b.toString() == "abc");
+    }
+}
+
 TEST_CASE("Comparison operators") {
     SECTION("operator==") {
         CHECK(String("") == String(""));
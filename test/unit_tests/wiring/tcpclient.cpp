@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hippomocks.h"
+
+#include <string>
+#include <vector>
+
+#include "spark_wiring_tcpclient.h"
+#include "system_network.h"
+#include "fake_socket.h"
+#include "system_error.h"
+
+#include "util/catch.h"
+
+using particle::test::FakeSocket;
+
+namespace {
+
+const sock_handle_t TEST_SOCKET = 1;
+
+class TcpClientTest {
+public:
+    TcpClientTest() {
+        mocks_.OnCallFunc(network_ready).Return(true);
+    }
+
+    FakeSocket sock;
+
+private:
+    MockRepository mocks_;
+};
+
+const uint8_t* bytes(const char* str) {
+    return (const uint8_t*)str;
+}
+
+} // namespace
+
+TEST_CASE("TCPClient") {
+    TcpClientTest test;
+    auto& sock = test.sock;
+    TCPClient client(TEST_SOCKET);
+
+    SECTION("sends the data immediately by default") {
+        CHECK(client.sendBufferSize() == 0);
+        CHECK(client.receiveBufferSize() == TCPCLIENT_BUF_MAX_SIZE);
+        CHECK(client.write(bytes("abc"), 3) == 3);
+        CHECK(client.write(bytes("def"), 3) == 3);
+        CHECK(sock.sent == "abcdef");
+        CHECK(sock.sendCount == 2);
+    }
+
+    SECTION("coalesces small writes if the send buffer is enabled") {
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, 8));
+        CHECK(client.sendBufferSize() == 8);
+        CHECK(client.write(bytes("abc"), 3) == 3);
+        CHECK(client.write(bytes("def"), 3) == 3);
+        CHECK(sock.sendCount == 0);
+        // Doesn't fit in the buffer
+        CHECK(client.write(bytes("ghi"), 3) == 3);
+        CHECK(sock.sent == "abcdef");
+        CHECK(sock.sendCount == 1);
+        client.flush();
+        CHECK(sock.sent == "abcdefghi");
+        CHECK(sock.sendCount == 2);
+        // Nothing to send
+        client.flush();
+        CHECK(sock.sendCount == 2);
+    }
+
+    SECTION("sends the data directly if it's larger than the send buffer") {
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, 4));
+        CHECK(client.write(bytes("ab"), 2) == 2);
+        CHECK(client.write(bytes("cdefgh"), 6) == 6);
+        CHECK(sock.sent == "abcdefgh");
+        CHECK(sock.sendCount == 2);
+    }
+
+    SECTION("sends the buffered data before reading") {
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, 32));
+        client.print("GET / HTTP/1.0\r\n\r\n");
+        CHECK(sock.sendCount == 0);
+        sock.received = "HTTP/1.0 200 OK";
+        CHECK(client.read() == 'H');
+        CHECK(sock.sent == "GET / HTTP/1.0\r\n\r\n");
+    }
+
+    SECTION("sends the buffered data when stopped") {
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, 16));
+        client.print("abc");
+        client.stop();
+        CHECK(sock.sent == "abc");
+        CHECK(sock.closed);
+    }
+
+    SECTION("bounds the time spent sending the buffered data when stopped") {
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, 32));
+        sock.maxSendSize = 1;
+        sock.sendDelay = 10;
+        client.print("abcdefghijklmnop");
+        client.stop(25 /* timeout */);
+        // Roughly 3 bytes are sent before the timeout expires
+        CHECK(sock.sent.size() < 16);
+        CHECK(sock.closed);
+        CHECK(client.getWriteError() == SYSTEM_ERROR_TIMEOUT);
+    }
+
+    SECTION("handles partial sends of the buffered data") {
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, 16));
+        sock.maxSendSize = 3;
+        client.print("abcdefgh");
+        client.flush();
+        CHECK(sock.sent == "abcdefgh");
+        CHECK(sock.sendCount == 3);
+    }
+
+    SECTION("writes multiple chunks") {
+        const TCPClient::Chunk chunks[] = { { bytes("abc"), 3 }, { bytes("de"), 2 }, { bytes("f"), 1 } };
+        CHECK(client.write(chunks, 3) == 6);
+        CHECK(sock.sent == "abcdef");
+        sock.sent.clear();
+        sock.sendCount = 0;
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE, 16));
+        CHECK(client.write(chunks, 3) == 6);
+        CHECK(sock.sendCount == 0);
+        client.flush();
+        CHECK(sock.sent == "abcdef");
+        CHECK(sock.sendCount == 1);
+    }
+
+    SECTION("writes more chunks than fit in a single vectored send") {
+        const std::string data = "abcdefghijklmnopqrst";
+        std::vector<TCPClient::Chunk> chunks;
+        for (size_t i = 0; i < data.size(); ++i) {
+            chunks.push_back({ bytes(data.c_str() + i), 1 });
+        }
+        CHECK(client.write(chunks.data(), chunks.size()) == data.size());
+        CHECK(sock.sent == data);
+    }
+
+    SECTION("reports a partial write of multiple chunks") {
+        const TCPClient::Chunk chunks[] = { { bytes("abc"), 3 }, { bytes("de"), 2 }, { bytes("f"), 1 } };
+        sock.maxSendSize = 2;
+        CHECK(client.write(chunks, 3) == 2);
+        CHECK(sock.sent == "ab");
+        CHECK(client.getWriteError() == 0);
+    }
+
+    SECTION("uses a receive buffer of the configured size") {
+        REQUIRE(client.setBufferSize(512));
+        CHECK(client.receiveBufferSize() == 512);
+        std::string data(500, 'a');
+        sock.received = data;
+        CHECK(client.available() == 500);
+        char buf[600] = {};
+        CHECK(client.read((uint8_t*)buf, sizeof(buf)) == 500);
+        CHECK(std::string(buf) == data);
+    }
+
+    SECTION("keeps the unread data when the receive buffer is resized") {
+        sock.received = "abcdef";
+        CHECK(client.read() == 'a');
+        REQUIRE(client.setBufferSize(16));
+        CHECK(client.available() == 5);
+        CHECK(client.read() == 'b');
+        // The unread data doesn't fit in the new buffer
+        CHECK_FALSE(client.setBufferSize(2));
+        REQUIRE(client.setBufferSize(TCPCLIENT_BUF_MAX_SIZE));
+        char buf[8] = {};
+        CHECK(client.read((uint8_t*)buf, sizeof(buf)) == 4);
+        CHECK(std::string(buf) == "cdef");
+    }
+
+    SECTION("fails to set the receive buffer of zero size") {
+        CHECK_FALSE(client.setBufferSize(0));
+        CHECK(client.receiveBufferSize() == TCPCLIENT_BUF_MAX_SIZE);
+    }
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hippomocks.h"
+
+#include <string>
+
+#include "spark_wiring_udp.h"
+#include "system_network.h"
+#include "system_error.h"
+#include "fake_socket.h"
+
+#include "util/catch.h"
+
+using particle::test::FakeSocket;
+
+namespace {
+
+class UdpTest {
+public:
+    UdpTest() {
+        mocks_.OnCallFunc(network_ready).Return(true);
+        REQUIRE(udp.begin(5683));
+    }
+
+    void addDatagram(std::string data, uint8_t lastOctet = 1, uint16_t port = 1234) {
+        sock.datagrams.push_back({ std::move(data), { 192, 168, 1, lastOctet }, port });
+    }
+
+    FakeSocket sock;
+    UDP udp;
+
+private:
+    MockRepository mocks_;
+};
+
+std::string str(const UDP::Packet& packet) {
+    return std::string((const char*)packet.data(), packet.size());
+}
+
+} // namespace
+
+TEST_CASE("UDP packet queue") {
+    UdpTest test;
+    auto& udp = test.udp;
+    UDP::Packet packet;
+
+    SECTION("fails if the packet pool is not enabled") {
+        test.addDatagram("abc");
+        CHECK(udp.receivePacket(packet) == SYSTEM_ERROR_INVALID_STATE);
+        CHECK_FALSE(packet.isValid());
+        CHECK(udp.poll() == SYSTEM_ERROR_INVALID_STATE);
+    }
+
+    SECTION("receives packets without copying them") {
+        REQUIRE(udp.setPacketPool(4, 16));
+        test.addDatagram("abc", 10, 1000);
+        test.addDatagram("defgh", 20, 2000);
+        CHECK(udp.receivePacket(packet) == 3);
+        CHECK(str(packet) == "abc");
+        CHECK(packet.remoteIP() == IPAddress(192, 168, 1, 10));
+        CHECK(packet.remotePort() == 1000);
+        CHECK(udp.remoteIP() == IPAddress(192, 168, 1, 10));
+        CHECK(udp.queuedPacketCount() == 1);
+        UDP::Packet packet2;
+        CHECK(udp.receivePacket(packet2) == 5);
+        CHECK(str(packet2) == "defgh");
+        CHECK(packet2.remotePort() == 2000);
+        // The first packet is still valid
+        CHECK(str(packet) == "abc");
+        CHECK(udp.receivePacket(packet) == 0);
+        CHECK_FALSE(packet.isValid());
+        CHECK(udp.droppedPacketCount() == 0);
+    }
+
+    SECTION("queues the pending packets") {
+        REQUIRE(udp.setPacketPool(4, 16));
+        test.addDatagram("a");
+        test.addDatagram("b");
+        test.addDatagram("c");
+        CHECK(udp.poll() == 3);
+        CHECK(udp.queuedPacketCount() == 3);
+        CHECK(test.sock.datagrams.empty());
+        CHECK(udp.poll() == 0);
+    }
+
+    SECTION("drops the oldest packets when the queue is full") {
+        REQUIRE(udp.setPacketPool(2, 16));
+        test.addDatagram("a");
+        test.addDatagram("b");
+        CHECK(udp.poll() == 2);
+        test.addDatagram("c");
+        test.addDatagram("d");
+        test.addDatagram("e");
+        CHECK(udp.poll() == 2); // Limited by the queue capacity
+        CHECK(udp.poll() == 1);
+        CHECK(udp.droppedPacketCount() == 3);
+        CHECK(udp.queuedPacketCount() == 2);
+        CHECK(udp.receivePacket(packet) == 1);
+        CHECK(str(packet) == "d");
+        packet.release();
+        CHECK(udp.receivePacket(packet) == 1);
+        CHECK(str(packet) == "e");
+    }
+
+    SECTION("doesn't reuse the buffers of the packets held by the application") {
+        REQUIRE(udp.setPacketPool(2, 16));
+        UDP::Packet p1, p2, p3;
+        test.addDatagram("a");
+        test.addDatagram("b");
+        test.addDatagram("c");
+        test.addDatagram("d");
+        CHECK(udp.receivePacket(p1) == 1);
+        CHECK(udp.receivePacket(p2) == 1);
+        CHECK(udp.receivePacket(p3) == 1);
+        // All buffers are in use: the remaining packet stays in the socket
+        CHECK(udp.poll() == 0);
+        CHECK(test.sock.datagrams.size() == 1);
+        CHECK(str(p1) == "a");
+        CHECK(str(p2) == "b");
+        CHECK(str(p3) == "c");
+        auto copy = p1;
+        p1.release();
+        CHECK(udp.poll() == 0);
+        copy.release();
+        CHECK(udp.receivePacket(p1) == 1);
+        CHECK(str(p1) == "d");
+        CHECK(udp.droppedPacketCount() == 0);
+    }
+
+    SECTION("truncates packets that don't fit in a buffer") {
+        REQUIRE(udp.setPacketPool(2, 4));
+        test.addDatagram("abcdef");
+        CHECK(udp.receivePacket(packet) == 4);
+        CHECK(str(packet) == "abcd");
+    }
+
+    SECTION("keeps the packets valid after the socket is closed") {
+        REQUIRE(udp.setPacketPool(2, 16));
+        test.addDatagram("a");
+        test.addDatagram("b");
+        CHECK(udp.receivePacket(packet) == 1);
+        udp.stop();
+        CHECK(udp.queuedPacketCount() == 0);
+        REQUIRE(udp.setPacketPool(0));
+        CHECK(str(packet) == "a");
+    }
+
+    SECTION("doesn't change the sender of the parsed packet when polling") {
+        REQUIRE(udp.setPacketPool(2, 16));
+        test.addDatagram("a", 10);
+        CHECK(udp.parsePacket() == 1);
+        test.addDatagram("b", 20);
+        CHECK(udp.poll() == 1);
+        CHECK(udp.remoteIP() == IPAddress(192, 168, 1, 10));
+        CHECK(udp.read() == 'a');
+    }
+
+    SECTION("doesn't change the sender of the parsed packet if no packet is retrieved") {
+        REQUIRE(udp.setPacketPool(2, 16));
+        test.addDatagram("a", 10, 1000);
+        CHECK(udp.parsePacket() == 1);
+        // Empty datagrams are not queued. The second one is received while waiting for a packet
+        test.addDatagram("", 20, 2000);
+        test.addDatagram("", 30, 3000);
+        CHECK(udp.receivePacket(packet, 100 /* timeout */) == 0);
+        CHECK(test.sock.datagrams.empty());
+        CHECK_FALSE(packet.isValid());
+        CHECK(udp.remoteIP() == IPAddress(192, 168, 1, 10));
+        CHECK(udp.remotePort() == 1000);
+        CHECK(udp.read() == 'a');
+    }
+
+    SECTION("reuses the buffers of the released packets") {
+        REQUIRE(udp.setPacketPool(2, 16));
+        for (int i = 0; i < 10; ++i) {
+            test.addDatagram(std::string(1, 'a' + i));
+            CHECK(udp.receivePacket(packet) == 1);
+            CHECK(str(packet) == std::string(1, 'a' + i));
+        }
+        CHECK(udp.droppedPacketCount() == 0);
+    }
+}
@@ -76,6 +76,7 @@
 #include "spark_wiring_vector.h"
 #include "spark_wiring_map.h"
 #include "spark_wiring_variant.h"
+#include "spark_wiring_string_builder.h"
 #include "spark_wiring_async.h"
 #include "spark_wiring_error.h"
 #include "spark_wiring_led.h"
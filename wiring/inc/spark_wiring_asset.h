@@ -162,6 +162,20 @@ public:
      */
     int seek(size_t pos);
 
+    /**
+     * Create a seek index for the asset.
+     *
+     * Seeking backwards within a compressed asset normally requires decompressing the asset
+     * from the beginning. The seek index stores restart points at regular intervals of the
+     * decompressed data, which allows seeking to an arbitrary position efficiently. The index is
+     * stored alongside the asset and only needs to be created once. Creating the index requires
+     * decompressing the entire asset and resets the read position to the beginning of the asset.
+     *
+     * @param span Distance between two restart points in bytes, or 0 to use the default.
+     * @return int 0 on success, `system_error_t` error code on error.
+     */
+    int createSeekIndex(size_t span = 0);
+
     /**
      * No-op, conforming to `Stream` interface.
      * 
@@ -23,10 +23,16 @@
 
 #include "system_cloud.h"
 #include "system_task.h"
+#include "concurrent_hal.h"
+#include "atomic_flag_mutex.h"
 
 #include <functional>
 #include <memory>
 #include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #if (ATOMIC_POINTER_LOCK_FREE != 2) || (ATOMIC_CHAR_LOCK_FREE != 2) || (ATOMIC_BOOL_LOCK_FREE != 2)
 #error "std::atomic is not always lock-free for required types"
@@ -34,8 +40,172 @@
 
 namespace particle {
 
+template<typename ResultT, typename ContextT>
+class Future;
+
+template<typename ResultT, typename ContextT>
+class Promise;
+
 namespace detail {
 
+// Type-erased callable that stores small function objects inline. Function objects that don't fit
+// into the inline storage are allocated on the heap
+template<typename FunctionT, size_t Size = 4 * sizeof(void*)>
+class InlineFunction;
+
+template<typename R, typename... ArgsT, size_t Size>
+class InlineFunction<R(ArgsT...), Size> {
+public:
+    InlineFunction() :
+            ops_(nullptr) {
+    }
+
+    InlineFunction(std::nullptr_t) :
+            InlineFunction() {
+    }
+
+    template<typename FunctionT, typename = typename std::enable_if<!std::is_same<typename std::decay<FunctionT>::type, InlineFunction>::value>::type>
+    InlineFunction(FunctionT&& fn) :
+            InlineFunction() {
+        typedef typename std::decay<FunctionT>::type Fn;
+        if (isNull(fn)) {
+            return;
+        }
+        init(std::forward<FunctionT>(fn), std::integral_constant<bool, isInline<Fn>()>());
+    }
+
+    InlineFunction(InlineFunction&& fn) :
+            InlineFunction() {
+        *this = std::move(fn);
+    }
+
+    ~InlineFunction() {
+        reset();
+    }
+
+    void reset() {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    R operator()(ArgsT... args) const {
+        return ops_->invoke(&storage_, std::forward<ArgsT>(args)...);
+    }
+
+    explicit operator bool() const {
+        return ops_;
+    }
+
+    InlineFunction& operator=(InlineFunction&& fn) {
+        if (this != &fn) {
+            reset();
+            if (fn.ops_) {
+                fn.ops_->move(&storage_, &fn.storage_);
+                ops_ = fn.ops_;
+                fn.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction(const InlineFunction&) = delete;
+    InlineFunction& operator=(const InlineFunction&) = delete;
+
+    // Returns true if a function object of the specified type is stored without allocating memory
+    template<typename FunctionT>
+    static constexpr bool isInline() {
+        return sizeof(FunctionT) <= Size && alignof(FunctionT) <= alignof(void*) &&
+                std::is_nothrow_move_constructible<FunctionT>::value;
+    }
+
+private:
+    struct Ops {
+        R (*invoke)(void* storage, ArgsT&&... args);
+        void (*move)(void* dest, void* src); // Moves the function object and destroys the source object
+        void (*destroy)(void* storage);
+    };
+
+    template<typename FunctionT>
+    struct InlineOps {
+        static R invoke(void* storage, ArgsT&&... args) {
+            return (*static_cast<FunctionT*>(storage))(std::forward<ArgsT>(args)...);
+        }
+
+        static void move(void* dest, void* src) {
+            new(dest) FunctionT(std::move(*static_cast<FunctionT*>(src)));
+            static_cast<FunctionT*>(src)->~FunctionT();
+        }
+
+        static void destroy(void* storage) {
+            static_cast<FunctionT*>(storage)->~FunctionT();
+        }
+
+        static constexpr Ops ops = { invoke, move, destroy };
+    };
+
+    template<typename FunctionT>
+    struct HeapOps {
+        static R invoke(void* storage, ArgsT&&... args) {
+            return (**static_cast<FunctionT**>(storage))(std::forward<ArgsT>(args)...);
+        }
+
+        static void move(void* dest, void* src) {
+            *static_cast<FunctionT**>(dest) = *static_cast<FunctionT**>(src);
+        }
+
+        static void destroy(void* storage) {
+            delete *static_cast<FunctionT**>(storage);
+        }
+
+        static constexpr Ops ops = { invoke, move, destroy };
+    };
+
+    mutable typename std::aligned_storage<Size, alignof(void*)>::type storage_; // Function object or a pointer to it
+    const Ops* ops_; // Type-specific operations
+
+    template<typename FunctionT>
+    void init(FunctionT&& fn, std::true_type /* inline */) {
+        typedef typename std::decay<FunctionT>::type Fn;
+        new(&storage_) Fn(std::forward<FunctionT>(fn));
+        ops_ = &InlineOps<Fn>::ops;
+    }
+
+    template<typename FunctionT>
+    void init(FunctionT&& fn, std::false_type /* inline */) {
+        typedef typename std::decay<FunctionT>::type Fn;
+        const auto p = new(std::nothrow) Fn(std::forward<FunctionT>(fn));
+        if (p) {
+            *reinterpret_cast<Fn**>(&storage_) = p;
+            ops_ = &HeapOps<Fn>::ops;
+        }
+    }
+
+    template<typename FunctionT>
+    static bool isNull(const FunctionT&) {
+        return false;
+    }
+
+    template<typename FunctionT>
+    static bool isNull(const std::function<FunctionT>& fn) {
+        return !fn;
+    }
+
+    template<typename T>
+    static bool isNull(T* ptr) {
+        return !ptr;
+    }
+};
+
+template<typename R, typename... ArgsT, size_t Size>
+template<typename FunctionT>
+constexpr typename InlineFunction<R(ArgsT...), Size>::Ops InlineFunction<R(ArgsT...), Size>::InlineOps<FunctionT>::ops;
+
+template<typename R, typename... ArgsT, size_t Size>
+template<typename FunctionT>
+constexpr typename InlineFunction<R(ArgsT...), Size>::Ops InlineFunction<R(ArgsT...), Size>::HeapOps<FunctionT>::ops;
+
 // Completion callback types
 template<typename ResultT>
 struct FutureCallbackTypes {
@@ -50,12 +220,12 @@ struct FutureCallbackTypes<void> {
     typedef std::function<void(const Error&)> OnError;
 };
 
-// Helper function for FutureImplBase::invokeCallback()
-void futureCallbackWrapper(void* data);
+template<typename ResultT, typename ContextT>
+class FutureImpl;
 
 // Internal future implementation. Base class for FutureImpl
 template<typename ResultT, typename ContextT>
-class FutureImplBase {
+class FutureImplBase: public std::enable_shared_from_this<FutureImpl<ResultT, ContextT>> {
 public:
     // Future state
     enum class State: char {
@@ -69,17 +239,22 @@ public:
     typedef typename detail::FutureCallbackTypes<ResultT>::OnSuccess OnSuccessCallback;
     typedef typename detail::FutureCallbackTypes<ResultT>::OnError OnErrorCallback;
 
+    // Internal completion callback. Invoked when the future is completed, regardless of its final state
+    typedef InlineFunction<void(FutureImpl<ResultT, ContextT>&)> Callback;
+
     ~FutureImplBase() {
-        delete onSuccess_.load(std::memory_order_relaxed);
-        delete onError_.load(std::memory_order_relaxed);
+        freeCallbacks();
     }
 
     bool wait(int timeout = 0) const {
-        // TODO: Waiting for a future in a non-default application thread is not supported
+        if (isDone()) { // We can use relaxed ordering here, as long as the future's result is not examined
+            return true;
+        }
         if (ContextT::isApplicationThreadCurrent()) {
+            // The application thread needs to keep processing events while waiting
             const system_tick_t t = (timeout > 0) ? millis() : 0;
             for (;;) {
-                if (isDone()) { // We can use relaxed ordering here, as long as the future's result is not examined
+                if (isDone()) {
                     return true;
                 }
                 if (timeout > 0 && millis() - t >= (system_tick_t)timeout) {
@@ -88,13 +263,35 @@ public:
                 ContextT::processApplicationEvents();
             }
         }
-        return false;
+        Waiter w;
+        if (!w.sem.isValid()) {
+            return false;
+        }
+        {
+            std::lock_guard<typename ContextT::Mutex> lock(mutex_);
+            if (isDone()) {
+                return true;
+            }
+            w.next = waiters_;
+            waiters_ = &w;
+        }
+        if (w.sem.take((timeout > 0) ? timeout : 0 /* Wait indefinitely */)) {
+            return true;
+        }
+        std::lock_guard<typename ContextT::Mutex> lock(mutex_);
+        for (auto p = &waiters_; *p; p = &(*p)->next) {
+            if (*p == &w) {
+                *p = w.next;
+                break;
+            }
+        }
+        return isDone();
     }
 
     // This method attempts to switch the future into cancelled state and doesn't affect pending operation
     bool cancel() {
         if (changeState(State::CANCELLED)) {
-            releaseDone();
+            complete();
             return true;
         }
         return false;
@@ -118,17 +315,47 @@ public:
         return done_.load(std::memory_order_relaxed);
     }
 
-protected:
-    std::atomic<State> state_; // Future state
-    std::atomic<bool> done_; // Flag signaling that future is in a final state
-    std::atomic<typename FutureCallbackTypes<ResultT>::OnSuccess*> onSuccess_; // User callback for succeeded operation
-    std::atomic<typename FutureCallbackTypes<ResultT>::OnError*> onError_; // User callback for failed operation
+    State state() const {
+        return state_.load(std::memory_order_relaxed);
+    }
 
+    // Registers a completion callback. If the future is already completed, the callback is invoked
+    // immediately. Unless `direct` is set to true, the callback is invoked in the application context
+    bool addCallback(Callback callback, bool direct = false) {
+        {
+            std::lock_guard<typename ContextT::Mutex> lock(mutex_);
+            if (!isDone()) {
+                CallbackNode* cb = nullptr;
+                if (!lastCallback_) {
+                    cb = callbacks_;
+                } else if (isInlineCallback(lastCallback_ + 1)) {
+                    cb = lastCallback_ + 1;
+                } else {
+                    cb = new(std::nothrow) CallbackNode();
+                    if (!cb) {
+                        return false;
+                    }
+                }
+                cb->fn = std::move(callback);
+                cb->direct = direct;
+                if (lastCallback_) {
+                    lastCallback_->next = cb;
+                }
+                lastCallback_ = cb;
+                return true;
+            }
+        }
+        acquireDone();
+        invokeCallback(std::move(callback), direct);
+        return true;
+    }
+
+protected:
     explicit FutureImplBase(State state) :
+            waiters_(nullptr),
+            lastCallback_(nullptr),
             state_(state),
-            done_(state != State::RUNNING),
-            onSuccess_(nullptr),
-            onError_(nullptr) {
+            done_(state != State::RUNNING) {
     }
 
     bool changeState(State state) {
@@ -136,6 +363,28 @@ protected:
         return state_.compare_exchange_strong(s, state, std::memory_order_relaxed);
     }
 
+    // Called after the future's state has been changed to a final state
+    void complete() {
+        releaseDone();
+        {
+            std::lock_guard<typename ContextT::Mutex> lock(mutex_);
+            // Wake up the waiting threads
+            auto w = waiters_;
+            while (w) {
+                const auto next = w->next; // The waiter may return as soon as its semaphore is released
+                w->sem.give();
+                w = next;
+            }
+            waiters_ = nullptr;
+        }
+        // No callbacks can be added to the list once the future is done, so it's safe to access it
+        // without holding the lock
+        for (auto cb = lastCallback_ ? callbacks_ : nullptr; cb; cb = cb->next) {
+            invokeCallback(std::move(cb->fn), cb->direct);
+        }
+        freeCallbacks();
+    }
+
     void releaseDone() {
         done_.store(true, std::memory_order_release);
     }
@@ -144,38 +393,78 @@ protected:
         return done_.load(std::memory_order_acquire);
     }
 
-    State state() const {
-        return state_.load(std::memory_order_relaxed);
-    }
+private:
+    struct CallbackNode {
+        Callback fn; // Callback function
+        CallbackNode* next; // Next callback
+        bool direct; // Whether the callback can be invoked in the calling thread
+
+        CallbackNode() :
+                next(nullptr),
+                direct(false) {
+        }
+    };
 
-    template<typename FunctionT>
-    static void setCallback(std::atomic<std::function<FunctionT>*>& wrapper, std::function<FunctionT>&& callback) {
-        auto callbackPtr = new std::function<FunctionT>(callback); // New callback
-        callbackPtr = wrapper.exchange(callbackPtr, std::memory_order_acq_rel);
-        delete callbackPtr; // Delete old callback
+    // Number of callbacks that can be registered without allocating memory. This covers the common
+    // case of a future having a success and an error callback
+    static const size_t INLINE_CALLBACK_COUNT = 2;
+
+    struct Waiter {
+        typename ContextT::Semaphore sem; // Semaphore released when the future is completed
+        Waiter* next; // Next waiting thread
+
+        Waiter() :
+                next(nullptr) {
+        }
+    };
+
+    // Callback invoked asynchronously in the application context
+    struct PostedCallback {
+        Callback fn;
+        std::shared_ptr<FutureImpl<ResultT, ContextT>> self;
+    };
+
+    CallbackNode callbacks_[INLINE_CALLBACK_COUNT]; // Completion callbacks. The first few callbacks are stored inline
+    mutable Waiter* waiters_; // Threads waiting for the future to complete
+    CallbackNode* lastCallback_; // Last registered callback
+    mutable typename ContextT::Mutex mutex_; // Protects the lists of callbacks and waiting threads
+    std::atomic<State> state_; // Future state
+    std::atomic<bool> done_; // Flag signaling that future is in a final state
+
+    bool isInlineCallback(const CallbackNode* cb) const {
+        return cb >= callbacks_ && cb < callbacks_ + INLINE_CALLBACK_COUNT;
     }
 
-    // Takes a callback from its atomic wrapper and invokes it
-    template<typename FunctionT, typename... ArgsT>
-    static void invokeCallback(std::atomic<std::function<FunctionT>*>& wrapper, ArgsT&&... args) {
-        std::function<FunctionT>* callbackPtr = wrapper.exchange(nullptr, std::memory_order_acq_rel);
-        if (callbackPtr) {
-            invokeCallback(*callbackPtr, std::forward<ArgsT>(args)...);
-            delete callbackPtr;
+    void freeCallbacks() {
+        auto cb = lastCallback_ ? callbacks_ : nullptr;
+        while (cb) {
+            const auto next = cb->next;
+            if (isInlineCallback(cb)) {
+                cb->fn.reset();
+                cb->next = nullptr;
+            } else {
+                delete cb;
+            }
+            cb = next;
         }
+        lastCallback_ = nullptr;
     }
 
-    // Invokes std::function in the application context
-    template<typename FunctionT, typename... ArgsT>
-    static void invokeCallback(const std::function<FunctionT>& callback, ArgsT&&... args) {
-        if (ContextT::isApplicationThreadCurrent()) {
-            callback(std::forward<ArgsT>(args)...); // Synchronous call
+    void invokeCallback(Callback fn, bool direct) {
+        if (direct || ContextT::isApplicationThreadCurrent()) {
+            fn(*static_cast<FutureImpl<ResultT, ContextT>*>(this)); // Synchronous call
         } else {
-            // Bind all arguments and wrap resulting function into a pointer
-            auto callbackPtr = new std::function<void()>(std::bind(callback, std::forward<ArgsT>(args)...));
-            ContextT::invokeApplicationCallback(futureCallbackWrapper, callbackPtr);
+            const auto d = new(std::nothrow) PostedCallback{ std::move(fn), this->shared_from_this() };
+            if (d) {
+                ContextT::invokeApplicationCallback(invokePostedCallback, d);
+            }
         }
     }
+
+    static void invokePostedCallback(void* data) {
+        const std::unique_ptr<PostedCallback> d(static_cast<PostedCallback*>(data));
+        d->fn(*d->self);
+    }
 };
 
 // Internal future implementation
@@ -217,8 +506,7 @@ public:
     void setResult(ResultT result) {
         if (this->changeState(State::SUCCEEDED)) {
             new(&result_) ResultT(std::move(result));
-            this->releaseDone();
-            this->invokeCallback(this->onSuccess_, result_);
+            this->complete();
         }
     }
 
@@ -233,8 +521,7 @@ public:
     void setError(Error error) {
         if (this->changeState(State::FAILED)) {
             new(&error_) Error(std::move(error));
-            this->releaseDone();
-            this->invokeCallback(this->onError_, error_);
+            this->complete();
         }
     }
 
@@ -246,19 +533,31 @@ public:
         return Error::NONE;
     }
 
-    void onSuccess(OnSuccessCallback callback) {
-        this->setCallback(this->onSuccess_, std::move(callback));
-        // Ensure that the newly assigned callback is invoked for already completed future
-        if (this->acquireDone() && this->isSucceeded()) {
-            this->invokeCallback(this->onSuccess_, result_);
-        }
+    // These methods can only be called from a completion callback
+    const ResultT& resultData() const {
+        return result_;
     }
 
-    void onError(OnErrorCallback callback) {
-        this->setCallback(this->onError_, std::move(callback));
-        if (this->acquireDone() && this->isFailed()) {
-            this->invokeCallback(this->onError_, error_);
-        }
+    const Error& errorData() const {
+        return error_;
+    }
+
+    template<typename FunctionT>
+    void onSuccess(FunctionT callback) {
+        this->addCallback([callback](FutureImpl& f) {
+            if (f.state() == State::SUCCEEDED) {
+                callback(f.result_);
+            }
+        });
+    }
+
+    template<typename FunctionT>
+    void onError(FunctionT callback) {
+        this->addCallback([callback](FutureImpl& f) {
+            if (f.state() == State::FAILED) {
+                callback(f.error_);
+            }
+        });
     }
 
 private:
@@ -291,16 +590,14 @@ public:
 
     void setResult() {
         if (this->changeState(State::SUCCEEDED)) {
-            this->releaseDone();
-            this->invokeCallback(this->onSuccess_);
+            this->complete();
         }
     }
 
     void setError(Error error) {
         if (this->changeState(State::FAILED)) {
             error_ = std::move(error);
-            this->releaseDone();
-            this->invokeCallback(this->onError_, error_);
+            this->complete();
         }
     }
 
@@ -312,19 +609,26 @@ public:
         return Error::NONE;
     }
 
-    void onSuccess(OnSuccessCallback callback) {
-        this->setCallback(this->onSuccess_, std::move(callback));
-        // Ensure that the newly assigned callback is invoked for already completed future
-        if (this->acquireDone() && this->isSucceeded()) {
-            this->invokeCallback(this->onSuccess_);
-        }
+    const Error& errorData() const {
+        return error_;
     }
 
-    void onError(OnErrorCallback callback) {
-        this->setCallback(this->onError_, std::move(callback));
-        if (this->acquireDone() && this->isFailed()) {
-            this->invokeCallback(this->onError_, error_);
-        }
+    template<typename FunctionT>
+    void onSuccess(FunctionT callback) {
+        this->addCallback([callback](FutureImpl& f) {
+            if (f.state() == State::SUCCEEDED) {
+                callback();
+            }
+        });
+    }
+
+    template<typename FunctionT>
+    void onError(FunctionT callback) {
+        this->addCallback([callback](FutureImpl& f) {
+            if (f.state() == State::FAILED) {
+                callback(f.error_);
+            }
+        });
     }
 
 private:
@@ -334,8 +638,192 @@ private:
 template<typename ResultT, typename ContextT>
 using FutureImplPtr = std::shared_ptr<FutureImpl<ResultT, ContextT>>;
 
+// Provides access to the internal implementation of futures and promises
+struct FutureAccess {
+    template<typename FutureT>
+    static auto impl(const FutureT& future) -> decltype(future.p_) {
+        return future.p_;
+    }
+};
+
+// Completes a future with the outcome of another future
+template<typename ResultT, typename ContextT>
+struct FutureForwarder {
+    static void forward(const FutureImpl<ResultT, ContextT>& src, FutureImpl<ResultT, ContextT>& dest) {
+        typedef typename FutureImpl<ResultT, ContextT>::State State;
+        const State s = src.state();
+        if (s == State::SUCCEEDED) {
+            dest.setResult(src.resultData());
+        } else if (s == State::FAILED) {
+            dest.setError(src.errorData());
+        } else {
+            dest.setError(Error::CANCELLED);
+        }
+    }
+};
+
+template<typename ContextT>
+struct FutureForwarder<void, ContextT> {
+    static void forward(const FutureImpl<void, ContextT>& src, FutureImpl<void, ContextT>& dest) {
+        typedef typename FutureImpl<void, ContextT>::State State;
+        const State s = src.state();
+        if (s == State::SUCCEEDED) {
+            dest.setResult();
+        } else if (s == State::FAILED) {
+            dest.setError(src.errorData());
+        } else {
+            dest.setError(Error::CANCELLED);
+        }
+    }
+};
+
+// Invokes a continuation function with the result of a succeeded future
+template<typename ResultT>
+struct FutureInvoker {
+    template<typename FunctionT>
+    using Result = typename std::decay<typename std::result_of<FunctionT&(const ResultT&)>::type>::type;
+
+    template<typename FunctionT, typename ContextT>
+    static Result<FunctionT> invoke(FunctionT& fn, const FutureImpl<ResultT, ContextT>& f) {
+        return fn(f.resultData());
+    }
+};
+
+template<>
+struct FutureInvoker<void> {
+    template<typename FunctionT>
+    using Result = typename std::decay<typename std::result_of<FunctionT&()>::type>::type;
+
+    template<typename FunctionT, typename ContextT>
+    static Result<FunctionT> invoke(FunctionT& fn, const FutureImpl<void, ContextT>&) {
+        return fn();
+    }
+};
+
+// Completes the future returned by Future::then() with the value returned by a continuation function
+template<typename ValueT, typename ContextT>
+struct FutureContinuation {
+    typedef ValueT ResultType;
+
+    template<typename FunctionT, typename ResultT>
+    static void run(FunctionT& fn, const FutureImpl<ResultT, ContextT>& src, const FutureImplPtr<ResultType, ContextT>& dest) {
+        dest->setResult(FutureInvoker<ResultT>::invoke(fn, src));
+    }
+};
+
+template<typename ContextT>
+struct FutureContinuation<void, ContextT> {
+    typedef void ResultType;
+
+    template<typename FunctionT, typename ResultT>
+    static void run(FunctionT& fn, const FutureImpl<ResultT, ContextT>& src, const FutureImplPtr<ResultType, ContextT>& dest) {
+        FutureInvoker<ResultT>::invoke(fn, src);
+        dest->setResult();
+    }
+};
+
+// Specialization for continuation functions returning a future
+template<typename ValueT, typename ContextT>
+struct FutureContinuation<Future<ValueT, ContextT>, ContextT> {
+    typedef ValueT ResultType;
+
+    template<typename FunctionT, typename ResultT>
+    static void run(FunctionT& fn, const FutureImpl<ResultT, ContextT>& src, const FutureImplPtr<ResultType, ContextT>& dest) {
+        const auto f = FutureInvoker<ResultT>::invoke(fn, src);
+        FutureAccess::impl(f)->addCallback([dest](FutureImpl<ValueT, ContextT>& f) {
+            FutureForwarder<ValueT, ContextT>::forward(f, *dest);
+        }, true /* direct */);
+    }
+};
+
+// Shared state of the future returned by whenAll()
+template<typename ContextT>
+struct FutureWhenAllState {
+    FutureImplPtr<void, ContextT> result; // Resulting future
+    std::atomic<size_t> pending; // Number of futures that haven't completed yet
+
+    explicit FutureWhenAllState(size_t count) :
+            result(std::make_shared<FutureImpl<void, ContextT>>(FutureImpl<void, ContextT>::State::RUNNING)),
+            pending(count) {
+    }
+};
+
+template<typename ContextT>
+inline void whenAllAdd(const std::shared_ptr<FutureWhenAllState<ContextT>>&) {
+}
+
+template<typename ContextT, typename ResultT, typename... FuturesT>
+inline void whenAllAdd(const std::shared_ptr<FutureWhenAllState<ContextT>>& state, const Future<ResultT, ContextT>& future,
+        const FuturesT&... futures) {
+    FutureAccess::impl(future)->addCallback([state](FutureImpl<ResultT, ContextT>& f) {
+        typedef typename FutureImpl<ResultT, ContextT>::State State;
+        const State s = f.state();
+        if (s == State::SUCCEEDED) {
+            if (state->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                state->result->setResult();
+            }
+        } else if (s == State::FAILED) {
+            state->result->setError(f.errorData());
+        } else {
+            state->result->setError(Error::CANCELLED);
+        }
+    }, true /* direct */);
+    whenAllAdd(state, futures...);
+}
+
+template<typename ContextT>
+inline void whenAnyAdd(const FutureImplPtr<size_t, ContextT>&, size_t) {
+}
+
+template<typename ContextT, typename ResultT, typename... FuturesT>
+inline void whenAnyAdd(const FutureImplPtr<size_t, ContextT>& result, size_t index, const Future<ResultT, ContextT>& future,
+        const FuturesT&... futures) {
+    FutureAccess::impl(future)->addCallback([result, index](FutureImpl<ResultT, ContextT>&) {
+        result->setResult(index);
+    }, true /* direct */);
+    whenAnyAdd(result, index + 1, futures...);
+}
+
 // Event loop and threading abstraction. Used for unit testing
 struct FutureContext {
+    // Mutex protecting the internal state of a future
+    typedef AtomicFlagMutex<os_result_t, os_thread_yield> Mutex;
+
+    // Semaphore used to block a non-application thread until a future is completed
+    class Semaphore {
+    public:
+        Semaphore() :
+                sem_(nullptr) {
+            os_semaphore_create(&sem_, 1 /* max_count */, 0 /* initial_count */);
+        }
+
+        ~Semaphore() {
+            if (sem_) {
+                os_semaphore_destroy(sem_);
+            }
+        }
+
+        bool isValid() const {
+            return sem_;
+        }
+
+        void give() {
+            os_semaphore_give(sem_, false);
+        }
+
+        // Returns false if the semaphore couldn't be acquired within the specified time. A timeout
+        // of 0 means to wait indefinitely
+        bool take(system_tick_t timeout) {
+            return (os_semaphore_take(sem_, timeout ? timeout : CONCURRENT_WAIT_FOREVER, false) == 0);
+        }
+
+        Semaphore(const Semaphore&) = delete;
+        Semaphore& operator=(const Semaphore&) = delete;
+
+    private:
+        os_semaphore_t sem_;
+    };
+
     // Runs the application's event loop
     static void processApplicationEvents() {
         spark_process();
@@ -354,19 +842,13 @@ struct FutureContext {
 
 } // namespace particle::detail
 
-template<typename ResultT, typename ContextT>
-class Future;
-
-template<typename ResultT, typename ContextT>
-class Promise;
-
 // Base class for Promise. Promise allows to store result of an asynchronous operation that later
 // can be acquired via Future
 template<typename ResultT, typename ContextT>
 class PromiseBase {
 public:
     PromiseBase() :
-            p_(new detail::FutureImpl<ResultT, ContextT>(State::RUNNING)) {
+            p_(std::make_shared<detail::FutureImpl<ResultT, ContextT>>(State::RUNNING)) {
     }
 
     explicit PromiseBase(detail::FutureImplPtr<ResultT, ContextT> ptr) :
@@ -403,6 +885,8 @@ protected:
     typedef typename detail::FutureImpl<ResultT, ContextT>::State State;
 
     detail::FutureImplPtr<ResultT, ContextT> p_;
+
+    friend struct detail::FutureAccess;
 };
 
 template<typename ResultT, typename ContextT = detail::FutureContext>
@@ -458,7 +942,7 @@ public:
 
     // Construct failed future
     explicit FutureBase(Error error) :
-            p_(new detail::FutureImpl<ResultT, ContextT>(std::move(error))) {
+            p_(std::make_shared<detail::FutureImpl<ResultT, ContextT>>(std::move(error))) {
     }
 
     explicit FutureBase(Error::Type error) :
@@ -497,20 +981,49 @@ public:
         return p_->isDone();
     }
 
-    Future<ResultT, ContextT>& onSuccess(OnSuccessCallback callback) {
+    // Registers a callback for succeeded operation. Multiple callbacks can be registered, they are
+    // invoked in the order of registration. Small function objects are stored without allocating memory
+    template<typename FunctionT>
+    Future<ResultT, ContextT>& onSuccess(FunctionT callback) {
         p_->onSuccess(std::move(callback));
         return *static_cast<Future<ResultT, ContextT>*>(this);
     }
 
-    Future<ResultT, ContextT>& onError(OnErrorCallback callback) {
+    template<typename FunctionT>
+    Future<ResultT, ContextT>& onError(FunctionT callback) {
         p_->onError(std::move(callback));
         return *static_cast<Future<ResultT, ContextT>*>(this);
     }
 
+    // Returns a future that is completed with the value returned by the function. The function is
+    // invoked in the application context with the result of this future when it succeeds. If the
+    // function returns a future, the returned future is completed with the outcome of that future.
+    // If this future fails, the returned future fails with the same error, and if this future is
+    // cancelled, the returned future fails with Error::CANCELLED
+    template<typename FunctionT,
+            typename ValueT = typename detail::FutureInvoker<ResultT>::template Result<FunctionT>,
+            typename NextT = typename detail::FutureContinuation<ValueT, ContextT>::ResultType>
+    Future<NextT, ContextT> then(FunctionT fn) const {
+        typedef detail::FutureImpl<ResultT, ContextT> Impl;
+        const auto next = std::make_shared<detail::FutureImpl<NextT, ContextT>>(detail::FutureImpl<NextT, ContextT>::State::RUNNING);
+        p_->addCallback([fn, next](Impl& f) mutable {
+            if (f.state() == Impl::State::SUCCEEDED) {
+                detail::FutureContinuation<ValueT, ContextT>::run(fn, f, next);
+            } else if (f.state() == Impl::State::FAILED) {
+                next->setError(f.errorData());
+            } else {
+                next->setError(Error::CANCELLED);
+            }
+        });
+        return Future<NextT, ContextT>(next);
+    }
+
 protected:
     typedef typename detail::FutureImpl<ResultT, ContextT>::State State;
 
     detail::FutureImplPtr<ResultT, ContextT> p_;
+
+    friend struct detail::FutureAccess;
 };
 
 template<typename ResultT, typename ContextT = detail::FutureContext>
@@ -551,6 +1064,24 @@ private:
     using typename FutureBase<void, ContextT>::State;
 };
 
+// Returns a future that succeeds when all of the specified futures succeed, or fails as soon as
+// any of them fails or is cancelled
+template<typename ResultT, typename ContextT, typename... FuturesT>
+inline Future<void, ContextT> whenAll(const Future<ResultT, ContextT>& future, const FuturesT&... futures) {
+    const auto state = std::make_shared<detail::FutureWhenAllState<ContextT>>(sizeof...(FuturesT) + 1);
+    detail::whenAllAdd(state, future, futures...);
+    return Future<void, ContextT>(state->result);
+}
+
+// Returns a future that is completed with the index of the first of the specified futures that
+// completes, regardless of whether it succeeded, failed or was cancelled
+template<typename ResultT, typename ContextT, typename... FuturesT>
+inline Future<size_t, ContextT> whenAny(const Future<ResultT, ContextT>& future, const FuturesT&... futures) {
+    const auto result = std::make_shared<detail::FutureImpl<size_t, ContextT>>(detail::FutureImpl<size_t, ContextT>::State::RUNNING);
+    detail::whenAnyAdd(result, 0, future, futures...);
+    return Future<size_t, ContextT>(result);
+}
+
 // Helper class that can be used to make existent functions, that use their own special return
 // values for error handling, asynchronous in an API-compatible way
 template<typename ResultT, ResultT defaultValue, typename ContextT = detail::FutureContext>
@@ -321,7 +321,7 @@ public:
 
     BleUuidType type() const;
 
-    hal_ble_uuid_t halUUID();
+    hal_ble_uuid_t halUUID() const;
 
     uint16_t shorted() const;
 
@@ -191,7 +191,7 @@ public:
 
 protected:
     virtual void write(const char *data, size_t size) = 0;
-    virtual void printf(const char *fmt, ...);
+    virtual void printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
 
 private:
     enum State {
@@ -35,6 +35,7 @@
 
 #include "spark_wiring_printable.h"
 #include "spark_wiring_fixed_point.h"
+#include "format.h"
 #include <cmath>
 #include <climits>
 #include <cstdarg>
@@ -125,6 +126,13 @@ class Print
 
     size_t printVariant(const particle::Variant& var);
 
+    struct FormatSink {
+        Print* print;
+        size_t written;
+    };
+
+    static bool appendFormatted(void* sink, const uint8_t* data, size_t size); // appender_fn
+
   protected:
     void setWriteError(int err = 1) { write_error = err; }
 
@@ -219,6 +227,19 @@ class Print
     }
 
     size_t vprintf(bool newline, const char* format, va_list args) __attribute__ ((format(printf, 3, 0)));
+
+    /**
+     * Print a formatted string.
+     *
+     * This is a type-safe variant of `printf()`, see `particle::format()`. If the output can't be
+     * written in full, the rest of it is discarded and the write error is set.
+     */
+    template<typename... ArgsT>
+    size_t format(const char* fmt, const ArgsT&... args) {
+        FormatSink sink = { this, 0 };
+        particle::format(appendFormatted, &sink, fmt, args...);
+        return sink.written;
+    }
 };
 
 namespace particle {
@@ -93,6 +93,12 @@ public:
     // invalid string (i.e., "if (s)" will be true afterwards)
     unsigned char reserve(unsigned int size);
     bool resize(size_t size);
+    // reduce the capacity of the string to its length.  appending to a
+    // string may allocate more memory than needed to hold the result so
+    // that building a string in a loop doesn't reallocate the buffer on
+    // every iteration.  return true on success, false on failure (in which
+    // case, the string is left unchanged)
+    bool shrink_to_fit();
     inline unsigned int length(void) const {return len;}
 
     unsigned int capacity() const {
@@ -218,7 +224,7 @@ public:
     unsigned long long toULongLongInt(unsigned char base=10) const;
     float toFloat(void) const;
 
-        static String format(const char* format, ...);
+        static String format(const char* format, ...) __attribute__((format(printf, 1, 2)));
 
 protected:
     char *buffer;           // the actual char array
@@ -229,6 +235,7 @@ protected:
     void init(void);
     void invalidate(void);
     unsigned char changeBuffer(unsigned int maxStrLen);
+    unsigned char grow(unsigned int size);
 
     // copy and move
     String & copy(const char *cstr, unsigned int length);
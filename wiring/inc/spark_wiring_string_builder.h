@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <cstddef>
+
+#include "spark_wiring_print.h"
+#include "spark_wiring_string.h"
+
+namespace particle {
+
+/**
+ * A string builder.
+ *
+ * Appended data is stored in a list of chunks. The chunks are allocated as needed and their size
+ * grows geometrically up to a fixed limit, so appending never copies the data that was appended
+ * earlier. The resulting string is allocated once, when `toString()` is called.
+ *
+ * The builder is a `Print` so it can be used with `print()`, `printf()` and the JSON writer classes.
+ * If a memory allocation fails, the builder sets the write error flag (see `getWriteError()`) and
+ * discards the data that could not be stored.
+ *
+ * ```cpp
+ * StringBuilder b;
+ * for (int i = 0; i < 100; ++i) {
+ *     b.printf("%d,", i);
+ * }
+ * String s = b.toString();
+ * ```
+ */
+class StringBuilder: public Print {
+public:
+    /**
+     * Size of the first allocated chunk.
+     */
+    static constexpr size_t MIN_CHUNK_SIZE = 64;
+
+    /**
+     * Maximum size of an allocated chunk.
+     */
+    static constexpr size_t MAX_CHUNK_SIZE = 1024;
+
+    /**
+     * Construct an empty builder.
+     */
+    StringBuilder();
+
+    /**
+     * Move constructor.
+     *
+     * @param b Builder to move from.
+     */
+    StringBuilder(StringBuilder&& b);
+
+    /**
+     * Destructor.
+     */
+    ~StringBuilder();
+
+    /**
+     * Append data.
+     *
+     * @param data Data.
+     * @param size Data size.
+     * @return This builder.
+     */
+    StringBuilder& append(const char* data, size_t size);
+
+    /**
+     * Append a null-terminated string.
+     *
+     * @param str String.
+     * @return This builder.
+     */
+    StringBuilder& append(const char* str) {
+        if (str) {
+            append(str, std::strlen(str));
+        }
+        return *this;
+    }
+
+    /**
+     * Append a string.
+     *
+     * @param str String.
+     * @return This builder.
+     */
+    StringBuilder& append(const String& str) {
+        return append(str.c_str(), str.length());
+    }
+
+    /**
+     * Append a character.
+     *
+     * @param c Character.
+     * @return This builder.
+     */
+    StringBuilder& append(char c) {
+        return append(&c, 1);
+    }
+
+    /**
+     * Get the length of the string being built.
+     *
+     * @return Length.
+     */
+    size_t length() const {
+        return len_;
+    }
+
+    /**
+     * Check if the string being built is empty.
+     *
+     * @return `true` if the string is empty, otherwise `false`.
+     */
+    bool isEmpty() const {
+        return !len_;
+    }
+
+    /**
+     * Get the string that was built.
+     *
+     * If there's not enough memory for the resulting string, an invalid string is returned.
+     *
+     * @return String.
+     */
+    String toString() const;
+
+    /**
+     * Copy the string that was built to a buffer.
+     *
+     * The output is null-terminated if the buffer size is greater than 0.
+     *
+     * @param buf Destination buffer.
+     * @param size Buffer size.
+     * @return Number of characters copied, not including the terminating null.
+     */
+    size_t toString(char* buf, size_t size) const;
+
+    /**
+     * Discard the appended data.
+     *
+     * The allocated chunks are kept for reuse by subsequent appends. Use `reset()` to free them.
+     */
+    void clear();
+
+    /**
+     * Discard the appended data and free all allocated memory.
+     */
+    void reset();
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t size) override;
+
+    using Print::write;
+
+    StringBuilder& operator+=(const char* str) {
+        return append(str);
+    }
+
+    StringBuilder& operator+=(const String& str) {
+        return append(str);
+    }
+
+    StringBuilder& operator+=(char c) {
+        return append(c);
+    }
+
+    StringBuilder& operator=(StringBuilder&& b);
+
+    // This class is non-copyable
+    StringBuilder(const StringBuilder&) = delete;
+    StringBuilder& operator=(const StringBuilder&) = delete;
+
+private:
+    struct Chunk {
+        Chunk* next; // Next chunk
+        size_t size; // Number of bytes used
+        size_t capacity; // Chunk capacity
+
+        char* data() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+
+        const char* data() const {
+            return reinterpret_cast<const char*>(this + 1);
+        }
+    };
+
+    Chunk* head_; // First chunk
+    Chunk* tail_; // Last chunk being written to
+    Chunk* free_; // Unused chunks
+    size_t len_; // Total length of the appended data
+    size_t nextChunkSize_; // Capacity of the next allocated chunk
+
+    Chunk* nextChunk();
+
+    static void freeChunks(Chunk* chunk);
+};
+
+} // namespace particle
@@ -34,13 +34,24 @@
 
 #include <memory>
 
+// Default size of the receive buffer
 #define TCPCLIENT_BUF_MAX_SIZE  128
 /* 30 seconds */
 #define SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT (30000)
+// Maximum time stop() spends sending the data remaining in the send buffer
+#define SPARK_WIRING_TCPCLIENT_DEFAULT_STOP_TIMEOUT (1000)
 
 class TCPClient : public Client {
 
 public:
+    /**
+     * A chunk of data for a gather write.
+     */
+    struct Chunk {
+        const uint8_t* data; // Data
+        size_t size; // Data size
+    };
+
     TCPClient();
     TCPClient(sock_handle_t sock);
     virtual ~TCPClient() {};
@@ -52,13 +63,69 @@ public:
     virtual size_t write(const uint8_t *buffer, size_t size);
     virtual size_t write(uint8_t, system_tick_t timeout);
     virtual size_t write(const uint8_t *buffer, size_t size, system_tick_t timeout);
+    /**
+     * Write multiple chunks of data.
+     *
+     * If the send buffer is enabled, the chunks are accumulated in the buffer like with the other
+     * write methods. Otherwise, the chunks are sent with vectored sends of up to 8 chunks each on
+     * platforms that support it, or one by one.
+     *
+     * The chunks are sent in order until all of them are sent, the timeout expires or an error
+     * occurs. If fewer bytes than the total size of the chunks are written, the data following the
+     * returned number of bytes has not been sent and needs to be written again. `getWriteError()`
+     * returns a non-zero error code if the write stopped due to an error.
+     *
+     * @param chunks Chunks of data.
+     * @param count Number of chunks.
+     * @param timeout Send timeout.
+     * @return Number of bytes written.
+     */
+    size_t write(const Chunk* chunks, size_t count, system_tick_t timeout = SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
     virtual int available();
     virtual int read();
     virtual int read(uint8_t *buffer, size_t size);
     virtual int peek();
+    /**
+     * Send the data accumulated in the send buffer.
+     */
     virtual void flush();
     void flush_buffer();
+
+    /**
+     * Set the sizes of the receive and send buffers.
+     *
+     * If the send buffer is enabled, small writes are accumulated in the buffer and sent together
+     * when the buffer is full, when `flush()` or `stop()` is called, or when the client is about to
+     * wait for incoming data in `available()`, `read()` or `peek()`. Data remaining in the buffer
+     * is discarded when the last copy of the client is destroyed without calling `flush()` or
+     * `stop()`.
+     *
+     * The buffers are shared by all copies of the client.
+     *
+     * @param rxSize Size of the receive buffer. The default size is `TCPCLIENT_BUF_MAX_SIZE`.
+     * @param txSize Size of the send buffer. If 0, the written data is sent immediately.
+     * @return `true` on success, or `false` if the buffers could not be allocated or the buffered
+     *         data could not be sent or doesn't fit in the new receive buffer.
+     */
+    bool setBufferSize(size_t rxSize, size_t txSize = 0);
+
+    size_t receiveBufferSize() const {
+        return d_->rxSize;
+    }
+
+    size_t sendBufferSize() const {
+        return d_->txSize;
+    }
     virtual void stop();
+    /**
+     * Close the connection.
+     *
+     * Data remaining in the send buffer is sent first. Whatever can't be sent within the timeout is
+     * discarded. `stop()` uses `SPARK_WIRING_TCPCLIENT_DEFAULT_STOP_TIMEOUT`.
+     *
+     * @param timeout Maximum time in milliseconds to spend sending the buffered data.
+     */
+    void stop(system_tick_t timeout);
     virtual uint8_t connected();
     virtual operator bool();
 
@@ -74,9 +141,15 @@ protected:
 private:
     struct Data {
         sock_handle_t sock;
-        uint8_t buffer[TCPCLIENT_BUF_MAX_SIZE];
-        uint16_t offset;
-        uint16_t total;
+        uint8_t defaultBuffer[TCPCLIENT_BUF_MAX_SIZE];
+        std::unique_ptr<uint8_t[]> rxBuf; // Receive buffer if its size is not the default one
+        std::unique_ptr<uint8_t[]> txBuf; // Send buffer
+        uint8_t* buffer; // Receive buffer
+        size_t rxSize; // Size of the receive buffer
+        size_t txSize; // Size of the send buffer
+        size_t txUsed; // Number of bytes in the send buffer
+        size_t offset;
+        size_t total;
         IPAddress remoteIP;
 
         explicit Data(sock_handle_t sock);
@@ -86,6 +159,12 @@ private:
     std::shared_ptr<Data> d_;
 
     inline int bufferCount();
+
+    // Sends data to the socket bypassing the send buffer. Implemented separately for each socket HAL
+    int sendData(const uint8_t* data, size_t size, system_tick_t timeout);
+    int sendDatav(const Chunk* chunks, size_t count, system_tick_t timeout);
+    int sendBuffered(system_tick_t timeout);
+    size_t writeBuffered(const uint8_t* data, size_t size, system_tick_t timeout);
 };
 
 #endif
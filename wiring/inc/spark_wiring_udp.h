@@ -30,6 +30,7 @@
 #include "spark_wiring_ipaddress.h"
 #include "spark_wiring_printable.h"
 #include "spark_wiring_stream.h"
+#include "spark_wiring_udp_packet.h"
 #include "socket_hal.h"
 
 class UDP : public Stream, public Printable {
@@ -88,9 +89,14 @@ private:
      */
     bool _buffer_allocated;
 
-
+    /**
+     * The pool of packet buffers and the queue of received packets. Set via setPacketPool().
+     */
+    particle::RefCountPtr<particle::detail::UdpPacketPool> _pool;
 
 public:
+    typedef particle::UdpPacket Packet;
+
     UDP();
     virtual ~UDP() { stop(); releaseBuffer(); }
     /**
@@ -153,6 +159,61 @@ public:
         return receivePacket((uint8_t*)buffer, buf_size, timeout);
     }
 
+    /**
+     * Retrieves a packet from the packet queue without copying its data.
+     *
+     * All packets that are pending in the socket are moved to the queue first. If the queue is
+     * empty, this method waits for a packet for up to the specified amount of time. The data is
+     * received directly into a buffer of the pool, and that is the only copy of the data that is
+     * made. If a packet is retrieved, `remoteIP()` and `remotePort()` return its sender, otherwise
+     * they are not changed.
+     *
+     * @param packet        The packet
+     * @param timeout       The timeout in milliseconds
+     * @return The size of the packet, 0 if no packet was received, or a negative value on error.
+     *
+     * @see setPacketPool()
+     */
+    int receivePacket(Packet& packet, system_tick_t timeout = 0);
+
+    /**
+     * Enables the queue of received packets.
+     *
+     * The buffers for the packets are allocated once and reused. The packets are moved from the
+     * socket to the queue by {@link #receivePacket(Packet&, system_tick_t)} and {@link #poll}.
+     * When the queue is full, the oldest packet is dropped to make room for a new one. Packets
+     * that don't fit in a buffer are truncated.
+     *
+     * @param packetCount   The maximum number of packets in the queue. Pass 0 to disable the queue.
+     * @param packetSize    The maximum packet size
+     * @return true on success.
+     */
+    bool setPacketPool(size_t packetCount, size_t packetSize = 512);
+
+    /**
+     * Moves the packets that are pending in the socket to the packet queue.
+     *
+     * Calling this method often enough allows the application to process the received packets
+     * in bursts without losing them in the network stack.
+     *
+     * @return The number of packets added to the queue, or a negative value on error.
+     */
+    int poll();
+
+    /**
+     * Returns the number of packets in the packet queue.
+     */
+    size_t queuedPacketCount() const {
+        return _pool ? _pool->queuedCount() : 0;
+    }
+
+    /**
+     * Returns the number of packets dropped because the packet queue was full.
+     */
+    size_t droppedPacketCount() const {
+        return _pool ? _pool->droppedCount() : 0;
+    }
+
     /**
      * Begin writing a packet to the given destination.
      * @param ip        The IP address of the destination peer.
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "spark_wiring_ipaddress.h"
+#include "ref_count.h"
+
+class UDP;
+
+namespace particle {
+
+namespace detail {
+
+/**
+ * A pool of fixed-size packet buffers and a queue of received packets.
+ *
+ * The pool has one more buffer than the capacity of the queue: the next packet is always received
+ * into a spare buffer, and if the queue is full when that packet is added to it, the oldest packet
+ * in the queue is dropped and its buffer becomes the new spare buffer. The queue is not thread-safe
+ * and is meant to be used by the thread that owns the socket, but the packets handed out by the
+ * queue can be released from any thread.
+ */
+class UdpPacketPool: public RefCount {
+public:
+    struct Slot {
+        std::atomic_int refCount; // Number of references to the buffer
+        IPAddress remoteIP; // Address of the sender
+        uint16_t remotePort; // Port of the sender
+        size_t size; // Packet size
+        uint8_t* data; // Packet data
+
+        Slot() :
+                refCount(0),
+                remotePort(0),
+                size(0),
+                data(nullptr) {
+        }
+    };
+
+    UdpPacketPool(size_t packetCount, size_t packetSize);
+
+    int init();
+
+    // Returns the buffer to receive the next packet into, or `nullptr` if all buffers are in use
+    Slot* spare();
+    // Adds the packet received into the spare buffer to the queue
+    void commit(size_t size, const IPAddress& remoteIP, uint16_t remotePort);
+    // Removes the oldest packet from the queue. The caller takes over the queue's reference
+    Slot* pop();
+    void clear();
+
+    static void addSlotRef(Slot* slot) {
+        slot->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void releaseSlot(Slot* slot) {
+        // If this is the only reference, no other thread can modify the counter, so the atomic
+        // read-modify-write operation can be avoided
+        if (slot->refCount.load(std::memory_order_relaxed) == 1) {
+            slot->refCount.store(0, std::memory_order_release);
+        } else {
+            slot->refCount.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    size_t packetSize() const {
+        return packetSize_;
+    }
+
+    size_t packetCount() const {
+        return queueCapacity_;
+    }
+
+    size_t queuedCount() const {
+        return queueSize_;
+    }
+
+    size_t droppedCount() const {
+        return dropped_;
+    }
+
+    void resetDroppedCount() {
+        dropped_ = 0;
+    }
+
+private:
+    std::unique_ptr<Slot[]> slots_; // Packet buffers
+    std::unique_ptr<uint8_t[]> data_; // Storage for the packet data
+    std::unique_ptr<Slot*[]> queue_; // Received packets
+    Slot* spare_; // Buffer for the next packet
+    size_t packetSize_; // Maximum packet size
+    size_t queueCapacity_; // Maximum number of packets in the queue
+    size_t queueHead_; // Index of the oldest packet in the queue
+    size_t queueSize_; // Number of packets in the queue
+    size_t nextSlot_; // Index of the buffer to check first when allocating a buffer
+    size_t dropped_; // Number of dropped packets
+
+    Slot* allocSlot();
+
+    size_t queueIndex(size_t offs) const {
+        // Cheaper than a modulo operation on platforms without a hardware divider
+        const size_t i = queueHead_ + offs;
+        return (i < queueCapacity_) ? i : i - queueCapacity_;
+    }
+};
+
+} // namespace detail
+
+/**
+ * A packet received by a `UDP` instance with a packet pool.
+ *
+ * The socket HAL copies the packet data directly into a buffer of the pool. The data is not copied
+ * again when the packet is handed out to the application or when an instance of this class is
+ * copied. The buffer is returned to the pool when the last copy of the packet is destroyed, so the
+ * application should not hold onto packets longer than necessary.
+ *
+ * @see `UDP::setPacketPool()`
+ */
+class UdpPacket {
+public:
+    UdpPacket() :
+            slot_(nullptr) {
+    }
+
+    UdpPacket(const UdpPacket& packet) :
+            pool_(packet.pool_),
+            slot_(packet.slot_) {
+        if (slot_) {
+            detail::UdpPacketPool::addSlotRef(slot_);
+        }
+    }
+
+    UdpPacket(UdpPacket&& packet) :
+            UdpPacket() {
+        swap(*this, packet);
+    }
+
+    ~UdpPacket() {
+        release();
+    }
+
+    /**
+     * Get the packet data.
+     */
+    const uint8_t* data() const {
+        return slot_ ? slot_->data : nullptr;
+    }
+
+    /**
+     * Get the packet size.
+     */
+    size_t size() const {
+        return slot_ ? slot_->size : 0;
+    }
+
+    /**
+     * Get the address of the sender.
+     */
+    IPAddress remoteIP() const {
+        return slot_ ? slot_->remoteIP : IPAddress();
+    }
+
+    /**
+     * Get the port of the sender.
+     */
+    uint16_t remotePort() const {
+        return slot_ ? slot_->remotePort : 0;
+    }
+
+    /**
+     * Check if this instance references a packet.
+     */
+    bool isValid() const {
+        return slot_;
+    }
+
+    /**
+     * Release the packet buffer.
+     */
+    void release() {
+        if (slot_) {
+            detail::UdpPacketPool::releaseSlot(slot_);
+            slot_ = nullptr;
+            pool_ = nullptr;
+        }
+    }
+
+    explicit operator bool() const {
+        return isValid();
+    }
+
+    UdpPacket& operator=(UdpPacket packet) {
+        swap(*this, packet);
+        return *this;
+    }
+
+    friend void swap(UdpPacket& packet1, UdpPacket& packet2) {
+        using std::swap;
+        swap(packet1.pool_, packet2.pool_);
+        swap(packet1.slot_, packet2.slot_);
+    }
+
+private:
+    RefCountPtr<detail::UdpPacketPool> pool_;
+    detail::UdpPacketPool::Slot* slot_;
+
+    // Takes over a reference to the packet buffer
+    UdpPacket(RefCountPtr<detail::UdpPacketPool> pool, detail::UdpPacketPool::Slot* slot) :
+            pool_(std::move(pool)),
+            slot_(slot) {
+    }
+
+    friend class ::UDP;
+};
+
+} // namespace particle
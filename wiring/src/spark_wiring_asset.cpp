@@ -145,6 +145,13 @@ int ApplicationAsset::seek(size_t pos) {
     return r;
 }
 
+int ApplicationAsset::createSeekIndex(size_t span) {
+    // The stream is rewound after the index is created
+    eof_ = false;
+    CHECK(prepareForReading());
+    return asset_manager_create_seek_index(data_->stream, span, nullptr);
+}
+
 void ApplicationAsset::flush() {
     return;
 }
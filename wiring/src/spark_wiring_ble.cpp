@@ -19,6 +19,7 @@
 
 #if Wiring_BLE
 #include "spark_wiring_thread.h"
+#include "spark_wiring_ble_scan.h"
 #include <memory>
 #include <algorithm>
 #include "check.h"
@@ -435,7 +436,7 @@ BleUuidType BleUuid::type() const {
     return type_;
 }
 
-hal_ble_uuid_t BleUuid::halUUID() {
+hal_ble_uuid_t BleUuid::halUUID() const {
     hal_ble_uuid_t uuid = {};
     if (type_ == BleUuidType::SHORT) {
         uuid.type = BLE_UUID_TYPE_16BIT;
@@ -2393,10 +2394,22 @@ private:
         BleScanDelegator* delegator = static_cast<BleScanDelegator*>(context);
 
         if (!delegator->filter_.allowDuplicates()) {
-            if (delegator->isCachedDevice(event->peer_addr)) {
+            if (!delegator->cachedDevices_.insert(event->peer_addr)) {
                 return;
             }
-            delegator->cachedDevices_.append(event->peer_addr);
+        }
+
+        // Apply the filters to the raw event data so that filtered out devices don't cost a copy
+        // of the advertising data
+        const BleAdStructureIndex advIndex(event->adv_data, event->adv_data_len);
+        const BleAdStructureIndex srIndex(event->sr_data, event->sr_data_len);
+        if (!delegator->filterByRssi(event->rssi) ||
+              !delegator->filterByAddress(event->peer_addr) ||
+              !delegator->filterByDeviceName(advIndex, srIndex) ||
+              !delegator->filterByServiceUUID(advIndex, srIndex) ||
+              !delegator->filterByAppearance(advIndex, srIndex) ||
+              !delegator->filterByCustomData(advIndex, srIndex)) {
+            return;
         }
 
         BleScanResult result = {};
@@ -2404,15 +2417,6 @@ private:
               .scanResponse(event->sr_data, event->sr_data_len)
               .advertisingData(event->adv_data, event->adv_data_len);
 
-        if (!delegator->filterByRssi(result) ||
-              !delegator->filterByAddress(result) ||
-              !delegator->filterByDeviceName(result) ||
-              !delegator->filterByServiceUUID(result) ||
-              !delegator->filterByAppearance(result) ||
-              !delegator->filterByCustomData(result)) {
-            return;
-        }
-
         if (delegator->scanResultCallback_) {
             delegator->foundCount_++;
             delegator->scanResultCallback_(&result);
@@ -2436,25 +2440,25 @@ private:
         delegator->resultsVector_.append(result);
     }
 
-    bool filterByRssi(const BleScanResult& result) {
+    bool filterByRssi(int8_t rssi) const {
         int8_t filterRssi = filter_.minRssi();
-        if (filterRssi != BLE_RSSI_INVALID && result.rssi() < filterRssi) {
+        if (filterRssi != BLE_RSSI_INVALID && rssi < filterRssi) {
             LOG_DEBUG(TRACE, "Exceed min. RSSI");
             return false;
         }
         filterRssi = filter_.maxRssi();
-        if (filterRssi != BLE_RSSI_INVALID && result.rssi() > filterRssi) {
+        if (filterRssi != BLE_RSSI_INVALID && rssi > filterRssi) {
             LOG_DEBUG(TRACE, "Exceed max. RSSI.");
             return false;
         }
         return true;
     }
 
-    bool filterByAddress(const BleScanResult& result) {
-        auto filerAddresses = filter_.addresses();
+    bool filterByAddress(const hal_ble_addr_t& peerAddress) const {
+        const auto& filerAddresses = filter_.addresses();
         if (filerAddresses.size() > 0) {
             for (const auto& address : filerAddresses) {
-                if (address == result.address()) {
+                if (address == peerAddress) {
                     return true;
                 }
             }
@@ -2464,17 +2468,20 @@ private:
         return true;
     }
 
-    bool filterByDeviceName(const BleScanResult& result) {
-        auto filterDeviceNames = filter_.deviceNames();
+    bool filterByDeviceName(const BleAdStructureIndex& adv, const BleAdStructureIndex& sr) const {
+        const auto& filterDeviceNames = filter_.deviceNames();
         if (filterDeviceNames.size() > 0) {
-            String srName = result.scanResponse().deviceName();
-            String advName = result.advertisingData().deviceName();
-            if (srName.length() == 0 && advName.length() == 0) {
+            size_t srNameLen = 0;
+            const uint8_t* srName = sr.deviceName(&srNameLen);
+            size_t advNameLen = 0;
+            const uint8_t* advName = adv.deviceName(&advNameLen);
+            if (srNameLen == 0 && advNameLen == 0) {
                 LOG_DEBUG(TRACE, "Device name mismatched.");
                 return false;
             }
             for (const auto& name : filterDeviceNames) {
-                if (name == srName || name == advName) {
+                if ((name.length() == srNameLen && !memcmp(name.c_str(), srName, srNameLen)) ||
+                        (name.length() == advNameLen && !memcmp(name.c_str(), advName, advNameLen))) {
                     return true;
                 }
             }
@@ -2484,25 +2491,17 @@ private:
         return true;
     }
 
-    bool filterByServiceUUID(const BleScanResult& result) {
-        auto filterServiceUuids = filter_.serviceUUIDs();
+    bool filterByServiceUUID(const BleAdStructureIndex& adv, const BleAdStructureIndex& sr) const {
+        const auto& filterServiceUuids = filter_.serviceUUIDs();
         if (filterServiceUuids.size() > 0) {
-            const Vector<BleUuid>& srUuids = result.scanResponse().serviceUUID();
-            const Vector<BleUuid>& advUuids = result.advertisingData().serviceUUID();
-            if (srUuids.size() <= 0 && advUuids.size() <= 0) {
+            if (!sr.hasServiceUuids() && !adv.hasServiceUuids()) {
                 LOG_DEBUG(TRACE, "Service UUID mismatched.");
                 return false;
             }
             for (const auto& uuid : filterServiceUuids) {
-                for (const auto& found : srUuids) {
-                    if (uuid == found) {
-                        return true;
-                    }
-                }
-                for (const auto& found : advUuids) {
-                    if (uuid == found) {
-                        return true;
-                    }
+                const hal_ble_uuid_t halUuid = uuid.halUUID();
+                if (sr.containsServiceUuid(halUuid) || adv.containsServiceUuid(halUuid)) {
+                    return true;
                 }
             }
             LOG_DEBUG(TRACE, "Service UUID mismatched.");
@@ -2511,11 +2510,11 @@ private:
         return true;
     }
 
-    bool filterByAppearance(const BleScanResult& result) {
-        auto filterAppearances = filter_.appearances();
+    bool filterByAppearance(const BleAdStructureIndex& adv, const BleAdStructureIndex& sr) const {
+        const auto& filterAppearances = filter_.appearances();
         if (filterAppearances.size() > 0) {
-            ble_sig_appearance_t srAppearance = result.scanResponse().appearance();
-            ble_sig_appearance_t advAppearance = result.advertisingData().appearance();
+            ble_sig_appearance_t srAppearance = sr.appearance();
+            ble_sig_appearance_t advAppearance = adv.appearance();
             for (const auto& appearance : filterAppearances) {
                 if (appearance == srAppearance || appearance == advAppearance) {
                     return true;
@@ -2527,53 +2526,19 @@ private:
         return true;
     }
 
-    bool filterByCustomData(const BleScanResult& result) {
+    bool filterByCustomData(const BleAdStructureIndex& adv, const BleAdStructureIndex& sr) const {
         size_t filterCustomDatalen;
         const uint8_t* filterCustomData = filter_.customData(&filterCustomDatalen);
         if (filterCustomData != nullptr && filterCustomDatalen > 0) {
-            size_t srLen = result.scanResponse().get(BleAdvertisingDataType::MANUFACTURER_SPECIFIC_DATA, nullptr, BLE_MAX_SUPPORTED_ADV_DATA_LEN);
-            size_t advLen = result.advertisingData().get(BleAdvertisingDataType::MANUFACTURER_SPECIFIC_DATA, nullptr, BLE_MAX_SUPPORTED_ADV_DATA_LEN);
-            if (srLen != filterCustomDatalen && advLen != filterCustomDatalen) {
-                LOG_DEBUG(TRACE, "Custom data mismatched.");
-                return false;
-            }
-            if (srLen == filterCustomDatalen) {
-                if (srLen == 0) {
-                    return false;
-                }
-                uint8_t* buf = (uint8_t*)malloc(srLen);
-                SCOPE_GUARD({
-                    if (buf) {
-                        free(buf);
-                    }
-                });
-                if (!buf) {
-                    LOG(ERROR, "Failed to allocate memory!");
-                    return false;
-                }
-                result.scanResponse().get(BleAdvertisingDataType::MANUFACTURER_SPECIFIC_DATA, buf, srLen);
-                if (!memcmp(buf, filterCustomData, srLen)) {
-                    return true;
-                }
+            size_t srLen = 0;
+            const uint8_t* srData = sr.customData(&srLen);
+            size_t advLen = 0;
+            const uint8_t* advData = adv.customData(&advLen);
+            if (srLen == filterCustomDatalen && !memcmp(srData, filterCustomData, srLen)) {
+                return true;
             }
-            if (advLen == filterCustomDatalen) {
-                if (advLen == 0) {
-                    return false;
-                }
-                uint8_t* buf = (uint8_t*)malloc(advLen);
-                SCOPE_GUARD({
-                    if (buf) {
-                        free(buf);
-                    }
-                });
-                if (!buf) {
-                    LOG(ERROR, "Failed to allocate memory!");
-                    return false;
-                }
-                result.advertisingData().get(BleAdvertisingDataType::MANUFACTURER_SPECIFIC_DATA, buf, advLen);
-                if (!memcmp(buf, filterCustomData, advLen)) {
-                    return true;
-                }
+            if (advLen == filterCustomDatalen && !memcmp(advData, filterCustomData, advLen)) {
+                return true;
             }
             LOG_DEBUG(TRACE, "Custom data mismatched.");
             return false;
@@ -2581,15 +2546,6 @@ private:
         return true;
     }
 
-    bool isCachedDevice(const BleAddress& address) const {
-        for (const auto& addr : cachedDevices_) {
-            if (address == addr) {
-                return true;
-            }
-        }
-        return false;
-    }
-
     Vector<BleScanResult> resultsVector_;
     BleScanResult* resultsPtr_;
     size_t targetCount_;
@@ -2597,7 +2553,7 @@ private:
     std::function<void(const BleScanResult*)> scanResultCallback_;
     BleOnScanResultStdFunction scanResultCallbackRef_;
     BleScanFilter filter_;
-    Vector<BleAddress> cachedDevices_;
+    BleAddressSet cachedDevices_;
 };
 
 int BleLocalDevice::setScanTimeout(uint16_t timeout) const {
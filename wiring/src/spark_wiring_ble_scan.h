@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_BLE
+
+#include "ble_hal.h"
+
+#include <algorithm>
+#include <new>
+#include <cstring>
+
+namespace particle {
+
+namespace ble {
+
+/*
+ * Set of the peer addresses seen during a scan. Implemented as an open addressing hash table, so that
+ * the duplicate check doesn't depend on the number of discovered devices.
+ */
+class BleAddressSet {
+public:
+    // Initial and maximum number of slots in the table
+    static const size_t INITIAL_CAPACITY = 16;
+    static const size_t MAX_CAPACITY = 1024;
+
+    BleAddressSet()
+            : slots_(nullptr),
+              capacity_(0),
+              count_(0) {
+    }
+
+    ~BleAddressSet() {
+        delete[] slots_;
+    }
+
+    /*
+     * Adds an address to the set. Returns false if the address is already in the set. If the set is full,
+     * the address is not cached and the function returns true, i.e. the device will be reported again.
+     */
+    bool insert(const hal_ble_addr_t& addr) {
+        // Keep the load factor below 3/4
+        if ((count_ + 1) * 4 > capacity_ * 3 && !grow()) {
+            return !contains(addr);
+        }
+        Slot* slot = find(slots_, capacity_, addr);
+        if (slot->used) {
+            return false;
+        }
+        slot->addr = addr;
+        slot->used = true;
+        ++count_;
+        return true;
+    }
+
+    bool contains(const hal_ble_addr_t& addr) const {
+        if (!slots_) {
+            return false;
+        }
+        return find(slots_, capacity_, addr)->used;
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+    BleAddressSet(const BleAddressSet&) = delete;
+    BleAddressSet& operator=(const BleAddressSet&) = delete;
+
+private:
+    struct Slot {
+        hal_ble_addr_t addr;
+        bool used;
+    };
+
+    Slot* slots_;
+    size_t capacity_;
+    size_t count_;
+
+    static size_t hash(const hal_ble_addr_t& addr) {
+        // FNV-1a
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < BLE_SIG_ADDR_LEN; ++i) {
+            h = (h ^ addr.addr[i]) * 16777619u;
+        }
+        h = (h ^ addr.addr_type) * 16777619u;
+        return h;
+    }
+
+    static bool equals(const hal_ble_addr_t& a, const hal_ble_addr_t& b) {
+        return a.addr_type == b.addr_type && !memcmp(a.addr, b.addr, BLE_SIG_ADDR_LEN);
+    }
+
+    // The capacity is always a power of two and the table always has free slots
+    static Slot* find(Slot* slots, size_t capacity, const hal_ble_addr_t& addr) {
+        size_t i = hash(addr) & (capacity - 1);
+        while (slots[i].used && !equals(slots[i].addr, addr)) {
+            i = (i + 1) & (capacity - 1);
+        }
+        return &slots[i];
+    }
+
+    bool grow() {
+        const size_t capacity = capacity_ ? capacity_ * 2 : INITIAL_CAPACITY;
+        if (capacity > MAX_CAPACITY) {
+            return false;
+        }
+        Slot* slots = new(std::nothrow) Slot[capacity]();
+        if (!slots) {
+            return false;
+        }
+        for (size_t i = 0; i < capacity_; ++i) {
+            if (slots_[i].used) {
+                *find(slots, capacity, slots_[i].addr) = slots_[i];
+            }
+        }
+        delete[] slots_;
+        slots_ = slots;
+        capacity_ = capacity;
+        return true;
+    }
+};
+
+/*
+ * Locations of the AD structures used by the scan filters. The advertising data is parsed once per
+ * scan result, instead of once per filter and AD type as with BleAdvertisingData::locate().
+ */
+class BleAdStructureIndex {
+public:
+    // Maximum number of indexed service UUID lists
+    static const size_t MAX_UUID_LIST_COUNT = 8;
+
+    BleAdStructureIndex(const uint8_t* data, size_t len)
+            : data_(data),
+              shortName_(),
+              completeName_(),
+              appearance_(),
+              customData_(),
+              uuidLists_(),
+              uuidListCount_(0) {
+        len = std::min(len, (size_t)BLE_MAX_SUPPORTED_ADV_DATA_LEN);
+        // Same traversal rules as in BleAdvertisingData::locate()
+        for (size_t i = 0; (i + 3) <= len; i += (data[i] + 1)) {
+            const size_t adsLen = data[i];
+            if ((i + adsLen + 1) > len) {
+                break;
+            }
+            if (adsLen < 1) {
+                continue;
+            }
+            const Entry e = { (uint16_t)(i + 2), (uint8_t)(adsLen - 1), data[i + 1] };
+            switch (e.type) {
+            case BLE_SIG_AD_TYPE_SHORT_LOCAL_NAME:
+                setFirst(&shortName_, e);
+                break;
+            case BLE_SIG_AD_TYPE_COMPLETE_LOCAL_NAME:
+                setFirst(&completeName_, e);
+                break;
+            case BLE_SIG_AD_TYPE_APPEARANCE:
+                setFirst(&appearance_, e);
+                break;
+            case BLE_SIG_AD_TYPE_MANUFACTURER_SPECIFIC_DATA:
+                setFirst(&customData_, e);
+                break;
+            case BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_MORE_AVAILABLE:
+            case BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE:
+            case BLE_SIG_AD_TYPE_128BIT_SERVICE_UUID_MORE_AVAILABLE:
+            case BLE_SIG_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE:
+                if (uuidListCount_ < MAX_UUID_LIST_COUNT) {
+                    uuidLists_[uuidListCount_++] = e;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Returns the device name as BleAdvertisingData::deviceName() would
+    const uint8_t* deviceName(size_t* len) const {
+        const Entry& e = (shortName_.size > 0) ? shortName_ : completeName_;
+        *len = e.size;
+        return data_ + e.offset;
+    }
+
+    ble_sig_appearance_t appearance() const {
+        if (appearance_.size == 0) {
+            return BLE_SIG_APPEARANCE_UNKNOWN;
+        }
+        const uint8_t* d = data_ + appearance_.offset;
+        const uint16_t hi = (appearance_.size > 1) ? d[1] : 0;
+        return (ble_sig_appearance_t)(hi << 8 | d[0]);
+    }
+
+    const uint8_t* customData(size_t* len) const {
+        *len = customData_.size;
+        return data_ + customData_.offset;
+    }
+
+    bool hasServiceUuids() const {
+        for (size_t i = 0; i < uuidListCount_; ++i) {
+            if (uuidLists_[i].size >= BLE_SIG_UUID_16BIT_LEN) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool containsServiceUuid(const hal_ble_uuid_t& uuid) const {
+        for (size_t i = 0; i < uuidListCount_; ++i) {
+            const Entry& e = uuidLists_[i];
+            const uint8_t* d = data_ + e.offset;
+            if (e.type == BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_MORE_AVAILABLE || e.type == BLE_SIG_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE) {
+                if (uuid.type != BLE_UUID_TYPE_16BIT) {
+                    continue;
+                }
+                for (size_t j = 0; j + BLE_SIG_UUID_16BIT_LEN <= e.size; j += BLE_SIG_UUID_16BIT_LEN) {
+                    if (uuid.uuid16 == ((uint16_t)d[j] | ((uint16_t)d[j + 1] << 8))) {
+                        return true;
+                    }
+                }
+            } else if (uuid.type == BLE_UUID_TYPE_128BIT) {
+                for (size_t j = 0; j + BLE_SIG_UUID_128BIT_LEN <= e.size; j += BLE_SIG_UUID_128BIT_LEN) {
+                    if (!memcmp(uuid.uuid128, d + j, BLE_SIG_UUID_128BIT_LEN)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Entry {
+        uint16_t offset; // Offset of the AD data
+        uint8_t size; // Size of the AD data
+        uint8_t type; // AD type
+    };
+
+    const uint8_t* data_;
+    Entry shortName_;
+    Entry completeName_;
+    Entry appearance_;
+    Entry customData_;
+    Entry uuidLists_[MAX_UUID_LIST_COUNT];
+    size_t uuidListCount_;
+
+    static void setFirst(Entry* dest, const Entry& e) {
+        if (dest->type == 0) {
+            *dest = e;
+        }
+    }
+};
+
+} // namespace ble
+
+} // namespace particle
+
+#endif // HAL_PLATFORM_BLE
@@ -17,6 +17,8 @@
 
 #include "spark_wiring_json.h"
 
+#include "format.h"
+
 #include <algorithm>
 #include <limits>
 
@@ -593,22 +595,13 @@ spark::JSONWriter& spark::JSONWriter::nullValue() {
 }
 
 void spark::JSONWriter::printf(const char *fmt, ...) {
-    char buf[16];
     va_list args;
     va_start(args, fmt);
-    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    particle::vformat([](void* writer, const uint8_t* data, size_t size) {
+        static_cast<JSONWriter*>(writer)->write((const char*)data, size);
+        return true;
+    }, this, fmt, args);
     va_end(args);
-    if ((size_t)n >= sizeof(buf)) {
-        char buf[n + 1]; // Use larger buffer
-        va_start(args, fmt);
-        n = vsnprintf(buf, sizeof(buf), fmt, args);
-        va_end(args);
-        if (n > 0) {
-            write(buf, n);
-        }
-    } else if (n > 0) {
-        write(buf, n);
-    }
 }
 
 void spark::JSONWriter::writeSeparator() {
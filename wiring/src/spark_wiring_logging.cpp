@@ -31,6 +31,8 @@
 #include "spark_wiring_usartserial.h"
 #include "spark_wiring_interrupts.h"
 
+#include "format.h"
+
 // Uncomment to enable logging in interrupt handlers
 // #define LOG_FROM_ISR
 
@@ -551,22 +553,13 @@ void spark::StreamLogHandler::write(const char *data, size_t size) {
 }
 
 void spark::StreamLogHandler::printf(const char *fmt, ...) {
-    char buf[32];
     va_list args;
     va_start(args, fmt);
-    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    particle::vformat([](void* handler, const uint8_t* data, size_t size) {
+        static_cast<StreamLogHandler*>(handler)->write((const char*)data, size);
+        return true;
+    }, this, fmt, args);
     va_end(args);
-    if ((size_t)n >= sizeof(buf)) {
-        char buf[n + 1]; // Use a larger buffer
-        va_start(args, fmt);
-        n = vsnprintf(buf, sizeof(buf), fmt, args);
-        va_end(args);
-        if (n > 0) {
-            write(buf, n);
-        }
-    } else if (n > 0) {
-        write(buf, n);
-    }
 }
 
 // spark::JSONStreamLogHandler
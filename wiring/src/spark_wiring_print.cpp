@@ -180,10 +180,6 @@ size_t Print::println(const __FlashStringHelper* str)
   return println(reinterpret_cast<const char*>(str));
 }
 
-size_t Print::print(const String& str) {
-    return write(str.c_str(), str.length());
-}
-
 // Private Methods /////////////////////////////////////////////////////////////
 
 size_t Print::printNumber(unsigned long n, uint8_t base) {
@@ -238,27 +234,27 @@ size_t Print::vprintf(bool newline, const char* format, va_list args)
         return 0; // Null format string
     }
 
-    const int bufsize = 20;
-    char test[bufsize];
-    va_list args2;
-    va_copy(args2, args);
-    size_t n = vsnprintf(test, bufsize, format, args);
-
-    if (n<bufsize)
-    {
-        n = print(test);
-    }
-    else
-    {
-        char bigger[n+1];
-        n = vsnprintf(bigger, n+1, format, args2);
-        n = print(bigger);
+    FormatSink sink = { this, 0 };
+    const int r = particle::vformat(appendFormatted, &sink, format, args);
+    if (newline && r >= 0) {
+        sink.written += println();
     }
-    if (newline)
-        n += println();
+    return sink.written;
+}
 
-    va_end(args2);
-    return n;
+bool Print::appendFormatted(void* sink, const uint8_t* data, size_t size)
+{
+    auto s = static_cast<FormatSink*>(sink);
+    const size_t n = s->print->write(data, size);
+    s->written += n;
+    if (n != size) {
+        // The rest of the output is discarded. Make sure the caller can tell that it was truncated
+        if (!s->print->getWriteError()) {
+            s->print->setWriteError();
+        }
+        return false;
+    }
+    return true;
 }
 
 namespace particle {
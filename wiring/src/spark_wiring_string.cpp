@@ -31,12 +31,25 @@
 #include <limits.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <charconv>
 #include <cstring>
 #include "string_convert.h"
+#include "str_util.h"
+#include "format.h"
 
 using namespace particle;
 
+namespace {
+
+// Maximum capacity of a string, see String::changeBuffer()
+const unsigned int MAX_STRING_CAPACITY = 65535;
+
+// Minimum capacity of a string that is grown by appending to it
+const unsigned int MIN_GROWN_CAPACITY = 16;
+
+} // namespace
+
 //These are very crude implementations - will refine later
 //------------------------------------------------------------------------------------------
 
@@ -257,9 +270,40 @@ bool String::resize(size_t size) {
     return true;
 }
 
+bool String::shrink_to_fit() {
+    if (!buffer || capacity_ == len) {
+        return true;
+    }
+    char* newbuffer = (char*)realloc(buffer, len + 1);
+    if (!newbuffer) {
+        return false;
+    }
+    buffer = newbuffer;
+    capacity_ = len;
+    return true;
+}
+
+unsigned char String::grow(unsigned int size)
+{
+    if (buffer && capacity_ >= size) {
+        return 1;
+    }
+    // Grow the buffer geometrically so that appending to a string in a loop takes amortized linear
+    // time. If there's not enough memory for that, try allocating exactly as much as needed
+    unsigned int newCapacity = std::max(capacity_ + capacity_ / 2, MIN_GROWN_CAPACITY);
+    newCapacity = std::min(newCapacity, MAX_STRING_CAPACITY);
+    if (newCapacity > size && changeBuffer(newCapacity)) {
+        if (len == 0) {
+            buffer[0] = 0;
+        }
+        return 1;
+    }
+    return reserve(size);
+}
+
 unsigned char String::changeBuffer(unsigned int maxStrLen)
 {
-    if (maxStrLen == 0 || maxStrLen > 65535) {  // Reasonable string size limit
+    if (maxStrLen == 0 || maxStrLen > MAX_STRING_CAPACITY) {  // Reasonable string size limit
         return 0;
     }
     char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
@@ -395,7 +439,7 @@ unsigned char String::concat(const char *cstr, unsigned int length)
     if (length == 0) {
         return 1;
     }
-    if (!reserve(newlen)) {
+    if (!grow(newlen)) {
         return 0;
     }
     memcpy(buffer + len, cstr, length);
@@ -487,18 +531,6 @@ unsigned char String::concat(double num)
     return concat(buf, strlen(buf));
 }
 
-// Optimized concatenation
-String& String::concat(const char* str) {
-    if (str) {
-        size_t len = strlen(str);
-        if (len > 0) {
-            reserve(length() + len);
-            strcat(buffer, str);
-        }
-    }
-    return *this;
-}
-
 /*********************************************/
 /*  Concatenate                              */
 /*********************************************/
@@ -675,14 +707,7 @@ unsigned char String::equalsIgnoreCase( const String &s2 ) const
     if (len == 0) {
         return 1;
     }
-    const char *p1 = buffer;
-    const char *p2 = s2.buffer;
-    while (*p1) {
-        if (tolower(*p1++) != tolower(*p2++)) {
-            return 0;
-        }
-    }
-    return 1;
+    return particle::equalsIgnoreCase(buffer, len, s2.buffer, s2.len);
 }
 
 unsigned char String::startsWith( const String &s2 ) const
@@ -847,23 +872,6 @@ String String::substring( unsigned int left ) const
     return substring(left, len);
 }
 
-// Optimized substring
-String String::substring(size_t start, size_t end) const {
-    if (start >= length()) {
-        return String();
-    }
-    if (end > length()) {
-        end = length();
-    }
-    size_t newLen = end - start;
-    char* newBuffer = new char[newLen + 1];
-    strncpy(newBuffer, buffer + start, newLen);
-    newBuffer[newLen] = '\0';
-    String result(newBuffer);
-    delete[] newBuffer;
-    return result;
-}
-
 String String::substring(unsigned int left, unsigned int right) const
 {
     if (left > right) {
@@ -1054,20 +1062,13 @@ String::String(const Printable& printable)
 
 String String::format(const char* fmt, ...)
 {
-    va_list marker;
-    va_start(marker, fmt);
-    const int bufsize = 5;
-    char test[bufsize];
-    size_t n = vsnprintf(test, bufsize, fmt, marker);
-    va_end(marker);
-
     String result;
-    result.reserve(n);  // internally adds +1 for null terminator
-    if (result.buffer) {
-        va_start(marker, fmt);
-        n = vsnprintf(result.buffer, n+1, fmt, marker);
-        va_end(marker);
-        result.len = n;
-    }
+    va_list args;
+    va_start(args, fmt);
+    particle::vformat([](void* str, const uint8_t* data, size_t size) {
+        return (bool)static_cast<String*>(str)->concat((const char*)data, size);
+    }, &result, fmt, args);
+    va_end(args);
+    result.shrink_to_fit();
     return result;
 }
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "spark_wiring_string_builder.h"
+
+namespace particle {
+
+StringBuilder::StringBuilder() :
+        head_(nullptr),
+        tail_(nullptr),
+        free_(nullptr),
+        len_(0),
+        nextChunkSize_(MIN_CHUNK_SIZE) {
+}
+
+StringBuilder::StringBuilder(StringBuilder&& b) :
+        Print(b),
+        head_(b.head_),
+        tail_(b.tail_),
+        free_(b.free_),
+        len_(b.len_),
+        nextChunkSize_(b.nextChunkSize_) {
+    b.head_ = nullptr;
+    b.tail_ = nullptr;
+    b.free_ = nullptr;
+    b.len_ = 0;
+    b.nextChunkSize_ = MIN_CHUNK_SIZE;
+}
+
+StringBuilder::~StringBuilder() {
+    reset();
+}
+
+StringBuilder& StringBuilder::append(const char* data, size_t size) {
+    while (size > 0) {
+        if (!tail_ || tail_->size == tail_->capacity) {
+            if (!nextChunk()) {
+                setWriteError();
+                break;
+            }
+        }
+        const size_t n = std::min(size, tail_->capacity - tail_->size);
+        std::memcpy(tail_->data() + tail_->size, data, n);
+        tail_->size += n;
+        len_ += n;
+        data += n;
+        size -= n;
+    }
+    return *this;
+}
+
+String StringBuilder::toString() const {
+    String s;
+    if (!len_) {
+        return s;
+    }
+    if (!s.reserve(len_)) {
+        return String((const char*)nullptr);
+    }
+    for (auto c = head_; c; c = c->next) {
+        s.concat(c->data(), c->size);
+    }
+    return s;
+}
+
+size_t StringBuilder::toString(char* buf, size_t size) const {
+    if (!size) {
+        return 0;
+    }
+    size_t offs = 0;
+    for (auto c = head_; c && offs < size - 1; c = c->next) {
+        const size_t n = std::min(c->size, size - 1 - offs);
+        std::memcpy(buf + offs, c->data(), n);
+        offs += n;
+    }
+    buf[offs] = '\0';
+    return offs;
+}
+
+void StringBuilder::clear() {
+    if (tail_) {
+        tail_->next = free_;
+        free_ = head_;
+    }
+    head_ = nullptr;
+    tail_ = nullptr;
+    len_ = 0;
+    clearWriteError();
+}
+
+void StringBuilder::reset() {
+    freeChunks(head_);
+    freeChunks(free_);
+    head_ = nullptr;
+    tail_ = nullptr;
+    free_ = nullptr;
+    len_ = 0;
+    nextChunkSize_ = MIN_CHUNK_SIZE;
+    clearWriteError();
+}
+
+size_t StringBuilder::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t StringBuilder::write(const uint8_t* data, size_t size) {
+    const size_t len = len_;
+    append((const char*)data, size);
+    return len_ - len;
+}
+
+StringBuilder& StringBuilder::operator=(StringBuilder&& b) {
+    if (this != &b) {
+        reset();
+        Print::operator=(b);
+        head_ = b.head_;
+        tail_ = b.tail_;
+        free_ = b.free_;
+        len_ = b.len_;
+        nextChunkSize_ = b.nextChunkSize_;
+        b.head_ = nullptr;
+        b.tail_ = nullptr;
+        b.free_ = nullptr;
+        b.len_ = 0;
+        b.nextChunkSize_ = MIN_CHUNK_SIZE;
+    }
+    return *this;
+}
+
+StringBuilder::Chunk* StringBuilder::nextChunk() {
+    Chunk* c = free_;
+    if (c) {
+        free_ = c->next;
+    } else {
+        c = (Chunk*)malloc(sizeof(Chunk) + nextChunkSize_);
+        if (!c) {
+            return nullptr;
+        }
+        c->capacity = nextChunkSize_;
+        nextChunkSize_ = std::min(nextChunkSize_ * 2, MAX_CHUNK_SIZE);
+    }
+    c->next = nullptr;
+    c->size = 0;
+    if (tail_) {
+        tail_->next = c;
+    } else {
+        head_ = c;
+    }
+    tail_ = c;
+    return c;
+}
+
+void StringBuilder::freeChunks(Chunk* chunk) {
+    while (chunk) {
+        auto next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+} // namespace particle
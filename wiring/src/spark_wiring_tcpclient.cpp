@@ -136,10 +136,10 @@ size_t TCPClient::write(const uint8_t *buffer, size_t size, system_tick_t timeou
         return 0;
     }
     clearWriteError();
-    int ret = status() ? socket_send_ex(d_->sock, buffer, size, 0, timeout, nullptr) : -1;
-    if (ret < 0) {
-        setWriteError(ret);
+    if (d_->txSize) {
+        return writeBuffered(buffer, size, timeout);
     }
+    int ret = sendData(buffer, size, timeout);
 
     /*
      * FIXME: We should not be returning negative numbers here
@@ -147,6 +147,32 @@ size_t TCPClient::write(const uint8_t *buffer, size_t size, system_tick_t timeou
     return ret;
 }
 
+int TCPClient::sendData(const uint8_t* data, size_t size, system_tick_t timeout)
+{
+    int ret = status() ? socket_send_ex(d_->sock, data, size, 0, timeout, nullptr) : -1;
+    if (ret < 0) {
+        setWriteError(ret);
+    }
+    return ret;
+}
+
+int TCPClient::sendDatav(const Chunk* chunks, size_t count, system_tick_t timeout)
+{
+    // The compat socket HAL doesn't support vectored sends
+    int sent = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int ret = sendData(chunks[i].data, chunks[i].size, timeout);
+        if (ret < 0) {
+            return sent ? sent : ret;
+        }
+        sent += ret;
+        if ((size_t)ret != chunks[i].size) {
+            break;
+        }
+    }
+    return sent;
+}
+
 int TCPClient::bufferCount()
 {
   return d_->total - d_->offset;
@@ -156,6 +182,11 @@ int TCPClient::available()
 {
     int avail = 0;
 
+    // The application is about to wait for a response to the buffered data
+    if (d_->txUsed > 0) {
+        sendBuffered(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+    }
+
     // At EOB => Flush it
     if (d_->total && (d_->offset == d_->total))
     {
@@ -169,9 +200,9 @@ int TCPClient::available()
     if(Network.from(nif_).ready() && isOpen(d_->sock))
     {
         // Have room
-        if ( d_->total < arraySize(d_->buffer))
+        if ( d_->total < d_->rxSize)
         {
-            int ret = socket_receive(d_->sock, d_->buffer + d_->total , arraySize(d_->buffer)-d_->total, 0);
+            int ret = socket_receive(d_->sock, d_->buffer + d_->total , d_->rxSize-d_->total, 0);
             if (ret > 0)
             {
                 DEBUG("recv(=%d)",ret);
@@ -219,16 +250,21 @@ void TCPClient::flush_buffer()
   d_->total = 0;
 }
 
-void TCPClient::flush()
+void TCPClient::stop()
 {
+  stop(SPARK_WIRING_TCPCLIENT_DEFAULT_STOP_TIMEOUT);
 }
 
-
-void TCPClient::stop()
+void TCPClient::stop(system_tick_t timeout)
 {
   // This log line pollutes the log too much
   // DEBUG("sock %d closesocket", d_->sock);
 
+  if (d_->txUsed > 0) {
+      clearWriteError();
+      sendBuffered(timeout);
+  }
+
   if (isOpen(d_->sock))
       socket_close(d_->sock);
   d_->sock = socket_handle_invalid();
@@ -269,6 +305,10 @@ IPAddress TCPClient::remoteIP()
 
 TCPClient::Data::Data(sock_handle_t sock)
         : sock(sock),
+          buffer(defaultBuffer),
+          rxSize(sizeof(defaultBuffer)),
+          txSize(0),
+          txUsed(0),
           offset(0),
           total(0) {
 }
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hal_platform.h"
+
+#if HAL_USE_SOCKET_HAL_COMPAT || HAL_USE_SOCKET_HAL_POSIX
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "spark_wiring_tcpclient.h"
+#include "timer_hal.h"
+#include "system_error.h"
+
+// Buffer management shared by the socket HAL specific implementations of TCPClient
+
+bool TCPClient::setBufferSize(size_t rxSize, size_t txSize)
+{
+    if (!rxSize) {
+        return false;
+    }
+    if (d_->txUsed > 0 && sendBuffered(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT) < 0) {
+        return false;
+    }
+    const size_t pending = d_->total - d_->offset;
+    if (pending > rxSize) {
+        return false;
+    }
+    std::unique_ptr<uint8_t[]> rxBuf;
+    uint8_t* buffer = d_->defaultBuffer;
+    if (rxSize != sizeof(d_->defaultBuffer)) {
+        rxBuf.reset(new(std::nothrow) uint8_t[rxSize]);
+        if (!rxBuf) {
+            return false;
+        }
+        buffer = rxBuf.get();
+    }
+    std::unique_ptr<uint8_t[]> txBuf;
+    if (txSize > 0) {
+        if (txSize == d_->txSize) {
+            txBuf = std::move(d_->txBuf);
+        } else {
+            txBuf.reset(new(std::nothrow) uint8_t[txSize]);
+            if (!txBuf) {
+                return false;
+            }
+        }
+    }
+    if (buffer != d_->buffer) {
+        // Keep the data that hasn't been read yet
+        std::memmove(buffer, d_->buffer + d_->offset, pending);
+        d_->offset = 0;
+        d_->total = pending;
+        d_->buffer = buffer;
+        d_->rxBuf = std::move(rxBuf);
+    }
+    d_->rxSize = rxSize;
+    d_->txBuf = std::move(txBuf);
+    d_->txSize = txSize;
+    d_->txUsed = 0;
+    return true;
+}
+
+void TCPClient::flush()
+{
+    if (d_->txUsed > 0) {
+        clearWriteError();
+        sendBuffered(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+    }
+}
+
+size_t TCPClient::write(const Chunk* chunks, size_t count, system_tick_t timeout)
+{
+    if (!chunks && count > 0) {
+        return 0;
+    }
+    clearWriteError();
+    size_t written = 0;
+    if (d_->txSize) {
+        for (size_t i = 0; i < count; ++i) {
+            const size_t n = writeBuffered(chunks[i].data, chunks[i].size, timeout);
+            written += n;
+            if (n != chunks[i].size) {
+                break;
+            }
+        }
+        return written;
+    }
+    const int ret = sendDatav(chunks, count, timeout);
+    return (ret > 0) ? ret : 0;
+}
+
+size_t TCPClient::writeBuffered(const uint8_t* data, size_t size, system_tick_t timeout)
+{
+    if (size > d_->txSize - d_->txUsed && sendBuffered(timeout) < 0) {
+        return 0;
+    }
+    if (size >= d_->txSize) {
+        // The data wouldn't fit in the buffer anyway
+        const int ret = sendData(data, size, timeout);
+        return (ret > 0) ? ret : 0;
+    }
+    std::memcpy(d_->txBuf.get() + d_->txUsed, data, size);
+    d_->txUsed += size;
+    return size;
+}
+
+int TCPClient::sendBuffered(system_tick_t timeout)
+{
+    // The timeout applies to the whole buffer, not to each partial send
+    const system_tick_t start = HAL_Timer_Get_Milli_Seconds();
+    size_t offs = 0;
+    while (offs < d_->txUsed) {
+        system_tick_t t = timeout;
+        if (timeout != SOCKET_WAIT_FOREVER) {
+            const system_tick_t elapsed = std::min(HAL_Timer_Get_Milli_Seconds() - start, timeout);
+            if (elapsed == timeout && offs > 0) {
+                // Discard the data that couldn't be sent in time
+                d_->txUsed = 0;
+                setWriteError(SYSTEM_ERROR_TIMEOUT);
+                return SYSTEM_ERROR_TIMEOUT;
+            }
+            t = timeout - elapsed;
+        }
+        const int ret = sendData(d_->txBuf.get() + offs, d_->txUsed - offs, t);
+        if (ret <= 0) {
+            // The connection is most likely broken, discard the remaining data
+            d_->txUsed = 0;
+            return (ret < 0) ? ret : -1;
+        }
+        offs += ret;
+    }
+    d_->txUsed = 0;
+    return offs;
+}
+
+#endif // HAL_USE_SOCKET_HAL_COMPAT || HAL_USE_SOCKET_HAL_POSIX
@@ -32,6 +32,7 @@
 #endif // HAL_PLATFORM_IFAPI
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <algorithm>
 #include "spark_wiring_constants.h"
 #include "spark_wiring_posix_common.h"
 
@@ -143,6 +144,23 @@ size_t TCPClient::write(uint8_t b, system_tick_t timeout) {
 
 size_t TCPClient::write(const uint8_t *buffer, size_t size, system_tick_t timeout) {
     clearWriteError();
+    if (d_->txSize) {
+        return writeBuffered(buffer, size, timeout);
+    }
+    int ret = sendData(buffer, size, timeout);
+    if (ret < 0) {
+        return 0;
+    }
+
+    return ret;
+}
+
+int TCPClient::sendData(const uint8_t* data, size_t size, system_tick_t timeout) {
+    const Chunk chunk = { data, size };
+    return sendDatav(&chunk, 1, timeout);
+}
+
+int TCPClient::sendDatav(const Chunk* chunks, size_t count, system_tick_t timeout) {
     struct timeval tv = {};
     if (timeout != SOCKET_WAIT_FOREVER) {
         tv.tv_sec = timeout / 1000;
@@ -151,16 +169,35 @@ size_t TCPClient::write(const uint8_t *buffer, size_t size, system_tick_t timeou
     int ret = sock_setsockopt(d_->sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
     if (ret < 0) {
         setWriteError(errno);
-        return 0;
+        return -1;
     }
 
-    ret = sock_send(d_->sock, buffer, size, 0);
-    if (ret < 0) {
-        setWriteError(errno);
-        return 0;
+    // Send the chunks in groups that fit in the array
+    int sent = 0;
+    struct iovec iov[8] = {};
+    for (size_t i = 0; i < count;) {
+        const size_t iovCount = std::min(count - i, arraySize(iov));
+        size_t size = 0;
+        for (size_t j = 0; j < iovCount; ++j) {
+            iov[j].iov_base = (void*)chunks[i + j].data;
+            iov[j].iov_len = chunks[i + j].size;
+            size += chunks[i + j].size;
+        }
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovCount;
+        ret = sock_sendmsg(d_->sock, &msg, 0);
+        if (ret < 0) {
+            setWriteError(errno);
+            return sent ? sent : -1;
+        }
+        sent += ret;
+        if ((size_t)ret != size) {
+            break; // The send timed out
+        }
+        i += iovCount;
     }
-
-    return ret;
+    return sent;
 }
 
 int TCPClient::bufferCount() {
@@ -171,6 +208,11 @@ int TCPClient::available()
 {
     int avail = 0;
 
+    // The application is about to wait for a response to the buffered data
+    if (d_->txUsed > 0) {
+        sendBuffered(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+    }
+
     // At EOB => Flush it
     if (d_->total && (d_->offset == d_->total)) {
         flush_buffer();
@@ -178,8 +220,8 @@ int TCPClient::available()
 
     if (isOpen(d_->sock)) {
         // Have room
-        if (d_->total < arraySize(d_->buffer)) {
-            int ret = sock_recv(d_->sock, d_->buffer + d_->total, arraySize(d_->buffer) - d_->total, MSG_DONTWAIT);
+        if (d_->total < d_->rxSize) {
+            int ret = sock_recv(d_->sock, d_->buffer + d_->total, d_->rxSize - d_->total, MSG_DONTWAIT);
             if (ret > 0) {
                 if (d_->total == 0) {
                     d_->offset = 0;
@@ -221,10 +263,15 @@ void TCPClient::flush_buffer() {
     d_->total = 0;
 }
 
-void TCPClient::flush() {
+void TCPClient::stop() {
+    stop(SPARK_WIRING_TCPCLIENT_DEFAULT_STOP_TIMEOUT);
 }
 
-void TCPClient::stop() {
+void TCPClient::stop(system_tick_t timeout) {
+    if (d_->txUsed > 0) {
+        clearWriteError();
+        sendBuffered(timeout);
+    }
     if (isOpen(d_->sock)) {
         sock_close(d_->sock);
     }
@@ -258,6 +305,10 @@ IPAddress TCPClient::remoteIP() {
 
 TCPClient::Data::Data(sock_handle_t sock)
         : sock(sock),
+          buffer(defaultBuffer),
+          rxSize(sizeof(defaultBuffer)),
+          txSize(0),
+          txUsed(0),
           offset(0),
           total(0) {
 }
@@ -75,7 +75,7 @@ bool UDP::setBuffer(size_t buf_size, uint8_t* buffer)
 void UDP::releaseBuffer()
 {
     if (_buffer_allocated && _buffer) {
-        delete _buffer;
+        delete[] _buffer;
     }
     _buffer = NULL;
     _buffer_allocated = false;
@@ -122,6 +122,9 @@ void UDP::stop()
     _sock = socket_handle_invalid();
 
     flush_buffer(); // clear buffer
+    if (_pool) {
+        _pool->clear();
+    }
 }
 
 int UDP::beginPacket(const char *host, uint16_t port)
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <new>
+
+#include "spark_wiring_udp_packet.h"
+#include "system_error.h"
+
+namespace particle {
+
+namespace detail {
+
+UdpPacketPool::UdpPacketPool(size_t packetCount, size_t packetSize) :
+        spare_(nullptr),
+        packetSize_(packetSize),
+        queueCapacity_(packetCount),
+        queueHead_(0),
+        queueSize_(0),
+        nextSlot_(0),
+        dropped_(0) {
+}
+
+int UdpPacketPool::init() {
+    if (!queueCapacity_ || !packetSize_) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const size_t slotCount = queueCapacity_ + 1; // Including the spare buffer
+    slots_.reset(new(std::nothrow) Slot[slotCount]);
+    data_.reset(new(std::nothrow) uint8_t[slotCount * packetSize_]);
+    queue_.reset(new(std::nothrow) Slot*[queueCapacity_]);
+    if (!slots_ || !data_ || !queue_) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots_[i].data = data_.get() + i * packetSize_;
+    }
+    return 0;
+}
+
+UdpPacketPool::Slot* UdpPacketPool::spare() {
+    if (!spare_) {
+        spare_ = allocSlot();
+    }
+    return spare_;
+}
+
+void UdpPacketPool::commit(size_t size, const IPAddress& remoteIP, uint16_t remotePort) {
+    auto slot = spare_;
+    slot->size = size;
+    slot->remoteIP = remoteIP;
+    slot->remotePort = remotePort;
+    if (queueSize_ == queueCapacity_) {
+        // Drop the oldest packet and reuse its buffer. The queue's reference is passed to the spare buffer
+        spare_ = queue_[queueHead_];
+        queueHead_ = queueIndex(1);
+        --queueSize_;
+        ++dropped_;
+    } else {
+        spare_ = nullptr;
+    }
+    queue_[queueIndex(queueSize_)] = slot;
+    ++queueSize_;
+}
+
+UdpPacketPool::Slot* UdpPacketPool::pop() {
+    if (!queueSize_) {
+        return nullptr;
+    }
+    auto slot = queue_[queueHead_];
+    queueHead_ = queueIndex(1);
+    --queueSize_;
+    return slot;
+}
+
+void UdpPacketPool::clear() {
+    while (queueSize_ > 0) {
+        releaseSlot(pop());
+    }
+    queueHead_ = 0;
+}
+
+UdpPacketPool::Slot* UdpPacketPool::allocSlot() {
+    // Only the owner of the pool can acquire a buffer, other threads can only release them.
+    // Buffers are mostly released in the order they were allocated, so the search starts after the
+    // last allocated buffer
+    const size_t slotCount = queueCapacity_ + 1;
+    size_t i = nextSlot_;
+    for (size_t n = 0; n < slotCount; ++n) {
+        auto slot = &slots_[i];
+        if (++i == slotCount) {
+            i = 0;
+        }
+        if (slot != spare_ && slot->refCount.load(std::memory_order_acquire) == 0) {
+            slot->refCount.store(1, std::memory_order_relaxed);
+            nextSlot_ = i;
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace detail
+
+} // namespace particle
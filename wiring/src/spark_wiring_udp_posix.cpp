@@ -119,7 +119,7 @@ bool UDP::setBuffer(size_t buf_size, uint8_t* buffer) {
 
 void UDP::releaseBuffer() {
     if (_buffer_allocated && _buffer) {
-        delete _buffer;
+        delete[] _buffer;
     }
     _buffer = NULL;
     _buffer_allocated = false;
@@ -207,6 +207,9 @@ void UDP::stop() {
     _sock = -1;
 
     flush_buffer(); // clear buffer
+    if (_pool) {
+        _pool->clear();
+    }
 }
 
 int UDP::beginPacket(const char *host, uint16_t port) {
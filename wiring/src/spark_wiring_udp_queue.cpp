@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hal_platform.h"
+
+#if HAL_USE_SOCKET_HAL_COMPAT || HAL_USE_SOCKET_HAL_POSIX
+
+#include "spark_wiring_udp.h"
+#include "system_error.h"
+#include "check.h"
+
+// Packet queue shared by the socket HAL specific implementations of UDP
+
+using particle::detail::UdpPacketPool;
+
+bool UDP::setPacketPool(size_t packetCount, size_t packetSize) {
+    if (!packetCount) {
+        _pool = nullptr;
+        return true;
+    }
+    auto pool = particle::makeRefCountPtr<UdpPacketPool>(packetCount, packetSize);
+    if (!pool || pool->init() < 0) {
+        return false;
+    }
+    _pool = std::move(pool);
+    return true;
+}
+
+int UDP::poll() {
+    if (!_pool || !socket_handle_valid(_sock)) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+    // The address of the sender of the packet parsed with parsePacket() should not change
+    const auto remoteIP = _remoteIP;
+    const auto remotePort = _remotePort;
+    int count = 0;
+    // Receive at most as many packets as the queue can hold so that a flood of packets can't keep
+    // the application in this loop
+    while ((size_t)count < _pool->packetCount()) {
+        auto slot = _pool->spare();
+        if (!slot) {
+            break; // All buffers are used by the application
+        }
+        const int r = receivePacket(slot->data, _pool->packetSize(), 0 /* timeout */);
+        if (r <= 0) {
+            break;
+        }
+        _pool->commit(r, _remoteIP, _remotePort);
+        ++count;
+    }
+    _remoteIP = remoteIP;
+    _remotePort = remotePort;
+    return count;
+}
+
+int UDP::receivePacket(Packet& packet, system_tick_t timeout) {
+    packet.release();
+    CHECK(poll());
+    if (!_pool->queuedCount() && timeout > 0) {
+        auto slot = _pool->spare();
+        if (slot) {
+            // Same as in poll(), the sender is only updated if a packet is retrieved from the queue
+            const auto remoteIP = _remoteIP;
+            const auto remotePort = _remotePort;
+            const int r = receivePacket(slot->data, _pool->packetSize(), timeout);
+            if (r > 0) {
+                _pool->commit(r, _remoteIP, _remotePort);
+            }
+            _remoteIP = remoteIP;
+            _remotePort = remotePort;
+        }
+    }
+    auto slot = _pool->pop();
+    if (!slot) {
+        return 0;
+    }
+    _remoteIP = slot->remoteIP;
+    _remotePort = slot->remotePort;
+    packet = Packet(_pool, slot);
+    return slot->size;
+}
+
+#endif // HAL_USE_SOCKET_HAL_COMPAT || HAL_USE_SOCKET_HAL_POSIX